@@ -62,6 +62,7 @@
 #include "libavutil/bprint.h"
 #include "libavutil/time.h"
 #include "libavutil/threadmessage.h"
+#include "libavutil/trace.h"
 #include "libavcodec/mathops.h"
 #include "libavformat/os_support.h"
 
@@ -463,6 +464,39 @@ static int decode_interrupt_cb(void *ctx)
 
 const AVIOInterruptCB int_cb = { decode_interrupt_cb, NULL };
 
+static int compare_mem_peak(const void *a, const void *b)
+{
+    const AVMemStats *sa = a, *sb = b;
+    return FFDIFFSIGN(sb->peak_bytes, sa->peak_bytes);
+}
+
+static void print_mem_stats(void)
+{
+    AVMemStats total, *stats;
+    int i, nb_stats;
+
+    stats = av_mem_get_stats(&total, &nb_stats);
+    if (!stats)
+        return;
+
+    av_log(NULL, AV_LOG_INFO, "bench: mem peak=%"PRId64"kB current=%"PRId64"kB allocs=%"PRIu64"\n",
+           total.peak_bytes >> 10, total.bytes >> 10, total.nb_allocs);
+    qsort(stats, nb_stats, sizeof(*stats), compare_mem_peak);
+    for (i = 0; i < nb_stats; i++) {
+        char tag[256] = "untagged";
+
+        if (!stats[i].nb_allocs)
+            continue;
+        if (stats[i].class_name)
+            snprintf(tag, sizeof(tag), "%s:%s", stats[i].class_name,
+                     stats[i].name ? stats[i].name : "");
+        av_log(NULL, AV_LOG_INFO, "bench: mem %s peak=%"PRId64"kB current=%"PRId64"kB allocs=%"PRIu64"\n",
+               tag, stats[i].peak_bytes >> 10, stats[i].bytes >> 10,
+               stats[i].nb_allocs);
+    }
+    av_free(stats);
+}
+
 static void ffmpeg_cleanup(int ret)
 {
     int i, j;
@@ -471,6 +505,8 @@ static void ffmpeg_cleanup(int ret)
         int maxrss = getmaxrss() / 1024;
         av_log(NULL, AV_LOG_INFO, "bench: maxrss=%ikB\n", maxrss);
     }
+    if (do_benchmark_mem)
+        print_mem_stats();
 
     for (i = 0; i < nb_filtergraphs; i++) {
         FilterGraph *fg = filtergraphs[i];
@@ -601,6 +637,8 @@ static void ffmpeg_cleanup(int ret)
     }
     av_freep(&vstats_filename);
 
+    av_trace_stop();
+
     av_freep(&input_streams);
     av_freep(&input_files);
     av_freep(&output_streams);
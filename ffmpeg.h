@@ -591,6 +591,7 @@ extern int video_sync_method;
 extern float frame_drop_threshold;
 extern int do_benchmark;
 extern int do_benchmark_all;
+extern int do_benchmark_mem;
 extern int do_deinterlace;
 extern int do_hex_dump;
 extern int do_pkt_dump;
@@ -40,6 +40,7 @@
 #include "libavutil/parseutils.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/trace.h"
 
 #define DEFAULT_PASS_LOGFILENAME_PREFIX "ffmpeg2pass"
 
@@ -105,6 +106,7 @@ int video_sync_method = VSYNC_AUTO;
 float frame_drop_threshold = 0;
 int do_deinterlace    = 0;
 int do_benchmark      = 0;
+int do_benchmark_mem  = 0;
 int do_benchmark_all  = 0;
 int do_hex_dump       = 0;
 int do_pkt_dump       = 0;
@@ -452,6 +454,17 @@ static int opt_sdp_file(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_trace(void *optctx, const char *opt, const char *arg)
+{
+    int ret = av_trace_start(arg);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_FATAL, "Failed to open trace file '%s': %s\n",
+               arg, av_err2str(ret));
+        exit_program(1);
+    }
+    return 0;
+}
+
 #if CONFIG_VAAPI
 static int opt_vaapi_device(void *optctx, const char *opt, const char *arg)
 {
@@ -3247,6 +3260,9 @@ int ffmpeg_parse_options(int argc, char **argv)
         goto fail;
     }
 
+    if (do_benchmark_mem && av_mem_set_accounting(1) < 0)
+        av_log(NULL, AV_LOG_WARNING, "Memory accounting is not supported on this build\n");
+
     /* configure terminal and setup signal handlers */
     term_init();
 
@@ -3375,6 +3391,10 @@ const OptionDef options[] = {
         "add timings for benchmarking" },
     { "benchmark_all",  OPT_BOOL | OPT_EXPERT,                       { &do_benchmark_all },
       "add timings for each task" },
+    { "benchmark_mem",  OPT_BOOL | OPT_EXPERT,                       { &do_benchmark_mem },
+      "add heap memory statistics per component" },
+    { "trace",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_trace },
+      "write a timeline of the processing steps to a Chrome trace file", "file" },
     { "progress",       HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_progress },
       "write program-readable progress information", "url" },
     { "stdin",          OPT_BOOL | OPT_EXPERT,                       { &stdin_interaction },
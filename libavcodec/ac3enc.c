@@ -935,32 +935,44 @@ static void count_frame_bits(AC3EncodeContext *s)
 
 
 /*
- * Calculate masking curve based on the final exponents.
+ * Calculate masking curve of one channel based on the final exponents.
  * Also calculate the power spectral densities to use in future calculations.
+ * Channels are independent here, so this is run as a slice thread job.
  */
-static void bit_alloc_masking(AC3EncodeContext *s)
+static int bit_alloc_masking_ch(AVCodecContext *avctx, void *arg, int ch, int threadnr)
 {
-    int blk, ch;
+    AC3EncodeContext *s = avctx->priv_data;
+    int blk;
 
     for (blk = 0; blk < s->num_blocks; blk++) {
         AC3Block *block = &s->blocks[blk];
-        for (ch = !block->cpl_in_use; ch <= s->channels; ch++) {
-            /* We only need psd and mask for calculating bap.
-               Since we currently do not calculate bap when exponent
-               strategy is EXP_REUSE we do not need to calculate psd or mask. */
-            if (s->exp_strategy[ch][blk] != EXP_REUSE) {
-                ff_ac3_bit_alloc_calc_psd(block->exp[ch], s->start_freq[ch],
-                                          block->end_freq[ch], block->psd[ch],
-                                          block->band_psd[ch]);
-                ff_ac3_bit_alloc_calc_mask(&s->bit_alloc, block->band_psd[ch],
-                                           s->start_freq[ch], block->end_freq[ch],
-                                           ff_ac3_fast_gain_tab[s->fast_gain_code[ch]],
-                                           ch == s->lfe_channel,
-                                           DBA_NONE, 0, NULL, NULL, NULL,
-                                           block->mask[ch]);
-            }
+        if (ch == CPL_CH && !block->cpl_in_use)
+            continue;
+        /* We only need psd and mask for calculating bap.
+           Since we currently do not calculate bap when exponent
+           strategy is EXP_REUSE we do not need to calculate psd or mask. */
+        if (s->exp_strategy[ch][blk] != EXP_REUSE) {
+            ff_ac3_bit_alloc_calc_psd(block->exp[ch], s->start_freq[ch],
+                                      block->end_freq[ch], block->psd[ch],
+                                      block->band_psd[ch]);
+            ff_ac3_bit_alloc_calc_mask(&s->bit_alloc, block->band_psd[ch],
+                                       s->start_freq[ch], block->end_freq[ch],
+                                       ff_ac3_fast_gain_tab[s->fast_gain_code[ch]],
+                                       ch == s->lfe_channel,
+                                       DBA_NONE, 0, NULL, NULL, NULL,
+                                       block->mask[ch]);
         }
     }
+    return 0;
+}
+
+
+/*
+ * Calculate masking curves for all channels, including the coupling channel.
+ */
+static void bit_alloc_masking(AC3EncodeContext *s)
+{
+    s->avctx->execute2(s->avctx, bit_alloc_masking_ch, NULL, NULL, s->channels + 1);
 }
 
 
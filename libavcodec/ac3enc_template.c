@@ -41,8 +41,8 @@ int AC3_NAME(allocate_sample_buffers)(AC3EncodeContext *s)
 {
     int ch;
 
-    FF_ALLOC_OR_GOTO(s->avctx, s->windowed_samples, AC3_WINDOW_SIZE *
-                     sizeof(*s->windowed_samples), alloc_fail);
+    FF_ALLOC_ARRAY_OR_GOTO(s->avctx, s->windowed_samples, s->channels,
+                           AC3_WINDOW_SIZE * sizeof(*s->windowed_samples), alloc_fail);
     FF_ALLOC_ARRAY_OR_GOTO(s->avctx, s->planar_samples, s->channels, sizeof(*s->planar_samples),
                      alloc_fail);
     for (ch = 0; ch < s->channels; ch++) {
@@ -80,34 +80,47 @@ static void copy_input_samples(AC3EncodeContext *s, SampleType **samples)
 
 
 /*
- * Apply the MDCT to input samples to generate frequency coefficients.
+ * Apply the MDCT to the input samples of one channel.
  * This applies the KBD window and normalizes the input to reduce precision
  * loss due to fixed-point calculations.
+ * Channels are independent here, so this is run as a slice thread job.
  */
-static void apply_mdct(AC3EncodeContext *s)
+static int apply_mdct_ch(AVCodecContext *avctx, void *arg, int ch, int threadnr)
 {
-    int blk, ch;
+    AC3EncodeContext *s = avctx->priv_data;
+    SampleType *windowed_samples = s->windowed_samples + ch * AC3_WINDOW_SIZE;
+    int blk;
 
-    for (ch = 0; ch < s->channels; ch++) {
-        for (blk = 0; blk < s->num_blocks; blk++) {
-            AC3Block *block = &s->blocks[blk];
-            const SampleType *input_samples = &s->planar_samples[ch][blk * AC3_BLOCK_SIZE];
+    for (blk = 0; blk < s->num_blocks; blk++) {
+        AC3Block *block = &s->blocks[blk];
+        const SampleType *input_samples = &s->planar_samples[ch][blk * AC3_BLOCK_SIZE];
 
 #if CONFIG_AC3ENC_FLOAT
-            s->fdsp->vector_fmul(s->windowed_samples, input_samples,
-                                s->mdct_window, AC3_WINDOW_SIZE);
+        s->fdsp->vector_fmul(windowed_samples, input_samples,
+                            s->mdct_window, AC3_WINDOW_SIZE);
 #else
-            s->ac3dsp.apply_window_int16(s->windowed_samples, input_samples,
-                                         s->mdct_window, AC3_WINDOW_SIZE);
+        s->ac3dsp.apply_window_int16(windowed_samples, input_samples,
+                                     s->mdct_window, AC3_WINDOW_SIZE);
 
-            if (s->fixed_point)
-                block->coeff_shift[ch+1] = normalize_samples(s);
+        if (s->fixed_point)
+            block->coeff_shift[ch+1] = normalize_samples(s, windowed_samples);
 #endif
 
-            s->mdct.mdct_calcw(&s->mdct, block->mdct_coef[ch+1],
-                               s->windowed_samples);
-        }
+        s->mdct.mdct_calcw(&s->mdct, block->mdct_coef[ch+1],
+                           windowed_samples);
     }
+
+    emms_c();
+    return 0;
+}
+
+
+/*
+ * Apply the MDCT to input samples to generate frequency coefficients.
+ */
+static void apply_mdct(AC3EncodeContext *s)
+{
+    s->avctx->execute2(s->avctx, apply_mdct_ch, NULL, NULL, s->channels);
 }
 
 
@@ -39,6 +39,7 @@
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/threadpool.h"
 
 #include "version.h"
 
@@ -3681,6 +3682,36 @@ typedef struct AVCodecContext {
      * (with the display dimensions being determined by the crop_* fields).
      */
     int apply_cropping;
+
+    /**
+     * Shared thread pool on which to run the slice threading jobs, instead of
+     * threads owned by the codec context. Frame threading is not affected.
+     * If thread_count is 0, it is derived from the size of the pool.
+     *
+     * - encoding/decoding: Set by user before avcodec_open2(). The pool must
+     *   outlive the codec context.
+     */
+    AVThreadPool *thread_pool;
+
+    /**
+     * Frame threading: approximate limit, in bytes, on the memory taken by
+     * the pictures decoded at the same time. Fewer threads are kept active
+     * when the pictures are large. 0 means no limit.
+     *
+     * - encoding: unused
+     * - decoding: Set by user before avcodec_open2().
+     */
+    int64_t thread_max_memory;
+
+    /**
+     * Frame threading: start with as few active threads as possible and
+     * activate one more, up to thread_count, whenever the caller keeps
+     * waiting for decoded frames.
+     *
+     * - encoding: unused
+     * - decoding: Set by user before avcodec_open2().
+     */
+    int thread_adaptive;
 } AVCodecContext;
 
 AVRational av_codec_get_pkt_timebase         (const AVCodecContext *avctx);
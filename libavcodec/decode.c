@@ -36,6 +36,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/intmath.h"
+#include "libavutil/trace.h"
 
 #include "avcodec.h"
 #include "bytestream.h"
@@ -632,10 +633,14 @@ static int decode_receive_frame_internal(AVCodecContext *avctx, AVFrame *frame)
 
     av_assert0(!frame->buf[0]);
 
+    av_trace_begin("decode", avctx->codec->name);
+    av_mem_tag_push(avctx);
     if (avctx->codec->receive_frame)
         ret = avctx->codec->receive_frame(avctx, frame);
     else
         ret = decode_simple_receive_frame(avctx, frame);
+    av_mem_tag_pop();
+    av_trace_end("decode", avctx->codec->name);
 
     if (ret == AVERROR_EOF)
         avci->draining_done = 1;
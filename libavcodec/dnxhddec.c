@@ -31,6 +31,7 @@
 #define  UNCHECKED_BITSTREAM_READER 1
 #include "get_bits.h"
 #include "dnxhddata.h"
+#include "dnxhddsp.h"
 #include "idctdsp.h"
 #include "internal.h"
 #include "profiles.h"
@@ -38,8 +39,11 @@
 
 typedef struct RowContext {
     DECLARE_ALIGNED(16, int16_t, blocks)[12][64];
-    int luma_scale[64];
-    int chroma_scale[64];
+    /* dequantization tables in block (permuted) order */
+    DECLARE_ALIGNED(32, int32_t, luma_scale)[64];
+    DECLARE_ALIGNED(32, int32_t, chroma_scale)[64];
+    DECLARE_ALIGNED(32, int32_t, luma_bias)[64];   ///< rounding, depends on luma_scale
+    DECLARE_ALIGNED(32, int32_t, chroma_bias)[64]; ///< rounding, depends on chroma_scale
     GetBitContext gb;
     int last_dc[3];
     int last_qscale;
@@ -52,6 +56,7 @@ typedef struct DNXHDContext {
     AVCodecContext *avctx;
     RowContext *rows;
     BlockDSPContext bdsp;
+    DNXHDDSPContext dsp;
     const uint8_t* buf;
     int buf_size;
     int64_t cid;                        ///< compression id
@@ -69,6 +74,7 @@ typedef struct DNXHDContext {
     int is_444;
     int mbaff;
     int act;
+    int level_bias;                     ///< rounding bias added to dequantized levels
     int (*decode_dct_block)(const struct DNXHDContext *ctx,
                             RowContext *row, int n);
 } DNXHDContext;
@@ -84,8 +90,6 @@ static int dnxhd_decode_dct_block_10_444(const DNXHDContext *ctx,
                                          RowContext *row, int n);
 static int dnxhd_decode_dct_block_12(const DNXHDContext *ctx,
                                      RowContext *row, int n);
-static int dnxhd_decode_dct_block_12_444(const DNXHDContext *ctx,
-                                         RowContext *row, int n);
 
 static av_cold int dnxhd_decode_init(AVCodecContext *avctx)
 {
@@ -239,30 +243,38 @@ static int dnxhd_decode_header(DNXHDContext *ctx, AVFrame *frame,
             return AVERROR_INVALIDDATA;
         } else if (bitdepth == 10) {
             ctx->decode_dct_block = dnxhd_decode_dct_block_10_444;
+            ctx->level_bias = 32;
             ctx->pix_fmt = ctx->act ? AV_PIX_FMT_YUV444P10
                                     : AV_PIX_FMT_GBRP10;
         } else {
-            ctx->decode_dct_block = dnxhd_decode_dct_block_12_444;
+            ctx->decode_dct_block = dnxhd_decode_dct_block_12;
+            ctx->level_bias = 32;
             ctx->pix_fmt = ctx->act ? AV_PIX_FMT_YUV444P12
                                     : AV_PIX_FMT_GBRP12;
         }
     } else if (bitdepth == 12) {
         ctx->decode_dct_block = dnxhd_decode_dct_block_12;
+        ctx->level_bias = 8;
         ctx->pix_fmt = AV_PIX_FMT_YUV422P12;
     } else if (bitdepth == 10) {
-        if (ctx->avctx->profile == FF_PROFILE_DNXHR_HQX)
+        if (ctx->avctx->profile == FF_PROFILE_DNXHR_HQX) {
             ctx->decode_dct_block = dnxhd_decode_dct_block_10_444;
-        else
+            ctx->level_bias = 32;
+        } else {
             ctx->decode_dct_block = dnxhd_decode_dct_block_10;
+            ctx->level_bias = 8;
+        }
         ctx->pix_fmt = AV_PIX_FMT_YUV422P10;
     } else {
         ctx->decode_dct_block = dnxhd_decode_dct_block_8;
+        ctx->level_bias = 32;
         ctx->pix_fmt = AV_PIX_FMT_YUV422P;
     }
 
     ctx->avctx->bits_per_raw_sample = ctx->bit_depth = bitdepth;
     if (ctx->bit_depth != old_bit_depth) {
         ff_blockdsp_init(&ctx->bdsp, ctx->avctx);
+        ff_dnxhddsp_init(&ctx->dsp);
         ff_idctdsp_init(&ctx->idsp, ctx->avctx);
         ff_init_scantable(ctx->idsp.idct_permutation, &ctx->scantable,
                           ff_zigzag_direct);
@@ -338,14 +350,12 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
                                                    RowContext *row,
                                                    int n,
                                                    int index_bits,
-                                                   int level_bias,
                                                    int level_shift,
                                                    int dc_shift)
 {
     int i, j, index1, index2, len, flags;
     int level, component, sign;
-    const int *scale;
-    const uint8_t *weight_matrix;
+    const int32_t *scale, *bias;
     const uint8_t *ac_info = ctx->cid_table->ac_info;
     int16_t *block = row->blocks[n];
     const int eob_index     = ctx->cid_table->eob_index;
@@ -356,22 +366,22 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
 
     if (!ctx->is_444) {
         if (n & 2) {
-            component     = 1 + (n & 1);
-            scale = row->chroma_scale;
-            weight_matrix = ctx->cid_table->chroma_weight;
+            component = 1 + (n & 1);
+            scale     = row->chroma_scale;
+            bias      = row->chroma_bias;
         } else {
-            component     = 0;
-            scale = row->luma_scale;
-            weight_matrix = ctx->cid_table->luma_weight;
+            component = 0;
+            scale     = row->luma_scale;
+            bias      = row->luma_bias;
         }
     } else {
         component = (n >> 1) % 3;
         if (component) {
             scale = row->chroma_scale;
-            weight_matrix = ctx->cid_table->chroma_weight;
+            bias  = row->chroma_bias;
         } else {
             scale = row->luma_scale;
-            weight_matrix = ctx->cid_table->luma_weight;
+            bias  = row->luma_bias;
         }
     }
 
@@ -384,7 +394,6 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
         level = (NEG_USR32(sign ^ level, len) ^ sign) - sign;
         row->last_dc[component] += level * (1 << dc_shift);
     }
-    block[0] = row->last_dc[component];
 
     i = 0;
 
@@ -417,13 +426,7 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
             break;
         }
 
-        j     = ctx->scantable.permutated[i];
-        level *= scale[i];
-        level += scale[i] >> 1;
-        if (level_bias < 32 || weight_matrix[i] != level_bias)
-            level += level_bias; // 1<<(level_shift-1)
-        level >>= level_shift;
-
+        j        = ctx->scantable.permutated[i];
         block[j] = (level ^ sign) - sign;
 
         UPDATE_CACHE(bs, &row->gb);
@@ -432,37 +435,48 @@ static av_always_inline int dnxhd_decode_dct_block(const DNXHDContext *ctx,
     }
 
     CLOSE_READER(bs, &row->gb);
+
+    if (i)
+        ctx->dsp.dequant(block, scale, bias, level_shift);
+    block[0] = row->last_dc[component];
+
     return ret;
 }
 
 static int dnxhd_decode_dct_block_8(const DNXHDContext *ctx,
                                     RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 4, 32, 6, 0);
+    return dnxhd_decode_dct_block(ctx, row, n, 4, 6, 0);
 }
 
 static int dnxhd_decode_dct_block_10(const DNXHDContext *ctx,
                                      RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 8, 4, 0);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 4, 0);
 }
 
 static int dnxhd_decode_dct_block_10_444(const DNXHDContext *ctx,
                                          RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 32, 6, 0);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 6, 0);
 }
 
 static int dnxhd_decode_dct_block_12(const DNXHDContext *ctx,
                                      RowContext *row, int n)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 8, 4, 2);
+    return dnxhd_decode_dct_block(ctx, row, n, 6, 4, 2);
 }
 
-static int dnxhd_decode_dct_block_12_444(const DNXHDContext *ctx,
-                                         RowContext *row, int n)
+/**
+ * Rounding added to a dequantized level before the final shift.
+ * Precomputed per qscale so that dequantization has no branches.
+ */
+static av_always_inline int dnxhd_dequant_bias(int level_bias, int scale, int weight)
 {
-    return dnxhd_decode_dct_block(ctx, row, n, 6, 32, 4, 2);
+    int bias = scale >> 1;
+    if (level_bias < 32 || weight != level_bias)
+        bias += level_bias; // 1<<(level_shift-1)
+    return bias;
 }
 
 static int dnxhd_decode_macroblock(const DNXHDContext *ctx, RowContext *row,
@@ -500,8 +514,13 @@ static int dnxhd_decode_macroblock(const DNXHDContext *ctx, RowContext *row,
 
     if (qscale != row->last_qscale) {
         for (i = 0; i < 64; i++) {
-            row->luma_scale[i]   = qscale * ctx->cid_table->luma_weight[i];
-            row->chroma_scale[i] = qscale * ctx->cid_table->chroma_weight[i];
+            int j = ctx->scantable.permutated[i];
+            row->luma_scale[j]   = qscale * ctx->cid_table->luma_weight[i];
+            row->chroma_scale[j] = qscale * ctx->cid_table->chroma_weight[i];
+            row->luma_bias[j]    = dnxhd_dequant_bias(ctx->level_bias, row->luma_scale[j],
+                                                      ctx->cid_table->luma_weight[i]);
+            row->chroma_bias[j]  = dnxhd_dequant_bias(ctx->level_bias, row->chroma_scale[j],
+                                                      ctx->cid_table->chroma_weight[i]);
         }
         row->last_qscale = qscale;
     }
@@ -605,8 +624,11 @@ static int dnxhd_decode_frame(AVCodecContext *avctx, void *data,
 
     ff_dlog(avctx, "frame size %d\n", buf_size);
 
-    for (i = 0; i < avctx->thread_count; i++)
+    for (i = 0; i < avctx->thread_count; i++) {
         ctx->rows[i].format = -1;
+        /* the cid and thus the dequantization tables may change between frames */
+        ctx->rows[i].last_qscale = -1;
+    }
 
 decode_coding_unit:
     if ((ret = dnxhd_decode_header(ctx, picture, buf, buf_size, first_field)) < 0)
@@ -0,0 +1,45 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "dnxhddsp.h"
+#include "config.h"
+
+static void dequant_c(int16_t *block, const int32_t *scale,
+                      const int32_t *bias, int shift)
+{
+    int i;
+
+    for (i = 0; i < 64; i++) {
+        int level = block[i];
+        if (level) {
+            int sign = level >> 31;
+            level    = (FFABS(level) * scale[i] + bias[i]) >> shift;
+            block[i] = (level ^ sign) - sign;
+        }
+    }
+}
+
+av_cold void ff_dnxhddsp_init(DNXHDDSPContext *c)
+{
+    c->dequant = dequant_c;
+
+    if (ARCH_X86)
+        ff_dnxhddsp_init_x86(c);
+}
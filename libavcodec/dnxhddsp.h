@@ -0,0 +1,40 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_DNXHDDSP_H
+#define AVCODEC_DNXHDDSP_H
+
+#include <stdint.h>
+
+typedef struct DNXHDDSPContext {
+    /**
+     * Dequantize the AC levels of a block in place:
+     * block[i] = sign(block[i]) * ((|block[i]| * scale[i] + bias[i]) >> shift).
+     * Zero levels stay zero.
+     * @param block 64 levels, 16-byte aligned
+     * @param scale 64 scales in block order, 32-byte aligned
+     * @param bias  64 rounding biases in block order, 32-byte aligned
+     */
+    void (*dequant)(int16_t *block, const int32_t *scale,
+                    const int32_t *bias, int shift);
+} DNXHDDSPContext;
+
+void ff_dnxhddsp_init(DNXHDDSPContext *c);
+void ff_dnxhddsp_init_x86(DNXHDDSPContext *c);
+
+#endif /* AVCODEC_DNXHDDSP_H */
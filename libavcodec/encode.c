@@ -24,6 +24,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/trace.h"
 
 #include "avcodec.h"
 #include "frame_thread_encoder.h"
@@ -195,7 +196,11 @@ int attribute_align_arg avcodec_encode_audio2(AVCodecContext *avctx,
 
     av_assert0(avctx->codec->encode2);
 
+    av_trace_begin("encode", avctx->codec->name);
+    av_mem_tag_push(avctx);
     ret = avctx->codec->encode2(avctx, avpkt, frame, got_packet_ptr);
+    av_mem_tag_pop();
+    av_trace_end("encode", avctx->codec->name);
     if (!ret) {
         if (*got_packet_ptr) {
             if (!(avctx->codec->capabilities & AV_CODEC_CAP_DELAY)) {
@@ -278,8 +283,14 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
     }
 
     if(CONFIG_FRAME_THREAD_ENCODER &&
-       avctx->internal->frame_thread_encoder && (avctx->active_thread_type&FF_THREAD_FRAME))
-        return ff_thread_video_encode_frame(avctx, avpkt, frame, got_packet_ptr);
+       avctx->internal->frame_thread_encoder && (avctx->active_thread_type&FF_THREAD_FRAME)) {
+        av_trace_begin("encode", avctx->codec->name);
+        av_mem_tag_push(avctx);
+        ret = ff_thread_video_encode_frame(avctx, avpkt, frame, got_packet_ptr);
+        av_mem_tag_pop();
+        av_trace_end("encode", avctx->codec->name);
+        return ret;
+    }
 
     if ((avctx->flags&AV_CODEC_FLAG_PASS1) && avctx->stats_out)
         avctx->stats_out[0] = '\0';
@@ -301,7 +312,11 @@ int attribute_align_arg avcodec_encode_video2(AVCodecContext *avctx,
 
     av_assert0(avctx->codec->encode2);
 
+    av_trace_begin("encode", avctx->codec->name);
+    av_mem_tag_push(avctx);
     ret = avctx->codec->encode2(avctx, avpkt, frame, got_packet_ptr);
+    av_mem_tag_pop();
+    av_trace_end("encode", avctx->codec->name);
     av_assert0(ret <= 0);
 
     emms_c();
@@ -406,8 +421,15 @@ int attribute_align_arg avcodec_send_frame(AVCodecContext *avctx, const AVFrame
             return 0;
     }
 
-    if (avctx->codec->send_frame)
-        return avctx->codec->send_frame(avctx, frame);
+    if (avctx->codec->send_frame) {
+        int ret;
+        av_trace_begin("encode", avctx->codec->name);
+        av_mem_tag_push(avctx);
+        ret = avctx->codec->send_frame(avctx, frame);
+        av_mem_tag_pop();
+        av_trace_end("encode", avctx->codec->name);
+        return ret;
+    }
 
     // Emulation via old API. Do it here instead of avcodec_receive_packet, because:
     // 1. if the AVFrame is not refcounted, the copying will be much more
@@ -429,9 +451,15 @@ int attribute_align_arg avcodec_receive_packet(AVCodecContext *avctx, AVPacket *
         return AVERROR(EINVAL);
 
     if (avctx->codec->receive_packet) {
+        int ret;
         if (avctx->internal->draining && !(avctx->codec->capabilities & AV_CODEC_CAP_DELAY))
             return AVERROR_EOF;
-        return avctx->codec->receive_packet(avctx, avpkt);
+        av_trace_begin("encode", avctx->codec->name);
+        av_mem_tag_push(avctx);
+        ret = avctx->codec->receive_packet(avctx, avpkt);
+        av_mem_tag_pop();
+        av_trace_end("encode", avctx->codec->name);
+        return ret;
     }
 
     // Emulation via old API.
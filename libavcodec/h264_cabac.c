@@ -1679,7 +1679,8 @@ decode_cabac_residual_internal(const H264Context *h, H264SliceContext *sl,
                                                  last_coeff_ctx_base, sig_off);
     } else {
         if (is_dc && chroma422) { // dc 422
-            DECODE_SIGNIFICANCE(7, sig_coeff_offset_dc[last], sig_coeff_offset_dc[last]);
+            coeff_count = decode_significance_dc422(CC, significant_coeff_ctx_base, index,
+                                                    last_coeff_ctx_base, sig_coeff_offset_dc);
         } else {
             coeff_count = decode_significance(CC, max_coeff, significant_coeff_ctx_base, index,
                                                  last_coeff_ctx_base-significant_coeff_ctx_base);
@@ -100,6 +100,15 @@ typedef struct {
    Jpeg2000Component *comp;
 } Jpeg2000Tile;
 
+/** a code-block to be tier-1 coded, with its position in the component */
+typedef struct {
+    Jpeg2000Component *comp;
+    Jpeg2000Band *band;
+    Jpeg2000Cblk *cblk;
+    int x0, x1, y0, y1;
+    int bandpos, lev;
+} Jpeg2000CblkJob;
+
 typedef struct {
     AVClass *class;
     AVCodecContext *avctx;
@@ -124,6 +133,10 @@ typedef struct {
     Jpeg2000QuantStyle  qntsty;
 
     Jpeg2000Tile *tile;
+    Jpeg2000CblkJob *cblk_job; ///< all code-blocks of the picture
+    int nb_cblk_jobs;
+    int nb_cblk_slices; ///< number of slice jobs the code-blocks are split into
+    int *job_ret; ///< return values of the slice jobs
 
     int format;
     int pred;
@@ -394,6 +407,89 @@ static uint8_t *put_sot(Jpeg2000EncoderContext *s, int tileno)
     return psotptr;
 }
 
+/**
+ * List the code-blocks of all tile-components, so that tier-1 coding can
+ * be split into jobs independently of the tile layout.
+ */
+static int init_cblk_jobs(Jpeg2000EncoderContext *s)
+{
+    Jpeg2000CodingStyle *codsty = &s->codsty;
+    int tileno, compno, reslevelno, bandno, pass, n, nb_jobs;
+
+    for (pass = 0; pass < 2; pass++) {
+        n = 0;
+        for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++)
+        for (compno = 0; compno < s->ncomponents; compno++) {
+            Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+
+            for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++) {
+                Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+
+                for (bandno = 0; bandno < reslevel->nbands; bandno++) {
+                    Jpeg2000Band *band = reslevel->band + bandno;
+                    Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
+                    int cblkx, cblky, cblkno = 0, xx0, x0, xx1, y0, yy0, yy1;
+
+                    if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                        continue;
+
+                    if (!pass) {
+                        n += prec->nb_codeblocks_width * prec->nb_codeblocks_height;
+                        continue;
+                    }
+
+                    yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
+                    y0 = yy0;
+                    yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
+                                band->coord[1][1]) - band->coord[1][0] + yy0;
+
+                    for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++) {
+                        if (reslevelno == 0 || bandno == 1)
+                            xx0 = 0;
+                        else
+                            xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
+                        x0 = xx0;
+                        xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
+                                    band->coord[0][1]) - band->coord[0][0] + xx0;
+
+                        for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++) {
+                            Jpeg2000CblkJob *job = s->cblk_job + n++;
+
+                            job->comp    = comp;
+                            job->band    = band;
+                            job->cblk    = prec->cblk + cblkno;
+                            job->x0      = xx0;
+                            job->x1      = xx1;
+                            job->y0      = yy0;
+                            job->y1      = yy1;
+                            job->bandpos = bandno + (reslevelno > 0);
+                            job->lev     = codsty->nreslevels - reslevelno - 1;
+
+                            xx0 = xx1;
+                            xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
+                        }
+                        yy0 = yy1;
+                        yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+                    }
+                }
+            }
+        }
+        if (!pass) {
+            s->cblk_job = av_malloc_array(n, sizeof(*s->cblk_job));
+            if (n && !s->cblk_job)
+                return AVERROR(ENOMEM);
+        }
+    }
+    s->nb_cblk_jobs = n;
+    s->nb_cblk_slices = FFMIN(n, FFMAX(s->avctx->thread_count, 1) * 16);
+
+    nb_jobs = FFMAX(s->numXtiles * s->numYtiles * s->ncomponents, s->nb_cblk_slices);
+    s->job_ret = av_malloc_array(nb_jobs, sizeof(*s->job_ret));
+    if (!s->job_ret)
+        return AVERROR(ENOMEM);
+    return 0;
+}
+
 /**
  * compute the sizes of tiles, resolution levels, bands, etc.
  * allocate memory for them
@@ -442,7 +538,7 @@ static int init_tiles(Jpeg2000EncoderContext *s)
                     return ret;
             }
         }
-    return 0;
+    return init_cblk_jobs(s);
 }
 
 static void copy_frame(Jpeg2000EncoderContext *s)
@@ -636,7 +732,7 @@ static void encode_clnpass(Jpeg2000T1Context *t1, int width, int height, int ban
         }
 }
 
-static void encode_cblk(Jpeg2000EncoderContext *s, Jpeg2000T1Context *t1, Jpeg2000Cblk *cblk, Jpeg2000Tile *tile,
+static void encode_cblk(Jpeg2000EncoderContext *s, Jpeg2000T1Context *t1, Jpeg2000Cblk *cblk,
                         int width, int height, int bandpos, int lev)
 {
     int pass_t = 2, passno, x, y, max=0, nmsedec, bpno;
@@ -847,113 +943,86 @@ static int getcut(Jpeg2000Cblk *cblk, int64_t lambda, int dwt_norm)
     return res;
 }
 
-static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
+static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int compno)
 {
-    int precno, compno, reslevelno, bandno, cblkno, lev;
+    int precno, reslevelno, bandno, cblkno, lev;
     Jpeg2000CodingStyle *codsty = &s->codsty;
+    Jpeg2000Component *comp = tile->comp + compno;
 
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = tile->comp + compno;
-
-        for (reslevelno = 0, lev = codsty->nreslevels-1; reslevelno < codsty->nreslevels; reslevelno++, lev--){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+    for (reslevelno = 0, lev = codsty->nreslevels-1; reslevelno < codsty->nreslevels; reslevelno++, lev--){
+        Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
 
-            for (precno = 0; precno < reslevel->num_precincts_x * reslevel->num_precincts_y; precno++){
-                for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                    int bandpos = bandno + (reslevelno > 0);
-                    Jpeg2000Band *band = reslevel->band + bandno;
-                    Jpeg2000Prec *prec = band->prec + precno;
+        for (precno = 0; precno < reslevel->num_precincts_x * reslevel->num_precincts_y; precno++){
+            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
+                int bandpos = bandno + (reslevelno > 0);
+                Jpeg2000Band *band = reslevel->band + bandno;
+                Jpeg2000Prec *prec = band->prec + precno;
 
-                    for (cblkno = 0; cblkno < prec->nb_codeblocks_height * prec->nb_codeblocks_width; cblkno++){
-                        Jpeg2000Cblk *cblk = prec->cblk + cblkno;
+                for (cblkno = 0; cblkno < prec->nb_codeblocks_height * prec->nb_codeblocks_width; cblkno++){
+                    Jpeg2000Cblk *cblk = prec->cblk + cblkno;
 
-                        cblk->ninclpasses = getcut(cblk, s->lambda,
-                                (int64_t)dwt_norms[codsty->transform == FF_DWT53][bandpos][lev] * (int64_t)band->i_stepsize >> 15);
-                    }
+                    cblk->ninclpasses = getcut(cblk, s->lambda,
+                            (int64_t)dwt_norms[codsty->transform == FF_DWT53][bandpos][lev] * (int64_t)band->i_stepsize >> 15);
                 }
             }
         }
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+/**
+ * Run the DWT of one tile-component. The code-blocks are coded afterwards
+ * by encode_cblks(), as they are many more than the tile-components.
+ */
+static int dwt_tile_comp(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int compno, reslevelno, bandno, ret;
-    Jpeg2000T1Context t1;
-    Jpeg2000CodingStyle *codsty = &s->codsty;
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    int tileno = jobnr / s->ncomponents, compno = jobnr % s->ncomponents;
+    Jpeg2000Component *comp = s->tile[tileno].comp + compno;
 
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
+    return ff_dwt_encode(&comp->dwt, comp->i_data);
+}
 
-        av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
-        if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
-            return ret;
-        av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+/**
+ * Tier-1 code a range of code-blocks. Each code-block is independent, so
+ * the list is split evenly among the slice jobs.
+ */
+static int encode_cblks(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    int start = (int64_t)s->nb_cblk_jobs *  jobnr      / s->nb_cblk_slices;
+    int end   = (int64_t)s->nb_cblk_jobs * (jobnr + 1) / s->nb_cblk_slices;
+    Jpeg2000T1Context t1;
+    int i;
 
-        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+    t1.stride = (1<<s->codsty.log2_cblk_width) + 2;
 
-            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                Jpeg2000Band *band = reslevel->band + bandno;
-                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
-                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
-                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
-                y0 = yy0;
-                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
-                            band->coord[1][1]) - band->coord[1][0] + yy0;
-
-                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
-                    continue;
+    for (i = start; i < end; i++) {
+        const Jpeg2000CblkJob *job = s->cblk_job + i;
+        Jpeg2000Component *comp = job->comp;
+        Jpeg2000Band *band = job->band;
+        int w = comp->coord[0][1] - comp->coord[0][0];
+        int y, x;
 
-                bandpos = bandno + (reslevelno > 0);
-
-                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
-                    if (reslevelno == 0 || bandno == 1)
-                        xx0 = 0;
-                    else
-                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
-                    x0 = xx0;
-                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
-                                band->coord[0][1]) - band->coord[0][0] + xx0;
-
-                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
-                        int y, x;
-                        if (codsty->transform == FF_DWT53){
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] << NMSEDEC_FRACBITS;
-                                }
-                            }
-                        } else{
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
-                                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
-                                    ptr++;
-                                }
-                            }
-                        }
-                        encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
-                                    bandpos, codsty->nreslevels - reslevelno - 1);
-                        xx0 = xx1;
-                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
-                    }
-                    yy0 = yy1;
-                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+        if (s->codsty.transform == FF_DWT53){
+            for (y = job->y0; y < job->y1; y++){
+                int *ptr = t1.data + (y-job->y0)*t1.stride;
+                for (x = job->x0; x < job->x1; x++){
+                    *ptr++ = comp->i_data[w * y + x] << NMSEDEC_FRACBITS;
+                }
+            }
+        } else{
+            for (y = job->y0; y < job->y1; y++){
+                int *ptr = t1.data + (y-job->y0)*t1.stride;
+                for (x = job->x0; x < job->x1; x++){
+                    *ptr = (comp->i_data[w * y + x]);
+                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
+                    ptr++;
                 }
             }
         }
-        av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
+        encode_cblk(s, &t1, job->cblk, job->x1 - job->x0, job->y1 - job->y0,
+                    job->bandpos, job->lev);
     }
-
-    av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
-    truncpasses(s, tile);
-    if ((ret = encode_packets(s, tile, tileno)) < 0)
-        return ret;
-    av_log(s->avctx, AV_LOG_DEBUG, "after rate control\n");
     return 0;
 }
 
@@ -970,6 +1039,8 @@ static void cleanup(Jpeg2000EncoderContext *s)
         av_freep(&s->tile[tileno].comp);
     }
     av_freep(&s->tile);
+    av_freep(&s->cblk_job);
+    av_freep(&s->job_ret);
 }
 
 static void reinit(Jpeg2000EncoderContext *s)
@@ -990,7 +1061,7 @@ static void update_size(uint8_t *size, const uint8_t *end)
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pict, int *got_packet)
 {
-    int tileno, ret;
+    int tileno, i, ret;
     Jpeg2000EncoderContext *s = avctx->priv_data;
     uint8_t *chunkstart, *jp2cstart, *jp2hstart;
 
@@ -1008,6 +1079,22 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     copy_frame(s);
     reinit(s);
 
+    av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
+    avctx->execute2(avctx, dwt_tile_comp, NULL, s->job_ret,
+                    s->numXtiles * s->numYtiles * s->ncomponents);
+    for (i = 0; i < s->numXtiles * s->numYtiles * s->ncomponents; i++)
+        if (s->job_ret[i] < 0)
+            return s->job_ret[i];
+
+    av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+    if (s->nb_cblk_slices)
+        avctx->execute2(avctx, encode_cblks, NULL, s->job_ret, s->nb_cblk_slices);
+    av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
+
+    for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++)
+        for (i = 0; i < s->ncomponents; i++)
+            truncpasses(s, s->tile + tileno, i);
+
     if (s->format == CODEC_JP2) {
         av_assert0(s->buf == pkt->data);
 
@@ -1079,7 +1166,7 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         if (s->buf_end - s->buf < 2)
             return -1;
         bytestream_put_be16(&s->buf, JPEG2000_SOD);
-        if ((ret = encode_tile(s, s->tile + tileno, tileno)) < 0)
+        if ((ret = encode_packets(s, s->tile + tileno, tileno)) < 0)
             return ret;
         bytestream_put_be32(&psotptr, s->buf - psotptr + 6);
     }
@@ -1208,6 +1295,7 @@ AVCodec ff_jpeg2000_encoder = {
     .init           = j2kenc_init,
     .encode2        = encode_frame,
     .close          = j2kenc_destroy,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_YUV444P, AV_PIX_FMT_GRAY8,
         AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P,
@@ -25,6 +25,7 @@
  * Discrete wavelet transform
  */
 
+#include "config.h"
 #include "libavutil/avassert.h"
 #include "libavutil/common.h"
 #include "libavutil/mem.h"
@@ -94,6 +95,147 @@ static void sd_1d53(int *p, int i0, int i1)
         p[2*i] += (p[2*i-1] + p[2*i+1] + 2) >> 2;
 }
 
+static void sd_lift53_high_c(int32_t *dst, const int32_t *src0, const int32_t *src1, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        dst[i] -= (src0[i] + src1[i]) >> 1;
+}
+
+static void sd_lift53_low_c(int32_t *dst, const int32_t *src0, const int32_t *src1, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        dst[i] += (src0[i] + src1[i] + 2) >> 2;
+}
+
+static void sd_lift97_int_c(int32_t *dst, const int32_t *src0, const int32_t *src1, int n, int coef)
+{
+    int64_t rnd = (1 << 15) - (coef < 0);
+    int i;
+
+    for (i = 0; i < n; i++)
+        dst[i] += (coef * (int64_t)(src0[i] + src1[i]) + rnd) >> 16;
+}
+
+/* Row k of the strip buffer, rows are FF_DWT_STRIP coefficients apart. */
+#define ROW(k) (p + (k) * FF_DWT_STRIP)
+
+/* Copy lv rows of sw columns of t into the strip buffer, from row mv. */
+static void strip_load(int32_t *p, const int *t, int w, int sw, int n, int lv, int mv)
+{
+    int i;
+
+    for (i = 0; i < lv; i++) {
+        memcpy(ROW(mv + i), t + w * i, sw * sizeof(*p));
+        memset(ROW(mv + i) + sw, 0, (n - sw) * sizeof(*p));
+    }
+}
+
+/* Same as sd_1d53(), on the columns of the strip buffer. */
+static void sd_strip53(DWTContext *s, int32_t *p, int i0, int i1, int n)
+{
+    int i;
+
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (i = 0; i < n; i++)
+                ROW(1)[i] <<= 1;
+        return;
+    }
+
+    memcpy(ROW(i0 - 1), ROW(i0 + 1), n * sizeof(*p));
+    memcpy(ROW(i1),     ROW(i1 - 2), n * sizeof(*p));
+    memcpy(ROW(i0 - 2), ROW(i0 + 2), n * sizeof(*p));
+    memcpy(ROW(i1 + 1), ROW(i1 - 3), n * sizeof(*p));
+
+    for (i = ((i0+1)>>1) - 1; i < (i1+1)>>1; i++)
+        s->sd_lift53_high(ROW(2*i+1), ROW(2*i), ROW(2*i+2), n);
+    for (i = ((i0+1)>>1); i < (i1+1)>>1; i++)
+        s->sd_lift53_low(ROW(2*i), ROW(2*i-1), ROW(2*i+1), n);
+}
+
+/* Same as sd_1d97_int(), on the columns of the strip buffer. */
+static void sd_strip97_int(DWTContext *s, int32_t *p, int i0, int i1, int n)
+{
+    int i, j;
+
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (i = 0; i < n; i++)
+                ROW(1)[i] = (ROW(1)[i] * I_LFTG_X + (1<<14)) >> 15;
+        else
+            for (i = 0; i < n; i++)
+                ROW(0)[i] = (ROW(0)[i] * I_LFTG_K + (1<<15)) >> 16;
+        return;
+    }
+
+    for (j = 1; j <= 4; j++) {
+        memcpy(ROW(i0 - j),     ROW(i0 + j),     n * sizeof(*p));
+        memcpy(ROW(i1 + j - 1), ROW(i1 - j - 1), n * sizeof(*p));
+    }
+    i0++; i1++;
+
+    for (i = (i0>>1) - 2; i < (i1>>1) + 1; i++)
+        s->sd_lift97_int(ROW(2*i+1), ROW(2*i),   ROW(2*i+2), n, -I_LFTG_ALPHA);
+    for (i = (i0>>1) - 1; i < (i1>>1) + 1; i++)
+        s->sd_lift97_int(ROW(2*i),   ROW(2*i-1), ROW(2*i+1), n, -I_LFTG_BETA);
+    for (i = (i0>>1) - 1; i < (i1>>1); i++)
+        s->sd_lift97_int(ROW(2*i+1), ROW(2*i),   ROW(2*i+2), n,  I_LFTG_GAMMA);
+    for (i = (i0>>1); i < (i1>>1); i++)
+        s->sd_lift97_int(ROW(2*i),   ROW(2*i-1), ROW(2*i+1), n,  I_LFTG_DELTA);
+}
+
+/*
+ * The vertical transform works on FF_DWT_STRIP columns at once, so that
+ * each lifting step is a vector operation over a row of the strip.
+ */
+static void dwt_encode53_ver(DWTContext *s, int *t, int w, int lh, int lv, int mv)
+{
+    int32_t *p = s->i_stripbuf + 2 * FF_DWT_STRIP;
+    int x, i, j;
+
+    for (x = 0; x < lh; x += FF_DWT_STRIP) {
+        int sw = FFMIN(lh - x, FF_DWT_STRIP), n = FFALIGN(sw, 8);
+
+        strip_load(p, t + x, w, sw, n, lv, mv);
+        sd_strip53(s, p, mv, mv + lv, n);
+
+        // copy back and deinterleave
+        for (i = mv, j = 0; i < lv; i += 2, j++)
+            memcpy(t + w*j + x, ROW(mv + i), sw * sizeof(*t));
+        for (i = 1 - mv; i < lv; i += 2, j++)
+            memcpy(t + w*j + x, ROW(mv + i), sw * sizeof(*t));
+    }
+}
+
+static void dwt_encode97_int_ver(DWTContext *s, int *t, int w, int lh, int lv, int mv)
+{
+    int32_t *p = s->i_stripbuf + 5 * FF_DWT_STRIP;
+    int x, i, j, k;
+
+    for (x = 0; x < lh; x += FF_DWT_STRIP) {
+        int sw = FFMIN(lh - x, FF_DWT_STRIP), n = FFALIGN(sw, 8);
+
+        strip_load(p, t + x, w, sw, n, lv, mv);
+        sd_strip97_int(s, p, mv, mv + lv, n);
+
+        // copy back and deinterleave
+        for (i = mv, j = 0; i < lv; i += 2, j++) {
+            const int32_t *src = ROW(mv + i);
+            int *dst = t + w*j + x;
+            for (k = 0; k < sw; k++)
+                dst[k] = ((src[k] * I_LFTG_X) + (1 << 15)) >> 16;
+        }
+        for (i = 1 - mv; i < lv; i += 2, j++)
+            memcpy(t + w*j + x, ROW(mv + i), sw * sizeof(*t));
+    }
+}
+
+#undef ROW
+
 static void dwt_encode53(DWTContext *s, int *t)
 {
     int lev,
@@ -110,21 +252,7 @@ static void dwt_encode53(DWTContext *s, int *t)
         int *l;
 
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
-            int i, j = 0;
-
-            for (i = 0; i < lv; i++)
-                l[i] = t[w*i + lp];
-
-            sd_1d53(line, mv, mv + lv);
-
-            // copy back and deinterleave
-            for (i =   mv; i < lv; i+=2, j++)
-                t[w*j + lp] = l[i];
-            for (i = 1-mv; i < lv; i+=2, j++)
-                t[w*j + lp] = l[i];
-        }
+        dwt_encode53_ver(s, t, w, lh, lv, mv);
 
         // HOR_SD
         l = line + mh;
@@ -266,21 +394,7 @@ static void dwt_encode97_int(DWTContext *s, int *t)
         int *l;
 
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
-            int i, j = 0;
-
-            for (i = 0; i < lv; i++)
-                l[i] = t[w*i + lp];
-
-            sd_1d97_int(line, mv, mv + lv);
-
-            // copy back and deinterleave
-            for (i =   mv; i < lv; i+=2, j++)
-                t[w*j + lp] = ((l[i] * I_LFTG_X) + (1 << 15)) >> 16;
-            for (i = 1-mv; i < lv; i+=2, j++)
-                t[w*j + lp] = l[i];
-        }
+        dwt_encode97_int_ver(s, t, w, lh, lv, mv);
 
         // HOR_SD
         l = line + mh;
@@ -575,6 +689,13 @@ int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
     default:
         return -1;
     }
+
+    s->sd_lift53_high = sd_lift53_high_c;
+    s->sd_lift53_low  = sd_lift53_low_c;
+    s->sd_lift97_int  = sd_lift97_int_c;
+    if (ARCH_X86)
+        ff_jpeg2000_dwt_init_x86(s);
+
     return 0;
 }
 
@@ -583,6 +704,15 @@ int ff_dwt_encode(DWTContext *s, void *t)
     if (s->ndeclevels == 0)
         return 0;
 
+    if (s->type != FF_DWT97 && !s->i_stripbuf) {
+        int maxlen = FFMAX(s->linelen[s->ndeclevels - 1][0],
+                           s->linelen[s->ndeclevels - 1][1]);
+        s->i_stripbuf = av_malloc_array(maxlen + 12,
+                                        FF_DWT_STRIP * sizeof(*s->i_stripbuf));
+        if (!s->i_stripbuf)
+            return AVERROR(ENOMEM);
+    }
+
     switch(s->type){
         case FF_DWT97:
             dwt_encode97_float(s, t); break;
@@ -621,4 +751,5 @@ void ff_dwt_destroy(DWTContext *s)
 {
     av_freep(&s->f_linebuf);
     av_freep(&s->i_linebuf);
+    av_freep(&s->i_stripbuf);
 }
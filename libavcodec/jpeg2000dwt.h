@@ -48,8 +48,27 @@ typedef struct DWTContext {
     uint8_t type;                        ///< 0 for 9/7; 1 for 5/3
     int32_t *i_linebuf;                  ///< int buffer used by transform
     float   *f_linebuf;                  ///< float buffer used by transform
+    int32_t *i_stripbuf;                 ///< buffer for FF_DWT_STRIP columns of the forward transform
+
+    /**
+     * Lifting steps of the vertical forward transform, applied to n
+     * coefficients of a row at once. n must be a multiple of 8.
+     */
+    /// dst[i] -= (src0[i] + src1[i]) >> 1
+    void (*sd_lift53_high)(int32_t *dst, const int32_t *src0, const int32_t *src1, int n);
+    /// dst[i] += (src0[i] + src1[i] + 2) >> 2
+    void (*sd_lift53_low)(int32_t *dst, const int32_t *src0, const int32_t *src1, int n);
+    /**
+     * dst[i] += (coef * (src0[i] + src1[i]) + (1 << 15) - (coef < 0)) >> 16,
+     * with a 64-bit product. A negative coef thus subtracts the product
+     * with -coef, rounded as a positive one.
+     */
+    void (*sd_lift97_int)(int32_t *dst, const int32_t *src0, const int32_t *src1, int n, int coef);
 } DWTContext;
 
+/// number of columns transformed at once by the vertical forward transform
+#define FF_DWT_STRIP 64
+
 /**
  * Initialize DWT.
  * @param s                 DWT context
@@ -60,6 +79,8 @@ typedef struct DWTContext {
 int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
                          int decomp_levels, int type);
 
+void ff_jpeg2000_dwt_init_x86(DWTContext *s);
+
 int ff_dwt_encode(DWTContext *s, void *t);
 int ff_dwt_decode(DWTContext *s, void *t);
 
@@ -574,6 +574,8 @@ static const AVOption avcodec_options[] = {
 {"pixel_format", "set pixel format", OFFSET(pix_fmt), AV_OPT_TYPE_PIXEL_FMT, {.i64=AV_PIX_FMT_NONE}, -1, INT_MAX, 0 },
 {"video_size", "set video size", OFFSET(width), AV_OPT_TYPE_IMAGE_SIZE, {.str=NULL}, 0, INT_MAX, 0 },
 {"max_pixels", "Maximum number of pixels", OFFSET(max_pixels), AV_OPT_TYPE_INT64, {.i64 = INT_MAX }, 0, INT_MAX, A|V|S|D|E },
+{"thread_max_memory", "maximum memory taken by the pictures decoded at once by frame threads", OFFSET(thread_max_memory), AV_OPT_TYPE_INT64, {.i64 = 0 }, 0, INT64_MAX, V|D },
+{"thread_adaptive", "adapt the number of active frame threads to the decoding speed", OFFSET(thread_adaptive), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, V|D },
 {NULL},
 };
 
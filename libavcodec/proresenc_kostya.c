@@ -31,6 +31,7 @@
 #include "bytestream.h"
 #include "internal.h"
 #include "proresdata.h"
+#include "proresencdsp.h"
 
 #define CFACTOR_Y422 2
 #define CFACTOR_Y444 3
@@ -181,6 +182,8 @@ struct TrellisNode {
 
 typedef struct ProresThreadData {
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(32, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
+    uint32_t nz[64];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16 * 16];
     int16_t custom_q[64];
     struct TrellisNode *nodes;
@@ -189,6 +192,8 @@ typedef struct ProresThreadData {
 typedef struct ProresContext {
     AVClass *class;
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(32, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
+    uint32_t nz[64];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16*16];
     int16_t quants[MAX_STORED_Q][64];
     int16_t custom_q[64];
@@ -198,6 +203,7 @@ typedef struct ProresContext {
     void (*fdct)(FDCTDSPContext *fdsp, const uint16_t *src,
                  ptrdiff_t linesize, int16_t *block);
     FDCTDSPContext fdsp;
+    ProresEncDSPContext dsp;
 
     const AVFrame *pic;
     int mb_width, mb_height;
@@ -386,36 +392,37 @@ static void encode_dcs(PutBitContext *pb, int16_t *blocks,
     }
 }
 
-static void encode_acs(PutBitContext *pb, int16_t *blocks,
-                       int blocks_per_slice,
-                       int plane_size_factor,
-                       const uint8_t *scan, const int16_t *qmat)
+/* The coefficients are coded in scan order, interleaved across the blocks
+ * of the slice; nz[] has one bit per block, so runs of zeroes are skipped
+ * over whole rather than coefficient by coefficient. */
+static void encode_acs(PutBitContext *pb, const int16_t *levels,
+                       const uint32_t *nz, int blocks_per_slice,
+                       int plane_size_factor, const uint8_t *scan)
 {
-    int idx, i;
+    int i, b, pos, prev;
     int run, level, run_cb, lev_cb;
-    int max_coeffs, abs_level;
+    int abs_level;
+    uint32_t mask;
 
-    max_coeffs = blocks_per_slice << 6;
     run_cb     = ff_prores_run_to_cb_index[4];
     lev_cb     = ff_prores_lev_to_cb_index[2];
-    run        = 0;
+    prev       = -1;
 
     for (i = 1; i < 64; i++) {
-        for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level = blocks[idx] / qmat[scan[i]];
-            if (level) {
-                abs_level = FFABS(level);
-                encode_vlc_codeword(pb, ff_prores_ac_codebook[run_cb], run);
-                encode_vlc_codeword(pb, ff_prores_ac_codebook[lev_cb],
-                                    abs_level - 1);
-                put_sbits(pb, 1, GET_SIGN(level));
-
-                run_cb = ff_prores_run_to_cb_index[FFMIN(run, 15)];
-                lev_cb = ff_prores_lev_to_cb_index[FFMIN(abs_level, 9)];
-                run    = 0;
-            } else {
-                run++;
-            }
+        for (mask = nz[scan[i]]; mask; mask &= mask - 1) {
+            b     = ff_ctz(mask);
+            pos   = (i - 1) * blocks_per_slice + b;
+            run   = pos - prev - 1;
+            prev  = pos;
+            level = levels[(b << 6) + scan[i]];
+            abs_level = FFABS(level);
+            encode_vlc_codeword(pb, ff_prores_ac_codebook[run_cb], run);
+            encode_vlc_codeword(pb, ff_prores_ac_codebook[lev_cb],
+                                abs_level - 1);
+            put_sbits(pb, 1, GET_SIGN(level));
+
+            run_cb = ff_prores_run_to_cb_index[FFMIN(run, 15)];
+            lev_cb = ff_prores_lev_to_cb_index[FFMIN(abs_level, 9)];
         }
     }
 }
@@ -432,8 +439,9 @@ static int encode_slice_plane(ProresContext *ctx, PutBitContext *pb,
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
     encode_dcs(pb, blocks, blocks_per_slice, qmat[0]);
-    encode_acs(pb, blocks, blocks_per_slice, plane_size_factor,
-               ctx->scantable, qmat);
+    ctx->dsp.quantize(ctx->levels, ctx->nz, blocks, qmat, blocks_per_slice);
+    encode_acs(pb, ctx->levels, ctx->nz, blocks_per_slice, plane_size_factor,
+               ctx->scantable);
     flush_put_bits(pb);
 
     return (put_bits_count(pb) - saved_pos) >> 3;
@@ -619,7 +627,7 @@ static int estimate_dcs(int *error, int16_t *blocks, int blocks_per_slice,
 
     for (i = 1; i < blocks_per_slice; i++, blocks += 64) {
         dc       = (blocks[0] - 0x4000) / scale;
-        *error  += FFABS(blocks[0] - 0x4000) % scale;
+        *error  += FFABS(blocks[0] - 0x4000 - dc * scale);
         delta    = dc - prev_dc;
         new_sign = GET_SIGN(delta);
         delta    = (delta ^ sign) - sign;
@@ -634,36 +642,34 @@ static int estimate_dcs(int *error, int16_t *blocks, int blocks_per_slice,
     return bits;
 }
 
-static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
-                        int plane_size_factor,
-                        const uint8_t *scan, const int16_t *qmat)
+static int estimate_acs(const int16_t *levels, const uint32_t *nz,
+                        int blocks_per_slice, int plane_size_factor,
+                        const uint8_t *scan)
 {
-    int idx, i;
+    int i, b, pos, prev;
     int run, level, run_cb, lev_cb;
-    int max_coeffs, abs_level;
+    int abs_level;
     int bits = 0;
+    uint32_t mask;
 
-    max_coeffs = blocks_per_slice << 6;
     run_cb     = ff_prores_run_to_cb_index[4];
     lev_cb     = ff_prores_lev_to_cb_index[2];
-    run        = 0;
+    prev       = -1;
 
     for (i = 1; i < 64; i++) {
-        for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level   = blocks[idx] / qmat[scan[i]];
-            *error += FFABS(blocks[idx]) % qmat[scan[i]];
-            if (level) {
-                abs_level = FFABS(level);
-                bits += estimate_vlc(ff_prores_ac_codebook[run_cb], run);
-                bits += estimate_vlc(ff_prores_ac_codebook[lev_cb],
-                                     abs_level - 1) + 1;
-
-                run_cb = ff_prores_run_to_cb_index[FFMIN(run, 15)];
-                lev_cb = ff_prores_lev_to_cb_index[FFMIN(abs_level, 9)];
-                run    = 0;
-            } else {
-                run++;
-            }
+        for (mask = nz[scan[i]]; mask; mask &= mask - 1) {
+            b     = ff_ctz(mask);
+            pos   = (i - 1) * blocks_per_slice + b;
+            run   = pos - prev - 1;
+            prev  = pos;
+            level = levels[(b << 6) + scan[i]];
+            abs_level = FFABS(level);
+            bits += estimate_vlc(ff_prores_ac_codebook[run_cb], run);
+            bits += estimate_vlc(ff_prores_ac_codebook[lev_cb],
+                                 abs_level - 1) + 1;
+
+            run_cb = ff_prores_run_to_cb_index[FFMIN(run, 15)];
+            lev_cb = ff_prores_lev_to_cb_index[FFMIN(abs_level, 9)];
         }
     }
 
@@ -681,9 +687,11 @@ static int estimate_slice_plane(ProresContext *ctx, int *error, int plane,
 
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
-    bits  = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
-    bits += estimate_acs(error, td->blocks[plane], blocks_per_slice,
-                         plane_size_factor, ctx->scantable, qmat);
+    bits    = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
+    *error += ctx->dsp.quantize(td->levels, td->nz, td->blocks[plane], qmat,
+                                blocks_per_slice);
+    bits   += estimate_acs(td->levels, td->nz, blocks_per_slice,
+                           plane_size_factor, ctx->scantable);
 
     return FFALIGN(bits, 8);
 }
@@ -1137,6 +1145,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     ctx->scantable = interlaced ? ff_prores_interlaced_scan
                                 : ff_prores_progressive_scan;
     ff_fdctdsp_init(&ctx->fdsp, avctx);
+    ff_proresencdsp_init(&ctx->dsp);
 
     mps = ctx->mbs_per_slice;
     if (mps & (mps - 1)) {
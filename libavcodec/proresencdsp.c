@@ -0,0 +1,54 @@
+/*
+ * Apple ProRes encoder DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "proresencdsp.h"
+
+static int quantize_c(int16_t *levels, uint32_t nz[64], const int16_t *blocks,
+                      const int16_t *qmat, int nb_blocks)
+{
+    int i, j, level, err = 0;
+
+    memset(nz, 0, 64 * sizeof(*nz));
+
+    for (i = 0; i < nb_blocks; i++, blocks += 64, levels += 64) {
+        for (j = 0; j < 64; j++) {
+            level     = blocks[j] / qmat[j];
+            levels[j] = level;
+            nz[j]    |= (uint32_t)!!level << i;
+            if (j)
+                err  += FFABS(blocks[j] - level * qmat[j]);
+        }
+    }
+
+    return err;
+}
+
+av_cold void ff_proresencdsp_init(ProresEncDSPContext *c)
+{
+    c->quantize = quantize_c;
+
+    if (HAVE_MMX)
+        ff_proresencdsp_init_x86(c);
+}
@@ -0,0 +1,42 @@
+/*
+ * Apple ProRes encoder DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_PRORESENCDSP_H
+#define AVCODEC_PRORESENCDSP_H
+
+#include <stdint.h>
+
+typedef struct ProresEncDSPContext {
+    /**
+     * Quantize the coefficients of nb_blocks 8x8 blocks, at most 32:
+     * levels[i] = blocks[i] / qmat[i & 63], rounded toward zero.
+     * Bit b of nz[j] is set if levels[64 * b + j] is not zero.
+     *
+     * @return sum of |blocks[i] - levels[i] * qmat[i & 63]| over the AC
+     *         coefficients
+     */
+    int (*quantize)(int16_t *levels, uint32_t nz[64], const int16_t *blocks,
+                    const int16_t *qmat, int nb_blocks);
+} ProresEncDSPContext;
+
+void ff_proresencdsp_init(ProresEncDSPContext *c);
+void ff_proresencdsp_init_x86(ProresEncDSPContext *c);
+
+#endif /* AVCODEC_PRORESENCDSP_H */
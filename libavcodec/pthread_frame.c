@@ -39,11 +39,21 @@
 #include "libavutil/common.h"
 #include "libavutil/cpu.h"
 #include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/log.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
+#include "libavutil/trace.h"
+
+/**
+ * Number of output frames over which thread_adaptive measures how long the
+ * caller waits for the decoder.
+ */
+#define ADAPT_WINDOW 16
 
 enum {
     ///< Set when the thread is awaiting a packet.
@@ -133,6 +143,14 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+
+    int nb_active;                 ///< Number of threads packets are submitted to, at most thread_count.
+    int min_active;                ///< Lowest possible nb_active.
+    int grow;                      ///< Set when the decoder is too slow for the caller, see thread_adaptive.
+
+    int64_t window_start;          ///< Time of the first output frame of the current window.
+    int64_t wait_time;             ///< Time spent waiting for output during the current window.
+    int     window_frames;         ///< Number of output frames in the current window.
 } FrameThreadContext;
 
 #define THREAD_SAFE_CALLBACKS(avctx) \
@@ -196,7 +214,11 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
 
         av_frame_unref(p->frame);
         p->got_frame = 0;
+        av_mem_tag_push(avctx);
+        av_trace_begin("decode", codec->name);
         p->result = codec->decode(avctx, p->frame, &p->got_frame, &p->avpkt);
+        av_trace_end("decode", codec->name);
+        av_mem_tag_pop();
 
         if ((p->result < 0 || !p->got_frame) && p->frame->buf[0]) {
             if (avctx->internal->allocate_progress)
@@ -469,6 +491,49 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     return 0;
 }
 
+/**
+ * Get the number of threads whose pictures fit in thread_max_memory.
+ */
+static int max_active_threads(AVCodecContext *avctx, int min_active)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(avctx->pix_fmt);
+    int w = FFMAX(avctx->width,  avctx->coded_width);
+    int h = FFMAX(avctx->height, avctx->coded_height);
+    int size;
+
+    if (!avctx->thread_max_memory || (desc && desc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+        return avctx->thread_count;
+
+    /* the picture size is not known before the first frames are decoded */
+    size = av_image_get_buffer_size(avctx->pix_fmt, w, h, 1);
+    if (size <= 0)
+        return min_active;
+
+    return av_clip64(avctx->thread_max_memory / size, min_active, avctx->thread_count);
+}
+
+/**
+ * Account for one output frame and decide at the end of each window if the
+ * decoder is too slow for the caller.
+ */
+static void update_adaptive_stats(FrameThreadContext *fctx, int64_t wait_time)
+{
+    int64_t now = av_gettime_relative();
+
+    if (!fctx->window_frames++) {
+        fctx->window_start = now;
+        fctx->wait_time    = 0;
+        return;
+    }
+
+    fctx->wait_time += wait_time;
+    if (fctx->window_frames > ADAPT_WINDOW) {
+        /* more than a quarter of the time was spent waiting for frames */
+        fctx->grow          = fctx->wait_time * 4 > now - fctx->window_start;
+        fctx->window_frames = 0;
+    }
+}
+
 int ff_thread_decode_frame(AVCodecContext *avctx,
                            AVFrame *picture, int *got_picture_ptr,
                            AVPacket *avpkt)
@@ -476,6 +541,7 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
     FrameThreadContext *fctx = avctx->internal->thread_ctx;
     int finished = fctx->next_finished;
     PerThreadContext *p;
+    int64_t wait_time = 0;
     int err;
 
     /* release the async lock, permitting blocked hwaccel threads to
@@ -495,7 +561,7 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
      * If we're still receiving the initial packets, don't return a frame.
      */
 
-    if (fctx->next_decoding > (avctx->thread_count-1-(avctx->codec_id == AV_CODEC_ID_FFV1)))
+    if (fctx->next_decoding > (fctx->nb_active-1-(avctx->codec_id == AV_CODEC_ID_FFV1)))
         fctx->delaying = 0;
 
     if (fctx->delaying) {
@@ -506,6 +572,25 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         }
     }
 
+    /*
+     * Activate one more thread after the last active one got a packet.
+     * Not returning a frame this time keeps the threads in submission order
+     * and lets the new thread decode the next packet.
+     */
+
+    if (!fctx->delaying && avpkt->size && fctx->next_decoding == fctx->nb_active &&
+        (fctx->grow || !avctx->thread_adaptive) &&
+        fctx->nb_active < max_active_threads(avctx, fctx->min_active)) {
+        fctx->nb_active++;
+        fctx->grow = 0;
+        if (avctx->debug & FF_DEBUG_THREADS)
+            av_log(avctx, AV_LOG_DEBUG, "%d frame threads active\n", fctx->nb_active);
+
+        *got_picture_ptr = 0;
+        err = avpkt->size;
+        goto finish;
+    }
+
     /*
      * Return the next available frame from the oldest thread.
      * If we're at the end of the stream, then we have to skip threads that
@@ -517,10 +602,15 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         p = &fctx->threads[finished++];
 
         if (atomic_load(&p->state) != STATE_INPUT_READY) {
+            int64_t wait_start = avctx->thread_adaptive ? av_gettime_relative() : 0;
+
             pthread_mutex_lock(&p->progress_mutex);
             while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
                 pthread_cond_wait(&p->output_cond, &p->progress_mutex);
             pthread_mutex_unlock(&p->progress_mutex);
+
+            if (avctx->thread_adaptive)
+                wait_time += av_gettime_relative() - wait_start;
         }
 
         av_frame_move_ref(picture, p->frame);
@@ -537,12 +627,15 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         p->got_frame = 0;
         p->result = 0;
 
-        if (finished >= avctx->thread_count) finished = 0;
+        if (finished >= fctx->nb_active) finished = 0;
     } while (!avpkt->size && !*got_picture_ptr && err >= 0 && finished != fctx->next_finished);
 
     update_context_from_thread(avctx, p->avctx, 1);
 
-    if (fctx->next_decoding >= avctx->thread_count) fctx->next_decoding = 0;
+    if (avctx->thread_adaptive && avpkt->size)
+        update_adaptive_stats(fctx, wait_time);
+
+    if (fctx->next_decoding >= fctx->nb_active) fctx->next_decoding = 0;
 
     fctx->next_finished = finished;
 
@@ -764,6 +857,10 @@ int ff_frame_thread_init(AVCodecContext *avctx)
     fctx->async_lock = 1;
     fctx->delaying = 1;
 
+    fctx->min_active = 1 + (codec->id == AV_CODEC_ID_FFV1);
+    fctx->nb_active  = avctx->thread_adaptive ? fctx->min_active :
+                       max_active_threads(avctx, fctx->min_active);
+
     for (i = 0; i < thread_count; i++) {
         AVCodecContext *copy = av_malloc(sizeof(AVCodecContext));
         PerThreadContext *p  = &fctx->threads[i];
@@ -853,6 +950,13 @@ void ff_thread_flush(AVCodecContext *avctx)
     fctx->next_decoding = fctx->next_finished = 0;
     fctx->delaying = 1;
     fctx->prev_thread = NULL;
+
+    /* all the threads are idle, so the number of active ones may go down */
+    if (avctx->thread_adaptive)
+        fctx->nb_active = FFMIN(fctx->nb_active, max_active_threads(avctx, fctx->min_active));
+    else
+        fctx->nb_active = max_active_threads(avctx, fctx->min_active);
+    fctx->grow = fctx->window_frames = 0;
     for (i = 0; i < avctx->thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
         // Make sure decode flush calls with size=0 won't return old frames
@@ -34,6 +34,8 @@
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+#include "libavutil/trace.h"
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -90,8 +92,10 @@ static void* attribute_align_arg worker(void *v)
         }
         pthread_mutex_unlock(&c->current_job_lock);
 
+        av_trace_begin("slice", avctx->codec->name);
         ret = c->func ? c->func(avctx, (char*)c->args + our_job*c->job_size):
                                 c->func2(avctx, c->args, our_job, self_id);
+        av_trace_end("slice", avctx->codec->name);
         if (c->rets)
             c->rets[our_job%c->job_count] = ret;
 
@@ -105,25 +109,28 @@ void ff_slice_thread_free(AVCodecContext *avctx)
     SliceThreadContext *c = avctx->internal->thread_ctx;
     int i;
 
-    pthread_mutex_lock(&c->current_job_lock);
-    c->done = 1;
-    pthread_cond_broadcast(&c->current_job_cond);
-    for (i = 0; i < c->thread_count; i++)
-        pthread_cond_broadcast(&c->progress_cond[i]);
-    pthread_mutex_unlock(&c->current_job_lock);
+    /* no workers of our own when running on a shared pool */
+    if (c->workers) {
+        pthread_mutex_lock(&c->current_job_lock);
+        c->done = 1;
+        pthread_cond_broadcast(&c->current_job_cond);
+        for (i = 0; i < c->thread_count; i++)
+            pthread_cond_broadcast(&c->progress_cond[i]);
+        pthread_mutex_unlock(&c->current_job_lock);
+
+        for (i=0; i<avctx->thread_count; i++)
+             pthread_join(c->workers[i], NULL);
 
-    for (i=0; i<avctx->thread_count; i++)
-         pthread_join(c->workers[i], NULL);
+        pthread_mutex_destroy(&c->current_job_lock);
+        pthread_cond_destroy(&c->current_job_cond);
+        pthread_cond_destroy(&c->last_job_cond);
+    }
 
     for (i = 0; i < c->thread_count; i++) {
         pthread_mutex_destroy(&c->progress_mutex[i]);
         pthread_cond_destroy(&c->progress_cond[i]);
     }
 
-    pthread_mutex_destroy(&c->current_job_lock);
-    pthread_cond_destroy(&c->current_job_cond);
-    pthread_cond_destroy(&c->last_job_cond);
-
     av_freep(&c->entries);
     av_freep(&c->progress_mutex);
     av_freep(&c->progress_cond);
@@ -172,6 +179,49 @@ static int thread_execute2(AVCodecContext *avctx, action_func2* func2, void *arg
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
+typedef struct PoolJob {
+    AVCodecContext *avctx;
+    action_func *func;
+    action_func2 *func2;
+    void *args;
+    int job_size;
+} PoolJob;
+
+static int pool_job(void *opaque, int jobnr, int threadnr)
+{
+    PoolJob *job = opaque;
+    const char *name = job->avctx->codec->name;
+    int ret;
+
+    av_trace_begin("slice", name);
+    ret = job->func ? job->func(job->avctx, (char*)job->args + jobnr*job->job_size):
+                      job->func2(job->avctx, job->args, jobnr, threadnr);
+    av_trace_end("slice", name);
+    return ret;
+}
+
+static int pool_execute(AVCodecContext *avctx, action_func* func, void *arg, int *ret, int job_count, int job_size)
+{
+    PoolJob job = { avctx, func, NULL, arg, job_size };
+
+    if (!(avctx->active_thread_type&FF_THREAD_SLICE) || avctx->thread_count <= 1)
+        return avcodec_default_execute(avctx, func, arg, ret, job_count, job_size);
+
+    return av_thread_pool_execute(avctx->thread_pool, pool_job, &job, ret,
+                                  job_count, avctx->thread_count);
+}
+
+static int pool_execute2(AVCodecContext *avctx, action_func2* func2, void *arg, int *ret, int job_count)
+{
+    PoolJob job = { avctx, NULL, func2, arg, 0 };
+
+    if (!(avctx->active_thread_type&FF_THREAD_SLICE) || avctx->thread_count <= 1)
+        return avcodec_default_execute2(avctx, func2, arg, ret, job_count);
+
+    return av_thread_pool_execute(avctx->thread_pool, pool_job, &job, ret,
+                                  job_count, avctx->thread_count);
+}
+
 int ff_slice_thread_init(AVCodecContext *avctx)
 {
     int i;
@@ -189,7 +239,9 @@ int ff_slice_thread_init(AVCodecContext *avctx)
         thread_count = avctx->thread_count = 1;
 
     if (!thread_count) {
-        int nb_cpus = av_cpu_count();
+        /* the pool workers plus the thread submitting the jobs */
+        int nb_cpus = avctx->thread_pool ? av_thread_pool_get_nb_threads(avctx->thread_pool) + 1
+                                         : av_cpu_count();
         if  (avctx->height)
             nb_cpus = FFMIN(nb_cpus, (avctx->height+15)/16);
         // use number of cores + 1 as thread count if there is more than one
@@ -208,6 +260,13 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     if (!c)
         return -1;
 
+    if (avctx->thread_pool) {
+        avctx->internal->thread_ctx = c;
+        avctx->execute  = pool_execute;
+        avctx->execute2 = pool_execute2;
+        return 0;
+    }
+
     c->workers = av_mallocz_array(thread_count, sizeof(pthread_t));
     if (!c->workers) {
         av_free(c);
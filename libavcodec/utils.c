@@ -819,7 +819,9 @@ int attribute_align_arg avcodec_open2(AVCodecContext *avctx, const AVCodec *code
 
     if (HAVE_THREADS
         && !(avctx->internal->frame_thread_encoder && (avctx->active_thread_type&FF_THREAD_FRAME))) {
+        av_mem_tag_push(avctx);
         ret = ff_thread_init(avctx);
+        av_mem_tag_pop();
         if (ret < 0) {
             goto free_and_end;
         }
@@ -1017,7 +1019,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     if (   avctx->codec->init && (!(avctx->active_thread_type&FF_THREAD_FRAME)
         || avctx->internal->frame_thread_encoder)) {
+        av_mem_tag_push(avctx);
         ret = avctx->codec->init(avctx);
+        av_mem_tag_pop();
         if (ret < 0) {
             goto free_and_end;
         }
@@ -1258,20 +1262,111 @@ AVCodec *avcodec_find_encoder(enum AVCodecID id)
     return find_encdec(id, 1);
 }
 
-AVCodec *avcodec_find_encoder_by_name(const char *name)
+/* Registered codecs sorted by name, for the lookups by name.
+ * Like the codec list, the array lives as long as the process: lavc has no
+ * deinit call, so it is only freed when rebuilt after a registration. */
+typedef struct CodecName {
+    const char *name;
+    AVCodec *codec;
+    int idx;                    ///< position in the registered codec list
+} CodecName;
+
+static AVOnce codec_index_once = AV_ONCE_INIT;
+static AVMutex codec_index_lock;
+static CodecName *codec_index;
+static int codec_index_size;
+static AVCodec **codec_index_last;  ///< last_avcodec when the index was built
+
+static void codec_index_init(void)
+{
+    ff_mutex_init(&codec_index_lock, NULL);
+}
+
+static int codec_name_cmp(const void *a, const void *b)
+{
+    const CodecName *ca = a, *cb = b;
+    int ret = strcmp(ca->name, cb->name);
+    return ret ? ret : ca->idx - cb->idx;
+}
+
+static int codec_name_find_cmp(const void *name, const void *b)
+{
+    return strcmp(name, ((const CodecName *)b)->name);
+}
+
+/* Rebuild the index if codecs were registered since; call with
+ * codec_index_lock held. */
+static void codec_index_update(void)
 {
+    AVCodec **last = last_avcodec;
     AVCodec *p;
+    int n = 0;
+
+    if (codec_index_last == last)
+        return;
+
+    for (p = first_avcodec; p; p = p->next)
+        n++;
+    av_freep(&codec_index);
+    codec_index_size = 0;
+    codec_index = av_malloc_array(n, sizeof(*codec_index));
+    if (!codec_index)
+        return;
+
+    for (p = first_avcodec; p && codec_index_size < n; p = p->next) {
+        CodecName *e = &codec_index[codec_index_size];
+        e->name  = p->name;
+        e->codec = p;
+        e->idx   = codec_index_size++;
+    }
+    qsort(codec_index, codec_index_size, sizeof(*codec_index), codec_name_cmp);
+    codec_index_last = last;
+}
+
+static AVCodec *find_codec_by_name(const char *name, int encoder)
+{
+    AVCodec *p = NULL;
+    CodecName *e = NULL;
+
     if (!name)
         return NULL;
+
+    ff_thread_once(&codec_index_once, codec_index_init);
+    ff_mutex_lock(&codec_index_lock);
+    codec_index_update();
+    if (codec_index)
+        e = bsearch(name, codec_index, codec_index_size, sizeof(*codec_index),
+                    codec_name_find_cmp);
+    if (e) {
+        while (e > codec_index && !strcmp(e[-1].name, name))
+            e--;
+        for (; e < codec_index + codec_index_size && !strcmp(e->name, name); e++) {
+            if (encoder ? av_codec_is_encoder(e->codec) : av_codec_is_decoder(e->codec)) {
+                p = e->codec;
+                break;
+            }
+        }
+    }
+    ff_mutex_unlock(&codec_index_lock);
+    if (p)
+        return p;
+
+    /* the index may miss codecs registered concurrently */
     p = first_avcodec;
     while (p) {
-        if (av_codec_is_encoder(p) && strcmp(name, p->name) == 0)
+        if ((encoder ? av_codec_is_encoder(p) : av_codec_is_decoder(p)) &&
+            strcmp(name, p->name) == 0)
             return p;
         p = p->next;
     }
     return NULL;
 }
 
+AVCodec *avcodec_find_encoder_by_name(const char *name)
+{
+    return find_codec_by_name(name, 1);
+}
+
 AVCodec *avcodec_find_decoder(enum AVCodecID id)
 {
     return find_encdec(id, 0);
@@ -1279,16 +1374,7 @@ AVCodec *avcodec_find_decoder(enum AVCodecID id)
 
 AVCodec *avcodec_find_decoder_by_name(const char *name)
 {
-    AVCodec *p;
-    if (!name)
-        return NULL;
-    p = first_avcodec;
-    while (p) {
-        if (av_codec_is_decoder(p) && strcmp(name, p->name) == 0)
-            return p;
-        p = p->next;
-    }
-    return NULL;
+    return find_codec_by_name(name, 0);
 }
 
 const char *avcodec_get_name(enum AVCodecID id)
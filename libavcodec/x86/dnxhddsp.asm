@@ -0,0 +1,76 @@
+;******************************************************************************
+;* VC3/DNxHD decoder SIMD functions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_0xffff: times 8 dd 0xffff
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void dnxhd_dequant(int16_t *block, const int32_t *scale,
+;                    const int32_t *bias, int shift)
+;
+; The levels are widened to 32 bits, as scale can take up to 17 bits. psignd
+; restores the sign and keeps zero levels at zero. The results are truncated
+; to 16 bits like the C stores, packusdw cannot saturate after the mask.
+;-----------------------------------------------------------------------------
+%macro DNXHD_DEQUANT 0
+cglobal dnxhd_dequant, 4, 5, 6, block, scale, bias, shift, i
+    movd       xm4, shiftd
+    mova        m5, [pd_0xffff]
+    add     blockq, 128
+    add     scaleq, 256
+    add      biasq, 256
+    mov         iq, -128
+.loop:
+    pmovsxwd    m0, [blockq+iq]
+    pmovsxwd    m1, [blockq+iq+mmsize/2]
+    pabsd       m2, m0
+    pabsd       m3, m1
+    pmulld      m2, [scaleq+2*iq]
+    pmulld      m3, [scaleq+2*iq+mmsize]
+    paddd       m2, [biasq+2*iq]
+    paddd       m3, [biasq+2*iq+mmsize]
+    psrad       m2, xm4
+    psrad       m3, xm4
+    psignd      m2, m0
+    psignd      m3, m1
+    pand        m2, m5
+    pand        m3, m5
+    packusdw    m2, m3
+%if mmsize == 32
+    vpermq      m2, m2, q3120
+%endif
+    movu [blockq+iq], m2
+    add         iq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse4
+DNXHD_DEQUANT
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+DNXHD_DEQUANT
+%endif
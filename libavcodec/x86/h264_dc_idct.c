@@ -0,0 +1,122 @@
+/*
+ * H.264 luma DC dequantization and transform
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * SSE4 version of the high bit depth luma DC transform, which the external
+ * asm only has for 8-bit. All arithmetic is done in 32-bit lanes, wrapping
+ * like the C code.
+ */
+
+#include "config.h"
+#include "libavutil/x86/asm.h"
+#include "h264_dc_idct.h"
+
+#if HAVE_SSE4_INLINE
+
+/* xmm6 = qmul in all lanes, xmm7 = 128 in all lanes */
+#define LOAD_QMUL(qmul)                                 \
+    "movd             "qmul", %%xmm6    \n\t"           \
+    "pshufd      $0, %%xmm6, %%xmm6     \n\t"           \
+    "pcmpeqd         %%xmm7, %%xmm7     \n\t"           \
+    "psrld              $31, %%xmm7     \n\t"           \
+    "pslld               $7, %%xmm7     \n\t"
+
+/* r = (r * qmul + 128) >> 8 */
+#define DEQUANT(r)                                      \
+    "pmulld          %%xmm6, %%"r"      \n\t"           \
+    "paddd           %%xmm7, %%"r"      \n\t"           \
+    "psrad               $8, %%"r"      \n\t"
+
+/* Store the four dwords of r to rows 0, 1, 4 and 5 of a 16-wide block. */
+#define STORE_LUMA(r, off)                              \
+    "movd         %%"r",   "off"+  0(%0)\n\t"           \
+    "pextrd $1,   %%"r",   "off"+ 64(%0)\n\t"           \
+    "pextrd $2,   %%"r",   "off"+256(%0)\n\t"           \
+    "pextrd $3,   %%"r",   "off"+320(%0)\n\t"
+
+void ff_h264_luma_dc_dequant_idct_high_sse4(int16_t *output, int16_t *input,
+                                            int qmul)
+{
+    /* The 1-D transforms are done vertically first, which gives the same
+     * result as the C code since everything wraps modulo 2^32. */
+    __asm__ volatile (
+        "movdqu        (%1), %%xmm0     \n\t"
+        "movdqu      16(%1), %%xmm1     \n\t"
+        "movdqu      32(%1), %%xmm2     \n\t"
+        "movdqu      48(%1), %%xmm3     \n\t"
+        "movdqa      %%xmm0, %%xmm4     \n\t"
+        "paddd       %%xmm2, %%xmm0     \n\t"
+        "psubd       %%xmm2, %%xmm4     \n\t"
+        "movdqa      %%xmm1, %%xmm5     \n\t"
+        "paddd       %%xmm3, %%xmm1     \n\t"
+        "psubd       %%xmm3, %%xmm5     \n\t"
+        "movdqa      %%xmm0, %%xmm2     \n\t"
+        "paddd       %%xmm1, %%xmm0     \n\t" /* rows 0 */
+        "psubd       %%xmm1, %%xmm2     \n\t" /* rows 5 */
+        "movdqa      %%xmm4, %%xmm1     \n\t"
+        "paddd       %%xmm5, %%xmm1     \n\t" /* rows 1 */
+        "psubd       %%xmm5, %%xmm4     \n\t" /* rows 4 */
+
+        /* transpose, so that each register holds one input column */
+        "movdqa      %%xmm0, %%xmm3     \n\t"
+        "punpckldq   %%xmm1, %%xmm0     \n\t"
+        "punpckhdq   %%xmm1, %%xmm3     \n\t"
+        "movdqa      %%xmm4, %%xmm5     \n\t"
+        "punpckldq   %%xmm2, %%xmm4     \n\t"
+        "punpckhdq   %%xmm2, %%xmm5     \n\t"
+        "movdqa      %%xmm0, %%xmm1     \n\t"
+        "punpcklqdq  %%xmm4, %%xmm0     \n\t"
+        "punpckhqdq  %%xmm4, %%xmm1     \n\t"
+        "movdqa      %%xmm3, %%xmm2     \n\t"
+        "punpcklqdq  %%xmm5, %%xmm2     \n\t"
+        "punpckhqdq  %%xmm5, %%xmm3     \n\t"
+
+        "movdqa      %%xmm0, %%xmm4     \n\t"
+        "paddd       %%xmm1, %%xmm0     \n\t"
+        "psubd       %%xmm1, %%xmm4     \n\t"
+        "movdqa      %%xmm2, %%xmm5     \n\t"
+        "paddd       %%xmm3, %%xmm2     \n\t"
+        "psubd       %%xmm3, %%xmm5     \n\t"
+        "movdqa      %%xmm0, %%xmm1     \n\t"
+        "paddd       %%xmm2, %%xmm0     \n\t" /* column 0 */
+        "psubd       %%xmm2, %%xmm1     \n\t" /* column 1 */
+        "movdqa      %%xmm4, %%xmm3     \n\t"
+        "psubd       %%xmm5, %%xmm4     \n\t" /* column 2 */
+        "paddd       %%xmm5, %%xmm3     \n\t" /* column 3 */
+
+        LOAD_QMUL("%2")
+        DEQUANT("xmm0")
+        DEQUANT("xmm1")
+        DEQUANT("xmm4")
+        DEQUANT("xmm3")
+        STORE_LUMA("xmm0", "0")
+        STORE_LUMA("xmm1", "128")
+        STORE_LUMA("xmm4", "512")
+        STORE_LUMA("xmm3", "640")
+        :
+        : "r"(output), "r"(input), "m"(qmul)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                       "%xmm4", "%xmm5", "%xmm6", "%xmm7",)
+          "memory"
+    );
+}
+
+#endif /* HAVE_SSE4_INLINE */
@@ -499,6 +499,92 @@ QPEL16_OP(mc33, MMX)
 QPEL16(mmxext)
 #endif
 
+#if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+void ff_put_h264_qpel16_hv1_lowpass_avx512(int16_t *tmp, const uint8_t *src, int srcStride);
+
+#define DEF_QPEL16_AVX512(OPNAME)\
+void ff_ ## OPNAME ## _h264_qpel16_h_lowpass_avx512(uint8_t *dst, const uint8_t *src, int dstStride, int srcStride);\
+void ff_ ## OPNAME ## _h264_qpel16_v_lowpass_avx512(uint8_t *dst, const uint8_t *src, int dstStride, int srcStride);\
+void ff_ ## OPNAME ## _h264_qpel16_hv2_lowpass_avx512(uint8_t *dst, const int16_t *tmp, int dstStride);\
+void ff_ ## OPNAME ## _pixels16_l2_avx512(uint8_t *dst, const uint8_t *src1, const uint8_t *src2, int dstStride, int src1Stride);\
+\
+static av_always_inline void ff_ ## OPNAME ## _h264_qpel16_hv_lowpass_avx512(uint8_t *dst, const uint8_t *src, int dstStride, int srcStride)\
+{\
+    LOCAL_ALIGNED(16, int16_t, tmp, [16 * 21]);\
+    ff_put_h264_qpel16_hv1_lowpass_avx512(tmp, src - 2 * srcStride, srcStride);\
+    ff_ ## OPNAME ## _h264_qpel16_hv2_lowpass_avx512(dst, tmp, dstStride);\
+}
+
+DEF_QPEL16_AVX512(put)
+DEF_QPEL16_AVX512(avg)
+
+#define H264_MC16_AVX512(OPNAME)                                            \
+static void OPNAME ## h264_qpel16_mc10_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    LOCAL_ALIGNED(16, uint8_t, half, [16 * 16]);                            \
+    ff_put_h264_qpel16_h_lowpass_avx512(half, src, 16, stride);             \
+    ff_ ## OPNAME ## pixels16_l2_avx512(dst, src, half, stride, stride);    \
+}                                                                           \
+                                                                            \
+static void OPNAME ## h264_qpel16_mc20_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    ff_ ## OPNAME ## h264_qpel16_h_lowpass_avx512(dst, src, stride, stride); \
+}                                                                           \
+                                                                            \
+static void OPNAME ## h264_qpel16_mc30_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    LOCAL_ALIGNED(16, uint8_t, half, [16 * 16]);                            \
+    ff_put_h264_qpel16_h_lowpass_avx512(half, src, 16, stride);             \
+    ff_ ## OPNAME ## pixels16_l2_avx512(dst, src + 1, half, stride, stride); \
+}                                                                           \
+                                                                            \
+static void OPNAME ## h264_qpel16_mc01_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    LOCAL_ALIGNED(16, uint8_t, half, [16 * 16]);                            \
+    ff_put_h264_qpel16_v_lowpass_avx512(half, src, 16, stride);             \
+    ff_ ## OPNAME ## pixels16_l2_avx512(dst, src, half, stride, stride);    \
+}                                                                           \
+                                                                            \
+static void OPNAME ## h264_qpel16_mc02_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    ff_ ## OPNAME ## h264_qpel16_v_lowpass_avx512(dst, src, stride, stride); \
+}                                                                           \
+                                                                            \
+static void OPNAME ## h264_qpel16_mc03_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    LOCAL_ALIGNED(16, uint8_t, half, [16 * 16]);                            \
+    ff_put_h264_qpel16_v_lowpass_avx512(half, src, 16, stride);             \
+    ff_ ## OPNAME ## pixels16_l2_avx512(dst, src + stride, half, stride, stride); \
+}                                                                           \
+                                                                            \
+static void OPNAME ## h264_qpel16_mc22_avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    ff_ ## OPNAME ## h264_qpel16_hv_lowpass_avx512(dst, src, stride, stride); \
+}                                                                           \
+H264_MC16_L2_AVX512(OPNAME, 11, h_lowpass, src,          v_lowpass,  src)   \
+H264_MC16_L2_AVX512(OPNAME, 31, h_lowpass, src,          v_lowpass,  src + 1) \
+H264_MC16_L2_AVX512(OPNAME, 13, h_lowpass, src + stride, v_lowpass,  src)   \
+H264_MC16_L2_AVX512(OPNAME, 33, h_lowpass, src + stride, v_lowpass,  src + 1) \
+H264_MC16_L2_AVX512(OPNAME, 21, h_lowpass, src,          hv_lowpass, src)   \
+H264_MC16_L2_AVX512(OPNAME, 23, h_lowpass, src + stride, hv_lowpass, src)   \
+H264_MC16_L2_AVX512(OPNAME, 12, v_lowpass, src,          hv_lowpass, src)   \
+H264_MC16_L2_AVX512(OPNAME, 32, v_lowpass, src + 1,      hv_lowpass, src)
+
+/* average of two half-pel planes */
+#define H264_MC16_L2_AVX512(OPNAME, XY, F1, SRC1, F2, SRC2)                 \
+static void OPNAME ## h264_qpel16_mc ## XY ## _avx512(uint8_t *dst, const uint8_t *src, ptrdiff_t stride) \
+{                                                                           \
+    LOCAL_ALIGNED(16, uint8_t, half1, [16 * 16]);                           \
+    LOCAL_ALIGNED(16, uint8_t, half2, [16 * 16]);                           \
+    ff_put_h264_qpel16_ ## F1 ## _avx512(half1, SRC1, 16, stride);          \
+    ff_put_h264_qpel16_ ## F2 ## _avx512(half2, SRC2, 16, stride);          \
+    ff_ ## OPNAME ## pixels16_l2_avx512(dst, half1, half2, stride, 16);     \
+}
+
+H264_MC16_AVX512(put_)
+H264_MC16_AVX512(avg_)
+#endif /* ARCH_X86_64 && HAVE_AVX512_EXTERNAL */
+
 #endif /* HAVE_YASM */
 
 #define SET_QPEL_FUNCS(PFX, IDX, SIZE, CPU, PREFIX)                          \
@@ -529,6 +615,12 @@ QPEL16(mmxext)
         c->avg_h264_qpel_pixels_tab[1][x + y * 4] = avg_h264_qpel8_mc  ## x ## y ## _ ## CPU; \
     } while (0)
 
+#define H264_QPEL16_FUNCS(x, y, CPU)                                                          \
+    do {                                                                                      \
+        c->put_h264_qpel_pixels_tab[0][x + y * 4] = put_h264_qpel16_mc ## x ## y ## _ ## CPU; \
+        c->avg_h264_qpel_pixels_tab[0][x + y * 4] = avg_h264_qpel16_mc ## x ## y ## _ ## CPU; \
+    } while (0)
+
 #define H264_QPEL_FUNCS_10(x, y, CPU)                                                               \
     do {                                                                                            \
         c->put_h264_qpel_pixels_tab[0][x + y * 4] = ff_put_h264_qpel16_mc ## x ## y ## _10_ ## CPU; \
@@ -631,4 +723,23 @@ av_cold void ff_h264qpel_init_x86(H264QpelContext *c, int bit_depth)
         }
     }
 #endif
+#if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+    if (bit_depth <= 8 && EXTERNAL_AVX512(av_get_cpu_flags())) {
+        H264_QPEL16_FUNCS(1, 0, avx512);
+        H264_QPEL16_FUNCS(2, 0, avx512);
+        H264_QPEL16_FUNCS(3, 0, avx512);
+        H264_QPEL16_FUNCS(0, 1, avx512);
+        H264_QPEL16_FUNCS(1, 1, avx512);
+        H264_QPEL16_FUNCS(2, 1, avx512);
+        H264_QPEL16_FUNCS(3, 1, avx512);
+        H264_QPEL16_FUNCS(0, 2, avx512);
+        H264_QPEL16_FUNCS(1, 2, avx512);
+        H264_QPEL16_FUNCS(2, 2, avx512);
+        H264_QPEL16_FUNCS(3, 2, avx512);
+        H264_QPEL16_FUNCS(0, 3, avx512);
+        H264_QPEL16_FUNCS(1, 3, avx512);
+        H264_QPEL16_FUNCS(2, 3, avx512);
+        H264_QPEL16_FUNCS(3, 3, avx512);
+    }
+#endif
 }
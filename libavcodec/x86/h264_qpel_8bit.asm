@@ -28,6 +28,7 @@
 SECTION_RODATA 32
 
 cextern pw_16
+cextern pw_20
 cextern pw_5
 cextern pb_0
 
@@ -860,3 +861,217 @@ INIT_XMM ssse3
 QPEL16_H_LOWPASS_L2_OP put
 QPEL16_H_LOWPASS_L2_OP avg
 %endif
+
+
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+; 16x16 MC with the 6-tap filter on two rows of 16 pixels widened to words
+; per zmm register. The second pass of the centre position needs 32-bit
+; intermediates and handles one row per register.
+
+; m%1 = the 16 pixels at %2 and at %3, widened to words
+%macro LOAD2_ZMM 3
+    movu          xm%1, %2
+    vinserti128   ym%1, ym%1, %3, 1
+    vpmovzxbw      m%1, ym%1
+%endmacro
+
+; m0, m1, m2 = sums of the outer, middle and inner taps of the rows at %1
+; and %1+%2
+%macro HSUM2_ZMM 2
+    LOAD2_ZMM      0, [%1-2], [%1+%2-2]
+    LOAD2_ZMM      1, [%1+3], [%1+%2+3]
+    paddw          m0, m1
+    LOAD2_ZMM      1, [%1-1], [%1+%2-1]
+    LOAD2_ZMM      3, [%1+2], [%1+%2+2]
+    paddw          m1, m3
+    LOAD2_ZMM      2, [%1  ], [%1+%2  ]
+    LOAD2_ZMM      3, [%1+1], [%1+%2+1]
+    paddw          m2, m3
+%endmacro
+
+; %1 = 20 * %1 - 5 * %2 + %3
+%macro FILT_ZMM 5 ; c, b, a, pw_20, pw_5
+    pmullw         %1, %4
+    pmullw         %2, %5
+    psubw          %1, %2
+    paddw          %1, %3
+%endmacro
+
+; filter m0-m2, round, clip and store the two rows in ym2 at r0 and r0+r2
+%macro FILT_STORE2_ZMM 1 ; put/avg
+    FILT_ZMM       m2, m1, m0, m14, m13
+    paddw          m2, m12
+    psraw          m2, 5
+    pmaxsw         m2, m15
+    vpmovuswb     ym2, m2
+%ifidn %1, avg
+    movu          xm3, [r0]
+    vinserti128   ym3, ym3, [r0+r2], 1
+    pavgb         ym2, ym3
+%endif
+    movu         [r0], xm2
+    vextracti128 [r0+r2], ym2, 1
+%endmacro
+
+%macro LOAD_CONSTS_ZMM 0
+    vpbroadcastw  m14, [pw_20]
+    vpbroadcastw  m13, [pw_5]
+    vpbroadcastw  m12, [pw_16]
+    pxor          m15, m15
+%endmacro
+
+%macro QPEL16_H_LOWPASS_OP_ZMM 1
+cglobal %1_h264_qpel16_h_lowpass, 4,5,16 ; dst, src, dstStride, srcStride
+    movsxdifnidn  r2, r2d
+    movsxdifnidn  r3, r3d
+    LOAD_CONSTS_ZMM
+    mov          r4d, 8
+.loop:
+    HSUM2_ZMM     r1, r3
+    FILT_STORE2_ZMM %1
+    lea           r1, [r1+2*r3]
+    lea           r0, [r0+2*r2]
+    dec          r4d
+    jg         .loop
+    RET
+%endmacro
+
+%macro QPEL16_V_LOWPASS_OP_ZMM 1
+cglobal %1_h264_qpel16_v_lowpass, 4,7,16 ; dst, src, dstStride, srcStride
+    movsxdifnidn  r2, r2d
+    movsxdifnidn  r3, r3d
+    sub           r1, r3
+    sub           r1, r3
+    lea           r5, [r3*3]
+    LOAD_CONSTS_ZMM
+    mov          r4d, 8
+.loop:
+    lea           r6, [r1+4*r3]
+    LOAD2_ZMM      0, [r1], [r1+r3]
+    LOAD2_ZMM      1, [r6+r3], [r6+2*r3]
+    paddw         m0, m1
+    LOAD2_ZMM      1, [r1+r3], [r1+2*r3]
+    LOAD2_ZMM      2, [r6], [r6+r3]
+    paddw         m1, m2
+    LOAD2_ZMM      2, [r1+2*r3], [r1+r5]
+    LOAD2_ZMM      3, [r1+r5], [r6]
+    paddw         m2, m3
+    FILT_STORE2_ZMM %1
+    lea           r1, [r1+2*r3]
+    lea           r0, [r0+2*r2]
+    dec          r4d
+    jg         .loop
+    RET
+%endmacro
+
+INIT_ZMM avx512
+QPEL16_H_LOWPASS_OP_ZMM put
+QPEL16_H_LOWPASS_OP_ZMM avg
+QPEL16_V_LOWPASS_OP_ZMM put
+QPEL16_V_LOWPASS_OP_ZMM avg
+
+; tmp[16 * 21] = unrounded horizontal filter of the 21 rows from src on
+cglobal put_h264_qpel16_hv1_lowpass, 3,4,16 ; tmp, src, srcStride
+    movsxdifnidn  r2, r2d
+    vpbroadcastw  m14, [pw_20]
+    vpbroadcastw  m13, [pw_5]
+    mov          r3d, 10
+.loop:
+    HSUM2_ZMM     r1, r2
+    FILT_ZMM      m2, m1, m0, m14, m13
+    movu        [r0], m2
+    lea           r1, [r1+2*r2]
+    add           r0, 64
+    dec          r3d
+    jg         .loop
+    vpmovzxbw    ym0, [r1-2]
+    vpmovzxbw    ym1, [r1+3]
+    paddw        ym0, ym1
+    vpmovzxbw    ym1, [r1-1]
+    vpmovzxbw    ym3, [r1+2]
+    paddw        ym1, ym3
+    vpmovzxbw    ym2, [r1  ]
+    vpmovzxbw    ym3, [r1+1]
+    paddw        ym2, ym3
+    FILT_ZMM     ym2, ym1, ym0, ym14, ym13
+    movu        [r0], ym2
+    RET
+
+%macro QPEL16_HV2_LOWPASS_OP_ZMM 1
+cglobal %1_h264_qpel16_hv2_lowpass, 3,4,16 ; dst, tmp, dstStride
+    movsxdifnidn  r2, r2d
+    mov          r3d, 20
+    vpbroadcastd m14, r3d
+    mov          r3d, 5
+    vpbroadcastd m13, r3d
+    mov          r3d, 512
+    vpbroadcastd m12, r3d
+    pxor         m15, m15
+    mov          r3d, 16
+.loop:
+    vpmovsxwd     m0, [r1]
+    vpmovsxwd     m1, [r1+160]
+    paddd         m0, m1
+    vpmovsxwd     m1, [r1+32]
+    vpmovsxwd     m3, [r1+128]
+    paddd         m1, m3
+    vpmovsxwd     m2, [r1+64]
+    vpmovsxwd     m3, [r1+96]
+    paddd         m2, m3
+    pmulld        m2, m14
+    pmulld        m1, m13
+    psubd         m2, m1
+    paddd         m2, m0
+    paddd         m2, m12
+    psrad         m2, 10
+    pmaxsd        m2, m15
+    vpmovusdb    xm2, m2
+%ifidn %1, avg
+    pavgb        xm2, [r0]
+%endif
+    movu        [r0], xm2
+    add           r1, 32
+    add           r0, r2
+    dec          r3d
+    jg         .loop
+    RET
+%endmacro
+
+; src2 has a stride of 16
+%macro PIXELS16_L2_ZMM 1
+cglobal %1_pixels16_l2, 5,8,2 ; dst, src1, src2, dstStride, src1Stride
+    movsxdifnidn  r3, r3d
+    movsxdifnidn  r4, r4d
+    lea           r5, [r3*3]
+    lea           r6, [r4*3]
+    mov          r7d, 4
+.loop:
+    movu          xm0, [r1]
+    vinserti32x4   m0, m0, [r1+r4], 1
+    vinserti32x4   m0, m0, [r1+2*r4], 2
+    vinserti32x4   m0, m0, [r1+r6], 3
+    pavgb          m0, [r2]
+%ifidn %1, avg
+    movu          xm1, [r0]
+    vinserti32x4   m1, m1, [r0+r3], 1
+    vinserti32x4   m1, m1, [r0+2*r3], 2
+    vinserti32x4   m1, m1, [r0+r5], 3
+    pavgb          m0, m1
+%endif
+    movu         [r0], xm0
+    vextracti32x4 [r0+r3], m0, 1
+    vextracti32x4 [r0+2*r3], m0, 2
+    vextracti32x4 [r0+r5], m0, 3
+    lea           r1, [r1+4*r4]
+    lea           r0, [r0+4*r3]
+    add           r2, 64
+    dec          r7d
+    jg         .loop
+    RET
+%endmacro
+
+QPEL16_HV2_LOWPASS_OP_ZMM put
+QPEL16_HV2_LOWPASS_OP_ZMM avg
+PIXELS16_L2_ZMM put
+PIXELS16_L2_ZMM avg
+%endif
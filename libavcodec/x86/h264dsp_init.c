@@ -23,6 +23,7 @@
 #include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 #include "libavcodec/h264dsp.h"
+#include "h264_dc_idct.h"
 
 /***********************************/
 /* IDCT */
@@ -224,9 +225,9 @@ H264_BIWEIGHT_10_SSE(4,  10)
 av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
                                  const int chroma_format_idc)
 {
-#if HAVE_YASM
     int cpu_flags = av_get_cpu_flags();
 
+#if HAVE_YASM
     if (EXTERNAL_MMXEXT(cpu_flags) && chroma_format_idc <= 1)
         c->h264_loop_filter_strength = ff_h264_loop_filter_strength_mmxext;
 
@@ -435,4 +436,9 @@ av_cold void ff_h264dsp_init_x86(H264DSPContext *c, const int bit_depth,
         }
     }
 #endif
+
+#if HAVE_SSE4_INLINE
+    if (INLINE_SSE4(cpu_flags) && bit_depth > 8)
+        c->h264_luma_dc_dequant_idct = ff_h264_luma_dc_dequant_idct_high_sse4;
+#endif /* HAVE_SSE4_INLINE */
 }
@@ -1554,6 +1554,7 @@ cglobal hevc_put_hevc_bi_w%1_%2, 4, 6, 10, dst, dststride, src, src2, height, de
     dec                h                         ; cmp height
     jnz               .loop                      ; height loop
     RET
+%undef h
 %endmacro
 
 INIT_XMM sse4                                    ; adds ff_ and _sse4 to function name
@@ -1669,4 +1670,126 @@ HEVC_PUT_HEVC_QPEL 16, 10
 HEVC_PUT_HEVC_QPEL_HV 16, 10
 
 %endif ;AVX2
+
+%if HAVE_AVX512_EXTERNAL
+; 8-bit put qpel/epel h and v for widths of 16 and up. Each tap is a word
+; multiply of 32 pixels, so the sums are exact; k1 masks off the columns of
+; the last block past the width.
+
+%macro PEL_LOAD_ZMM 3 ; dst, src, masked
+%if %3
+    vpmovzxbw  %1{k1}{z}, %2
+%else
+    vpmovzxbw         %1, %2
+%endif
+%endmacro
+
+; m0 = filter taps %1 applied to the pixels at column %2 of the row
+%macro PEL_COMPUTE_ZMM 3 ; taps, column, masked
+%assign %%i 0
+%rep %1
+%if %%i < 4
+    %xdefine %%base srcq
+%else
+    %xdefine %%base pel_src4
+%endif
+%if %%i == 0
+    %xdefine %%reg m0
+%else
+    %xdefine %%reg m1
+%endif
+%if (%%i & 3) == 0
+    PEL_LOAD_ZMM  %%reg, [%%base + %2], %3
+%elif (%%i & 3) == 1
+    PEL_LOAD_ZMM  %%reg, [%%base + pel_step + %2], %3
+%elif (%%i & 3) == 2
+    PEL_LOAD_ZMM  %%reg, [%%base + 2*pel_step + %2], %3
+%else
+    PEL_LOAD_ZMM  %%reg, [%%base + pel_step3 + %2], %3
+%endif
+%assign %%c 8 + %%i
+    pmullw        %%reg, m %+ %%c
+%if %%i
+    paddw            m0, m1
+%endif
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+; m8 + i = coefficient i of filter %3, broadcast to words
+%macro PEL_FILTER_ZMM 3 ; taps, table, filter index
+    lea         rfilterq, [%2]
+    sub              %3d, 1
+%if %1 == 8
+    shl              %3d, 6
+%else
+    shl              %3d, 5
+%endif
+    add         rfilterq, %3q
+%assign %%i 0
+%rep %1
+%assign %%c 8 + %%i
+    vpbroadcastw  m %+ %%c, [rfilterq + (%%i >> 1) * 16 + (%%i & 1) * 2]
+%assign %%i %%i+1
+%endrep
+%endmacro
+
+%macro HEVC_PUT_HEVC_PEL_ZMM 4 ; epel/qpel, h/v, taps, width
+cglobal hevc_put_hevc_%1_%2%4_8, 6, 9, 8 + %3, dst, src, srcstride, height, mx, my, rfilter, r3src, r4src
+%ifidn %2, h
+    %define pel_step  1
+    %define pel_step3 3
+    %define pel_src4  srcq + 4
+    PEL_FILTER_ZMM    %3, hevc_%1_filters_sse4_10, mx
+    sub             srcq, %3 / 2 - 1
+%else
+    %define pel_step  srcstrideq
+    %define pel_step3 r3srcq
+    %define pel_src4  r4srcq
+    PEL_FILTER_ZMM    %3, hevc_%1_filters_sse4_10, my
+    lea           r3srcq, [srcstrideq*3]
+%if %3 == 8
+    sub             srcq, r3srcq
+%else
+    sub             srcq, srcstrideq
+%endif
+%endif
+%if %4 & 31
+    mov         rfilterd, (1 << (%4 & 31)) - 1
+    kmovd             k1, rfilterd
+%endif
+.loop:
+%ifidn %2, v
+%if %3 == 8
+    lea           r4srcq, [srcq+4*srcstrideq]
+%endif
+%endif
+%assign %%x 0
+%rep %4 / 32
+    PEL_COMPUTE_ZMM   %3, %%x, 0
+    movu   [dstq + 2*%%x], m0
+%assign %%x %%x + 32
+%endrep
+%if %4 & 31
+    PEL_COMPUTE_ZMM   %3, %%x, 1
+    vmovdqu16 [dstq + 2*%%x]{k1}, m0
+%endif
+    LOOP_END         dst, src, srcstride
+    RET
+%endmacro
+
+%macro HEVC_PUT_HEVC_H_V_ZMM 1 ; width
+HEVC_PUT_HEVC_PEL_ZMM epel, h, 4, %1
+HEVC_PUT_HEVC_PEL_ZMM epel, v, 4, %1
+HEVC_PUT_HEVC_PEL_ZMM qpel, h, 8, %1
+HEVC_PUT_HEVC_PEL_ZMM qpel, v, 8, %1
+%endmacro
+
+INIT_ZMM avx512
+HEVC_PUT_HEVC_H_V_ZMM 16
+HEVC_PUT_HEVC_H_V_ZMM 24
+HEVC_PUT_HEVC_H_V_ZMM 32
+HEVC_PUT_HEVC_H_V_ZMM 48
+HEVC_PUT_HEVC_H_V_ZMM 64
+%endif ; AVX512
 %endif ; ARCH_X86_64
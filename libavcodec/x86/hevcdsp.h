@@ -229,6 +229,31 @@ PEL_PROTOTYPE(qpel_hv32,10, avx2);
 PEL_PROTOTYPE(qpel_hv48,10, avx2);
 PEL_PROTOTYPE(qpel_hv64,10, avx2);
 
+PEL_PROTOTYPE(epel_h16, 8, avx512);
+PEL_PROTOTYPE(epel_h24, 8, avx512);
+PEL_PROTOTYPE(epel_h32, 8, avx512);
+PEL_PROTOTYPE(epel_h48, 8, avx512);
+PEL_PROTOTYPE(epel_h64, 8, avx512);
+
+PEL_PROTOTYPE(epel_v16, 8, avx512);
+PEL_PROTOTYPE(epel_v24, 8, avx512);
+PEL_PROTOTYPE(epel_v32, 8, avx512);
+PEL_PROTOTYPE(epel_v48, 8, avx512);
+PEL_PROTOTYPE(epel_v64, 8, avx512);
+
+PEL_PROTOTYPE(qpel_h16, 8, avx512);
+PEL_PROTOTYPE(qpel_h24, 8, avx512);
+PEL_PROTOTYPE(qpel_h32, 8, avx512);
+PEL_PROTOTYPE(qpel_h48, 8, avx512);
+PEL_PROTOTYPE(qpel_h64, 8, avx512);
+
+PEL_PROTOTYPE(qpel_v16, 8, avx512);
+PEL_PROTOTYPE(qpel_v24, 8, avx512);
+PEL_PROTOTYPE(qpel_v32, 8, avx512);
+PEL_PROTOTYPE(qpel_v48, 8, avx512);
+PEL_PROTOTYPE(qpel_v64, 8, avx512);
+
+
 WEIGHTING_PROTOTYPES(8, sse4);
 WEIGHTING_PROTOTYPES(10, sse4);
 WEIGHTING_PROTOTYPES(12, sse4);
@@ -877,6 +877,33 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
 
             c->add_residual[3] = ff_hevc_add_residual_32_8_avx2;
         }
+        if (EXTERNAL_AVX512(cpu_flags)) {
+            if (ARCH_X86_64) {
+                c->put_hevc_epel[5][0][1] = ff_hevc_put_hevc_epel_h16_8_avx512;
+                c->put_hevc_epel[6][0][1] = ff_hevc_put_hevc_epel_h24_8_avx512;
+                c->put_hevc_epel[7][0][1] = ff_hevc_put_hevc_epel_h32_8_avx512;
+                c->put_hevc_epel[8][0][1] = ff_hevc_put_hevc_epel_h48_8_avx512;
+                c->put_hevc_epel[9][0][1] = ff_hevc_put_hevc_epel_h64_8_avx512;
+
+                c->put_hevc_epel[5][1][0] = ff_hevc_put_hevc_epel_v16_8_avx512;
+                c->put_hevc_epel[6][1][0] = ff_hevc_put_hevc_epel_v24_8_avx512;
+                c->put_hevc_epel[7][1][0] = ff_hevc_put_hevc_epel_v32_8_avx512;
+                c->put_hevc_epel[8][1][0] = ff_hevc_put_hevc_epel_v48_8_avx512;
+                c->put_hevc_epel[9][1][0] = ff_hevc_put_hevc_epel_v64_8_avx512;
+
+                c->put_hevc_qpel[5][0][1] = ff_hevc_put_hevc_qpel_h16_8_avx512;
+                c->put_hevc_qpel[6][0][1] = ff_hevc_put_hevc_qpel_h24_8_avx512;
+                c->put_hevc_qpel[7][0][1] = ff_hevc_put_hevc_qpel_h32_8_avx512;
+                c->put_hevc_qpel[8][0][1] = ff_hevc_put_hevc_qpel_h48_8_avx512;
+                c->put_hevc_qpel[9][0][1] = ff_hevc_put_hevc_qpel_h64_8_avx512;
+
+                c->put_hevc_qpel[5][1][0] = ff_hevc_put_hevc_qpel_v16_8_avx512;
+                c->put_hevc_qpel[6][1][0] = ff_hevc_put_hevc_qpel_v24_8_avx512;
+                c->put_hevc_qpel[7][1][0] = ff_hevc_put_hevc_qpel_v32_8_avx512;
+                c->put_hevc_qpel[8][1][0] = ff_hevc_put_hevc_qpel_v48_8_avx512;
+                c->put_hevc_qpel[9][1][0] = ff_hevc_put_hevc_qpel_v64_8_avx512;
+            }
+        }
     } else if (bit_depth == 10) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
             c->add_residual[0] = ff_hevc_add_residual_4_10_mmxext;
@@ -0,0 +1,127 @@
+/*
+ * Discrete wavelet transform lifting steps
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/jpeg2000dwt.h"
+
+#if HAVE_AVX2_INLINE
+
+static void sd_lift53_high_avx2(int32_t *dst, const int32_t *src0,
+                                const int32_t *src1, int n)
+{
+    x86_reg i = -4 * (x86_reg)n;
+
+    __asm__ volatile (
+        "1:                                         \n\t"
+        "vmovdqu     (%[src0], %[i]), %%ymm0        \n\t"
+        "vpaddd      (%[src1], %[i]), %%ymm0, %%ymm0\n\t"
+        "vmovdqu     (%[dst],  %[i]), %%ymm1        \n\t"
+        "vpsrad                   $1, %%ymm0, %%ymm0\n\t"
+        "vpsubd               %%ymm0, %%ymm1, %%ymm1\n\t"
+        "vmovdqu              %%ymm1, (%[dst], %[i])\n\t"
+        "add                     $32, %[i]          \n\t"
+        "jl                       1b                \n\t"
+        "vzeroupper                                 \n\t"
+        : [i]"+r"(i)
+        : [dst]"r"(dst + n), [src0]"r"(src0 + n), [src1]"r"(src1 + n)
+        : XMM_CLOBBERS("%xmm0", "%xmm1",)
+          "memory"
+    );
+}
+
+static void sd_lift53_low_avx2(int32_t *dst, const int32_t *src0,
+                               const int32_t *src1, int n)
+{
+    x86_reg i = -4 * (x86_reg)n;
+    int rnd = 2;
+
+    __asm__ volatile (
+        "vpbroadcastd          %[rnd], %%ymm2       \n\t"
+        "1:                                         \n\t"
+        "vmovdqu     (%[src0], %[i]), %%ymm0        \n\t"
+        "vpaddd      (%[src1], %[i]), %%ymm0, %%ymm0\n\t"
+        "vpaddd               %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vpsrad                   $2, %%ymm0, %%ymm0\n\t"
+        "vpaddd      (%[dst],  %[i]), %%ymm0, %%ymm0\n\t"
+        "vmovdqu              %%ymm0, (%[dst], %[i])\n\t"
+        "add                     $32, %[i]          \n\t"
+        "jl                       1b                \n\t"
+        "vzeroupper                                 \n\t"
+        : [i]"+r"(i)
+        : [dst]"r"(dst + n), [src0]"r"(src0 + n), [src1]"r"(src1 + n),
+          [rnd]"m"(rnd)
+        : XMM_CLOBBERS("%xmm0", "%xmm2",)
+          "memory"
+    );
+}
+
+/* The even and odd lanes are multiplied separately into 64-bit products,
+ * then bits 16..47 of each are merged back into 32-bit lanes. */
+static void sd_lift97_int_avx2(int32_t *dst, const int32_t *src0,
+                               const int32_t *src1, int n, int coef)
+{
+    x86_reg i = -4 * (x86_reg)n;
+    int64_t rnd = (1 << 15) - (coef < 0);
+
+    __asm__ volatile (
+        "vpbroadcastd         %[coef], %%ymm4       \n\t"
+        "vpbroadcastq          %[rnd], %%ymm5       \n\t"
+        "1:                                         \n\t"
+        "vmovdqu     (%[src0], %[i]), %%ymm0        \n\t"
+        "vpaddd      (%[src1], %[i]), %%ymm0, %%ymm0\n\t"
+        "vpsrlq                  $32, %%ymm0, %%ymm1\n\t"
+        "vpmuldq              %%ymm4, %%ymm0, %%ymm0\n\t"
+        "vpmuldq              %%ymm4, %%ymm1, %%ymm1\n\t"
+        "vpaddq               %%ymm5, %%ymm0, %%ymm0\n\t"
+        "vpaddq               %%ymm5, %%ymm1, %%ymm1\n\t"
+        "vpsrlq                  $16, %%ymm0, %%ymm0\n\t"
+        "vpsllq                  $16, %%ymm1, %%ymm1\n\t"
+        "vpblendd     $0xAA, %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpaddd      (%[dst],  %[i]), %%ymm0, %%ymm0\n\t"
+        "vmovdqu              %%ymm0, (%[dst], %[i])\n\t"
+        "add                     $32, %[i]          \n\t"
+        "jl                       1b                \n\t"
+        "vzeroupper                                 \n\t"
+        : [i]"+r"(i)
+        : [dst]"r"(dst + n), [src0]"r"(src0 + n), [src1]"r"(src1 + n),
+          [coef]"m"(coef), [rnd]"m"(rnd)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm4", "%xmm5",)
+          "memory"
+    );
+}
+
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_jpeg2000_dwt_init_x86(DWTContext *s)
+{
+#if HAVE_AVX2_INLINE
+    int cpu_flags = av_get_cpu_flags();
+
+    if (INLINE_AVX2(cpu_flags)) {
+        s->sd_lift53_high = sd_lift53_high_avx2;
+        s->sd_lift53_low  = sd_lift53_low_avx2;
+        s->sd_lift97_int  = sd_lift97_int_avx2;
+    }
+#endif /* HAVE_AVX2_INLINE */
+}
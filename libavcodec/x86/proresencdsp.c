@@ -0,0 +1,139 @@
+/*
+ * Apple ProRes encoder quantization
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/proresencdsp.h"
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+
+static const DECLARE_ALIGNED(32, int32_t, ac_mask)[8] = {
+    0, -1, -1, -1, -1, -1, -1, -1
+};
+
+/* Coefficients and quantizers are both exact in single precision, and the
+ * quotient of two 16-bit integers is never rounded up to the next integer,
+ * so truncating the float quotient gives the same level as the C code. */
+static int quantize_avx2(int16_t *levels, uint32_t nz[64], const int16_t *blocks,
+                         const int16_t *qmat, int nb_blocks)
+{
+    x86_reg n = nb_blocks, j;
+    int err;
+
+    __asm__ volatile (
+        "vpxor            %%ymm9, %%ymm9, %%ymm9    \n\t"
+        "vpxor            %%ymm6, %%ymm6, %%ymm6    \n\t"
+        "vmovdqa         %[mask], %%ymm7            \n\t"
+        "vpcmpeqd         %%ymm8, %%ymm8, %%ymm8    \n\t"
+        "vpsrld              $31, %%ymm8, %%ymm8    \n\t"
+        "vmovdqu          %%ymm9,    (%[nz])        \n\t"
+        "vmovdqu          %%ymm9,  32(%[nz])        \n\t"
+        "vmovdqu          %%ymm9,  64(%[nz])        \n\t"
+        "vmovdqu          %%ymm9,  96(%[nz])        \n\t"
+        "vmovdqu          %%ymm9, 128(%[nz])        \n\t"
+        "vmovdqu          %%ymm9, 160(%[nz])        \n\t"
+        "vmovdqu          %%ymm9, 192(%[nz])        \n\t"
+        "vmovdqu          %%ymm9, 224(%[nz])        \n\t"
+        "1:                                         \n\t"
+        "xor                %[j], %[j]              \n\t"
+        /* 16 coefficients per iteration, in two halves of 8 */
+        "2:                                         \n\t"
+        "vpmovsxwd     (%[blk], %[j]), %%ymm0       \n\t"
+        "vpmovsxwd   16(%[blk], %[j]), %%ymm1       \n\t"
+        "vpmovsxwd    (%[qmat], %[j]), %%ymm2       \n\t"
+        "vpmovsxwd  16(%[qmat], %[j]), %%ymm3       \n\t"
+        "vcvtdq2ps        %%ymm0, %%ymm4            \n\t"
+        "vcvtdq2ps        %%ymm2, %%ymm5            \n\t"
+        "vdivps           %%ymm5, %%ymm4, %%ymm4    \n\t"
+        "vcvtdq2ps        %%ymm1, %%ymm5            \n\t"
+        "vcvtdq2ps        %%ymm3, %%ymm10           \n\t"
+        "vdivps          %%ymm10, %%ymm5, %%ymm5    \n\t"
+        "vcvttps2dq       %%ymm4, %%ymm4            \n\t"
+        "vcvttps2dq       %%ymm5, %%ymm5            \n\t"
+        /* quantization error */
+        "vpmulld          %%ymm4, %%ymm2, %%ymm2    \n\t"
+        "vpmulld          %%ymm5, %%ymm3, %%ymm3    \n\t"
+        "vpsubd           %%ymm2, %%ymm0, %%ymm0    \n\t"
+        "vpsubd           %%ymm3, %%ymm1, %%ymm1    \n\t"
+        "vpabsd           %%ymm0, %%ymm0            \n\t"
+        "vpabsd           %%ymm1, %%ymm1            \n\t"
+        "test               %[j], %[j]              \n\t"
+        "jnz                  3f                    \n\t"
+        "vpand            %%ymm7, %%ymm0, %%ymm0    \n\t"
+        "3:                                         \n\t"
+        "vpaddd           %%ymm0, %%ymm6, %%ymm6    \n\t"
+        "vpaddd           %%ymm1, %%ymm6, %%ymm6    \n\t"
+        /* nonzero masks, ymm8 holds the bit of the current block */
+        "vpcmpeqd         %%ymm9, %%ymm4, %%ymm0    \n\t"
+        "vpcmpeqd         %%ymm9, %%ymm5, %%ymm1    \n\t"
+        "vpandn           %%ymm8, %%ymm0, %%ymm0    \n\t"
+        "vpandn           %%ymm8, %%ymm1, %%ymm1    \n\t"
+        "vpor      (%[nz], %[j], 2), %%ymm0, %%ymm0 \n\t"
+        "vpor    32(%[nz], %[j], 2), %%ymm1, %%ymm1 \n\t"
+        "vmovdqu          %%ymm0,   (%[nz], %[j], 2)\n\t"
+        "vmovdqu          %%ymm1, 32(%[nz], %[j], 2)\n\t"
+        /* levels */
+        "vpackssdw        %%ymm5, %%ymm4, %%ymm4    \n\t"
+        "vpermq    $0xD8, %%ymm4, %%ymm4            \n\t"
+        "vmovdqu          %%ymm4, (%[lev], %[j])    \n\t"
+        "add                 $32, %[j]              \n\t"
+        "cmp                $128, %[j]              \n\t"
+        "jl                   2b                    \n\t"
+        "vpslld               $1, %%ymm8, %%ymm8    \n\t"
+        "add                $128, %[blk]            \n\t"
+        "add                $128, %[lev]            \n\t"
+        "sub                  $1, %[n]              \n\t"
+        "jg                   1b                    \n\t"
+
+        "vextracti128  $1, %%ymm6, %%xmm0           \n\t"
+        "vpaddd           %%xmm0, %%xmm6, %%xmm6    \n\t"
+        "vpshufd   $0x4E, %%xmm6, %%xmm0            \n\t"
+        "vpaddd           %%xmm0, %%xmm6, %%xmm6    \n\t"
+        "vpshufd   $0xB1, %%xmm6, %%xmm0            \n\t"
+        "vpaddd           %%xmm0, %%xmm6, %%xmm6    \n\t"
+        "vmovd            %%xmm6, %[err]            \n\t"
+        "vzeroupper                                 \n\t"
+        : [err]"=r"(err), [blk]"+r"(blocks), [lev]"+r"(levels),
+          [n]"+r"(n), [j]"=&r"(j)
+        : [nz]"r"(nz), [qmat]"r"(qmat), [mask]"m"(ac_mask)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",
+                       "%xmm5", "%xmm6", "%xmm7", "%xmm8", "%xmm9",
+                       "%xmm10",)
+          "memory"
+    );
+
+    return err;
+}
+
+#endif /* ARCH_X86_64 && HAVE_AVX2_INLINE */
+
+av_cold void ff_proresencdsp_init_x86(ProresEncDSPContext *c)
+{
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+    int cpu_flags = av_get_cpu_flags();
+
+    if (INLINE_AVX2(cpu_flags))
+        c->quantize = quantize_avx2;
+#endif
+}
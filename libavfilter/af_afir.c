@@ -52,63 +52,100 @@ static void fcmul_add_c(float *sum, const float *t, const float *c, ptrdiff_t le
     sum[2 * n] += t[2 * n] * c[2 * n];
 }
 
-static int fir_channel(AVFilterContext *ctx, void *arg, int ch, int nb_jobs)
+static int fir_quantum(AVFilterContext *ctx, AVFrame *out, int ch)
 {
     AudioFIRContext *s = ctx->priv;
-    const float *src = (const float *)s->in[0]->extended_data[ch];
-    int index1 = (s->index + 1) % 3;
-    int index2 = (s->index + 2) % 3;
-    float *sum = s->sum[ch];
-    AVFrame *out = arg;
-    float *block;
-    float *dst;
-    int n, i, j;
+    const float *in = (const float *)s->in[0]->extended_data[ch];
+    float *ptr = (float *)out->extended_data[ch];
+    float *block, *buf;
+    int n, i, j, segment;
 
-    memset(sum, 0, sizeof(*sum) * s->fft_length);
-    block = s->block[ch] + s->part_index * s->block_size;
-    memset(block, 0, sizeof(*block) * s->fft_length);
+    memset(ptr, 0, sizeof(*ptr) * s->nb_samples);
 
-    s->fdsp->vector_fmul_scalar(block + s->part_size, src, s->dry_gain, FFALIGN(s->nb_samples, 4));
-    emms_c();
+    for (segment = 0; segment < s->nb_segments; segment++) {
+        AudioFIRSegment *seg = &s->seg[segment];
+        float *src = (float *)seg->input->extended_data[ch];
+        float *dst = (float *)seg->output->extended_data[ch];
+        float *sum = (float *)seg->sum->extended_data[ch];
 
-    av_rdft_calc(s->rdft[ch], block);
-    block[2 * s->part_size] = block[1];
-    block[1] = 0;
+        s->fdsp->vector_fmul_scalar(src + seg->input_offset, in, s->dry_gain, s->min_part_size);
+        emms_c();
 
-    j = s->part_index;
+        /* longer partitions only run once every part_size / min_part_size
+         * quanta, in between their previous output is drained */
+        seg->output_offset[ch] += s->min_part_size;
+        if (seg->output_offset[ch] == seg->part_size) {
+            seg->output_offset[ch] = 0;
+        } else {
+            memmove(src, src + s->min_part_size, (seg->input_size - s->min_part_size) * sizeof(*src));
+
+            dst += seg->output_offset[ch];
+            for (n = 0; n < s->nb_samples; n++) {
+                ptr[n] += dst[n];
+            }
+            continue;
+        }
 
-    for (i = 0; i < s->nb_partitions; i++) {
-        const int coffset = i * s->coeff_size;
-        const FFTComplex *coeff = s->coeff[ch * !s->one2many] + coffset;
+        memset(sum, 0, sizeof(*sum) * seg->fft_length);
+        block = (float *)seg->block->extended_data[ch] + seg->part_index[ch] * seg->block_size;
+        memset(block + seg->part_size, 0, sizeof(*block) * (seg->fft_length - seg->part_size));
 
-        block = s->block[ch] + j * s->block_size;
-        s->fcmul_add(sum, block, (const float *)coeff, s->part_size);
+        memcpy(block, src, sizeof(*src) * seg->part_size);
 
-        if (j == 0)
-            j = s->nb_partitions;
-        j--;
-    }
+        av_rdft_calc(seg->rdft[ch], block);
+        block[2 * seg->part_size] = block[1];
+        block[1] = 0;
 
-    sum[1] = sum[2 * s->part_size];
-    av_rdft_calc(s->irdft[ch], sum);
+        j = seg->part_index[ch];
 
-    dst = (float *)s->buffer->extended_data[ch] + index1 * s->part_size;
-    for (n = 0; n < s->part_size; n++) {
-        dst[n] += sum[n];
-    }
+        for (i = 0; i < seg->nb_partitions; i++) {
+            const int coffset = i * seg->coeff_size;
+            const FFTComplex *coeff = (const FFTComplex *)seg->coeff->extended_data[ch * !s->one2many] + coffset;
 
-    dst = (float *)s->buffer->extended_data[ch] + index2 * s->part_size;
+            block = (float *)seg->block->extended_data[ch] + j * seg->block_size;
+            s->fcmul_add(sum, block, (const float *)coeff, seg->part_size);
 
-    memcpy(dst, sum + s->part_size, s->part_size * sizeof(*dst));
+            if (j == 0)
+                j = seg->nb_partitions;
+            j--;
+        }
 
-    dst = (float *)s->buffer->extended_data[ch] + s->index * s->part_size;
+        sum[1] = sum[2 * seg->part_size];
+        av_rdft_calc(seg->irdft[ch], sum);
 
-    if (out) {
-        float *ptr = (float *)out->extended_data[ch];
-        s->fdsp->vector_fmul_scalar(ptr, dst, s->gain * s->wet_gain, FFALIGN(out->nb_samples, 4));
-        emms_c();
+        buf = (float *)seg->buffer->extended_data[ch];
+        for (n = 0; n < seg->part_size; n++) {
+            buf[n] += sum[n];
+        }
+
+        memcpy(dst, buf, seg->part_size * sizeof(*dst));
+        memcpy(buf, sum + seg->part_size, seg->part_size * sizeof(*buf));
+
+        seg->part_index[ch] = (seg->part_index[ch] + 1) % seg->nb_partitions;
+
+        memmove(src, src + s->min_part_size, (seg->input_size - s->min_part_size) * sizeof(*src));
+
+        for (n = 0; n < s->nb_samples; n++) {
+            ptr[n] += dst[n];
+        }
     }
 
+    s->fdsp->vector_fmul_scalar(ptr, ptr, s->gain * s->wet_gain, FFALIGN(s->nb_samples, 4));
+    emms_c();
+
+    return 0;
+}
+
+static int fir_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AVFrame *out = arg;
+    const int start = (out->channels * jobnr) / nb_jobs;
+    const int end = (out->channels * (jobnr+1)) / nb_jobs;
+    int ch;
+
+    for (ch = start; ch < end; ch++)
+        fir_quantum(ctx, out, ch);
+
     return 0;
 }
 
@@ -116,147 +153,216 @@ static int fir_frame(AudioFIRContext *s, AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     AVFrame *out = NULL;
-    int ret;
 
-    s->nb_samples = FFMIN(s->part_size, av_audio_fifo_size(s->fifo[0]));
+    s->nb_samples = FFMIN(s->min_part_size, av_audio_fifo_size(s->fifo[0]));
 
-    if (!s->want_skip) {
-        out = ff_get_audio_buffer(outlink, s->nb_samples);
-        if (!out)
-            return AVERROR(ENOMEM);
-    }
+    out = ff_get_audio_buffer(outlink, s->nb_samples);
+    if (!out)
+        return AVERROR(ENOMEM);
 
-    s->in[0] = ff_get_audio_buffer(ctx->inputs[0], s->nb_samples);
+    s->in[0] = ff_get_audio_buffer(ctx->inputs[0], s->min_part_size);
     if (!s->in[0]) {
         av_frame_free(&out);
         return AVERROR(ENOMEM);
     }
 
     av_audio_fifo_peek(s->fifo[0], (void **)s->in[0]->extended_data, s->nb_samples);
+    if (s->nb_samples < s->min_part_size)
+        av_samples_set_silence(s->in[0]->extended_data, s->nb_samples,
+                               s->min_part_size - s->nb_samples,
+                               outlink->channels, outlink->format);
 
-    ctx->internal->execute(ctx, fir_channel, out, NULL, outlink->channels);
-
-    s->part_index = (s->part_index + 1) % s->nb_partitions;
+    ctx->internal->execute(ctx, fir_channels, out, NULL,
+                           FFMIN(outlink->channels, ff_filter_get_nb_threads(ctx)));
 
     av_audio_fifo_drain(s->fifo[0], s->nb_samples);
 
-    if (!s->want_skip) {
-        out->pts = s->pts;
-        if (s->pts != AV_NOPTS_VALUE)
-            s->pts += av_rescale_q(out->nb_samples, (AVRational){1, outlink->sample_rate}, outlink->time_base);
+    out->pts = s->pts;
+    if (s->pts != AV_NOPTS_VALUE)
+        s->pts += av_rescale_q(out->nb_samples, (AVRational){1, outlink->sample_rate}, outlink->time_base);
+
+    av_frame_free(&s->in[0]);
+
+    return ff_filter_frame(outlink, out);
+}
+
+static AVFrame *get_zeroed_buffer(AVFilterLink *link, int nb_samples)
+{
+    AVFrame *frame = ff_get_audio_buffer(link, nb_samples);
+
+    if (frame)
+        av_samples_set_silence(frame->extended_data, 0, nb_samples,
+                               frame->channels, frame->format);
+    return frame;
+}
+
+static int init_segment(AVFilterContext *ctx, AudioFIRSegment *seg,
+                        int offset, int nb_partitions, int part_size)
+{
+    AudioFIRContext *s = ctx->priv;
+    int ch;
+
+    seg->fft_length    = part_size * 2 + 1;
+    seg->part_size     = part_size;
+    seg->block_size    = FFALIGN(seg->fft_length, 32);
+    seg->coeff_size    = FFALIGN(seg->part_size + 1, 32);
+    seg->nb_partitions = nb_partitions;
+    seg->input_size    = offset + s->min_part_size;
+    seg->input_offset  = offset;
+
+    seg->rdft          = av_calloc(s->nb_channels, sizeof(*seg->rdft));
+    seg->irdft         = av_calloc(s->nb_channels, sizeof(*seg->irdft));
+    seg->part_index    = av_calloc(s->nb_channels, sizeof(*seg->part_index));
+    seg->output_offset = av_calloc(s->nb_channels, sizeof(*seg->output_offset));
+    if (!seg->rdft || !seg->irdft || !seg->part_index || !seg->output_offset)
+        return AVERROR(ENOMEM);
+
+    for (ch = 0; ch < s->nb_channels; ch++) {
+        seg->rdft[ch]  = av_rdft_init(av_log2(2 * part_size), DFT_R2C);
+        seg->irdft[ch] = av_rdft_init(av_log2(2 * part_size), IDFT_C2R);
+        if (!seg->rdft[ch] || !seg->irdft[ch])
+            return AVERROR(ENOMEM);
     }
 
-    s->index++;
-    if (s->index == 3)
-        s->index = 0;
+    /* the fcmul_add SIMD may touch a few values past 2 * part_size */
+    seg->sum    = get_zeroed_buffer(ctx->inputs[0], seg->block_size);
+    seg->block  = get_zeroed_buffer(ctx->inputs[0], seg->nb_partitions * seg->block_size);
+    seg->buffer = get_zeroed_buffer(ctx->inputs[0], seg->part_size);
+    seg->coeff  = get_zeroed_buffer(ctx->inputs[1], seg->nb_partitions * seg->coeff_size * 2);
+    seg->input  = get_zeroed_buffer(ctx->inputs[0], seg->input_size);
+    seg->output = get_zeroed_buffer(ctx->inputs[0], seg->part_size);
+    if (!seg->buffer || !seg->sum || !seg->block || !seg->coeff || !seg->input || !seg->output)
+        return AVERROR(ENOMEM);
 
-    av_frame_free(&s->in[0]);
+    return 0;
+}
 
-    if (s->want_skip == 1) {
-        s->want_skip = 0;
-        ret = 0;
-    } else {
-        ret = ff_filter_frame(outlink, out);
+static void uninit_segment(AVFilterContext *ctx, AudioFIRSegment *seg)
+{
+    AudioFIRContext *s = ctx->priv;
+    int ch;
+
+    if (seg->rdft) {
+        for (ch = 0; ch < s->nb_channels; ch++) {
+            av_rdft_end(seg->rdft[ch]);
+        }
     }
+    av_freep(&seg->rdft);
 
-    return ret;
+    if (seg->irdft) {
+        for (ch = 0; ch < s->nb_channels; ch++) {
+            av_rdft_end(seg->irdft[ch]);
+        }
+    }
+    av_freep(&seg->irdft);
+
+    av_freep(&seg->output_offset);
+    av_freep(&seg->part_index);
+
+    av_frame_free(&seg->block);
+    av_frame_free(&seg->sum);
+    av_frame_free(&seg->buffer);
+    av_frame_free(&seg->coeff);
+    av_frame_free(&seg->input);
+    av_frame_free(&seg->output);
 }
 
 static int convert_coeffs(AVFilterContext *ctx)
 {
     AudioFIRContext *s = ctx->priv;
-    int i, ch, n, N;
+    int left, offset = 0, part_size, max_part_size;
+    int i, ch, n, ret, segment;
     float power = 0;
 
     s->nb_taps = av_audio_fifo_size(s->fifo[1]);
     if (s->nb_taps <= 0)
         return AVERROR(EINVAL);
 
-    for (n = 4; (1 << n) < s->nb_taps; n++);
-    N = FFMIN(n, 16);
-    s->ir_length = 1 << n;
-    s->fft_length = (1 << (N + 1)) + 1;
-    s->part_size = 1 << (N - 1);
-    s->block_size = FFALIGN(s->fft_length, 32);
-    s->coeff_size = FFALIGN(s->part_size + 1, 32);
-    s->nb_partitions = (s->nb_taps + s->part_size - 1) / s->part_size;
-    s->nb_coeffs = s->ir_length + s->nb_partitions;
-
-    for (ch = 0; ch < ctx->inputs[0]->channels; ch++) {
-        s->sum[ch] = av_calloc(s->fft_length, sizeof(**s->sum));
-        if (!s->sum[ch])
-            return AVERROR(ENOMEM);
-    }
+    if (s->minp > s->maxp)
+        s->maxp = s->minp;
 
-    for (ch = 0; ch < ctx->inputs[1]->channels; ch++) {
-        s->coeff[ch] = av_calloc(s->nb_partitions * s->coeff_size, sizeof(**s->coeff));
-        if (!s->coeff[ch])
-            return AVERROR(ENOMEM);
-    }
+    /* Start with short partitions for the head of the response and double
+     * their size up to maxp. Every segment begins where the input delay
+     * covers the time needed to collect one of its partitions, so all
+     * segments contribute to the current output quantum. */
+    left = s->nb_taps;
+    part_size = 1 << av_log2(s->minp);
+    max_part_size = 1 << av_log2(s->maxp);
 
-    for (ch = 0; ch < ctx->inputs[0]->channels; ch++) {
-        s->block[ch] = av_calloc(s->nb_partitions * s->block_size, sizeof(**s->block));
-        if (!s->block[ch])
-            return AVERROR(ENOMEM);
-    }
+    s->min_part_size = part_size;
 
-    for (ch = 0; ch < ctx->inputs[0]->channels; ch++) {
-        s->rdft[ch]  = av_rdft_init(N, DFT_R2C);
-        s->irdft[ch] = av_rdft_init(N, IDFT_C2R);
-        if (!s->rdft[ch] || !s->irdft[ch])
-            return AVERROR(ENOMEM);
+    for (i = 0; left > 0; i++) {
+        int step = part_size == max_part_size ? INT_MAX : 1 + (i == 0);
+        int nb_partitions = FFMIN(step, (left + part_size - 1) / part_size);
+
+        s->nb_segments = i + 1;
+        ret = init_segment(ctx, &s->seg[i], offset, nb_partitions, part_size);
+        if (ret < 0)
+            return ret;
+        offset += nb_partitions * part_size;
+        left -= nb_partitions * part_size;
+        part_size *= 2;
+        part_size = FFMIN(part_size, max_part_size);
     }
 
     s->in[1] = ff_get_audio_buffer(ctx->inputs[1], s->nb_taps);
     if (!s->in[1])
         return AVERROR(ENOMEM);
 
-    s->buffer = ff_get_audio_buffer(ctx->inputs[0], s->part_size * 3);
-    if (!s->buffer)
-        return AVERROR(ENOMEM);
-
     av_audio_fifo_read(s->fifo[1], (void **)s->in[1]->extended_data, s->nb_taps);
 
     for (ch = 0; ch < ctx->inputs[1]->channels; ch++) {
         float *time = (float *)s->in[1]->extended_data[!s->one2many * ch];
-        float *block = s->block[ch];
-        FFTComplex *coeff = s->coeff[ch];
+        int toffset = 0;
 
         power += s->fdsp->scalarproduct_float(time, time, s->nb_taps);
 
         for (i = FFMAX(1, s->length * s->nb_taps); i < s->nb_taps; i++)
             time[i] = 0;
 
-        for (i = 0; i < s->nb_partitions; i++) {
-            const float scale = 1.f / s->part_size;
-            const int toffset = i * s->part_size;
-            const int coffset = i * s->coeff_size;
-            const int boffset = s->part_size;
-            const int remaining = s->nb_taps - (i * s->part_size);
-            const int size = remaining >= s->part_size ? s->part_size : remaining;
+        for (segment = 0; segment < s->nb_segments; segment++) {
+            AudioFIRSegment *seg = &s->seg[segment];
+            float *block = (float *)seg->block->extended_data[ch];
+            FFTComplex *coeff = (FFTComplex *)seg->coeff->extended_data[ch];
 
-            memset(block, 0, sizeof(*block) * s->fft_length);
-            memcpy(block + boffset, time + toffset, size * sizeof(*block));
+            for (i = 0; i < seg->nb_partitions; i++) {
+                const float scale = 1.f / seg->part_size;
+                const int coffset = i * seg->coeff_size;
+                const int remaining = s->nb_taps - toffset;
+                const int size = remaining >= seg->part_size ? seg->part_size : remaining;
 
-            av_rdft_calc(s->rdft[0], block);
+                memset(block, 0, sizeof(*block) * seg->fft_length);
+                memcpy(block, time + toffset, size * sizeof(*block));
 
-            coeff[coffset].re = block[0] * scale;
-            coeff[coffset].im = 0;
-            for (n = 1; n < s->part_size; n++) {
-                coeff[coffset + n].re = block[2 * n] * scale;
-                coeff[coffset + n].im = block[2 * n + 1] * scale;
+                av_rdft_calc(seg->rdft[0], block);
+
+                coeff[coffset].re = block[0] * scale;
+                coeff[coffset].im = 0;
+                for (n = 1; n < seg->part_size; n++) {
+                    coeff[coffset + n].re = block[2 * n] * scale;
+                    coeff[coffset + n].im = block[2 * n + 1] * scale;
+                }
+                coeff[coffset + seg->part_size].re = block[1] * scale;
+                coeff[coffset + seg->part_size].im = 0;
+
+                toffset += size;
             }
-            coeff[coffset + s->part_size].re = block[1] * scale;
-            coeff[coffset + s->part_size].im = 0;
+
+            memset(block, 0, sizeof(*block) * seg->fft_length);
         }
     }
 
     av_frame_free(&s->in[1]);
     s->gain = s->again ? 1.f / sqrtf(power / ctx->inputs[1]->channels) : 1.f;
     av_log(ctx, AV_LOG_DEBUG, "nb_taps: %d\n", s->nb_taps);
-    av_log(ctx, AV_LOG_DEBUG, "nb_partitions: %d\n", s->nb_partitions);
-    av_log(ctx, AV_LOG_DEBUG, "partition size: %d\n", s->part_size);
-    av_log(ctx, AV_LOG_DEBUG, "ir_length: %d\n", s->ir_length);
+    av_log(ctx, AV_LOG_DEBUG, "nb_segments: %d\n", s->nb_segments);
+
+    for (segment = 0; segment < s->nb_segments; segment++) {
+        av_log(ctx, AV_LOG_DEBUG, "segment: %d\n", segment);
+        av_log(ctx, AV_LOG_DEBUG, " nb_partitions: %d\n", s->seg[segment].nb_partitions);
+        av_log(ctx, AV_LOG_DEBUG, " partition size: %d\n", s->seg[segment].part_size);
+        av_log(ctx, AV_LOG_DEBUG, " input offset: %d\n", s->seg[segment].input_offset);
+    }
 
     s->have_coeffs = 1;
 
@@ -304,7 +410,7 @@ static int filter_frame(AVFilterLink *link, AVFrame *frame)
     }
 
     if (s->have_coeffs) {
-        while (av_audio_fifo_size(s->fifo[0]) >= s->part_size) {
+        while (av_audio_fifo_size(s->fifo[0]) >= s->min_part_size) {
             ret = fir_frame(s, outlink);
             if (ret < 0)
                 break;
@@ -329,17 +435,6 @@ static int request_frame(AVFilterLink *outlink)
     }
     ret = ff_request_frame(ctx->inputs[0]);
     if (ret == AVERROR_EOF && s->have_coeffs) {
-        if (s->need_padding) {
-            AVFrame *silence = ff_get_audio_buffer(outlink, s->part_size);
-
-            if (!silence)
-                return AVERROR(ENOMEM);
-            av_audio_fifo_write(s->fifo[0], (void **)silence->extended_data,
-                        silence->nb_samples);
-            av_frame_free(&silence);
-            s->need_padding = 0;
-        }
-
         while (av_audio_fifo_size(s->fifo[0]) > 0) {
             ret = fir_frame(s, outlink);
             if (ret < 0)
@@ -402,18 +497,8 @@ static int config_output(AVFilterLink *outlink)
     if (!s->fifo[0] || !s->fifo[1])
         return AVERROR(ENOMEM);
 
-    s->sum = av_calloc(outlink->channels, sizeof(*s->sum));
-    s->coeff = av_calloc(ctx->inputs[1]->channels, sizeof(*s->coeff));
-    s->block = av_calloc(ctx->inputs[0]->channels, sizeof(*s->block));
-    s->rdft = av_calloc(outlink->channels, sizeof(*s->rdft));
-    s->irdft = av_calloc(outlink->channels, sizeof(*s->irdft));
-    if (!s->sum || !s->coeff || !s->block || !s->rdft || !s->irdft)
-        return AVERROR(ENOMEM);
-
     s->nb_channels = outlink->channels;
     s->nb_coef_channels = ctx->inputs[1]->channels;
-    s->want_skip = 1;
-    s->need_padding = 1;
     s->pts = AV_NOPTS_VALUE;
 
     return 0;
@@ -422,46 +507,13 @@ static int config_output(AVFilterLink *outlink)
 static av_cold void uninit(AVFilterContext *ctx)
 {
     AudioFIRContext *s = ctx->priv;
-    int ch;
+    int i;
 
-    if (s->sum) {
-        for (ch = 0; ch < s->nb_channels; ch++) {
-            av_freep(&s->sum[ch]);
-        }
-    }
-    av_freep(&s->sum);
-
-    if (s->coeff) {
-        for (ch = 0; ch < s->nb_coef_channels; ch++) {
-            av_freep(&s->coeff[ch]);
-        }
-    }
-    av_freep(&s->coeff);
-
-    if (s->block) {
-        for (ch = 0; ch < s->nb_channels; ch++) {
-            av_freep(&s->block[ch]);
-        }
-    }
-    av_freep(&s->block);
-
-    if (s->rdft) {
-        for (ch = 0; ch < s->nb_channels; ch++) {
-            av_rdft_end(s->rdft[ch]);
-        }
-    }
-    av_freep(&s->rdft);
-
-    if (s->irdft) {
-        for (ch = 0; ch < s->nb_channels; ch++) {
-            av_rdft_end(s->irdft[ch]);
-        }
-    }
-    av_freep(&s->irdft);
+    for (i = 0; i < s->nb_segments; i++)
+        uninit_segment(ctx, &s->seg[i]);
 
     av_frame_free(&s->in[0]);
     av_frame_free(&s->in[1]);
-    av_frame_free(&s->buffer);
 
     av_audio_fifo_free(s->fifo[0]);
     av_audio_fifo_free(s->fifo[1]);
@@ -516,6 +568,8 @@ static const AVOption afir_options[] = {
     { "wet",    "set wet gain",     OFFSET(wet_gain), AV_OPT_TYPE_FLOAT, {.dbl=1}, 0, 1, AF },
     { "length", "set IR length",    OFFSET(length),   AV_OPT_TYPE_FLOAT, {.dbl=1}, 0, 1, AF },
     { "again",  "enable auto gain", OFFSET(again),    AV_OPT_TYPE_BOOL,  {.i64=1}, 0, 1, AF },
+    { "minp",   "set min partition size", OFFSET(minp), AV_OPT_TYPE_INT, {.i64=512},  8, 32768, AF },
+    { "maxp",   "set max partition size", OFFSET(maxp), AV_OPT_TYPE_INT, {.i64=8192}, 8, 32768, AF },
     { NULL }
 };
 
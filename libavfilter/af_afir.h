@@ -33,6 +33,33 @@
 #include "internal.h"
 
 #define MAX_IR_DURATION 30
+#define MAX_SEGMENTS 16
+
+/**
+ * A run of equally sized partitions of the impulse response, convolved
+ * with the input delayed by input_offset samples.
+ */
+typedef struct AudioFIRSegment {
+    int nb_partitions;
+    int part_size;
+    int block_size;
+    int fft_length;
+    int coeff_size;
+    int input_size;
+    int input_offset;
+
+    int *output_offset;
+    int *part_index;
+
+    AVFrame *sum;
+    AVFrame *block;
+    AVFrame *buffer;
+    AVFrame *coeff;
+    AVFrame *input;
+    AVFrame *output;
+
+    RDFTContext **rdft, **irdft;
+} AudioFIRSegment;
 
 typedef struct AudioFIRContext {
     const AVClass *class;
@@ -41,37 +68,26 @@ typedef struct AudioFIRContext {
     float dry_gain;
     float length;
     int again;
+    int minp;
+    int maxp;
 
     float gain;
 
     int eof_coeffs;
     int have_coeffs;
-    int nb_coeffs;
     int nb_taps;
-    int part_size;
-    int part_index;
-    int coeff_size;
-    int block_size;
-    int nb_partitions;
     int nb_channels;
-    int ir_length;
-    int fft_length;
     int nb_coef_channels;
     int one2many;
     int nb_samples;
-    int want_skip;
-    int need_padding;
 
-    RDFTContext **rdft, **irdft;
-    float **sum;
-    float **block;
-    FFTComplex **coeff;
+    AudioFIRSegment seg[MAX_SEGMENTS];
+    int nb_segments;
+    int min_part_size;
 
     AVAudioFifo *fifo[2];
     AVFrame *in[2];
-    AVFrame *buffer;
     int64_t pts;
-    int index;
 
     AVFloatDSPContext *fdsp;
     void (*fcmul_add)(float *sum, const float *t, const float *c,
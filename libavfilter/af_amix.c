@@ -34,11 +34,11 @@
 #include "libavutil/avstring.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/common.h"
-#include "libavutil/float_dsp.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/samplefmt.h"
 
+#include "af_amix.h"
 #include "audio.h"
 #include "avfilter.h"
 #include "formats.h"
@@ -154,7 +154,7 @@ static int frame_list_add_frame(FrameList *frame_list, int nb_samples, int64_t p
 
 typedef struct MixContext {
     const AVClass *class;       /**< class for AVOptions */
-    AVFloatDSPContext *fdsp;
+    AMixDSPContext dsp;
 
     int nb_inputs;              /**< number of inputs */
     int active_inputs;          /**< number of input currently active */
@@ -164,7 +164,16 @@ typedef struct MixContext {
     int nb_channels;            /**< number of channels */
     int sample_rate;            /**< sample rate */
     int planar;
+    int sample_size;            /**< size in bytes of one sample of all channels in a plane */
     AVAudioFifo **fifos;        /**< audio fifo for each input */
+    AVFrame **pending;          /**< frame mixed in place for each input with an empty fifo */
+    int *pending_offset;        /**< number of samples already mixed from each pending frame */
+    uint8_t **pending_data;     /**< plane pointers into a pending frame */
+    const uint8_t **mix_src;    /**< source planes of all mixed inputs, per plane */
+    float *mix_scale;           /**< scales of all mixed inputs */
+    double *mix_scale_dbl;      /**< scales of all mixed inputs, for double samples */
+    uint8_t *fifo_buf;          /**< samples read from the fifos for mixing */
+    unsigned int fifo_buf_size;
     uint8_t *input_state;       /**< current state of each input */
     float *input_scale;         /**< mixing scale factor for each input */
     float scale_norm;           /**< normalization factor for all inputs */
@@ -241,6 +250,18 @@ static int config_output(AVFilterLink *outlink)
         if (!s->fifos[i])
             return AVERROR(ENOMEM);
     }
+    s->sample_size = av_get_bytes_per_sample(outlink->format) *
+                     (s->planar ? 1 : s->nb_channels);
+
+    s->pending        = av_mallocz_array(s->nb_inputs, sizeof(*s->pending));
+    s->pending_offset = av_mallocz_array(s->nb_inputs, sizeof(*s->pending_offset));
+    s->pending_data   = av_mallocz_array(s->nb_channels, sizeof(*s->pending_data));
+    s->mix_src        = av_mallocz_array(s->nb_inputs * s->nb_channels, sizeof(*s->mix_src));
+    s->mix_scale      = av_mallocz_array(s->nb_inputs, sizeof(*s->mix_scale));
+    s->mix_scale_dbl  = av_mallocz_array(s->nb_inputs, sizeof(*s->mix_scale_dbl));
+    if (!s->pending || !s->pending_offset || !s->pending_data ||
+        !s->mix_src || !s->mix_scale || !s->mix_scale_dbl)
+        return AVERROR(ENOMEM);
 
     s->input_state = av_malloc(s->nb_inputs);
     if (!s->input_state)
@@ -265,6 +286,76 @@ static int config_output(AVFilterLink *outlink)
 
 static int calc_active_inputs(MixContext *s);
 
+/**
+ * Get the number of samples queued for an input, in its fifo or pending frame.
+ */
+static int input_size(MixContext *s, int i)
+{
+    int size = av_audio_fifo_size(s->fifos[i]);
+
+    if (s->pending[i])
+        size += s->pending[i]->nb_samples - s->pending_offset[i];
+    return size;
+}
+
+/**
+ * Point pending_data to the first unmixed sample of the pending frame of an input.
+ */
+static void get_pending_data(MixContext *s, int i)
+{
+    int planes = s->planar ? s->nb_channels : 1;
+    int p;
+
+    for (p = 0; p < planes; p++)
+        s->pending_data[p] = s->pending[i]->extended_data[p] +
+                             s->pending_offset[i] * s->sample_size;
+}
+
+/**
+ * Move the unmixed samples of the pending frame of an input to its fifo.
+ */
+static int flush_pending(MixContext *s, int i)
+{
+    int ret;
+
+    if (!s->pending[i])
+        return 0;
+
+    get_pending_data(s, i);
+    ret = av_audio_fifo_write(s->fifos[i], (void **)s->pending_data,
+                              s->pending[i]->nb_samples - s->pending_offset[i]);
+    av_frame_free(&s->pending[i]);
+    s->pending_offset[i] = 0;
+
+    return ret < 0 ? ret : 0;
+}
+
+#define MIX_FUNC(name, type, scale_type)                                      \
+static void mix_##name##_c(type *dst, const type **src, const scale_type *scale, \
+                           int nb_src, int len)                               \
+{                                                                             \
+    int i, n;                                                                 \
+                                                                              \
+    for (n = 0; n < len; n++) {                                               \
+        type sum = dst[n];                                                    \
+        for (i = 0; i < nb_src; i++)                                          \
+            sum += src[i][n] * scale[i];                                      \
+        dst[n] = sum;                                                         \
+    }                                                                         \
+}
+
+MIX_FUNC(flt, float,  float)
+MIX_FUNC(dbl, double, double)
+
+av_cold void ff_amix_init(AMixDSPContext *dsp)
+{
+    dsp->mix_flt = mix_flt_c;
+    dsp->mix_dbl = mix_dbl_c;
+
+    if (ARCH_X86)
+        ff_amix_init_x86(dsp);
+}
+
 /**
  * Read samples from the input FIFOs, mix, and write to the output link.
  */
@@ -272,8 +363,10 @@ static int output_frame(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     MixContext      *s = ctx->priv;
-    AVFrame *out_buf, *in_buf;
-    int nb_samples, ns, ret, i;
+    AVFrame *out_buf;
+    uint8_t *fifo_buf;
+    int nb_samples, ns, ret, i, p;
+    int planes, plane_size, stride, nb_mix = 0, nb_fifo_inputs = 0;
 
     ret = calc_active_inputs(s);
     if (ret < 0)
@@ -284,7 +377,7 @@ static int output_frame(AVFilterLink *outlink)
         nb_samples = frame_list_next_frame_size(s->frame_list);
         for (i = 1; i < s->nb_inputs; i++) {
             if (s->input_state[i] & INPUT_ON) {
-                ns = av_audio_fifo_size(s->fifos[i]);
+                ns = input_size(s, i);
                 if (ns < nb_samples) {
                     if (!(s->input_state[i] & INPUT_EOF))
                         /* unclosed input with not enough samples */
@@ -299,7 +392,7 @@ static int output_frame(AVFilterLink *outlink)
         nb_samples = INT_MAX;
         for (i = 1; i < s->nb_inputs; i++) {
             if (s->input_state[i] & INPUT_ON) {
-                ns = av_audio_fifo_size(s->fifos[i]);
+                ns = input_size(s, i);
                 nb_samples = FFMIN(nb_samples, ns);
             }
         }
@@ -319,40 +412,66 @@ static int output_frame(AVFilterLink *outlink)
     if (!out_buf)
         return AVERROR(ENOMEM);
 
-    in_buf = ff_get_audio_buffer(outlink, nb_samples);
-    if (!in_buf) {
-        av_frame_free(&out_buf);
-        return AVERROR(ENOMEM);
+    planes     = s->planar ? s->nb_channels : 1;
+    plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
+    stride     = FFALIGN(nb_samples * s->sample_size, 64);
+
+    for (i = 0; i < s->nb_inputs; i++)
+        nb_fifo_inputs += (s->input_state[i] & INPUT_ON) && !s->pending[i];
+    if (nb_fifo_inputs) {
+        av_fast_malloc(&s->fifo_buf, &s->fifo_buf_size,
+                       (size_t)nb_fifo_inputs * planes * stride);
+        if (!s->fifo_buf) {
+            av_frame_free(&out_buf);
+            return AVERROR(ENOMEM);
+        }
     }
+    fifo_buf = s->fifo_buf;
 
+    /* Gather the source planes of all inputs first, so that all of them
+     * are accumulated in a single pass over the output.
+     * Inputs delivering frames in lock-step are mixed straight from their
+     * pending frame, the others are read from their fifo. */
     for (i = 0; i < s->nb_inputs; i++) {
         if (s->input_state[i] & INPUT_ON) {
-            int planes, plane_size, p;
-
-            av_audio_fifo_read(s->fifos[i], (void **)in_buf->extended_data,
-                               nb_samples);
-
-            planes     = s->planar ? s->nb_channels : 1;
-            plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
-            plane_size = FFALIGN(plane_size, 16);
-
-            if (out_buf->format == AV_SAMPLE_FMT_FLT ||
-                out_buf->format == AV_SAMPLE_FMT_FLTP) {
-                for (p = 0; p < planes; p++) {
-                    s->fdsp->vector_fmac_scalar((float *)out_buf->extended_data[p],
-                                                (float *) in_buf->extended_data[p],
-                                                s->input_scale[i], plane_size);
-                }
+            if (s->pending[i]) {
+                /* the fifo is empty while a frame is pending */
+                av_assert1(s->pending[i]->nb_samples - s->pending_offset[i] >= nb_samples);
+                get_pending_data(s, i);
+                for (p = 0; p < planes; p++)
+                    s->mix_src[p * s->nb_inputs + nb_mix] = s->pending_data[p];
+                s->pending_offset[i] += nb_samples;
             } else {
                 for (p = 0; p < planes; p++) {
-                    s->fdsp->vector_dmac_scalar((double *)out_buf->extended_data[p],
-                                                (double *) in_buf->extended_data[p],
-                                                s->input_scale[i], plane_size);
+                    s->pending_data[p] = fifo_buf;
+                    s->mix_src[p * s->nb_inputs + nb_mix] = fifo_buf;
+                    fifo_buf += stride;
                 }
+                av_audio_fifo_read(s->fifos[i], (void **)s->pending_data, nb_samples);
             }
+            s->mix_scale[nb_mix]     = s->input_scale[i];
+            s->mix_scale_dbl[nb_mix] = s->input_scale[i];
+            nb_mix++;
         }
     }
-    av_frame_free(&in_buf);
+
+    for (p = 0; p < planes; p++) {
+        const uint8_t **src = s->mix_src + p * s->nb_inputs;
+
+        if (out_buf->format == AV_SAMPLE_FMT_FLT ||
+            out_buf->format == AV_SAMPLE_FMT_FLTP)
+            s->dsp.mix_flt((float *)out_buf->extended_data[p], (const float **)src,
+                           s->mix_scale, nb_mix, plane_size);
+        else
+            s->dsp.mix_dbl((double *)out_buf->extended_data[p], (const double **)src,
+                           s->mix_scale_dbl, nb_mix, plane_size);
+    }
+
+    for (i = 0; i < s->nb_inputs; i++)
+        if (s->pending[i] && s->pending_offset[i] == s->pending[i]->nb_samples) {
+            av_frame_free(&s->pending[i]);
+            s->pending_offset[i] = 0;
+        }
 
     out_buf->pts = s->next_pts;
     if (s->next_pts != AV_NOPTS_VALUE)
@@ -375,12 +494,12 @@ static int request_samples(AVFilterContext *ctx, int min_samples)
         ret = 0;
         if (!(s->input_state[i] & INPUT_ON))
             continue;
-        if (av_audio_fifo_size(s->fifos[i]) >= min_samples)
+        if (input_size(s, i) >= min_samples)
             continue;
         ret = ff_request_frame(ctx->inputs[i]);
         if (ret == AVERROR_EOF) {
             s->input_state[i] |= INPUT_EOF;
-            if (av_audio_fifo_size(s->fifos[i]) == 0) {
+            if (input_size(s, i) == 0) {
                 s->input_state[i] = 0;
                 continue;
             }
@@ -466,8 +585,21 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
             goto fail;
     }
 
+    if (!s->pending[i] && !av_audio_fifo_size(s->fifos[i])) {
+        /* keep the frame to mix from it directly if the other inputs
+         * deliver frames of the same size */
+        s->pending[i] = buf;
+        s->pending_offset[i] = 0;
+        return output_frame(outlink);
+    }
+
+    ret = flush_pending(s, i);
+    if (ret < 0)
+        goto fail;
     ret = av_audio_fifo_write(s->fifos[i], (void **)buf->extended_data,
                               buf->nb_samples);
+    if (ret < 0)
+        goto fail;
 
     av_frame_free(&buf);
     return output_frame(outlink);
@@ -497,9 +629,7 @@ static av_cold int init(AVFilterContext *ctx)
         ff_insert_inpad(ctx, i, &pad);
     }
 
-    s->fdsp = avpriv_float_dsp_alloc(0);
-    if (!s->fdsp)
-        return AVERROR(ENOMEM);
+    ff_amix_init(&s->dsp);
 
     return 0;
 }
@@ -514,11 +644,21 @@ static av_cold void uninit(AVFilterContext *ctx)
             av_audio_fifo_free(s->fifos[i]);
         av_freep(&s->fifos);
     }
+    if (s->pending) {
+        for (i = 0; i < s->nb_inputs; i++)
+            av_frame_free(&s->pending[i]);
+        av_freep(&s->pending);
+    }
+    av_freep(&s->pending_offset);
+    av_freep(&s->pending_data);
+    av_freep(&s->mix_src);
+    av_freep(&s->mix_scale);
+    av_freep(&s->mix_scale_dbl);
+    av_freep(&s->fifo_buf);
     frame_list_clear(s->frame_list);
     av_freep(&s->frame_list);
     av_freep(&s->input_state);
     av_freep(&s->input_scale);
-    av_freep(&s->fdsp);
 
     for (i = 0; i < ctx->nb_inputs; i++)
         av_freep(&ctx->input_pads[i].name);
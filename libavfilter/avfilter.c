@@ -33,6 +33,8 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/thread.h"
+#include "libavutil/trace.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -558,16 +560,94 @@ int avfilter_process_command(AVFilterContext *filter, const char *cmd, const cha
 static AVFilter *first_filter;
 static AVFilter **last_filter = &first_filter;
 
+/* Registered filters sorted by name, for avfilter_get_by_name().
+ * The array is replaced when filters are registered and freed by
+ * avfilter_uninit(); without that call it stays reachable until exit. */
+typedef struct FilterName {
+    const char *name;
+    AVFilter *filter;
+    int idx;                    ///< position in the registered filter list
+} FilterName;
+
+static AVOnce filter_index_once = AV_ONCE_INIT;
+static AVMutex filter_index_lock;
+static FilterName *filter_index;
+static int filter_index_size;
+static AVFilter **filter_index_last; ///< last_filter when the index was built
+
+static void filter_index_init(void)
+{
+    ff_mutex_init(&filter_index_lock, NULL);
+}
+
+static int filter_name_cmp(const void *a, const void *b)
+{
+    const FilterName *fa = a, *fb = b;
+    int ret = strcmp(fa->name, fb->name);
+    return ret ? ret : fa->idx - fb->idx;
+}
+
+static int filter_name_find_cmp(const void *name, const void *b)
+{
+    return strcmp(name, ((const FilterName *)b)->name);
+}
+
+/* Rebuild the index if filters were registered since; call with
+ * filter_index_lock held. */
+static void filter_index_update(void)
+{
+    AVFilter **last = last_filter;
+    AVFilter *f;
+    int n = 0;
+
+    if (filter_index_last == last)
+        return;
+
+    for (f = first_filter; f; f = f->next)
+        n++;
+    av_freep(&filter_index);
+    filter_index_size = 0;
+    filter_index = av_malloc_array(n, sizeof(*filter_index));
+    if (!filter_index)
+        return;
+
+    for (f = first_filter; f && filter_index_size < n; f = f->next) {
+        FilterName *e = &filter_index[filter_index_size];
+        e->name   = f->name;
+        e->filter = f;
+        e->idx    = filter_index_size++;
+    }
+    qsort(filter_index, filter_index_size, sizeof(*filter_index), filter_name_cmp);
+    filter_index_last = last;
+}
+
 #if !FF_API_NOCONST_GET_NAME
 const
 #endif
 AVFilter *avfilter_get_by_name(const char *name)
 {
     const AVFilter *f = NULL;
+    FilterName *e = NULL;
 
     if (!name)
         return NULL;
 
+    ff_thread_once(&filter_index_once, filter_index_init);
+    ff_mutex_lock(&filter_index_lock);
+    filter_index_update();
+    if (filter_index)
+        e = bsearch(name, filter_index, filter_index_size, sizeof(*filter_index),
+                    filter_name_find_cmp);
+    if (e) {
+        while (e > filter_index && !strcmp(e[-1].name, name))
+            e--;
+        f = e->filter;
+    }
+    ff_mutex_unlock(&filter_index_lock);
+    if (f)
+        return (AVFilter *)f;
+
+    /* the index may miss filters registered concurrently */
     while ((f = avfilter_next(f)))
         if (!strcmp(f->name, name))
             return (AVFilter *)f;
@@ -604,6 +684,12 @@ AVFilter **av_filter_next(AVFilter **filter)
 
 void avfilter_uninit(void)
 {
+    ff_thread_once(&filter_index_once, filter_index_init);
+    ff_mutex_lock(&filter_index_lock);
+    av_freep(&filter_index);
+    filter_index_size = 0;
+    filter_index_last = NULL;
+    ff_mutex_unlock(&filter_index_lock);
 }
 #endif
 
@@ -947,12 +1033,14 @@ int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
         }
     }
 
+    av_mem_tag_push(ctx);
     if (ctx->filter->init_opaque)
         ret = ctx->filter->init_opaque(ctx, NULL);
     else if (ctx->filter->init)
         ret = ctx->filter->init(ctx);
     else if (ctx->filter->init_dict)
         ret = ctx->filter->init_dict(ctx, options);
+    av_mem_tag_pop();
 
     return ret;
 }
@@ -1113,7 +1201,11 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
     if (dstctx->is_disabled &&
         (dstctx->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC))
         filter_frame = default_filter_frame;
+    av_trace_begin("filter", dstctx->name);
+    av_mem_tag_push(dstctx);
     ret = filter_frame(link, frame);
+    av_mem_tag_pop();
+    av_trace_end("filter", dstctx->name);
     link->frame_count_out++;
     return ret;
 
@@ -1473,8 +1565,12 @@ int ff_filter_activate(AVFilterContext *filter)
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
     filter->ready = 0;
+    av_trace_begin("activate", filter->name);
+    av_mem_tag_push(filter);
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
+    av_mem_tag_pop();
+    av_trace_end("activate", filter->name);
     if (ret == FFERROR_NOT_READY)
         ret = 0;
     return ret;
@@ -46,6 +46,7 @@
 #include "libavutil/samplefmt.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/rational.h"
+#include "libavutil/threadpool.h"
 
 #include "libavfilter/version.h"
 
@@ -896,6 +897,15 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Shared thread pool on which to run the slice threading jobs, instead of
+     * threads owned by the graph. May be set by the caller before adding any
+     * filters to the graph; the pool must outlive the graph.
+     *
+     * Ignored if AVFilterGraph.execute is set.
+     */
+    AVThreadPool *thread_pool;
+
     /**
      * Private fields
      *
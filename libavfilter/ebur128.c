@@ -47,6 +47,7 @@
 #include <limits.h>
 #include <math.h>               /* You may have to define _USE_MATH_DEFINES if you use MSVC */
 
+#include "libavutil/attributes.h"
 #include "libavutil/common.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
@@ -82,8 +83,12 @@ struct FFEBUR128StateInternal {
     double b[5];
     /** BS.1770 filter coefficients (denominator). */
     double a[5];
-    /** BS.1770 filter state. */
-    double v[5][5];
+    /** b[0..4] and a[1..4], in the layout used by dsp. */
+    double coeffs[9];
+    /** Filter functions. */
+    FFEBUR128DSPContext dsp;
+    /** BS.1770 filter state, 4 arrays of one element per channel. */
+    double *v;
     /** Histograms, used to calculate LRA. */
     unsigned long *block_energy_histogram;
     unsigned long *short_term_block_energy_histogram;
@@ -103,8 +108,6 @@ static DECLARE_ALIGNED(32, double, histogram_energy_boundaries)[1001];
 
 static void ebur128_init_filter(FFEBUR128State * st)
 {
-    int i, j;
-
     double f0 = 1681.974450955533;
     double G = 3.999843853973347;
     double Q = 0.7071752369554196;
@@ -144,11 +147,9 @@ static void ebur128_init_filter(FFEBUR128State * st)
     st->d->a[3] = pa[1] * ra[2] + pa[2] * ra[1];
     st->d->a[4] = pa[2] * ra[2];
 
-    for (i = 0; i < 5; ++i) {
-        for (j = 0; j < 5; ++j) {
-            st->d->v[i][j] = 0.0;
-        }
-    }
+    memcpy(st->d->coeffs,     st->d->b,     5 * sizeof(*st->d->b));
+    memcpy(st->d->coeffs + 5, st->d->a + 1, 4 * sizeof(*st->d->a));
+    ff_ebur128_init_dsp(&st->d->dsp);
 }
 
 static int ebur128_init_channel_map(FFEBUR128State * st)
@@ -256,11 +257,14 @@ FFEBUR128State *ff_ebur128_init(unsigned int channels,
                                     st->channels * sizeof(double));
     CHECK_ERROR(!st->d->audio_data, 0, free_sample_peak)
 
+    st->d->v = (double *) av_mallocz_array(st->channels, 4 * sizeof(double));
+    CHECK_ERROR(!st->d->v, 0, free_audio_data)
+
     ebur128_init_filter(st);
 
     st->d->block_energy_histogram =
         av_mallocz(1000 * sizeof(unsigned long));
-    CHECK_ERROR(!st->d->block_energy_histogram, 0, free_audio_data)
+    CHECK_ERROR(!st->d->block_energy_histogram, 0, free_filter_state)
     st->d->short_term_block_energy_histogram =
         av_mallocz(1000 * sizeof(unsigned long));
     CHECK_ERROR(!st->d->short_term_block_energy_histogram, 0,
@@ -285,6 +289,8 @@ free_short_term_block_energy_histogram:
     av_free(st->d->short_term_block_energy_histogram);
 free_block_energy_histogram:
     av_free(st->d->block_energy_histogram);
+free_filter_state:
+    av_free(st->d->v);
 free_audio_data:
     av_free(st->d->audio_data);
 free_sample_peak:
@@ -304,6 +310,7 @@ void ff_ebur128_destroy(FFEBUR128State ** st)
     av_free((*st)->d->block_energy_histogram);
     av_free((*st)->d->short_term_block_energy_histogram);
     av_free((*st)->d->audio_data);
+    av_free((*st)->d->v);
     av_free((*st)->d->channel_map);
     av_free((*st)->d->sample_peak);
     av_free((*st)->d->data_ptrs);
@@ -312,11 +319,53 @@ void ff_ebur128_destroy(FFEBUR128State ** st)
     *st = NULL;
 }
 
-#define EBUR128_FILTER(type, scaling_factor)                                       \
+static void ebur128_filter_c(double *dst, const double *src, double *v,
+                             const double *coeffs, int channels, int frames)
+{
+    double *v1 = v,            *v2 = v1 + channels;
+    double *v3 = v2 + channels, *v4 = v3 + channels;
+    const double b0 = coeffs[0], b1 = coeffs[1], b2 = coeffs[2];
+    const double b3 = coeffs[3], b4 = coeffs[4];
+    const double a1 = coeffs[5], a2 = coeffs[6];
+    const double a3 = coeffs[7], a4 = coeffs[8];
+    int i, c;
+
+    for (c = 0; c < channels; ++c) {
+        double s1 = v1[c], s2 = v2[c], s3 = v3[c], s4 = v4[c];
+        for (i = 0; i < frames; ++i) {
+            double s0 = src[i * channels + c]
+                      - a1 * s1 - a2 * s2 - a3 * s3 - a4 * s4;
+            dst[i * channels + c] = b0 * s0 + b1 * s1 + b2 * s2 + b3 * s3 + b4 * s4;
+            s4 = s3;
+            s3 = s2;
+            s2 = s1;
+            s1 = s0;
+        }
+        v1[c] = s1; v2[c] = s2; v3[c] = s3; v4[c] = s4;
+    }
+}
+
+av_cold void ff_ebur128_init_dsp(FFEBUR128DSPContext *dsp)
+{
+    dsp->filter = ebur128_filter_c;
+
+    if (ARCH_X86)
+        ff_ebur128_init_dsp_x86(dsp);
+}
+
+/* Interleaved doubles are filtered by dsp, for all channels at once. */
+#define EBUR128_FILTER(type, scaling_factor, use_dsp)                              \
 static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,           \
                                   size_t src_index, size_t frames,                 \
-                                  int stride) {                                    \
+                                  int stride, int interleaved) {                   \
     double* audio_data = st->d->audio_data + st->d->audio_data_index;              \
+    const size_t channels = st->channels;                                          \
+    double *v1 = st->d->v,     *v2 = v1 + channels;                                \
+    double *v3 = v2 + channels, *v4 = v3 + channels;                               \
+    const double a1 = st->d->a[1], a2 = st->d->a[2];                               \
+    const double a3 = st->d->a[3], a4 = st->d->a[4];                               \
+    const double b0 = st->d->b[0], b1 = st->d->b[1], b2 = st->d->b[2];             \
+    const double b3 = st->d->b[3], b4 = st->d->b[4];                               \
     size_t i, c;                                                                   \
                                                                                    \
     if ((st->mode & FF_EBUR128_MODE_SAMPLE_PEAK) == FF_EBUR128_MODE_SAMPLE_PEAK) { \
@@ -334,37 +383,41 @@ static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,
             if (max > st->d->sample_peak[c]) st->d->sample_peak[c] = max;          \
         }                                                                          \
     }                                                                              \
-    for (c = 0; c < st->channels; ++c) {                                           \
-        int ci = st->d->channel_map[c] - 1;                                        \
-        if (ci < 0) continue;                                                      \
-        else if (ci == FF_EBUR128_DUAL_MONO - 1) ci = 0; /*dual mono */            \
+    if (use_dsp && interleaved) {                                                  \
+        st->d->dsp.filter(audio_data, (const double *)srcs[0] + src_index,         \
+                          st->d->v, st->d->coeffs, channels, frames);              \
+        for (c = 0; c < 4 * channels; ++c)                                         \
+            st->d->v[c] = fabs(st->d->v[c]) < DBL_MIN ? 0.0 : st->d->v[c];         \
+        return;                                                                    \
+    }                                                                              \
+    /* Keep the state of the recursive filter in local variables, so that */       \
+    /* it does not have to go through memory for each sample.             */       \
+    for (c = 0; c < channels; ++c) {                                               \
+        const type *src = srcs[c] + src_index;                                     \
+        double *dst = audio_data + c;                                              \
+        double s1, s2, s3, s4;                                                     \
+        if (st->d->channel_map[c] == FF_EBUR128_UNUSED)                            \
+            continue;                                                              \
+        s1 = v1[c]; s2 = v2[c]; s3 = v3[c]; s4 = v4[c];                            \
         for (i = 0; i < frames; ++i) {                                             \
-            st->d->v[ci][0] = (double) (srcs[c][src_index + i * stride] / scaling_factor) \
-                         - st->d->a[1] * st->d->v[ci][1]                           \
-                         - st->d->a[2] * st->d->v[ci][2]                           \
-                         - st->d->a[3] * st->d->v[ci][3]                           \
-                         - st->d->a[4] * st->d->v[ci][4];                          \
-            audio_data[i * st->channels + c] =                                     \
-                           st->d->b[0] * st->d->v[ci][0]                           \
-                         + st->d->b[1] * st->d->v[ci][1]                           \
-                         + st->d->b[2] * st->d->v[ci][2]                           \
-                         + st->d->b[3] * st->d->v[ci][3]                           \
-                         + st->d->b[4] * st->d->v[ci][4];                          \
-            st->d->v[ci][4] = st->d->v[ci][3];                                     \
-            st->d->v[ci][3] = st->d->v[ci][2];                                     \
-            st->d->v[ci][2] = st->d->v[ci][1];                                     \
-            st->d->v[ci][1] = st->d->v[ci][0];                                     \
+            double s0 = (double) (src[i * stride] / scaling_factor)                \
+                      - a1 * s1 - a2 * s2 - a3 * s3 - a4 * s4;                     \
+            dst[i * channels] = b0 * s0 + b1 * s1 + b2 * s2 + b3 * s3 + b4 * s4;   \
+            s4 = s3;                                                               \
+            s3 = s2;                                                               \
+            s2 = s1;                                                               \
+            s1 = s0;                                                               \
         }                                                                          \
-        st->d->v[ci][4] = fabs(st->d->v[ci][4]) < DBL_MIN ? 0.0 : st->d->v[ci][4]; \
-        st->d->v[ci][3] = fabs(st->d->v[ci][3]) < DBL_MIN ? 0.0 : st->d->v[ci][3]; \
-        st->d->v[ci][2] = fabs(st->d->v[ci][2]) < DBL_MIN ? 0.0 : st->d->v[ci][2]; \
-        st->d->v[ci][1] = fabs(st->d->v[ci][1]) < DBL_MIN ? 0.0 : st->d->v[ci][1]; \
+        v4[c] = fabs(s4) < DBL_MIN ? 0.0 : s4;                                     \
+        v3[c] = fabs(s3) < DBL_MIN ? 0.0 : s3;                                     \
+        v2[c] = fabs(s2) < DBL_MIN ? 0.0 : s2;                                     \
+        v1[c] = fabs(s1) < DBL_MIN ? 0.0 : s1;                                     \
     }                                                                              \
 }
-EBUR128_FILTER(short, -((double)SHRT_MIN))
-EBUR128_FILTER(int, -((double)INT_MIN))
-EBUR128_FILTER(float,  1.0)
-EBUR128_FILTER(double, 1.0)
+EBUR128_FILTER(short, -((double)SHRT_MIN), 0)
+EBUR128_FILTER(int, -((double)INT_MIN), 0)
+EBUR128_FILTER(float,  1.0, 0)
+EBUR128_FILTER(double, 1.0, 1)
 
 static double ebur128_energy_to_loudness(double energy)
 {
@@ -458,13 +511,17 @@ int ff_ebur128_set_channel(FFEBUR128State * st,
 }
 
 static int ebur128_energy_shortterm(FFEBUR128State * st, double *out);
-#define FF_EBUR128_ADD_FRAMES_PLANAR(type)                                             \
-void ff_ebur128_add_frames_planar_##type(FFEBUR128State* st, const type** srcs,        \
-                                 size_t frames, int stride) {                          \
+/* srcs[c] points to channel c, with a distance of stride between samples.
+ * If interleaved is set, the channels are also contiguous in memory, starting
+ * at srcs[0], which lets the filter process them all at once. */
+#define EBUR128_ADD_FRAMES(type)                                                       \
+static void ebur128_add_frames_##type(FFEBUR128State* st, const type** srcs,           \
+                                      size_t frames, int stride, int interleaved) {    \
     size_t src_index = 0;                                                              \
     while (frames > 0) {                                                               \
         if (frames >= st->d->needed_frames) {                                          \
-            ebur128_filter_##type(st, srcs, src_index, st->d->needed_frames, stride);  \
+            ebur128_filter_##type(st, srcs, src_index, st->d->needed_frames, stride,   \
+                                  interleaved);                                        \
             src_index += st->d->needed_frames * stride;                                \
             frames -= st->d->needed_frames;                                            \
             st->d->audio_data_index += st->d->needed_frames * st->channels;            \
@@ -491,7 +548,7 @@ void ff_ebur128_add_frames_planar_##type(FFEBUR128State* st, const type** srcs,
                 st->d->audio_data_index = 0;                                           \
             }                                                                          \
         } else {                                                                       \
-            ebur128_filter_##type(st, srcs, src_index, frames, stride);                \
+            ebur128_filter_##type(st, srcs, src_index, frames, stride, interleaved);   \
             st->d->audio_data_index += frames * st->channels;                          \
             if ((st->mode & FF_EBUR128_MODE_LRA) == FF_EBUR128_MODE_LRA) {             \
                 st->d->short_term_frame_counter += frames;                             \
@@ -501,6 +558,15 @@ void ff_ebur128_add_frames_planar_##type(FFEBUR128State* st, const type** srcs,
         }                                                                              \
     }                                                                                  \
 }
+EBUR128_ADD_FRAMES(short)
+EBUR128_ADD_FRAMES(int)
+EBUR128_ADD_FRAMES(float)
+EBUR128_ADD_FRAMES(double)
+#define FF_EBUR128_ADD_FRAMES_PLANAR(type)                                             \
+void ff_ebur128_add_frames_planar_##type(FFEBUR128State* st, const type** srcs,        \
+                                 size_t frames, int stride) {                          \
+    ebur128_add_frames_##type(st, srcs, frames, stride, 0);                            \
+}
 FF_EBUR128_ADD_FRAMES_PLANAR(short)
 FF_EBUR128_ADD_FRAMES_PLANAR(int)
 FF_EBUR128_ADD_FRAMES_PLANAR(float)
@@ -512,12 +578,25 @@ void ff_ebur128_add_frames_##type(FFEBUR128State* st, const type* src,         \
   const type **buf = (const type**)st->d->data_ptrs;                           \
   for (i = 0; i < st->channels; i++)                                           \
     buf[i] = src + i;                                                          \
-  ff_ebur128_add_frames_planar_##type(st, buf, frames, st->channels);          \
+  ebur128_add_frames_##type(st, buf, frames, st->channels, 1);                 \
 }
 FF_EBUR128_ADD_FRAMES(short)
 FF_EBUR128_ADD_FRAMES(int)
 FF_EBUR128_ADD_FRAMES(float)
 FF_EBUR128_ADD_FRAMES(double)
+#define FF_EBUR128_ADD_FRAMES_MULTIPLE(type)                                   \
+void ff_ebur128_add_frames_##type##_multiple(FFEBUR128State** sts,             \
+                                             size_t size,                      \
+                                             const type** srcs,                \
+                                             size_t frames) {                  \
+  size_t i;                                                                    \
+  for (i = 0; i < size; i++)                                                   \
+    ff_ebur128_add_frames_##type(sts[i], srcs[i], frames);                     \
+}
+FF_EBUR128_ADD_FRAMES_MULTIPLE(short)
+FF_EBUR128_ADD_FRAMES_MULTIPLE(int)
+FF_EBUR128_ADD_FRAMES_MULTIPLE(float)
+FF_EBUR128_ADD_FRAMES_MULTIPLE(double)
 
 static int ebur128_calc_relative_threshold(FFEBUR128State **sts, size_t size,
                                            double *relative_threshold)
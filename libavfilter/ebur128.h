@@ -186,6 +186,29 @@ void ff_ebur128_add_frames_planar_double(FFEBUR128State * st,
                                          const double **srcs,
                                          size_t frames, int stride);
 
+/** \brief Add the same number of frames to several states.
+ *
+ *  Use this to measure multiple streams, e.g. all programs of an asset,
+ *  with a single call per chunk of audio.
+ *
+ *  @param sts array of library states.
+ *  @param size length of sts and srcs.
+ *  @param srcs array of source frames, srcs[i] is added to sts[i].
+ *              Channels must be interleaved.
+ *  @param frames number of frames added to each state. Not number of samples!
+ */
+void ff_ebur128_add_frames_short_multiple(FFEBUR128State ** sts, size_t size,
+                                          const short **srcs, size_t frames);
+/** \brief See \ref ebur128_add_frames_short_multiple */
+void ff_ebur128_add_frames_int_multiple(FFEBUR128State ** sts, size_t size,
+                                        const int **srcs, size_t frames);
+/** \brief See \ref ebur128_add_frames_short_multiple */
+void ff_ebur128_add_frames_float_multiple(FFEBUR128State ** sts, size_t size,
+                                          const float **srcs, size_t frames);
+/** \brief See \ref ebur128_add_frames_short_multiple */
+void ff_ebur128_add_frames_double_multiple(FFEBUR128State ** sts, size_t size,
+                                           const double **srcs, size_t frames);
+
 /** \brief Get global integrated loudness in LUFS.
  *
  *  @param st library state.
@@ -293,4 +316,21 @@ int ff_ebur128_sample_peak(FFEBUR128State * st,
  */
 int ff_ebur128_relative_threshold(FFEBUR128State * st, double *out);
 
+/** \brief Filter functions, which may be replaced by SIMD versions. */
+typedef struct FFEBUR128DSPContext {
+    /** \brief Apply the BS.1770 filter to interleaved samples.
+     *
+     *  All the channels are filtered, and the output is interleaved like the
+     *  input.
+     *
+     *  @param v filter state, 4 arrays of channels elements, updated on return.
+     *  @param coeffs b0, b1, b2, b3, b4, a1, a2, a3 and a4.
+     */
+    void (*filter)(double *dst, const double *src, double *v,
+                   const double *coeffs, int channels, int frames);
+} FFEBUR128DSPContext;
+
+void ff_ebur128_init_dsp(FFEBUR128DSPContext *dsp);
+void ff_ebur128_init_dsp_x86(FFEBUR128DSPContext *dsp);
+
 #endif                          /* AVFILTER_EBUR128_H */
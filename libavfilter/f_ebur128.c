@@ -34,31 +34,18 @@
 #include "libavutil/channel_layout.h"
 #include "libavutil/dict.h"
 #include "libavutil/ffmath.h"
+#include "libavutil/mem.h"
 #include "libavutil/xga_font_data.h"
 #include "libavutil/opt.h"
 #include "libavutil/timestamp.h"
-#include "libswresample/swresample.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "f_ebur128.h"
 #include "formats.h"
 #include "internal.h"
 
 #define MAX_CHANNELS 63
 
-/* pre-filter coefficients */
-#define PRE_B0  1.53512485958697
-#define PRE_B1 -2.69169618940638
-#define PRE_B2  1.19839281085285
-#define PRE_A1 -1.69065929318241
-#define PRE_A2  0.73248077421585
-
-/* RLB-filter coefficients */
-#define RLB_B0  1.0
-#define RLB_B1 -2.0
-#define RLB_B2  1.0
-#define RLB_A1 -1.99004745483398
-#define RLB_A2  0.99007225036621
-
 #define ABS_THRES    -70            ///< silence gate: we discard anything below this absolute (LUFS) threshold
 #define ABS_UP_THRES  10            ///< upper loud limit to consider (ABS_THRES being the minimum)
 #define HIST_GRAIN   100            ///< defines histogram precision
@@ -98,11 +85,7 @@ typedef struct EBUR128Context {
     double *true_peaks;             ///< true peaks per channel
     double *sample_peaks;           ///< sample peaks per channel
     double *true_peaks_per_frame;   ///< true peaks in a frame per channel
-#if CONFIG_SWRESAMPLE
-    SwrContext *swr_ctx;            ///< over-sampling context for true peak metering
-    double *swr_buf;                ///< resampled audio data for true peak metering
-    int swr_linesize;
-#endif
+    double *tp_buf;                 ///< interpolator history followed by the current input samples
 
     /* video  */
     int do_video;                   ///< 1 if video output enabled, 0 otherwise
@@ -122,10 +105,12 @@ typedef struct EBUR128Context {
     int sample_count;               ///< sample count used for refresh frequency, reset at refresh
 
     /* Filter caches.
-     * The mult by 3 in the following is for X[i], X[i-1] and X[i-2] */
-    double x[MAX_CHANNELS * 3];     ///< 3 input samples cache for each channel
-    double y[MAX_CHANNELS * 3];     ///< 3 pre-filter samples cache for each channel
-    double z[MAX_CHANNELS * 3];     ///< 3 RLB-filter samples cache for each channel
+     * One row of nb_channels values for each of X[i-1], X[i-2], Y[i-1],
+     * Y[i-2], Z[i-1] and Z[i-2] */
+    double filter_state[EBUR128_FILTER_STATE * MAX_CHANNELS];
+    double *filtered;               ///< RLB-filter output of the current frame
+    unsigned int filtered_size;     ///< allocated size of filtered
+    EBUR128DSPContext dsp;
 
 #define I400_BINS  (48000 * 4 / 10)
 #define I3000_BINS (48000 * 3)
@@ -173,6 +158,82 @@ static const AVOption ebur128_options[] = {
 
 AVFILTER_DEFINE_CLASS(ebur128);
 
+/* ITU-R BS.1770-4 Annex 2 interpolation filter, with the 4 phases of each tap
+ * next to each other. */
+DECLARE_ALIGNED(32, const double, ff_ebur128_tp_coeffs)[EBUR128_TP_TAPS][EBUR128_TP_PHASES] = {
+    {  0.0017089843750, -0.0291748046875, -0.0189208984375, -0.0083007812500 },
+    {  0.0109863281250,  0.0292968750000,  0.0330810546875,  0.0148925781250 },
+    { -0.0196533203125, -0.0517578125000, -0.0582275390625, -0.0266113281250 },
+    {  0.0332031250000,  0.0891113281250,  0.1015625000000,  0.0476074218750 },
+    { -0.0594482421875, -0.1665039062500, -0.2003173828125, -0.1022949218750 },
+    {  0.1373291015625,  0.4650878906250,  0.7797851562500,  0.9721679687500 },
+    {  0.9721679687500,  0.7797851562500,  0.4650878906250,  0.1373291015625 },
+    { -0.1022949218750, -0.2003173828125, -0.1665039062500, -0.0594482421875 },
+    {  0.0476074218750,  0.1015625000000,  0.0891113281250,  0.0332031250000 },
+    { -0.0266113281250, -0.0582275390625, -0.0517578125000, -0.0196533203125 },
+    {  0.0148925781250,  0.0330810546875,  0.0292968750000,  0.0109863281250 },
+    { -0.0083007812500, -0.0189208984375, -0.0291748046875,  0.0017089843750 },
+};
+
+static void filter_c(double *dst, const double *src, double *state,
+                     int nb_channels, int nb_samples)
+{
+    double *x1 = state,            *x2 = x1 + nb_channels;
+    double *y1 = x2 + nb_channels, *y2 = y1 + nb_channels;
+    double *z1 = y2 + nb_channels, *z2 = z1 + nb_channels;
+    int i, ch;
+
+    for (ch = 0; ch < nb_channels; ch++) {
+        double X1 = x1[ch], X2 = x2[ch];
+        double Y1 = y1[ch], Y2 = y2[ch];
+        double Z1 = z1[ch], Z2 = z2[ch];
+
+        /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+        for (i = 0; i < nb_samples; i++) {
+            const double x = src[i * nb_channels + ch];
+            const double y = x  * PRE_B0 + X1 * PRE_B1 + X2 * PRE_B2
+                                         - Y1 * PRE_A1 - Y2 * PRE_A2;
+            const double z = y  * RLB_B0 + Y1 * RLB_B1 + Y2 * RLB_B2
+                                         - Z1 * RLB_A1 - Z2 * RLB_A2;
+
+            dst[i * nb_channels + ch] = z;
+            X2 = X1; X1 = x;
+            Y2 = Y1; Y1 = y;
+            Z2 = Z1; Z1 = z;
+        }
+        x1[ch] = X1; x2[ch] = X2;
+        y1[ch] = Y1; y2[ch] = Y2;
+        z1[ch] = Z1; z2[ch] = Z2;
+    }
+}
+
+static double true_peak_c(const double *src, ptrdiff_t stride, int nb_samples)
+{
+    double peak = 0.0;
+    int i, j, k;
+
+    for (i = 0; i < nb_samples; i++) {
+        for (j = 0; j < EBUR128_TP_PHASES; j++) {
+            double sum = src[0] * ff_ebur128_tp_coeffs[0][j];
+
+            for (k = 1; k < EBUR128_TP_TAPS; k++)
+                sum += src[-k * stride] * ff_ebur128_tp_coeffs[k][j];
+            peak = FFMAX(peak, fabs(sum));
+        }
+        src += stride;
+    }
+    return peak;
+}
+
+av_cold void ff_ebur128_filter_init(EBUR128DSPContext *dsp)
+{
+    dsp->filter    = filter_c;
+    dsp->true_peak = true_peak_c;
+
+    if (ARCH_X86)
+        ff_ebur128_filter_init_x86(dsp);
+}
+
 static const uint8_t graph_colors[] = {
     0xdd, 0x66, 0x66,   // value above 0LU non reached
     0x66, 0x66, 0xdd,   // value below 0LU non reached
@@ -352,7 +413,7 @@ static int config_audio_input(AVFilterLink *inlink)
 
     /* Force 100ms framing in case of metadata injection: the frames must have
      * a granularity of the window overlap to be accurately exploited.
-     * As for the true peaks mode, it just simplifies the resampling buffer
+     * As for the true peaks mode, it just simplifies the interpolation buffer
      * allocation and the lookup in it (since sample buffers differ in size, it
      * can be more complex to integrate in the one-sample loop of
      * filter_frame()). */
@@ -401,31 +462,18 @@ static int config_audio_output(AVFilterLink *outlink)
             return AVERROR(ENOMEM);
     }
 
-#if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        int ret;
+        /* the input frames are at most 100ms long, see config_audio_input() */
+        const int max_samples = outlink->sample_rate / 10;
 
-        ebur128->swr_buf    = av_malloc_array(nb_channels, 19200 * sizeof(double));
+        ebur128->tp_buf     = av_calloc(nb_channels, (EBUR128_TP_TAPS - 1 + max_samples) *
+                                                     sizeof(*ebur128->tp_buf));
         ebur128->true_peaks = av_calloc(nb_channels, sizeof(*ebur128->true_peaks));
         ebur128->true_peaks_per_frame = av_calloc(nb_channels, sizeof(*ebur128->true_peaks_per_frame));
-        ebur128->swr_ctx    = swr_alloc();
-        if (!ebur128->swr_buf || !ebur128->true_peaks ||
-            !ebur128->true_peaks_per_frame || !ebur128->swr_ctx)
+        if (!ebur128->tp_buf || !ebur128->true_peaks ||
+            !ebur128->true_peaks_per_frame)
             return AVERROR(ENOMEM);
-
-        av_opt_set_int(ebur128->swr_ctx, "in_channel_layout",    outlink->channel_layout, 0);
-        av_opt_set_int(ebur128->swr_ctx, "in_sample_rate",       outlink->sample_rate, 0);
-        av_opt_set_sample_fmt(ebur128->swr_ctx, "in_sample_fmt", outlink->format, 0);
-
-        av_opt_set_int(ebur128->swr_ctx, "out_channel_layout",    outlink->channel_layout, 0);
-        av_opt_set_int(ebur128->swr_ctx, "out_sample_rate",       192000, 0);
-        av_opt_set_sample_fmt(ebur128->swr_ctx, "out_sample_fmt", outlink->format, 0);
-
-        ret = swr_init(ebur128->swr_ctx);
-        if (ret < 0)
-            return ret;
     }
-#endif
 
     if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS) {
         ebur128->sample_peaks = av_calloc(nb_channels, sizeof(*ebur128->sample_peaks));
@@ -467,11 +515,7 @@ static av_cold int init(AVFilterContext *ctx)
             ebur128->loglevel = AV_LOG_INFO;
     }
 
-    if (!CONFIG_SWRESAMPLE && (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS)) {
-        av_log(ctx, AV_LOG_ERROR,
-               "True-peak mode requires libswresample to be performed\n");
-        return AVERROR(EINVAL);
-    }
+    ff_ebur128_filter_init(&ebur128->dsp);
 
     // if meter is  +9 scale, scale range is from -18 LU to  +9 LU (or 3*9)
     // if meter is +18 scale, scale range is from -36 LU to +18 LU (or 3*18)
@@ -546,27 +590,33 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
     const int nb_channels = ebur128->nb_channels;
     const int nb_samples  = insamples->nb_samples;
     const double *samples = (double *)insamples->data[0];
+    const double *filtered;
     AVFrame *pic = ebur128->outpicref;
 
-#if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
-        const double *swr_samples = ebur128->swr_buf;
-        int ret = swr_convert(ebur128->swr_ctx, (uint8_t**)&ebur128->swr_buf, 19200,
-                              (const uint8_t **)insamples->data, nb_samples);
-        if (ret < 0)
-            return ret;
-        for (ch = 0; ch < nb_channels; ch++)
-            ebur128->true_peaks_per_frame[ch] = 0.0;
-        for (idx_insample = 0; idx_insample < ret; idx_insample++) {
-            for (ch = 0; ch < nb_channels; ch++) {
-                ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], fabs(*swr_samples));
-                ebur128->true_peaks_per_frame[ch] = FFMAX(ebur128->true_peaks_per_frame[ch],
-                                                          fabs(*swr_samples));
-                swr_samples++;
-            }
+        const int history = (EBUR128_TP_TAPS - 1) * nb_channels;
+        double *tp_samples = ebur128->tp_buf + history;
+
+        memcpy(tp_samples, samples, nb_samples * nb_channels * sizeof(*tp_samples));
+        for (ch = 0; ch < nb_channels; ch++) {
+            const double peak = ebur128->dsp.true_peak(tp_samples + ch, nb_channels,
+                                                       nb_samples);
+            ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], peak);
+            ebur128->true_peaks_per_frame[ch] = peak;
         }
+        memmove(ebur128->tp_buf, ebur128->tp_buf + nb_samples * nb_channels,
+                history * sizeof(*ebur128->tp_buf));
+    }
+
+    av_fast_malloc(&ebur128->filtered, &ebur128->filtered_size,
+                   nb_samples * nb_channels * sizeof(*ebur128->filtered));
+    if (!ebur128->filtered) {
+        av_frame_free(&insamples);
+        return AVERROR(ENOMEM);
     }
-#endif
+    ebur128->dsp.filter(ebur128->filtered, samples, ebur128->filter_state,
+                        nb_channels, nb_samples);
+    filtered = ebur128->filtered;
 
     for (idx_insample = 0; idx_insample < nb_samples; idx_insample++) {
         const int bin_id_400  = ebur128->i400.cache_pos;
@@ -587,30 +637,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
             double bin;
 
             if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
-                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], fabs(*samples));
-
-            ebur128->x[ch * 3] = *samples++; // set X[i]
+                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], fabs(samples[ch]));
 
             if (!ebur128->ch_weighting[ch])
                 continue;
 
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, name) do {                                                 \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*name##_B0 + src[1]*name##_B1 + src[2]*name##_B2     \
-                                      - dst[1]*name##_A1 - dst[2]*name##_A2;    \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, PRE);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, RLB);  // apply RLB-filter
-
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
+            bin = filtered[ch] * filtered[ch];
 
             /* add the new value, and limit the sum to the cache size (400ms or 3s)
              * by removing the oldest one */
@@ -621,6 +653,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
             ebur128->i400.cache [ch][bin_id_400 ] = bin;
             ebur128->i3000.cache[ch][bin_id_3000] = bin;
         }
+        samples  += nb_channels;
+        filtered += nb_channels;
 
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
@@ -920,10 +954,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < ctx->nb_outputs; i++)
         av_freep(&ctx->output_pads[i].name);
     av_frame_free(&ebur128->outpicref);
-#if CONFIG_SWRESAMPLE
-    av_freep(&ebur128->swr_buf);
-    swr_free(&ebur128->swr_ctx);
-#endif
+    av_freep(&ebur128->tp_buf);
+    av_freep(&ebur128->filtered);
 }
 
 static const AVFilterPad ebur128_inputs[] = {
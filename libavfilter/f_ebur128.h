@@ -0,0 +1,74 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_F_EBUR128_H
+#define AVFILTER_F_EBUR128_H
+
+#include <stddef.h>
+
+/** number of taps of each phase of the true-peak interpolator */
+#define EBUR128_TP_TAPS   12
+/** true-peak over-sampling factor */
+#define EBUR128_TP_PHASES  4
+
+/** K-weighting filter state: x[i-1], x[i-2], y[i-1], y[i-2], z[i-1], z[i-2] */
+#define EBUR128_FILTER_STATE 6
+
+/* pre-filter coefficients */
+#define PRE_B0  1.53512485958697
+#define PRE_B1 -2.69169618940638
+#define PRE_B2  1.19839281085285
+#define PRE_A1 -1.69065929318241
+#define PRE_A2  0.73248077421585
+
+/* RLB-filter coefficients */
+#define RLB_B0  1.0
+#define RLB_B1 -2.0
+#define RLB_B2  1.0
+#define RLB_A1 -1.99004745483398
+#define RLB_A2  0.99007225036621
+
+typedef struct EBUR128DSPContext {
+    /**
+     * Apply the pre-filter and the RLB-filter to interleaved samples.
+     *
+     * @param dst      filtered samples, interleaved like src
+     * @param src      input samples, nb_channels values per frame
+     * @param state    EBUR128_FILTER_STATE rows of nb_channels values each,
+     *                 updated on return
+     */
+    void (*filter)(double *dst, const double *src, double *state,
+                   int nb_channels, int nb_samples);
+
+    /**
+     * Over-sample one channel with the ITU-R BS.1770 polyphase interpolator
+     * and return the highest absolute value of the over-sampled signal.
+     *
+     * @param src      first new sample of the channel; the EBUR128_TP_TAPS - 1
+     *                 previous samples must be readable before it
+     * @param stride   distance between two samples of the channel, in doubles
+     */
+    double (*true_peak)(const double *src, ptrdiff_t stride, int nb_samples);
+} EBUR128DSPContext;
+
+extern const double ff_ebur128_tp_coeffs[EBUR128_TP_TAPS][EBUR128_TP_PHASES];
+
+void ff_ebur128_filter_init(EBUR128DSPContext *dsp);
+void ff_ebur128_filter_init_x86(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_F_EBUR128_H */
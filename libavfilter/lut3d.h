@@ -0,0 +1,79 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_LUT3D_H
+#define AVFILTER_LUT3D_H
+
+#include <stdint.h>
+
+#include "libavutil/pixdesc.h"
+#include "avfilter.h"
+#include "dualinput.h"
+#include "internal.h"
+
+enum interp_mode {
+    INTERPOLATE_NEAREST,
+    INTERPOLATE_TRILINEAR,
+    INTERPOLATE_TETRAHEDRAL,
+    NB_INTERP_MODE
+};
+
+struct rgbvec {
+    float r, g, b;
+};
+
+/* 3D LUT don't often go up to level 32, but it is common to have a Hald CLUT
+ * of 512x512 (64x64x64) */
+#define MAX_LEVEL 64
+
+typedef struct LUT3DContext {
+    const AVClass *class;
+    int interpolation;          ///<interp_mode
+    char *file;
+    uint8_t rgba_map[4];
+    int step;
+    avfilter_action_func *interp;
+    /**
+     * Interpolate the first w pixels of a planar RGB line, w being a
+     * multiple of 8. Optional, set by the arch specific init.
+     */
+    void (*interp_line)(const struct LUT3DContext *lut3d,
+                        uint8_t *dstr, uint8_t *dstg, uint8_t *dstb,
+                        const uint8_t *srcr, const uint8_t *srcg,
+                        const uint8_t *srcb, int w, int depth);
+    struct rgbvec lut[MAX_LEVEL][MAX_LEVEL][MAX_LEVEL];
+    int lutsize;
+    /* YUV input, converted to RGB around the LUT */
+    int yuv_depth;              ///< 0 for RGB input
+    int yuv_csp, yuv_range;
+    float yuv_off[3], yuv_scale[3];
+    float yuv2rgb[3][3], rgb2yuv[3][3];
+#if CONFIG_HALDCLUT_FILTER
+    uint8_t clut_rgba_map[4];
+    int clut_step;
+    int clut_is16bit;
+    int clut_planar;
+    int clut_depth;
+    int clut_width;
+    FFDualInputContext dinput;
+#endif
+} LUT3DContext;
+
+void ff_lut3d_init_x86(LUT3DContext *s, const AVPixFmtDescriptor *desc);
+
+#endif /* AVFILTER_LUT3D_H */
@@ -27,6 +27,8 @@
 #include "libavutil/cpu.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+#include "libavutil/trace.h"
 
 #include "avfilter.h"
 #include "internal.h"
@@ -81,7 +83,9 @@ static void* attribute_align_arg worker(void *v)
         }
         pthread_mutex_unlock(&c->current_job_lock);
 
+        av_trace_begin("slice", c->ctx->name);
         ret = c->func(c->ctx, c->arg, our_job, c->nb_jobs);
+        av_trace_end("slice", c->ctx->name);
         if (c->rets)
             c->rets[our_job % c->nb_jobs] = ret;
 
@@ -140,6 +144,33 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
     return 0;
 }
 
+typedef struct PoolJob {
+    AVFilterContext *ctx;
+    avfilter_action_func *func;
+    void *arg;
+    int nb_jobs;
+} PoolJob;
+
+static int pool_job(void *opaque, int jobnr, int threadnr)
+{
+    PoolJob *job = opaque;
+    int ret;
+
+    av_trace_begin("slice", job->ctx->name);
+    ret = job->func(job->ctx, job->arg, jobnr, job->nb_jobs);
+    av_trace_end("slice", job->ctx->name);
+    return ret;
+}
+
+static int pool_execute(AVFilterContext *ctx, avfilter_action_func *func,
+                        void *arg, int *ret, int nb_jobs)
+{
+    PoolJob job = { ctx, func, arg, nb_jobs };
+
+    return av_thread_pool_execute(ctx->graph->thread_pool, pool_job, &job,
+                                  ret, nb_jobs, ctx->graph->nb_threads);
+}
+
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
     int i, ret;
@@ -198,6 +229,16 @@ int ff_graph_thread_init(AVFilterGraph *graph)
         return 0;
     }
 
+    if (graph->thread_pool) {
+        /* the thread submitting the jobs works on them too */
+        int nb_threads = av_thread_pool_get_nb_threads(graph->thread_pool) + 1;
+        if (graph->nb_threads > 0)
+            nb_threads = FFMIN(nb_threads, graph->nb_threads);
+        graph->nb_threads = nb_threads;
+        graph->internal->thread_execute = pool_execute;
+        return 0;
+    }
+
     graph->internal->thread = av_mallocz(sizeof(ThreadContext));
     if (!graph->internal->thread)
         return AVERROR(ENOMEM);
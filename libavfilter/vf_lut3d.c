@@ -34,6 +34,7 @@
 #include "dualinput.h"
 #include "formats.h"
 #include "internal.h"
+#include "lut3d.h"
 #include "video.h"
 
 #define R 0
@@ -41,39 +42,6 @@
 #define B 2
 #define A 3
 
-enum interp_mode {
-    INTERPOLATE_NEAREST,
-    INTERPOLATE_TRILINEAR,
-    INTERPOLATE_TETRAHEDRAL,
-    NB_INTERP_MODE
-};
-
-struct rgbvec {
-    float r, g, b;
-};
-
-/* 3D LUT don't often go up to level 32, but it is common to have a Hald CLUT
- * of 512x512 (64x64x64) */
-#define MAX_LEVEL 64
-
-typedef struct LUT3DContext {
-    const AVClass *class;
-    int interpolation;          ///<interp_mode
-    char *file;
-    uint8_t rgba_map[4];
-    int step;
-    avfilter_action_func *interp;
-    struct rgbvec lut[MAX_LEVEL][MAX_LEVEL][MAX_LEVEL];
-    int lutsize;
-#if CONFIG_HALDCLUT_FILTER
-    uint8_t clut_rgba_map[4];
-    int clut_step;
-    int clut_is16bit;
-    int clut_width;
-    FFDualInputContext dinput;
-#endif
-} LUT3DContext;
-
 typedef struct ThreadData {
     AVFrame *in, *out;
 } ThreadData;
@@ -246,6 +214,168 @@ DEFINE_INTERP_FUNC(nearest,     16)
 DEFINE_INTERP_FUNC(trilinear,   16)
 DEFINE_INTERP_FUNC(tetrahedral, 16)
 
+#define DEFINE_INTERP_FUNC_PLANAR(name, nbits, depth)                                               \
+static int interp_##nbits##_##name##_p##depth(AVFilterContext *ctx, void *arg,                      \
+                                              int jobnr, int nb_jobs)                               \
+{                                                                                                   \
+    int x, y;                                                                                       \
+    const LUT3DContext *lut3d = ctx->priv;                                                          \
+    const ThreadData *td = arg;                                                                     \
+    const AVFrame *in  = td->in;                                                                    \
+    const AVFrame *out = td->out;                                                                   \
+    const int direct = out == in;                                                                   \
+    const int slice_start = (in->height *  jobnr   ) / nb_jobs;                                     \
+    const int slice_end   = (in->height * (jobnr+1)) / nb_jobs;                                     \
+    uint8_t       *grow = out->data[0] + slice_start * out->linesize[0];                            \
+    uint8_t       *brow = out->data[1] + slice_start * out->linesize[1];                            \
+    uint8_t       *rrow = out->data[2] + slice_start * out->linesize[2];                            \
+    uint8_t       *arow = out->data[3] + slice_start * out->linesize[3];                            \
+    const uint8_t *srcgrow = in->data[0] + slice_start * in->linesize[0];                           \
+    const uint8_t *srcbrow = in->data[1] + slice_start * in->linesize[1];                           \
+    const uint8_t *srcrrow = in->data[2] + slice_start * in->linesize[2];                           \
+    const uint8_t *srcarow = in->data[3] + slice_start * in->linesize[3];                           \
+    const float scale = (1. / ((1<<depth) - 1)) * (lut3d->lutsize - 1);                             \
+    const int simd_w = lut3d->interp_line ? in->width & ~7 : 0;                                     \
+                                                                                                    \
+    for (y = slice_start; y < slice_end; y++) {                                                     \
+        uint##nbits##_t *dstg = (uint##nbits##_t *)grow;                                            \
+        uint##nbits##_t *dstb = (uint##nbits##_t *)brow;                                            \
+        uint##nbits##_t *dstr = (uint##nbits##_t *)rrow;                                            \
+        uint##nbits##_t *dsta = (uint##nbits##_t *)arow;                                            \
+        const uint##nbits##_t *srcg = (const uint##nbits##_t *)srcgrow;                             \
+        const uint##nbits##_t *srcb = (const uint##nbits##_t *)srcbrow;                             \
+        const uint##nbits##_t *srcr = (const uint##nbits##_t *)srcrrow;                             \
+        const uint##nbits##_t *srca = (const uint##nbits##_t *)srcarow;                             \
+        if (simd_w)                                                                                 \
+            lut3d->interp_line(lut3d, rrow, grow, brow, srcrrow, srcgrow, srcbrow,                  \
+                               simd_w, depth);                                                      \
+        for (x = simd_w; x < in->width; x++) {                                                      \
+            const struct rgbvec scaled_rgb = {srcr[x] * scale,                                      \
+                                              srcg[x] * scale,                                      \
+                                              srcb[x] * scale};                                     \
+            struct rgbvec vec = interp_##name(lut3d, &scaled_rgb);                                  \
+            dstr[x] = av_clip_uintp2(vec.r * (float)((1<<depth) - 1), depth);                       \
+            dstg[x] = av_clip_uintp2(vec.g * (float)((1<<depth) - 1), depth);                       \
+            dstb[x] = av_clip_uintp2(vec.b * (float)((1<<depth) - 1), depth);                       \
+        }                                                                                           \
+        if (!direct && in->data[3])                                                                 \
+            memcpy(dsta, srca, in->width * sizeof(*dsta));                                          \
+        grow += out->linesize[0];                                                                   \
+        brow += out->linesize[1];                                                                   \
+        rrow += out->linesize[2];                                                                   \
+        arow += out->linesize[3];                                                                   \
+        srcgrow += in->linesize[0];                                                                 \
+        srcbrow += in->linesize[1];                                                                 \
+        srcrrow += in->linesize[2];                                                                 \
+        srcarow += in->linesize[3];                                                                 \
+    }                                                                                               \
+    return 0;                                                                                       \
+}
+
+DEFINE_INTERP_FUNC_PLANAR(nearest,     8, 8)
+DEFINE_INTERP_FUNC_PLANAR(trilinear,   8, 8)
+DEFINE_INTERP_FUNC_PLANAR(tetrahedral, 8, 8)
+
+DEFINE_INTERP_FUNC_PLANAR(nearest,     16, 9)
+DEFINE_INTERP_FUNC_PLANAR(trilinear,   16, 9)
+DEFINE_INTERP_FUNC_PLANAR(tetrahedral, 16, 9)
+
+DEFINE_INTERP_FUNC_PLANAR(nearest,     16, 10)
+DEFINE_INTERP_FUNC_PLANAR(trilinear,   16, 10)
+DEFINE_INTERP_FUNC_PLANAR(tetrahedral, 16, 10)
+
+DEFINE_INTERP_FUNC_PLANAR(nearest,     16, 12)
+DEFINE_INTERP_FUNC_PLANAR(trilinear,   16, 12)
+DEFINE_INTERP_FUNC_PLANAR(tetrahedral, 16, 12)
+
+DEFINE_INTERP_FUNC_PLANAR(nearest,     16, 14)
+DEFINE_INTERP_FUNC_PLANAR(trilinear,   16, 14)
+DEFINE_INTERP_FUNC_PLANAR(tetrahedral, 16, 14)
+
+DEFINE_INTERP_FUNC_PLANAR(nearest,     16, 16)
+DEFINE_INTERP_FUNC_PLANAR(trilinear,   16, 16)
+DEFINE_INTERP_FUNC_PLANAR(tetrahedral, 16, 16)
+
+/* The LUT is defined on RGB, so YUV is converted to RGB in [0,1] before the
+ * lookup and back after it, using the matrix of the frame colorspace. */
+#define DEFINE_INTERP_FUNC_YUV(name, nbits, depth)                                                  \
+static int interp_##nbits##_##name##_yuv##depth(AVFilterContext *ctx, void *arg,                    \
+                                                int jobnr, int nb_jobs)                             \
+{                                                                                                   \
+    int x, y;                                                                                       \
+    const LUT3DContext *lut3d = ctx->priv;                                                          \
+    const ThreadData *td = arg;                                                                     \
+    const AVFrame *in  = td->in;                                                                    \
+    const AVFrame *out = td->out;                                                                   \
+    const int direct = out == in;                                                                   \
+    const int slice_start = (in->height *  jobnr   ) / nb_jobs;                                     \
+    const int slice_end   = (in->height * (jobnr+1)) / nb_jobs;                                     \
+    const float (*m)[3] = lut3d->yuv2rgb;                                                           \
+    const float (*c)[3] = lut3d->rgb2yuv;                                                           \
+    const float *off    = lut3d->yuv_off;                                                           \
+    const float *sc     = lut3d->yuv_scale;                                                         \
+    const float lutmax  = lut3d->lutsize - 1;                                                       \
+    uint8_t       *yrow = out->data[0] + slice_start * out->linesize[0];                            \
+    uint8_t       *urow = out->data[1] + slice_start * out->linesize[1];                            \
+    uint8_t       *vrow = out->data[2] + slice_start * out->linesize[2];                            \
+    uint8_t       *arow = out->data[3] + slice_start * out->linesize[3];                            \
+    const uint8_t *srcyrow = in->data[0] + slice_start * in->linesize[0];                           \
+    const uint8_t *srcurow = in->data[1] + slice_start * in->linesize[1];                           \
+    const uint8_t *srcvrow = in->data[2] + slice_start * in->linesize[2];                           \
+    const uint8_t *srcarow = in->data[3] + slice_start * in->linesize[3];                           \
+                                                                                                    \
+    for (y = slice_start; y < slice_end; y++) {                                                     \
+        uint##nbits##_t *dsty = (uint##nbits##_t *)yrow;                                            \
+        uint##nbits##_t *dstu = (uint##nbits##_t *)urow;                                            \
+        uint##nbits##_t *dstv = (uint##nbits##_t *)vrow;                                            \
+        uint##nbits##_t *dsta = (uint##nbits##_t *)arow;                                            \
+        const uint##nbits##_t *srcy = (const uint##nbits##_t *)srcyrow;                             \
+        const uint##nbits##_t *srcu = (const uint##nbits##_t *)srcurow;                             \
+        const uint##nbits##_t *srcv = (const uint##nbits##_t *)srcvrow;                             \
+        const uint##nbits##_t *srca = (const uint##nbits##_t *)srcarow;                             \
+        for (x = 0; x < in->width; x++) {                                                           \
+            const float ny = (srcy[x] - off[0]) * sc[0];                                            \
+            const float nu = (srcu[x] - off[1]) * sc[1];                                            \
+            const float nv = (srcv[x] - off[2]) * sc[2];                                            \
+            const struct rgbvec scaled_rgb = {                                                      \
+                av_clipf(ny + m[0][1] * nu + m[0][2] * nv, 0.f, 1.f) * lutmax,                      \
+                av_clipf(ny + m[1][1] * nu + m[1][2] * nv, 0.f, 1.f) * lutmax,                      \
+                av_clipf(ny + m[2][1] * nu + m[2][2] * nv, 0.f, 1.f) * lutmax,                      \
+            };                                                                                      \
+            struct rgbvec vec = interp_##name(lut3d, &scaled_rgb);                                  \
+            dsty[x] = av_clip_uintp2(lrintf(off[0] + c[0][0] * vec.r + c[0][1] * vec.g +            \
+                                            c[0][2] * vec.b), depth);                               \
+            dstu[x] = av_clip_uintp2(lrintf(off[1] + c[1][0] * vec.r + c[1][1] * vec.g +            \
+                                            c[1][2] * vec.b), depth);                               \
+            dstv[x] = av_clip_uintp2(lrintf(off[2] + c[2][0] * vec.r + c[2][1] * vec.g +            \
+                                            c[2][2] * vec.b), depth);                               \
+        }                                                                                           \
+        if (!direct && in->data[3])                                                                 \
+            memcpy(dsta, srca, in->width * sizeof(*dsta));                                          \
+        yrow += out->linesize[0];                                                                   \
+        urow += out->linesize[1];                                                                   \
+        vrow += out->linesize[2];                                                                   \
+        arow += out->linesize[3];                                                                   \
+        srcyrow += in->linesize[0];                                                                 \
+        srcurow += in->linesize[1];                                                                 \
+        srcvrow += in->linesize[2];                                                                 \
+        srcarow += in->linesize[3];                                                                 \
+    }                                                                                               \
+    return 0;                                                                                       \
+}
+
+DEFINE_INTERP_FUNC_YUV(nearest,     8, 8)
+DEFINE_INTERP_FUNC_YUV(trilinear,   8, 8)
+DEFINE_INTERP_FUNC_YUV(tetrahedral, 8, 8)
+
+DEFINE_INTERP_FUNC_YUV(nearest,     16, 10)
+DEFINE_INTERP_FUNC_YUV(trilinear,   16, 10)
+DEFINE_INTERP_FUNC_YUV(tetrahedral, 16, 10)
+
+DEFINE_INTERP_FUNC_YUV(nearest,     16, 12)
+DEFINE_INTERP_FUNC_YUV(trilinear,   16, 12)
+DEFINE_INTERP_FUNC_YUV(tetrahedral, 16, 12)
+
 #define MAX_LINE_SIZE 512
 
 static int skip_line(const char *p)
@@ -460,18 +590,31 @@ static void set_identity_matrix(LUT3DContext *lut3d, int size)
     }
 }
 
+#define RGB_PIX_FMTS                        \
+    AV_PIX_FMT_RGB24,  AV_PIX_FMT_BGR24,    \
+    AV_PIX_FMT_RGBA,   AV_PIX_FMT_BGRA,     \
+    AV_PIX_FMT_ARGB,   AV_PIX_FMT_ABGR,     \
+    AV_PIX_FMT_0RGB,   AV_PIX_FMT_0BGR,     \
+    AV_PIX_FMT_RGB0,   AV_PIX_FMT_BGR0,     \
+    AV_PIX_FMT_RGB48,  AV_PIX_FMT_BGR48,    \
+    AV_PIX_FMT_RGBA64, AV_PIX_FMT_BGRA64,   \
+    AV_PIX_FMT_GBRP,   AV_PIX_FMT_GBRAP,    \
+    AV_PIX_FMT_GBRP9,                       \
+    AV_PIX_FMT_GBRP10, AV_PIX_FMT_GBRAP10,  \
+    AV_PIX_FMT_GBRP12, AV_PIX_FMT_GBRAP12,  \
+    AV_PIX_FMT_GBRP14,                      \
+    AV_PIX_FMT_GBRP16, AV_PIX_FMT_GBRAP16
+
+static const enum AVPixelFormat pix_fmts[] = {
+    RGB_PIX_FMTS,
+    AV_PIX_FMT_YUV444P,   AV_PIX_FMT_YUVA444P,
+    AV_PIX_FMT_YUV444P10, AV_PIX_FMT_YUVA444P10,
+    AV_PIX_FMT_YUV444P12,
+    AV_PIX_FMT_NONE
+};
+
 static int query_formats(AVFilterContext *ctx)
 {
-    static const enum AVPixelFormat pix_fmts[] = {
-        AV_PIX_FMT_RGB24,  AV_PIX_FMT_BGR24,
-        AV_PIX_FMT_RGBA,   AV_PIX_FMT_BGRA,
-        AV_PIX_FMT_ARGB,   AV_PIX_FMT_ABGR,
-        AV_PIX_FMT_0RGB,   AV_PIX_FMT_0BGR,
-        AV_PIX_FMT_RGB0,   AV_PIX_FMT_BGR0,
-        AV_PIX_FMT_RGB48,  AV_PIX_FMT_BGR48,
-        AV_PIX_FMT_RGBA64, AV_PIX_FMT_BGRA64,
-        AV_PIX_FMT_NONE
-    };
     AVFilterFormats *fmts_list = ff_make_format_list(pix_fmts);
     if (!fmts_list)
         return AVERROR(ENOMEM);
@@ -480,10 +623,12 @@ static int query_formats(AVFilterContext *ctx)
 
 static int config_input(AVFilterLink *inlink)
 {
-    int is16bit = 0;
+    int depth, is16bit = 0, planar = 0;
     LUT3DContext *lut3d = inlink->dst->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
 
+    depth = desc->comp[0].depth;
+
     switch (inlink->format) {
     case AV_PIX_FMT_RGB48:
     case AV_PIX_FMT_BGR48:
@@ -492,12 +637,30 @@ static int config_input(AVFilterLink *inlink)
         is16bit = 1;
     }
 
+    planar = desc->flags & AV_PIX_FMT_FLAG_PLANAR;
+    lut3d->yuv_depth = desc->flags & AV_PIX_FMT_FLAG_RGB ? 0 : depth;
+    lut3d->yuv_csp   = lut3d->yuv_range = -1;
     ff_fill_rgba_map(lut3d->rgba_map, inlink->format);
     lut3d->step = av_get_padded_bits_per_pixel(desc) >> (3 + is16bit);
 
-#define SET_FUNC(name) do {                             \
-    if (is16bit) lut3d->interp = interp_16_##name;      \
-    else         lut3d->interp = interp_8_##name;       \
+#define SET_FUNC(name) do {                                       \
+    if (lut3d->yuv_depth) {                                       \
+        switch (depth) {                                          \
+        case  8: lut3d->interp = interp_8_##name##_yuv8;   break; \
+        case 10: lut3d->interp = interp_16_##name##_yuv10; break; \
+        case 12: lut3d->interp = interp_16_##name##_yuv12; break; \
+        }                                                         \
+    } else if (planar) {                                          \
+        switch (depth) {                                          \
+        case  8: lut3d->interp = interp_8_##name##_p8;   break;   \
+        case  9: lut3d->interp = interp_16_##name##_p9;  break;   \
+        case 10: lut3d->interp = interp_16_##name##_p10; break;   \
+        case 12: lut3d->interp = interp_16_##name##_p12; break;   \
+        case 14: lut3d->interp = interp_16_##name##_p14; break;   \
+        case 16: lut3d->interp = interp_16_##name##_p16; break;   \
+        }                                                         \
+    } else if (is16bit) { lut3d->interp = interp_16_##name;       \
+    } else {              lut3d->interp = interp_8_##name; }      \
 } while (0)
 
     switch (lut3d->interpolation) {
@@ -508,9 +671,62 @@ static int config_input(AVFilterLink *inlink)
         av_assert0(0);
     }
 
+    lut3d->interp_line = NULL;
+    if (ARCH_X86)
+        ff_lut3d_init_x86(lut3d, desc);
+
     return 0;
 }
 
+static void set_yuv_matrix(LUT3DContext *lut3d, const AVFrame *frame)
+{
+    const int depth = lut3d->yuv_depth;
+    const int full  = frame->color_range == AVCOL_RANGE_JPEG;
+    const float ymax = full ? (1 << depth) - 1 : 219 << (depth - 8);
+    const float cmax = full ? (1 << depth) - 1 : 224 << (depth - 8);
+    double kr, kb, kg;
+
+    switch (frame->colorspace) {
+    case AVCOL_SPC_BT709:      kr = 0.2126; kb = 0.0722; break;
+    case AVCOL_SPC_FCC:        kr = 0.30;   kb = 0.11;   break;
+    case AVCOL_SPC_SMPTE240M:  kr = 0.212;  kb = 0.087;  break;
+    case AVCOL_SPC_BT2020_NCL:
+    case AVCOL_SPC_BT2020_CL:  kr = 0.2627; kb = 0.0593; break;
+    default:                   kr = 0.299;  kb = 0.114;  break;
+    }
+    kg = 1 - kr - kb;
+
+    lut3d->yuv_off[0]   = full ? 0 : 16 << (depth - 8);
+    lut3d->yuv_off[1]   =
+    lut3d->yuv_off[2]   = 1 << (depth - 1);
+    lut3d->yuv_scale[0] = 1 / ymax;
+    lut3d->yuv_scale[1] =
+    lut3d->yuv_scale[2] = 1 / cmax;
+
+    lut3d->yuv2rgb[0][0] = 1;
+    lut3d->yuv2rgb[0][1] = 0;
+    lut3d->yuv2rgb[0][2] = 2 * (1 - kr);
+    lut3d->yuv2rgb[1][0] = 1;
+    lut3d->yuv2rgb[1][1] = -2 * kb * (1 - kb) / kg;
+    lut3d->yuv2rgb[1][2] = -2 * kr * (1 - kr) / kg;
+    lut3d->yuv2rgb[2][0] = 1;
+    lut3d->yuv2rgb[2][1] = 2 * (1 - kb);
+    lut3d->yuv2rgb[2][2] = 0;
+
+    lut3d->rgb2yuv[0][0] = ymax * kr;
+    lut3d->rgb2yuv[0][1] = ymax * kg;
+    lut3d->rgb2yuv[0][2] = ymax * kb;
+    lut3d->rgb2yuv[1][0] = cmax * -kr / (2 * (1 - kb));
+    lut3d->rgb2yuv[1][1] = cmax * -kg / (2 * (1 - kb));
+    lut3d->rgb2yuv[1][2] = cmax * 0.5;
+    lut3d->rgb2yuv[2][0] = cmax * 0.5;
+    lut3d->rgb2yuv[2][1] = cmax * -kg / (2 * (1 - kr));
+    lut3d->rgb2yuv[2][2] = cmax * -kb / (2 * (1 - kr));
+
+    lut3d->yuv_csp   = frame->colorspace;
+    lut3d->yuv_range = frame->color_range;
+}
+
 static AVFrame *apply_lut(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -530,6 +746,10 @@ static AVFrame *apply_lut(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
     }
 
+    if (lut3d->yuv_depth && (in->colorspace  != lut3d->yuv_csp ||
+                             in->color_range != lut3d->yuv_range))
+        set_yuv_matrix(lut3d, in);
+
     td.in  = in;
     td.out = out;
     ctx->internal->execute(ctx, lut3d->interp, &td, NULL, FFMIN(outlink->h, ff_filter_get_nb_threads(ctx)));
@@ -670,11 +890,73 @@ static void update_clut(LUT3DContext *lut3d, const AVFrame *frame)
     }                                                                   \
 } while (0)
 
-    if (!lut3d->clut_is16bit) LOAD_CLUT(8);
-    else                      LOAD_CLUT(16);
+#define LOAD_CLUT_PLANAR(nbits, depth) do {                           \
+    int i, j, k, x = 0, y = 0;                                          \
+                                                                        \
+    for (k = 0; k < level; k++) {                                       \
+        for (j = 0; j < level; j++) {                                   \
+            for (i = 0; i < level; i++) {                               \
+                const uint##nbits##_t *gsrc = (const uint##nbits##_t *) \
+                    (datag + y*glinesize);                              \
+                const uint##nbits##_t *bsrc = (const uint##nbits##_t *) \
+                    (datab + y*blinesize);                              \
+                const uint##nbits##_t *rsrc = (const uint##nbits##_t *) \
+                    (datar + y*rlinesize);                              \
+                struct rgbvec *vec = &lut3d->lut[i][j][k];              \
+                vec->r = rsrc[x] / (float)((1<<(depth)) - 1);           \
+                vec->g = gsrc[x] / (float)((1<<(depth)) - 1);           \
+                vec->b = bsrc[x] / (float)((1<<(depth)) - 1);           \
+                if (++x == w) {                                         \
+                    x = 0;                                              \
+                    y++;                                                \
+                }                                                       \
+            }                                                           \
+        }                                                               \
+    }                                                                   \
+} while (0)
+
+    if (lut3d->clut_planar) {
+        const uint8_t *datag = frame->data[0];
+        const uint8_t *datab = frame->data[1];
+        const uint8_t *datar = frame->data[2];
+        const int glinesize  = frame->linesize[0];
+        const int blinesize  = frame->linesize[1];
+        const int rlinesize  = frame->linesize[2];
+
+        switch (lut3d->clut_depth) {
+        case  8: LOAD_CLUT_PLANAR(8,  8);  break;
+        case  9: LOAD_CLUT_PLANAR(16, 9);  break;
+        case 10: LOAD_CLUT_PLANAR(16, 10); break;
+        case 12: LOAD_CLUT_PLANAR(16, 12); break;
+        case 14: LOAD_CLUT_PLANAR(16, 14); break;
+        case 16: LOAD_CLUT_PLANAR(16, 16); break;
+        }
+    } else if (!lut3d->clut_is16bit) {
+        LOAD_CLUT(8);
+    } else {
+        LOAD_CLUT(16);
+    }
 }
 
 
+/* The main input may be YUV, but the CLUT is always read as RGB. */
+static int haldclut_query_formats(AVFilterContext *ctx)
+{
+    static const enum AVPixelFormat clut_pix_fmts[] = {
+        RGB_PIX_FMTS,
+        AV_PIX_FMT_NONE
+    };
+    AVFilterFormats *fmts_list = ff_make_format_list(pix_fmts);
+    int ret;
+
+    if ((ret = ff_formats_ref(fmts_list, &ctx->inputs[0]->out_formats)) < 0 ||
+        (ret = ff_formats_ref(fmts_list, &ctx->outputs[0]->in_formats)) < 0)
+        return ret;
+
+    fmts_list = ff_make_format_list(clut_pix_fmts);
+    return ff_formats_ref(fmts_list, &ctx->inputs[1]->out_formats);
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -719,6 +1001,8 @@ static int config_clut(AVFilterLink *inlink)
         lut3d->clut_is16bit = 1;
     }
 
+    lut3d->clut_planar = desc->flags & AV_PIX_FMT_FLAG_PLANAR;
+    lut3d->clut_depth  = desc->comp[0].depth;
     lut3d->clut_step = av_get_padded_bits_per_pixel(desc) >> 3;
     ff_fill_rgba_map(lut3d->clut_rgba_map, inlink->format);
 
@@ -811,7 +1095,7 @@ AVFilter ff_vf_haldclut = {
     .priv_size     = sizeof(LUT3DContext),
     .init          = haldclut_init,
     .uninit        = haldclut_uninit,
-    .query_formats = query_formats,
+    .query_formats = haldclut_query_formats,
     .inputs        = haldclut_inputs,
     .outputs       = haldclut_outputs,
     .priv_class    = &haldclut_class,
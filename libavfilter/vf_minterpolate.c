@@ -157,6 +157,13 @@ typedef struct Frame {
     Block *blocks;
 } Frame;
 
+typedef struct ThreadData {
+    Block *blocks;
+    int dir;
+    AVFrame *avf_out;
+    int alpha;
+} ThreadData;
+
 typedef struct MIContext {
     const AVClass *class;
     AVMotionEstContext me_ctx;
@@ -254,20 +261,18 @@ static uint64_t get_sbad(AVMotionEstContext *me_ctx, int x, int y, int x_mv, int
     int linesize = me_ctx->linesize;
     int mv_x1 = x_mv - x;
     int mv_y1 = y_mv - y;
-    int mv_x, mv_y, i, j;
-    uint64_t sbad = 0;
+    int mv_x, mv_y;
+    uint64_t sbad;
 
     x = av_clip(x, me_ctx->x_min, me_ctx->x_max);
     y = av_clip(y, me_ctx->y_min, me_ctx->y_max);
     mv_x = av_clip(x_mv - x, -FFMIN(x - me_ctx->x_min, me_ctx->x_max - x), FFMIN(x - me_ctx->x_min, me_ctx->x_max - x));
     mv_y = av_clip(y_mv - y, -FFMIN(y - me_ctx->y_min, me_ctx->y_max - y), FFMIN(y - me_ctx->y_min, me_ctx->y_max - y));
 
-    data_cur += (y + mv_y) * linesize;
-    data_next += (y - mv_y) * linesize;
+    data_cur  += x + mv_x + (y + mv_y) * linesize;
+    data_next += x - mv_x + (y - mv_y) * linesize;
 
-    for (j = 0; j < me_ctx->mb_size; j++)
-        for (i = 0; i < me_ctx->mb_size; i++)
-            sbad += FFABS(data_cur[x + mv_x + i + j * linesize] - data_next[x - mv_x + i + j * linesize]);
+    sbad = ff_me_block_sad(me_ctx, data_cur, data_next, linesize, me_ctx->mb_size);
 
     return sbad + (FFABS(mv_x1 - me_ctx->pred_x) + FFABS(mv_y1 - me_ctx->pred_y)) * COST_PRED_SCALE;
 }
@@ -281,19 +286,22 @@ static uint64_t get_sbad_ob(AVMotionEstContext *me_ctx, int x, int y, int x_mv,
     int x_max = me_ctx->x_max - me_ctx->mb_size / 2;
     int y_min = me_ctx->y_min + me_ctx->mb_size / 2;
     int y_max = me_ctx->y_max - me_ctx->mb_size / 2;
+    int ob_start = me_ctx->mb_size / 2;
+    int ob_size = me_ctx->mb_size * 3 / 2 + ob_start;
     int mv_x1 = x_mv - x;
     int mv_y1 = y_mv - y;
-    int mv_x, mv_y, i, j;
-    uint64_t sbad = 0;
+    int mv_x, mv_y;
+    uint64_t sbad;
 
     x = av_clip(x, x_min, x_max);
     y = av_clip(y, y_min, y_max);
     mv_x = av_clip(x_mv - x, -FFMIN(x - x_min, x_max - x), FFMIN(x - x_min, x_max - x));
     mv_y = av_clip(y_mv - y, -FFMIN(y - y_min, y_max - y), FFMIN(y - y_min, y_max - y));
 
-    for (j = -me_ctx->mb_size / 2; j < me_ctx->mb_size * 3 / 2; j++)
-        for (i = -me_ctx->mb_size / 2; i < me_ctx->mb_size * 3 / 2; i++)
-            sbad += FFABS(data_cur[x + mv_x + i + (y + mv_y + j) * linesize] - data_next[x - mv_x + i + (y - mv_y + j) * linesize]);
+    data_cur  += x + mv_x - ob_start + (y + mv_y - ob_start) * linesize;
+    data_next += x - mv_x - ob_start + (y - mv_y - ob_start) * linesize;
+
+    sbad = ff_me_block_sad(me_ctx, data_cur, data_next, linesize, ob_size);
 
     return sbad + (FFABS(mv_x1 - me_ctx->pred_x) + FFABS(mv_y1 - me_ctx->pred_y)) * COST_PRED_SCALE;
 }
@@ -307,19 +315,21 @@ static uint64_t get_sad_ob(AVMotionEstContext *me_ctx, int x, int y, int x_mv, i
     int x_max = me_ctx->x_max - me_ctx->mb_size / 2;
     int y_min = me_ctx->y_min + me_ctx->mb_size / 2;
     int y_max = me_ctx->y_max - me_ctx->mb_size / 2;
+    int ob_start = me_ctx->mb_size / 2;
+    int ob_size = me_ctx->mb_size * 3 / 2 + ob_start;
     int mv_x = x_mv - x;
     int mv_y = y_mv - y;
-    int i, j;
-    uint64_t sad = 0;
+    uint64_t sad;
 
     x = av_clip(x, x_min, x_max);
     y = av_clip(y, y_min, y_max);
     x_mv = av_clip(x_mv, x_min, x_max);
     y_mv = av_clip(y_mv, y_min, y_max);
 
-    for (j = -me_ctx->mb_size / 2; j < me_ctx->mb_size * 3 / 2; j++)
-        for (i = -me_ctx->mb_size / 2; i < me_ctx->mb_size * 3 / 2; i++)
-            sad += FFABS(data_ref[x_mv + i + (y_mv + j) * linesize] - data_cur[x + i + (y + j) * linesize]);
+    data_ref += x_mv - ob_start + (y_mv - ob_start) * linesize;
+    data_cur += x    - ob_start + (y    - ob_start) * linesize;
+
+    sad = ff_me_block_sad(me_ctx, data_ref, data_cur, linesize, ob_size);
 
     return sad + (FFABS(mv_x - me_ctx->pred_x) + FFABS(mv_y - me_ctx->pred_y)) * COST_PRED_SCALE;
 }
@@ -402,9 +412,9 @@ static int config_output(AVFilterLink *outlink)
         preds.nb++;\
     } while(0)
 
-static void search_mv(MIContext *mi_ctx, Block *blocks, int mb_x, int mb_y, int dir)
+static void search_mv(MIContext *mi_ctx, AVMotionEstContext *me_ctx, Block *blocks,
+                      int mb_x, int mb_y, int dir)
 {
-    AVMotionEstContext *me_ctx = &mi_ctx->me_ctx;
     AVMotionEstPredictor *preds = me_ctx->preds;
     Block *block = &blocks[mb_x + mb_y * mi_ctx->b_width];
 
@@ -544,8 +554,47 @@ static void search_mv(MIContext *mi_ctx, Block *blocks, int mb_x, int mb_y, int
     block->mvs[dir][1] = mv[1] - y_mb;
 }
 
-static void bilateral_me(MIContext *mi_ctx)
+static int search_mv_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    MIContext *mi_ctx = ctx->priv;
+    ThreadData *td = arg;
+    AVMotionEstContext me_ctx = mi_ctx->me_ctx;
+    const int slice_start = (mi_ctx->b_height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (mi_ctx->b_height * (jobnr+1)) / nb_jobs;
+    int mb_x, mb_y;
+
+    for (mb_y = slice_start; mb_y < slice_end; mb_y++)
+        for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++)
+            search_mv(mi_ctx, &me_ctx, td->blocks, mb_x, mb_y, td->dir);
+
+    emms_c();
+    return 0;
+}
+
+static void search_mvs(AVFilterContext *ctx, Block *blocks, int dir)
 {
+    MIContext *mi_ctx = ctx->priv;
+    int mb_x, mb_y;
+
+    if (mi_ctx->me_method == AV_ME_METHOD_EPZS || mi_ctx->me_method == AV_ME_METHOD_UMH) {
+        /* the predictors depend on the previous blocks of the same frame */
+        for (mb_y = 0; mb_y < mi_ctx->b_height; mb_y++)
+            for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++)
+                search_mv(mi_ctx, &mi_ctx->me_ctx, blocks, mb_x, mb_y, dir);
+        emms_c();
+    } else {
+        ThreadData td;
+
+        td.blocks = blocks;
+        td.dir = dir;
+        ctx->internal->execute(ctx, search_mv_slice, &td, NULL,
+                               FFMIN(mi_ctx->b_height, ff_filter_get_nb_threads(ctx)));
+    }
+}
+
+static void bilateral_me(AVFilterContext *ctx)
+{
+    MIContext *mi_ctx = ctx->priv;
     Block *block;
     int mb_x, mb_y;
 
@@ -560,9 +609,7 @@ static void bilateral_me(MIContext *mi_ctx)
             block->mvs[0][1] = 0;
         }
 
-    for (mb_y = 0; mb_y < mi_ctx->b_height; mb_y++)
-        for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++)
-            search_mv(mi_ctx, mi_ctx->int_blocks, mb_x, mb_y, 0);
+    search_mvs(ctx, mi_ctx->int_blocks, 0);
 }
 
 static int var_size_bme(MIContext *mi_ctx, Block *block, int x_mb, int y_mb, int n)
@@ -745,9 +792,7 @@ static int inject_frame(AVFilterLink *inlink, AVFrame *avf_in)
                     mi_ctx->me_ctx.data_cur = mi_ctx->frames[2].avf->data[0];
                     mi_ctx->me_ctx.data_ref = mi_ctx->frames[dir ? 3 : 1].avf->data[0];
 
-                    for (mb_y = 0; mb_y < mi_ctx->b_height; mb_y++)
-                        for (mb_x = 0; mb_x < mi_ctx->b_width; mb_x++)
-                            search_mv(mi_ctx, mi_ctx->frames[2].blocks, mb_x, mb_y, dir);
+                    search_mvs(ctx, mi_ctx->frames[2].blocks, dir);
                 }
             }
 
@@ -762,7 +807,7 @@ static int inject_frame(AVFilterLink *inlink, AVFrame *avf_in)
             mi_ctx->me_ctx.data_cur = mi_ctx->frames[1].avf->data[0];
             mi_ctx->me_ctx.data_ref = mi_ctx->frames[2].avf->data[0];
 
-            bilateral_me(mi_ctx);
+            bilateral_me(ctx);
 
             if (mi_ctx->mc_mode == MC_MODE_AOBMC) {
 
@@ -797,6 +842,8 @@ static int inject_frame(AVFilterLink *inlink, AVFrame *avf_in)
                 if (ret = cluster_mvs(mi_ctx))
                     return ret;
             }
+
+            emms_c();
         }
     }
 
@@ -895,16 +942,24 @@ static void bidirectional_obmc(MIContext *mi_ctx, int alpha)
             }
 }
 
-static void set_frame_data(MIContext *mi_ctx, int alpha, AVFrame *avf_out)
+static int set_frame_data(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    MIContext *mi_ctx = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *avf_out = td->avf_out;
+    const int alpha = td->alpha;
+    /* keep the luma rows of a chroma row in the same slice, they all write it */
+    const int chroma_height = AV_CEIL_RSHIFT(avf_out->height, mi_ctx->log2_chroma_h);
+    const int slice_start = ((chroma_height *  jobnr   ) / nb_jobs) << mi_ctx->log2_chroma_h;
+    const int slice_end   = FFMIN(((chroma_height * (jobnr+1)) / nb_jobs) << mi_ctx->log2_chroma_h,
+                                  avf_out->height);
     int x, y, plane;
 
     for (plane = 0; plane < mi_ctx->nb_planes; plane++) {
         int width = avf_out->width;
-        int height = avf_out->height;
         int chroma = plane == 1 || plane == 2;
 
-        for (y = 0; y < height; y++)
+        for (y = slice_start; y < slice_end; y++)
             for (x = 0; x < width; x++) {
                 int x_mv, y_mv;
                 int weight_sum = 0;
@@ -949,6 +1004,8 @@ static void set_frame_data(MIContext *mi_ctx, int alpha, AVFrame *avf_out)
                     avf_out->data[plane][x + y * avf_out->linesize[plane]] = val;
             }
     }
+
+    return 0;
 }
 
 static void var_size_bmc(MIContext *mi_ctx, Block *block, int x_mb, int y_mb, int n, int alpha)
@@ -1055,6 +1112,7 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
     AVFilterContext *ctx = inlink->dst;
     AVFilterLink *outlink = ctx->outputs[0];
     MIContext *mi_ctx = ctx->priv;
+    ThreadData td;
     int x, y;
     int plane, alpha;
     int64_t pts;
@@ -1104,7 +1162,6 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
         case MI_MODE_MCI:
             if (mi_ctx->me_mode == ME_MODE_BIDIR) {
                 bidirectional_obmc(mi_ctx, alpha);
-                set_frame_data(mi_ctx, alpha, avf_out);
 
             } else if (mi_ctx->me_mode == ME_MODE_BILAT) {
                 int mb_x, mb_y;
@@ -1125,9 +1182,15 @@ static void interpolate(AVFilterLink *inlink, AVFrame *avf_out)
 
                     }
 
-                set_frame_data(mi_ctx, alpha, avf_out);
+                emms_c();
             }
 
+            td.avf_out = avf_out;
+            td.alpha = alpha;
+            ctx->internal->execute(ctx, set_frame_data, &td, NULL,
+                                   FFMIN(AV_CEIL_RSHIFT(avf_out->height, mi_ctx->log2_chroma_h),
+                                         ff_filter_get_nb_threads(ctx)));
+
             break;
     }
 }
@@ -1239,4 +1302,5 @@ AVFilter ff_vf_minterpolate = {
     .query_formats = query_formats,
     .inputs        = minterpolate_inputs,
     .outputs       = minterpolate_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -38,11 +38,7 @@
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
-
-struct weighted_avg {
-    double total_weight;
-    double sum;
-};
+#include "vf_nlmeans.h"
 
 #define WEIGHT_LUT_NBITS 9
 #define WEIGHT_LUT_SIZE  (1<<WEIGHT_LUT_NBITS)
@@ -66,6 +62,7 @@ typedef struct NLMeansContext {
     double weight_lut[WEIGHT_LUT_SIZE];         // lookup table mapping (scaled) patch differences to their associated weights
     double pdiff_lut_scale;                     // scale factor for patch differences before looking into the LUT
     int max_meaningful_diff;                    // maximum difference considered (if the patch difference is too high we ignore the pixel)
+    NLMeansDSPContext dsp;
 } NLMeansContext;
 
 #define OFFSET(x) offsetof(NLMeansContext, x)
@@ -129,14 +126,6 @@ static int query_formats(AVFilterContext *ctx)
  * contains the sum of the squared difference of every corresponding pixels of
  * two input planes of the same size as M.
  */
-static inline int get_integral_patch_value(const uint32_t *ii, int ii_lz_32, int x, int y, int p)
-{
-    const int e = ii[(y + p    ) * ii_lz_32 + (x + p    )];
-    const int d = ii[(y + p    ) * ii_lz_32 + (x - p - 1)];
-    const int b = ii[(y - p - 1) * ii_lz_32 + (x + p    )];
-    const int a = ii[(y - p - 1) * ii_lz_32 + (x - p - 1)];
-    return e - d - b + a;
-}
 
 /**
  * Compute squared difference of the safe area (the zone where s1 and s2
@@ -149,25 +138,38 @@ static inline int get_integral_patch_value(const uint32_t *ii, int ii_lz_32, int
  * This C version computes the SSD integral image using a scalar accumulator,
  * while for SIMD implementation it is likely more interesting to use the
  * two-loops algorithm variant.
+ *
+ * The width is a multiple of 4 so that the loop can be unrolled; the caller
+ * handles the remaining columns with the unsafe version.
  */
-static void compute_safe_ssd_integral_image_c(uint32_t *dst, int dst_linesize_32,
-                                              const uint8_t *s1, int linesize1,
-                                              const uint8_t *s2, int linesize2,
+static void compute_safe_ssd_integral_image_c(uint32_t *dst, ptrdiff_t dst_linesize_32,
+                                              const uint8_t *s1, ptrdiff_t linesize1,
+                                              const uint8_t *s2, ptrdiff_t linesize2,
                                               int w, int h)
 {
     int x, y;
+    const uint32_t *dst_top = dst - dst_linesize_32;
+
+    av_assert2(!(w & 3));
 
     for (y = 0; y < h; y++) {
         uint32_t acc = dst[-1] - dst[-dst_linesize_32 - 1];
 
-        for (x = 0; x < w; x++) {
-            const int d  = s1[x] - s2[x];
-            acc += d * d;
-            dst[x] = dst[-dst_linesize_32 + x] + acc;
+        for (x = 0; x < w; x += 4) {
+            const int d0 = s1[x    ] - s2[x    ];
+            const int d1 = s1[x + 1] - s2[x + 1];
+            const int d2 = s1[x + 2] - s2[x + 2];
+            const int d3 = s1[x + 3] - s2[x + 3];
+
+            dst[x    ] = dst_top[x    ] + (acc += d0 * d0);
+            dst[x + 1] = dst_top[x + 1] + (acc += d1 * d1);
+            dst[x + 2] = dst_top[x + 2] + (acc += d2 * d2);
+            dst[x + 3] = dst_top[x + 3] + (acc += d3 * d3);
         }
-        s1  += linesize1;
-        s2  += linesize2;
-        dst += dst_linesize_32;
+        s1      += linesize1;
+        s2      += linesize2;
+        dst     += dst_linesize_32;
+        dst_top += dst_linesize_32;
     }
 }
 
@@ -225,6 +227,7 @@ static inline void compute_unsafe_ssd_integral_image(uint32_t *dst, int dst_line
  * http://www.ipol.im/pub/art/2014/57/
  * Integral Images for Block Matching - Gabriele Facciolo, Nicolas Limare, Enric Meinhardt-Llopis
  *
+ * @param dsp               NL-means DSP context
  * @param ii                integral image of dimension (w+e*2) x (h+e*2) with
  *                          an additional zeroed top line and column already
  *                          "applied" to the pointer value
@@ -237,7 +240,8 @@ static inline void compute_unsafe_ssd_integral_image(uint32_t *dst, int dst_line
  * @param h                 source height
  * @param e                 research padding edge
  */
-static void compute_ssd_integral_image(uint32_t *ii, int ii_linesize_32,
+static void compute_ssd_integral_image(const NLMeansDSPContext *dsp,
+                                       uint32_t *ii, int ii_linesize_32,
                                        const uint8_t *src, int linesize, int offx, int offy,
                                        int e, int w, int h)
 {
@@ -260,6 +264,10 @@ static void compute_ssd_integral_image(uint32_t *ii, int ii_linesize_32,
     const int endx_safe   = FFMIN(s1x + w, s2x + w);
     const int endy_safe   = FFMIN(s1y + h, s2y + h);
 
+    // the safe area is computed in blocks of 4 columns, the remaining ones
+    // are part of the right unsafe area
+    const int safe_pw = (endx_safe - startx_safe) & ~3;
+
     // top part where only one of s1 and s2 is still readable, or none at all
     compute_unsafe_ssd_integral_image(ii, ii_linesize_32,
                                       0, 0,
@@ -280,17 +288,17 @@ static void compute_ssd_integral_image(uint32_t *ii, int ii_linesize_32,
     av_assert1(starty_safe - s1y >= 0); av_assert1(starty_safe - s1y < h);
     av_assert1(startx_safe - s2x >= 0); av_assert1(startx_safe - s2x < w);
     av_assert1(starty_safe - s2y >= 0); av_assert1(starty_safe - s2y < h);
-    compute_safe_ssd_integral_image_c(ii + starty_safe*ii_linesize_32 + startx_safe, ii_linesize_32,
-                                      src + (starty_safe - s1y) * linesize + (startx_safe - s1x), linesize,
-                                      src + (starty_safe - s2y) * linesize + (startx_safe - s2x), linesize,
-                                      endx_safe - startx_safe, endy_safe - starty_safe);
+    dsp->compute_safe_ssd_integral_image(ii + starty_safe*ii_linesize_32 + startx_safe, ii_linesize_32,
+                                         src + (starty_safe - s1y) * linesize + (startx_safe - s1x), linesize,
+                                         src + (starty_safe - s2y) * linesize + (startx_safe - s2x), linesize,
+                                         safe_pw, endy_safe - starty_safe);
 
     // right part of the integral
     compute_unsafe_ssd_integral_image(ii, ii_linesize_32,
-                                      endx_safe, starty_safe,
+                                      startx_safe + safe_pw, starty_safe,
                                       src, linesize,
                                       offx, offy, e, w, h,
-                                      ii_w - endx_safe, endy_safe - starty_safe);
+                                      ii_w - (startx_safe + safe_pw), endy_safe - starty_safe);
 
     // bottom part where only one of s1 and s2 is still readable, or none at all
     compute_unsafe_ssd_integral_image(ii, ii_linesize_32,
@@ -363,9 +371,29 @@ struct thread_data {
     int p;
 };
 
+static void compute_weights_line_c(const uint32_t *iia, const uint32_t *iib,
+                                   const uint32_t *iid, const uint32_t *iie,
+                                   const uint8_t *src, struct weighted_avg *wa,
+                                   const double *weight_lut, double pdiff_lut_scale,
+                                   int max_meaningful_diff, int startx, int endx)
+{
+    int x;
+
+    for (x = startx; x < endx; x++) {
+        /* sum of the patch box X = e-d-b+a, see the integral image schema */
+        const int patch_diff_sq = iie[x] - iid[x] - iib[x] + iia[x];
+        if (patch_diff_sq < max_meaningful_diff) {
+            const int weight_lut_idx = patch_diff_sq * pdiff_lut_scale;
+            const double weight = weight_lut[weight_lut_idx]; // exp(-patch_diff_sq * s->pdiff_scale)
+            wa[x].total_weight += weight;
+            wa[x].sum += weight * src[x];
+        }
+    }
+}
+
 static int nlmeans_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int x, y;
+    int y;
     NLMeansContext *s = ctx->priv;
     const struct thread_data *td = arg;
     const uint8_t *src = td->src;
@@ -376,17 +404,17 @@ static int nlmeans_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs
     const int starty = td->starty + slice_start;
     const int endy   = td->starty + slice_end;
 
+    const int p = td->p;
+
     for (y = starty; y < endy; y++) {
-        for (x = td->startx; x < td->endx; x++) {
-            const int patch_diff_sq = get_integral_patch_value(td->ii_start, s->ii_lz_32, x, y, td->p);
-            if (patch_diff_sq < s->max_meaningful_diff) {
-                struct weighted_avg *wa = &s->wa[y*s->wa_linesize + x];
-                const int weight_lut_idx = patch_diff_sq * s->pdiff_lut_scale;
-                const double weight = s->weight_lut[weight_lut_idx]; // exp(-patch_diff_sq * s->pdiff_scale)
-                wa->total_weight += weight;
-                wa->sum += weight * src[y*src_linesize + x];
-            }
-        }
+        const uint32_t *ii_top    = td->ii_start + (y - p - 1) * s->ii_lz_32;
+        const uint32_t *ii_bottom = td->ii_start + (y + p    ) * s->ii_lz_32;
+
+        s->dsp.compute_weights_line(ii_top    - p - 1, ii_top    + p,
+                                    ii_bottom - p - 1, ii_bottom + p,
+                                    src + y*src_linesize, s->wa + y*s->wa_linesize,
+                                    s->weight_lut, s->pdiff_lut_scale,
+                                    s->max_meaningful_diff, td->startx, td->endx);
     }
     return 0;
 }
@@ -420,7 +448,7 @@ static int nlmeans_plane(AVFilterContext *ctx, int w, int h, int p, int r,
                     .p            = p,
                 };
 
-                compute_ssd_integral_image(s->ii, s->ii_lz_32,
+                compute_ssd_integral_image(&s->dsp, s->ii, s->ii_lz_32,
                                            src, src_linesize,
                                            offx, offy, e, w, h);
                 ctx->internal->execute(ctx, nlmeans_slice, &td, NULL,
@@ -470,6 +498,15 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     return ff_filter_frame(outlink, out);
 }
 
+av_cold void ff_nlmeans_init(NLMeansDSPContext *dsp)
+{
+    dsp->compute_safe_ssd_integral_image = compute_safe_ssd_integral_image_c;
+    dsp->compute_weights_line            = compute_weights_line_c;
+
+    if (ARCH_X86)
+        ff_nlmeans_init_x86(dsp);
+}
+
 #define CHECK_ODD_FIELD(field, name) do {                       \
     if (!(s->field & 1)) {                                      \
         s->field |= 1;                                          \
@@ -509,6 +546,8 @@ static av_cold int init(AVFilterContext *ctx)
            s->research_size, s->research_size, s->research_size_uv, s->research_size_uv,
            s->patch_size,    s->patch_size,    s->patch_size_uv,    s->patch_size_uv);
 
+    ff_nlmeans_init(&s->dsp);
+
     return 0;
 }
 
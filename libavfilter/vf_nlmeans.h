@@ -0,0 +1,60 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_NLMEANS_H
+#define AVFILTER_NLMEANS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct weighted_avg {
+    double total_weight;
+    double sum;
+};
+
+typedef struct NLMeansDSPContext {
+    /**
+     * Compute the SSD integral image of the area where both sources are
+     * readable. The line above dst and the column to its left must be
+     * readable.
+     *
+     * @param w width to compute, must be a multiple of 4
+     */
+    void (*compute_safe_ssd_integral_image)(uint32_t *dst, ptrdiff_t dst_linesize_32,
+                                            const uint8_t *s1, ptrdiff_t linesize1,
+                                            const uint8_t *s2, ptrdiff_t linesize2,
+                                            int w, int h);
+
+    /**
+     * Accumulate the patch weights of one line into the weighted averages.
+     *
+     * iia, iib, iid and iie point to the integral image lines of the top
+     * left, top right, bottom left and bottom right corners of the patches,
+     * already offset so that index x addresses the patch centered on x.
+     */
+    void (*compute_weights_line)(const uint32_t *iia, const uint32_t *iib,
+                                 const uint32_t *iid, const uint32_t *iie,
+                                 const uint8_t *src, struct weighted_avg *wa,
+                                 const double *weight_lut, double pdiff_lut_scale,
+                                 int max_meaningful_diff, int startx, int endx);
+} NLMeansDSPContext;
+
+void ff_nlmeans_init(NLMeansDSPContext *dsp);
+void ff_nlmeans_init_x86(NLMeansDSPContext *dsp);
+
+#endif /* AVFILTER_NLMEANS_H */
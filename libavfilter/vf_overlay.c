@@ -32,6 +32,7 @@
 #include "libavutil/avstring.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/timestamp.h"
@@ -39,6 +40,7 @@
 #include "dualinput.h"
 #include "drawutils.h"
 #include "video.h"
+#include "vf_overlay.h"
 
 static const char *const var_names[] = {
     "main_w",    "W", ///< width  of the main    video
@@ -119,6 +121,7 @@ typedef struct OverlayContext {
     uint8_t overlay_rgba_map[4];
     uint8_t overlay_has_alpha;
     int format;                 ///< OverlayFormat
+    int alpha_format;           ///< OverlayAlphaFormat
     int eval_mode;              ///< EvalMode
 
     FFDualInputContext dinput;
@@ -135,6 +138,8 @@ typedef struct OverlayContext {
 
     AVExpr *x_pexpr, *y_pexpr;
 
+    OverlayDSPContext dsp;
+
     void (*blend_image)(AVFilterContext *ctx, AVFrame *dst, const AVFrame *src, int x, int y);
 } OverlayContext;
 
@@ -424,6 +429,7 @@ static void blend_image_packed_rgb(AVFilterContext *ctx,
     const int sa = s->overlay_rgba_map[A];
     const int sstep = s->overlay_pix_step[0];
     const int main_has_alpha = s->main_has_alpha;
+    const int premultiplied = s->alpha_format == OVERLAY_ALPHA_PREMULTIPLIED;
     uint8_t *S, *sp, *d, *dp;
 
     i = FFMAX(-y, 0);
@@ -440,7 +446,7 @@ static void blend_image_packed_rgb(AVFilterContext *ctx,
 
             // if the main channel has an alpha channel, alpha has to be calculated
             // to create an un-premultiplied (straight) alpha value
-            if (main_has_alpha && alpha != 0 && alpha != 255) {
+            if (main_has_alpha && !premultiplied && alpha != 0 && alpha != 255) {
                 uint8_t alpha_d = d[da];
                 alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
             }
@@ -454,6 +460,13 @@ static void blend_image_packed_rgb(AVFilterContext *ctx,
                 d[db] = S[sb];
                 break;
             default:
+                if (premultiplied) {
+                    // the overlay value is already multiplied by alpha
+                    d[dr] = FFMIN(FAST_DIV255(d[dr] * (255 - alpha)) + S[sr], 255);
+                    d[dg] = FFMIN(FAST_DIV255(d[dg] * (255 - alpha)) + S[sg], 255);
+                    d[db] = FFMIN(FAST_DIV255(d[db] * (255 - alpha)) + S[sb], 255);
+                    break;
+                }
                 // main_value = main_value * (1 - alpha) + overlay_value * alpha
                 // since alpha is in the range 0-255, the result must divided by 255
                 d[dr] = FAST_DIV255(d[dr] * (255 - alpha) + S[sr] * alpha);
@@ -480,6 +493,49 @@ static void blend_image_packed_rgb(AVFilterContext *ctx,
     }
 }
 
+/**
+ * Check whether all the alpha values covering the next 8 pixels of a
+ * (possibly subsampled) plane are equal to v, v being 0 or UINT64_MAX.
+ */
+static av_always_inline int alpha_run_is(const uint8_t *a, ptrdiff_t linesize,
+                                         int hsub, int vsub, uint64_t v)
+{
+    int i, j;
+
+    for (j = 0; j < 1 << vsub; j++)
+        for (i = 0; i < 8 << hsub; i += 8)
+            if (AV_RN64(a + i + j * linesize) != v)
+                return 0;
+    return 1;
+}
+
+static int blend_row_c(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    int x;
+
+    for (x = 0; x < w; x++)
+        d[x] = FAST_DIV255(d[x] * (255 - a[x]) + s[x] * a[x]);
+    return w;
+}
+
+static int blend_row_premultiplied_c(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    int x;
+
+    for (x = 0; x < w; x++)
+        d[x] = FFMIN(FAST_DIV255(d[x] * (255 - a[x])) + s[x], 255);
+    return w;
+}
+
+av_cold void ff_overlay_init(OverlayDSPContext *dsp)
+{
+    dsp->blend_row[OVERLAY_ALPHA_STRAIGHT]      = blend_row_c;
+    dsp->blend_row[OVERLAY_ALPHA_PREMULTIPLIED] = blend_row_premultiplied_c;
+
+    if (ARCH_X86)
+        ff_overlay_init_x86(dsp);
+}
+
 static av_always_inline void blend_plane(AVFilterContext *ctx,
                                          AVFrame *dst, const AVFrame *src,
                                          int src_w, int src_h,
@@ -487,10 +543,13 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
                                          int i, int hsub, int vsub,
                                          int x, int y,
                                          int main_has_alpha,
+                                         int chroma,
                                          int dst_plane,
                                          int dst_offset,
                                          int dst_step)
 {
+    const OverlayContext *octx = ctx->priv;
+    const int premultiplied = octx->alpha_format == OVERLAY_ALPHA_PREMULTIPLIED;
     int src_wp = AV_CEIL_RSHIFT(src_w, hsub);
     int src_hp = AV_CEIL_RSHIFT(src_h, vsub);
     int dst_wp = AV_CEIL_RSHIFT(dst_w, hsub);
@@ -498,7 +557,7 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
     int yp = y>>vsub;
     int xp = x>>hsub;
     uint8_t *s, *sp, *d, *dp, *a, *ap;
-    int jmax, j, k, kmax;
+    int jmax, j, k, kmax, kend;
 
     j = FFMAX(-yp, 0);
     sp = src->data[i] + j         * src->linesize[i];
@@ -512,44 +571,86 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
         d = dp + (xp+k) * dst_step;
         s = sp + k;
         a = ap + (k<<hsub);
+        kmax = FFMIN(-xp + dst_wp, src_wp);
+
+        if (!hsub && !vsub && dst_step == 1 && !main_has_alpha &&
+            !(premultiplied && chroma) && k < kmax) {
+            int n = octx->dsp.blend_row[octx->alpha_format](d, s, a, kmax - k);
+            k += n;
+            s += n;
+            d += n;
+            a += n;
+        }
+
+        while (k < kmax) {
+            kend = FFMIN(k + 8, kmax);
+
+            // fully transparent or opaque runs leave main or copy the overlay
+            if (kend - k == 8 && (k + 8) << hsub <= src_w &&
+                (!vsub || j + 1 < src_hp)) {
+                if (alpha_run_is(a, src->linesize[3], hsub, vsub, 0)) {
+                    s += 8;
+                    d += 8 * dst_step;
+                    a += 8 << hsub;
+                    k += 8;
+                    continue;
+                }
+                if (alpha_run_is(a, src->linesize[3], hsub, vsub, UINT64_MAX)) {
+                    int l;
+
+                    for (l = 0; l < 8; l++)
+                        d[l * dst_step] = s[l];
+                    s += 8;
+                    d += 8 * dst_step;
+                    a += 8 << hsub;
+                    k += 8;
+                    continue;
+                }
+            }
+
+            for (; k < kend; k++) {
+                int alpha_v, alpha_h, alpha;
 
-        for (kmax = FFMIN(-xp + dst_wp, src_wp); k < kmax; k++) {
-            int alpha_v, alpha_h, alpha;
-
-            // average alpha for color components, improve quality
-            if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
-                alpha = (a[0] + a[src->linesize[3]] +
-                         a[1] + a[src->linesize[3]+1]) >> 2;
-            } else if (hsub || vsub) {
-                alpha_h = hsub && k+1 < src_wp ?
-                    (a[0] + a[1]) >> 1 : a[0];
-                alpha_v = vsub && j+1 < src_hp ?
-                    (a[0] + a[src->linesize[3]]) >> 1 : a[0];
-                alpha = (alpha_v + alpha_h) >> 1;
-            } else
-                alpha = a[0];
-            // if the main channel has an alpha channel, alpha has to be calculated
-            // to create an un-premultiplied (straight) alpha value
-            if (main_has_alpha && alpha != 0 && alpha != 255) {
                 // average alpha for color components, improve quality
-                uint8_t alpha_d;
                 if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
-                    alpha_d = (d[0] + d[src->linesize[3]] +
-                               d[1] + d[src->linesize[3]+1]) >> 2;
+                    alpha = (a[0] + a[src->linesize[3]] +
+                             a[1] + a[src->linesize[3]+1]) >> 2;
                 } else if (hsub || vsub) {
                     alpha_h = hsub && k+1 < src_wp ?
-                        (d[0] + d[1]) >> 1 : d[0];
+                        (a[0] + a[1]) >> 1 : a[0];
                     alpha_v = vsub && j+1 < src_hp ?
-                        (d[0] + d[src->linesize[3]]) >> 1 : d[0];
-                    alpha_d = (alpha_v + alpha_h) >> 1;
+                        (a[0] + a[src->linesize[3]]) >> 1 : a[0];
+                    alpha = (alpha_v + alpha_h) >> 1;
                 } else
-                    alpha_d = d[0];
-                alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+                    alpha = a[0];
+                // if the main channel has an alpha channel, alpha has to be calculated
+                // to create an un-premultiplied (straight) alpha value
+                if (main_has_alpha && !premultiplied && alpha != 0 && alpha != 255) {
+                    // average alpha for color components, improve quality
+                    uint8_t alpha_d;
+                    if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
+                        alpha_d = (d[0] + d[src->linesize[3]] +
+                                   d[1] + d[src->linesize[3]+1]) >> 2;
+                    } else if (hsub || vsub) {
+                        alpha_h = hsub && k+1 < src_wp ?
+                            (d[0] + d[1]) >> 1 : d[0];
+                        alpha_v = vsub && j+1 < src_hp ?
+                            (d[0] + d[src->linesize[3]]) >> 1 : d[0];
+                        alpha_d = (alpha_v + alpha_h) >> 1;
+                    } else
+                        alpha_d = d[0];
+                    alpha = UNPREMULTIPLY_ALPHA(alpha, alpha_d);
+                }
+                if (premultiplied && chroma)
+                    *d = av_clip_uint8(FAST_DIV255((*d - 128) * (255 - alpha)) + *s);
+                else if (premultiplied)
+                    *d = FFMIN(FAST_DIV255(*d * (255 - alpha)) + *s, 255);
+                else
+                    *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);
+                s++;
+                d += dst_step;
+                a += 1 << hsub;
             }
-            *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);
-            s++;
-            d += dst_step;
-            a += 1 << hsub;
         }
         dp += dst->linesize[dst_plane];
         sp += src->linesize[i];
@@ -614,11 +715,11 @@ static av_always_inline void blend_image_yuv(AVFilterContext *ctx,
     if (main_has_alpha)
         alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y);
 
-    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 0, 0,       0, x, y, main_has_alpha,
+    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 0, 0,       0, x, y, main_has_alpha, 0,
                 s->main_desc->comp[0].plane, s->main_desc->comp[0].offset, s->main_desc->comp[0].step);
-    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 1, hsub, vsub, x, y, main_has_alpha,
+    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 1, hsub, vsub, x, y, main_has_alpha, 1,
                 s->main_desc->comp[1].plane, s->main_desc->comp[1].offset, s->main_desc->comp[1].step);
-    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 2, hsub, vsub, x, y, main_has_alpha,
+    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 2, hsub, vsub, x, y, main_has_alpha, 1,
                 s->main_desc->comp[2].plane, s->main_desc->comp[2].offset, s->main_desc->comp[2].step);
 }
 
@@ -637,11 +738,11 @@ static av_always_inline void blend_image_rgb(AVFilterContext *ctx,
     if (main_has_alpha)
         alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y);
 
-    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 0, 0,       0, x, y, main_has_alpha,
+    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 0, 0,       0, x, y, main_has_alpha, 0,
                 s->main_desc->comp[1].plane, s->main_desc->comp[1].offset, s->main_desc->comp[1].step);
-    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 1, hsub, vsub, x, y, main_has_alpha,
+    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 1, hsub, vsub, x, y, main_has_alpha, 0,
                 s->main_desc->comp[2].plane, s->main_desc->comp[2].offset, s->main_desc->comp[2].step);
-    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 2, hsub, vsub, x, y, main_has_alpha,
+    blend_plane(ctx, dst, src, src_w, src_h, dst_w, dst_h, 2, hsub, vsub, x, y, main_has_alpha, 0,
                 s->main_desc->comp[0].plane, s->main_desc->comp[0].offset, s->main_desc->comp[0].step);
 }
 
@@ -771,6 +872,8 @@ static av_cold int init(AVFilterContext *ctx)
         s->eof_action = EOF_ACTION_ENDALL;
     }
 
+    ff_overlay_init(&s->dsp);
+
     s->dinput.process = do_blend;
     return 0;
 }
@@ -799,6 +902,9 @@ static const AVOption overlay_options[] = {
         { "rgb",    "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_RGB},    .flags = FLAGS, .unit = "format" },
         { "gbrp",   "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_GBRP},   .flags = FLAGS, .unit = "format" },
     { "repeatlast", "repeat overlay of the last overlay frame", OFFSET(dinput.repeatlast), AV_OPT_TYPE_BOOL, {.i64=1}, 0, 1, FLAGS },
+    { "alpha", "alpha format", OFFSET(alpha_format), AV_OPT_TYPE_INT, {.i64=OVERLAY_ALPHA_STRAIGHT}, 0, OVERLAY_ALPHA_NB-1, FLAGS, "alpha_format" },
+        { "straight",      "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_ALPHA_STRAIGHT},      .flags = FLAGS, .unit = "alpha_format" },
+        { "premultiplied", "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_ALPHA_PREMULTIPLIED}, .flags = FLAGS, .unit = "alpha_format" },
     { NULL }
 };
 
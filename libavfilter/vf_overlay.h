@@ -0,0 +1,45 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_OVERLAY_H
+#define AVFILTER_OVERLAY_H
+
+#include <stdint.h>
+
+enum OverlayAlphaFormat {
+    OVERLAY_ALPHA_STRAIGHT,
+    OVERLAY_ALPHA_PREMULTIPLIED,
+    OVERLAY_ALPHA_NB
+};
+
+typedef struct OverlayDSPContext {
+    /**
+     * Blend a line of a non subsampled plane, indexed by OverlayAlphaFormat.
+     * Straight alpha computes d = (d * (255 - a) + s * a) / 255, premultiplied
+     * alpha computes d = d * (255 - a) / 255 + s, saturated.
+     *
+     * @return number of pixels blended, the caller blends the remaining ones
+     */
+    int (*blend_row[OVERLAY_ALPHA_NB])(uint8_t *d, const uint8_t *s,
+                                       const uint8_t *a, int w);
+} OverlayDSPContext;
+
+void ff_overlay_init(OverlayDSPContext *dsp);
+void ff_overlay_init_x86(OverlayDSPContext *dsp);
+
+#endif /* AVFILTER_OVERLAY_H */
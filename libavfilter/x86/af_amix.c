@@ -0,0 +1,160 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/af_amix.h"
+
+/*
+ * Two vectors of output are kept in registers while all the inputs are
+ * accumulated into them. The products and sums are rounded separately, in
+ * the same order as in C, so the output is identical to it.
+ */
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+#define MIX_SSE(name, type, sfx, bcast)                                             \
+static void mix_##name##_sse2(type *dst, const type **src, const type *scale,      \
+                              int nb_src, int len)                                  \
+{                                                                                   \
+    const int step = 32 / sizeof(type);                                             \
+    x86_reg x = 0, n = (len & ~(step - 1)) * sizeof(type), nb = nb_src, i;          \
+    const type *p;                                                                  \
+    int j, k;                                                                       \
+                                                                                    \
+    if (!nb_src)                                                                    \
+        return;                                                                     \
+                                                                                    \
+    if (n) {                                                                        \
+        __asm__ volatile (                                                          \
+            "1:                                             \n\t"                   \
+            "movup"sfx"    (%[dst], %[x]), %%xmm0           \n\t"                   \
+            "movup"sfx"  16(%[dst], %[x]), %%xmm2           \n\t"                   \
+            "xor              %[i], %[i]                    \n\t"                   \
+            "2:                                             \n\t"                   \
+            "mov    (%[src], %[i], 8), %[p]                 \n\t"                   \
+            bcast                                                                   \
+            "movup"sfx"      (%[p], %[x]), %%xmm1           \n\t"                   \
+            "movup"sfx"    16(%[p], %[x]), %%xmm3           \n\t"                   \
+            "mulp"sfx"          %%xmm4, %%xmm1              \n\t"                   \
+            "mulp"sfx"          %%xmm4, %%xmm3              \n\t"                   \
+            "addp"sfx"          %%xmm1, %%xmm0              \n\t"                   \
+            "addp"sfx"          %%xmm3, %%xmm2              \n\t"                   \
+            "add                 $1, %[i]                   \n\t"                   \
+            "cmp              %[nb], %[i]                   \n\t"                   \
+            "jl                  2b                         \n\t"                   \
+            "movup"sfx"         %%xmm0,   (%[dst], %[x])    \n\t"                   \
+            "movup"sfx"         %%xmm2, 16(%[dst], %[x])    \n\t"                   \
+            "add                $32, %[x]                   \n\t"                   \
+            "cmp               %[n], %[x]                   \n\t"                   \
+            "jl                  1b                         \n\t"                   \
+            : [x]"+&r"(x), [i]"=&r"(i), [p]"=&r"(p)                                 \
+            : [dst]"r"(dst), [src]"r"(src), [scale]"r"(scale),                      \
+              [nb]"r"(nb), [n]"r"(n)                                                \
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",)            \
+              "memory"                                                              \
+        );                                                                          \
+    }                                                                               \
+                                                                                    \
+    for (k = n / sizeof(type); k < len; k++) {                                      \
+        type sum = dst[k];                                                          \
+        for (j = 0; j < nb_src; j++)                                                \
+            sum += src[j][k] * scale[j];                                            \
+        dst[k] = sum;                                                               \
+    }                                                                               \
+}
+
+MIX_SSE(flt, float,  "s", "movss  (%[scale], %[i], 4), %%xmm4 \n\t"
+                          "shufps $0, %%xmm4, %%xmm4          \n\t")
+MIX_SSE(dbl, double, "d", "movsd  (%[scale], %[i], 8), %%xmm4 \n\t"
+                          "unpcklpd %%xmm4, %%xmm4            \n\t")
+#endif /* ARCH_X86_64 && HAVE_SSE2_INLINE */
+
+#if ARCH_X86_64 && HAVE_AVX_INLINE
+#define MIX_AVX(name, type, sfx, es)                                                \
+static void mix_##name##_avx(type *dst, const type **src, const type *scale,       \
+                             int nb_src, int len)                                   \
+{                                                                                   \
+    const int step = 64 / sizeof(type);                                             \
+    x86_reg x = 0, n = (len & ~(step - 1)) * sizeof(type), nb = nb_src, i;          \
+    const type *p;                                                                  \
+    int j, k;                                                                       \
+                                                                                    \
+    if (!nb_src)                                                                    \
+        return;                                                                     \
+                                                                                    \
+    if (n) {                                                                        \
+        __asm__ volatile (                                                          \
+            "1:                                             \n\t"                   \
+            "vmovup"sfx"   (%[dst], %[x]), %%ymm0           \n\t"                   \
+            "vmovup"sfx" 32(%[dst], %[x]), %%ymm2           \n\t"                   \
+            "xor              %[i], %[i]                    \n\t"                   \
+            "2:                                             \n\t"                   \
+            "mov    (%[src], %[i], 8), %[p]                 \n\t"                   \
+            "vbroadcasts"sfx" (%[scale], %[i], "es"), %%ymm4 \n\t"                  \
+            "vmulp"sfx"      (%[p], %[x]), %%ymm4, %%ymm1   \n\t"                   \
+            "vmulp"sfx"    32(%[p], %[x]), %%ymm4, %%ymm3   \n\t"                   \
+            "vaddp"sfx"     %%ymm1, %%ymm0, %%ymm0          \n\t"                   \
+            "vaddp"sfx"     %%ymm3, %%ymm2, %%ymm2          \n\t"                   \
+            "add                 $1, %[i]                   \n\t"                   \
+            "cmp              %[nb], %[i]                   \n\t"                   \
+            "jl                  2b                         \n\t"                   \
+            "vmovup"sfx"        %%ymm0,   (%[dst], %[x])    \n\t"                   \
+            "vmovup"sfx"        %%ymm2, 32(%[dst], %[x])    \n\t"                   \
+            "add                $64, %[x]                   \n\t"                   \
+            "cmp               %[n], %[x]                   \n\t"                   \
+            "jl                  1b                         \n\t"                   \
+            "vzeroupper                                     \n\t"                   \
+            : [x]"+&r"(x), [i]"=&r"(i), [p]"=&r"(p)                                 \
+            : [dst]"r"(dst), [src]"r"(src), [scale]"r"(scale),                      \
+              [nb]"r"(nb), [n]"r"(n)                                                \
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",)            \
+              "memory"                                                              \
+        );                                                                          \
+    }                                                                               \
+                                                                                    \
+    for (k = n / sizeof(type); k < len; k++) {                                      \
+        type sum = dst[k];                                                          \
+        for (j = 0; j < nb_src; j++)                                                \
+            sum += src[j][k] * scale[j];                                            \
+        dst[k] = sum;                                                               \
+    }                                                                               \
+}
+
+MIX_AVX(flt, float,  "s", "4")
+MIX_AVX(dbl, double, "d", "8")
+#endif /* ARCH_X86_64 && HAVE_AVX_INLINE */
+
+av_cold void ff_amix_init_x86(AMixDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        dsp->mix_flt = mix_flt_sse2;
+        dsp->mix_dbl = mix_dbl_sse2;
+    }
+#endif
+#if ARCH_X86_64 && HAVE_AVX_INLINE
+    if (INLINE_AVX(cpu_flags)) {
+        dsp->mix_flt = mix_flt_avx;
+        dsp->mix_dbl = mix_dbl_avx;
+    }
+#endif
+}
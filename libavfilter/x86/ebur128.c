@@ -0,0 +1,244 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/ebur128.h"
+
+/*
+ * The filter is recursive in time, so the channels are filtered in parallel,
+ * one per vector lane. Products and sums are rounded separately and in the
+ * same order as in C, so the output is identical to it.
+ */
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+
+/* broadcast each of the 9 coefficients over 4 doubles */
+static void splat_coeffs(double (*c)[4], const double *coeffs)
+{
+    int i, j;
+
+    for (i = 0; i < 9; i++)
+        for (j = 0; j < 4; j++)
+            c[i][j] = coeffs[i];
+}
+
+static void load_state(double (*s)[4], const double *v,
+                       int channels, int ch, int nb)
+{
+    int i, j;
+
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < nb; j++)
+            s[i][j] = v[i * channels + ch + j];
+}
+
+static void store_state(double *v, double (*s)[4],
+                        int channels, int ch, int nb)
+{
+    int i, j;
+
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < nb; j++)
+            v[i * channels + ch + j] = s[i][j];
+}
+
+/* xmm0-xmm3: v[i-1] to v[i-4] */
+#define FILTER_GROUP_SSE2(name, mov, op)                                        \
+static void filter_group_##name(double *dst, const double *src,                 \
+                                double (*s)[4], double (*c)[4],                 \
+                                x86_reg stride, x86_reg n)                      \
+{                                                                               \
+    __asm__ volatile (                                                          \
+        mov"         (%[s]), %%xmm0                 \n\t"                       \
+        mov"       32(%[s]), %%xmm1                 \n\t"                       \
+        mov"       64(%[s]), %%xmm2                 \n\t"                       \
+        mov"       96(%[s]), %%xmm3                 \n\t"                       \
+        "1:                                         \n\t"                       \
+        mov"       (%[src]), %%xmm4                 \n\t"                       \
+        "movapd       %%xmm0, %%xmm6                \n\t"                       \
+        "mul"op"  160(%[c]), %%xmm6                 \n\t"                       \
+        "sub"op"      %%xmm6, %%xmm4                \n\t"                       \
+        "movapd       %%xmm1, %%xmm6                \n\t"                       \
+        "mul"op"  192(%[c]), %%xmm6                 \n\t"                       \
+        "sub"op"      %%xmm6, %%xmm4                \n\t"                       \
+        "movapd       %%xmm2, %%xmm6                \n\t"                       \
+        "mul"op"  224(%[c]), %%xmm6                 \n\t"                       \
+        "sub"op"      %%xmm6, %%xmm4                \n\t"                       \
+        "movapd       %%xmm3, %%xmm6                \n\t"                       \
+        "mul"op"  256(%[c]), %%xmm6                 \n\t"                       \
+        "sub"op"      %%xmm6, %%xmm4                \n\t"                       \
+        "movapd       %%xmm4, %%xmm5                \n\t"                       \
+        "mul"op"     (%[c]), %%xmm5                 \n\t"                       \
+        "movapd       %%xmm0, %%xmm6                \n\t"                       \
+        "mul"op"   32(%[c]), %%xmm6                 \n\t"                       \
+        "add"op"      %%xmm6, %%xmm5                \n\t"                       \
+        "movapd       %%xmm1, %%xmm6                \n\t"                       \
+        "mul"op"   64(%[c]), %%xmm6                 \n\t"                       \
+        "add"op"      %%xmm6, %%xmm5                \n\t"                       \
+        "movapd       %%xmm2, %%xmm6                \n\t"                       \
+        "mul"op"   96(%[c]), %%xmm6                 \n\t"                       \
+        "add"op"      %%xmm6, %%xmm5                \n\t"                       \
+        "movapd       %%xmm3, %%xmm6                \n\t"                       \
+        "mul"op"  128(%[c]), %%xmm6                 \n\t"                       \
+        "add"op"      %%xmm6, %%xmm5                \n\t"                       \
+        mov"          %%xmm5, (%[dst])              \n\t"                       \
+        "movapd       %%xmm2, %%xmm3                \n\t"                       \
+        "movapd       %%xmm1, %%xmm2                \n\t"                       \
+        "movapd       %%xmm0, %%xmm1                \n\t"                       \
+        "movapd       %%xmm4, %%xmm0                \n\t"                       \
+        "add       %[stride], %[src]                \n\t"                       \
+        "add       %[stride], %[dst]                \n\t"                       \
+        "sub              $1, %[n]                  \n\t"                       \
+        "jg               1b                        \n\t"                       \
+        mov"          %%xmm0,   (%[s])              \n\t"                       \
+        mov"          %%xmm1, 32(%[s])              \n\t"                       \
+        mov"          %%xmm2, 64(%[s])              \n\t"                       \
+        mov"          %%xmm3, 96(%[s])              \n\t"                       \
+        : [src]"+&r"(src), [dst]"+&r"(dst), [n]"+&r"(n)                         \
+        : [s]"r"(s), [c]"r"(c), [stride]"r"(stride)                             \
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",                      \
+                       "%xmm4", "%xmm5", "%xmm6",)                              \
+          "memory"                                                              \
+    );                                                                          \
+}
+
+FILTER_GROUP_SSE2(pd_sse2, "movupd", "pd")
+FILTER_GROUP_SSE2(sd_sse2, "movsd",  "sd")
+
+/* filter the channels from ch on, two at a time */
+static void filter_channels_sse2(double *dst, const double *src, double *v,
+                                 double (*c)[4], int channels, int ch, int frames)
+{
+    DECLARE_ALIGNED(32, double, s)[4][4];
+    const x86_reg stride = channels * sizeof(*src);
+
+    for (; ch + 2 <= channels; ch += 2) {
+        load_state(s, v, channels, ch, 2);
+        filter_group_pd_sse2(dst + ch, src + ch, s, c, stride, frames);
+        store_state(v, s, channels, ch, 2);
+    }
+    if (ch < channels) {
+        load_state(s, v, channels, ch, 1);
+        filter_group_sd_sse2(dst + ch, src + ch, s, c, stride, frames);
+        store_state(v, s, channels, ch, 1);
+    }
+}
+
+static void filter_sse2(double *dst, const double *src, double *v,
+                        const double *coeffs, int channels, int frames)
+{
+    DECLARE_ALIGNED(32, double, c)[9][4];
+
+    if (frames <= 0)
+        return;
+
+    splat_coeffs(c, coeffs);
+    filter_channels_sse2(dst, src, v, c, channels, 0, frames);
+}
+#endif /* ARCH_X86_64 && HAVE_SSE2_INLINE */
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE && HAVE_AVX_INLINE
+/* ymm0-ymm3: v[i-1] to v[i-4] */
+static void filter_group_avx(double *dst, const double *src,
+                             double (*s)[4], double (*c)[4],
+                             x86_reg stride, x86_reg n)
+{
+    __asm__ volatile (
+        "vmovupd         (%[s]), %%ymm0             \n\t"
+        "vmovupd       32(%[s]), %%ymm1             \n\t"
+        "vmovupd       64(%[s]), %%ymm2             \n\t"
+        "vmovupd       96(%[s]), %%ymm3             \n\t"
+        "1:                                         \n\t"
+        "vmovupd       (%[src]), %%ymm4             \n\t"
+        "vmulpd   160(%[c]), %%ymm0, %%ymm6         \n\t"
+        "vsubpd      %%ymm6, %%ymm4, %%ymm4         \n\t"
+        "vmulpd   192(%[c]), %%ymm1, %%ymm6         \n\t"
+        "vsubpd      %%ymm6, %%ymm4, %%ymm4         \n\t"
+        "vmulpd   224(%[c]), %%ymm2, %%ymm6         \n\t"
+        "vsubpd      %%ymm6, %%ymm4, %%ymm4         \n\t"
+        "vmulpd   256(%[c]), %%ymm3, %%ymm6         \n\t"
+        "vsubpd      %%ymm6, %%ymm4, %%ymm4         \n\t"
+        "vmulpd      (%[c]), %%ymm4, %%ymm5         \n\t"
+        "vmulpd    32(%[c]), %%ymm0, %%ymm6         \n\t"
+        "vaddpd      %%ymm6, %%ymm5, %%ymm5         \n\t"
+        "vmulpd    64(%[c]), %%ymm1, %%ymm6         \n\t"
+        "vaddpd      %%ymm6, %%ymm5, %%ymm5         \n\t"
+        "vmulpd    96(%[c]), %%ymm2, %%ymm6         \n\t"
+        "vaddpd      %%ymm6, %%ymm5, %%ymm5         \n\t"
+        "vmulpd   128(%[c]), %%ymm3, %%ymm6         \n\t"
+        "vaddpd      %%ymm6, %%ymm5, %%ymm5         \n\t"
+        "vmovupd       %%ymm5, (%[dst])             \n\t"
+        "vmovapd       %%ymm2, %%ymm3               \n\t"
+        "vmovapd       %%ymm1, %%ymm2               \n\t"
+        "vmovapd       %%ymm0, %%ymm1               \n\t"
+        "vmovapd       %%ymm4, %%ymm0               \n\t"
+        "add        %[stride], %[src]               \n\t"
+        "add        %[stride], %[dst]               \n\t"
+        "sub               $1, %[n]                 \n\t"
+        "jg                1b                       \n\t"
+        "vmovupd       %%ymm0,   (%[s])             \n\t"
+        "vmovupd       %%ymm1, 32(%[s])             \n\t"
+        "vmovupd       %%ymm2, 64(%[s])             \n\t"
+        "vmovupd       %%ymm3, 96(%[s])             \n\t"
+        "vzeroupper                                 \n\t"
+        : [src]"+&r"(src), [dst]"+&r"(dst), [n]"+&r"(n)
+        : [s]"r"(s), [c]"r"(c), [stride]"r"(stride)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                       "%xmm4", "%xmm5", "%xmm6",)
+          "memory"
+    );
+}
+
+static void filter_avx(double *dst, const double *src, double *v,
+                       const double *coeffs, int channels, int frames)
+{
+    DECLARE_ALIGNED(32, double, c)[9][4];
+    DECLARE_ALIGNED(32, double, s)[4][4];
+    const x86_reg stride = channels * sizeof(*src);
+    int ch;
+
+    if (frames <= 0)
+        return;
+
+    splat_coeffs(c, coeffs);
+    for (ch = 0; ch + 4 <= channels; ch += 4) {
+        load_state(s, v, channels, ch, 4);
+        filter_group_avx(dst + ch, src + ch, s, c, stride, frames);
+        store_state(v, s, channels, ch, 4);
+    }
+    filter_channels_sse2(dst, src, v, c, channels, ch, frames);
+}
+#endif /* ARCH_X86_64 && HAVE_SSE2_INLINE && HAVE_AVX_INLINE */
+
+av_cold void ff_ebur128_init_dsp_x86(FFEBUR128DSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags))
+        dsp->filter = filter_sse2;
+#endif
+#if ARCH_X86_64 && HAVE_SSE2_INLINE && HAVE_AVX_INLINE
+    if (INLINE_AVX(cpu_flags))
+        dsp->filter = filter_avx;
+#endif
+}
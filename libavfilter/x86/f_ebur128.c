@@ -0,0 +1,385 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/f_ebur128.h"
+
+/*
+ * The K-weighting filter is recursive in time, so the channels are filtered
+ * in parallel instead, one per vector lane. The true-peak interpolator
+ * computes the 4 phases of an input sample in one vector.
+ * Products and sums are rounded separately and in the same order as in C,
+ * so the output of both is identical to it.
+ */
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+
+/* each coefficient is repeated over a full ymm register */
+static const DECLARE_ALIGNED(32, double, filter_coeffs)[10][4] = {
+    { PRE_B0, PRE_B0, PRE_B0, PRE_B0 },
+    { PRE_B1, PRE_B1, PRE_B1, PRE_B1 },
+    { PRE_B2, PRE_B2, PRE_B2, PRE_B2 },
+    { PRE_A1, PRE_A1, PRE_A1, PRE_A1 },
+    { PRE_A2, PRE_A2, PRE_A2, PRE_A2 },
+    { RLB_B0, RLB_B0, RLB_B0, RLB_B0 },
+    { RLB_B1, RLB_B1, RLB_B1, RLB_B1 },
+    { RLB_B2, RLB_B2, RLB_B2, RLB_B2 },
+    { RLB_A1, RLB_A1, RLB_A1, RLB_A1 },
+    { RLB_A2, RLB_A2, RLB_A2, RLB_A2 },
+};
+
+static const DECLARE_ALIGNED(32, uint64_t, abs_mask)[4] = {
+    UINT64_C(0x7fffffffffffffff), UINT64_C(0x7fffffffffffffff),
+    UINT64_C(0x7fffffffffffffff), UINT64_C(0x7fffffffffffffff),
+};
+
+static void load_state(double (*s)[4], const double *state,
+                       int nb_channels, int ch, int nb)
+{
+    int i, j;
+
+    for (i = 0; i < EBUR128_FILTER_STATE; i++)
+        for (j = 0; j < nb; j++)
+            s[i][j] = state[i * nb_channels + ch + j];
+}
+
+static void store_state(double *state, double (*s)[4],
+                        int nb_channels, int ch, int nb)
+{
+    int i, j;
+
+    for (i = 0; i < EBUR128_FILTER_STATE; i++)
+        for (j = 0; j < nb; j++)
+            state[i * nb_channels + ch + j] = s[i][j];
+}
+
+/* xmm0-xmm5: X[i-1], X[i-2], Y[i-1], Y[i-2], Z[i-1], Z[i-2] */
+#define FILTER_GROUP_SSE2(name, mov, op)                                        \
+static void filter_group_##name(double *dst, const double *src,                 \
+                                double (*s)[4], x86_reg stride, x86_reg n)      \
+{                                                                               \
+    __asm__ volatile (                                                          \
+        mov"         (%[s]), %%xmm0                 \n\t"                       \
+        mov"       32(%[s]), %%xmm1                 \n\t"                       \
+        mov"       64(%[s]), %%xmm2                 \n\t"                       \
+        mov"       96(%[s]), %%xmm3                 \n\t"                       \
+        mov"      128(%[s]), %%xmm4                 \n\t"                       \
+        mov"      160(%[s]), %%xmm5                 \n\t"                       \
+        "1:                                         \n\t"                       \
+        mov"       (%[src]), %%xmm6                 \n\t"                       \
+        "movapd       %%xmm6, %%xmm7                \n\t"                       \
+        "mul"op"     (%[c]), %%xmm7                 \n\t"                       \
+        "movapd       %%xmm0, %%xmm9                \n\t"                       \
+        "mul"op"   32(%[c]), %%xmm9                 \n\t"                       \
+        "add"op"      %%xmm9, %%xmm7                \n\t"                       \
+        "movapd       %%xmm1, %%xmm9                \n\t"                       \
+        "mul"op"   64(%[c]), %%xmm9                 \n\t"                       \
+        "add"op"      %%xmm9, %%xmm7                \n\t"                       \
+        "movapd       %%xmm2, %%xmm9                \n\t"                       \
+        "mul"op"   96(%[c]), %%xmm9                 \n\t"                       \
+        "sub"op"      %%xmm9, %%xmm7                \n\t"                       \
+        "movapd       %%xmm3, %%xmm9                \n\t"                       \
+        "mul"op"  128(%[c]), %%xmm9                 \n\t"                       \
+        "sub"op"      %%xmm9, %%xmm7                \n\t"                       \
+        "movapd       %%xmm7, %%xmm8                \n\t"                       \
+        "mul"op"  160(%[c]), %%xmm8                 \n\t"                       \
+        "movapd       %%xmm2, %%xmm9                \n\t"                       \
+        "mul"op"  192(%[c]), %%xmm9                 \n\t"                       \
+        "add"op"      %%xmm9, %%xmm8                \n\t"                       \
+        "movapd       %%xmm3, %%xmm9                \n\t"                       \
+        "mul"op"  224(%[c]), %%xmm9                 \n\t"                       \
+        "add"op"      %%xmm9, %%xmm8                \n\t"                       \
+        "movapd       %%xmm4, %%xmm9                \n\t"                       \
+        "mul"op"  256(%[c]), %%xmm9                 \n\t"                       \
+        "sub"op"      %%xmm9, %%xmm8                \n\t"                       \
+        "movapd       %%xmm5, %%xmm9                \n\t"                       \
+        "mul"op"  288(%[c]), %%xmm9                 \n\t"                       \
+        "sub"op"      %%xmm9, %%xmm8                \n\t"                       \
+        mov"          %%xmm8, (%[dst])              \n\t"                       \
+        "movapd       %%xmm0, %%xmm1                \n\t"                       \
+        "movapd       %%xmm6, %%xmm0                \n\t"                       \
+        "movapd       %%xmm2, %%xmm3                \n\t"                       \
+        "movapd       %%xmm7, %%xmm2                \n\t"                       \
+        "movapd       %%xmm4, %%xmm5                \n\t"                       \
+        "movapd       %%xmm8, %%xmm4                \n\t"                       \
+        "add       %[stride], %[src]                \n\t"                       \
+        "add       %[stride], %[dst]                \n\t"                       \
+        "sub              $1, %[n]                  \n\t"                       \
+        "jg               1b                        \n\t"                       \
+        mov"          %%xmm0,    (%[s])             \n\t"                       \
+        mov"          %%xmm1,  32(%[s])             \n\t"                       \
+        mov"          %%xmm2,  64(%[s])             \n\t"                       \
+        mov"          %%xmm3,  96(%[s])             \n\t"                       \
+        mov"          %%xmm4, 128(%[s])             \n\t"                       \
+        mov"          %%xmm5, 160(%[s])             \n\t"                       \
+        : [src]"+&r"(src), [dst]"+&r"(dst), [n]"+&r"(n)                         \
+        : [s]"r"(s), [c]"r"(filter_coeffs), [stride]"r"(stride)                 \
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",             \
+                       "%xmm5", "%xmm6", "%xmm7", "%xmm8", "%xmm9",)            \
+          "memory"                                                              \
+    );                                                                          \
+}
+
+FILTER_GROUP_SSE2(pd_sse2, "movupd", "pd")
+FILTER_GROUP_SSE2(sd_sse2, "movsd",  "sd")
+
+/* filter the channels from ch on, two at a time */
+static void filter_channels_sse2(double *dst, const double *src, double *state,
+                                 int nb_channels, int ch, int nb_samples)
+{
+    DECLARE_ALIGNED(32, double, s)[EBUR128_FILTER_STATE][4];
+    const x86_reg stride = nb_channels * sizeof(*src);
+
+    if (nb_samples <= 0)
+        return;
+
+    for (; ch + 2 <= nb_channels; ch += 2) {
+        load_state(s, state, nb_channels, ch, 2);
+        filter_group_pd_sse2(dst + ch, src + ch, s, stride, nb_samples);
+        store_state(state, s, nb_channels, ch, 2);
+    }
+    if (ch < nb_channels) {
+        load_state(s, state, nb_channels, ch, 1);
+        filter_group_sd_sse2(dst + ch, src + ch, s, stride, nb_samples);
+        store_state(state, s, nb_channels, ch, 1);
+    }
+}
+
+static void filter_sse2(double *dst, const double *src, double *state,
+                        int nb_channels, int nb_samples)
+{
+    filter_channels_sse2(dst, src, state, nb_channels, 0, nb_samples);
+}
+
+/* xmm0: phases 0 and 1, xmm1: phases 2 and 3, xmm5: running maximum */
+static double true_peak_sse2(const double *src, ptrdiff_t stride, int nb_samples)
+{
+    x86_reg n = nb_samples, k;
+    const x86_reg bstride = stride * sizeof(*src);
+    const double *p;
+    double peak;
+
+    if (nb_samples <= 0)
+        return 0.0;
+
+    __asm__ volatile (
+        "xorpd          %%xmm5, %%xmm5              \n\t"
+        "movapd       %[mask], %%xmm4               \n\t"
+        "1:                                         \n\t"
+        "mov            %[src], %[p]                \n\t"
+        "movsd          (%[p]), %%xmm2              \n\t"
+        "unpcklpd       %%xmm2, %%xmm2              \n\t"
+        "movapd         %%xmm2, %%xmm0              \n\t"
+        "mulpd          (%[c]), %%xmm0              \n\t"
+        "mulpd        16(%[c]), %%xmm2              \n\t"
+        "movapd         %%xmm2, %%xmm1              \n\t"
+        "mov               $32, %[k]                \n\t"
+        "2:                                         \n\t"
+        "sub         %[stride], %[p]                \n\t"
+        "movsd          (%[p]), %%xmm2              \n\t"
+        "unpcklpd       %%xmm2, %%xmm2              \n\t"
+        "movapd         %%xmm2, %%xmm3              \n\t"
+        "mulpd   (%[c], %[k]), %%xmm3               \n\t"
+        "mulpd 16(%[c], %[k]), %%xmm2               \n\t"
+        "addpd          %%xmm3, %%xmm0              \n\t"
+        "addpd          %%xmm2, %%xmm1              \n\t"
+        "add               $32, %[k]                \n\t"
+        "cmp       %[end], %[k]                     \n\t"
+        "jl                 2b                      \n\t"
+        "andpd          %%xmm4, %%xmm0              \n\t"
+        "andpd          %%xmm4, %%xmm1              \n\t"
+        "maxpd          %%xmm0, %%xmm5              \n\t"
+        "maxpd          %%xmm1, %%xmm5              \n\t"
+        "add         %[stride], %[src]              \n\t"
+        "sub                $1, %[n]                \n\t"
+        "jg                 1b                      \n\t"
+        "movhlps        %%xmm5, %%xmm0              \n\t"
+        "maxsd          %%xmm0, %%xmm5              \n\t"
+        "movsd          %%xmm5, %[peak]             \n\t"
+        : [src]"+&r"(src), [n]"+&r"(n), [p]"=&r"(p), [k]"=&r"(k),
+          [peak]"=m"(peak)
+        : [c]"r"(ff_ebur128_tp_coeffs), [stride]"r"(bstride),
+          [end]"i"(EBUR128_TP_TAPS * EBUR128_TP_PHASES * sizeof(double)),
+          [mask]"m"(abs_mask)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5",)
+          "memory"
+    );
+
+    return peak;
+}
+#endif /* ARCH_X86_64 && HAVE_SSE2_INLINE */
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE && HAVE_AVX_INLINE
+/* ymm0-ymm5: X[i-1], X[i-2], Y[i-1], Y[i-2], Z[i-1], Z[i-2] */
+static void filter_group_avx(double *dst, const double *src,
+                             double (*s)[4], x86_reg stride, x86_reg n)
+{
+    __asm__ volatile (
+        "vmovupd         (%[s]), %%ymm0             \n\t"
+        "vmovupd       32(%[s]), %%ymm1             \n\t"
+        "vmovupd       64(%[s]), %%ymm2             \n\t"
+        "vmovupd       96(%[s]), %%ymm3             \n\t"
+        "vmovupd      128(%[s]), %%ymm4             \n\t"
+        "vmovupd      160(%[s]), %%ymm5             \n\t"
+        "1:                                         \n\t"
+        "vmovupd       (%[src]), %%ymm6             \n\t"
+        "vmulpd      (%[c]), %%ymm6, %%ymm7         \n\t"
+        "vmulpd    32(%[c]), %%ymm0, %%ymm9         \n\t"
+        "vaddpd      %%ymm9, %%ymm7, %%ymm7         \n\t"
+        "vmulpd    64(%[c]), %%ymm1, %%ymm9         \n\t"
+        "vaddpd      %%ymm9, %%ymm7, %%ymm7         \n\t"
+        "vmulpd    96(%[c]), %%ymm2, %%ymm9         \n\t"
+        "vsubpd      %%ymm9, %%ymm7, %%ymm7         \n\t"
+        "vmulpd   128(%[c]), %%ymm3, %%ymm9         \n\t"
+        "vsubpd      %%ymm9, %%ymm7, %%ymm7         \n\t"
+        "vmulpd   160(%[c]), %%ymm7, %%ymm8         \n\t"
+        "vmulpd   192(%[c]), %%ymm2, %%ymm9         \n\t"
+        "vaddpd      %%ymm9, %%ymm8, %%ymm8         \n\t"
+        "vmulpd   224(%[c]), %%ymm3, %%ymm9         \n\t"
+        "vaddpd      %%ymm9, %%ymm8, %%ymm8         \n\t"
+        "vmulpd   256(%[c]), %%ymm4, %%ymm9         \n\t"
+        "vsubpd      %%ymm9, %%ymm8, %%ymm8         \n\t"
+        "vmulpd   288(%[c]), %%ymm5, %%ymm9         \n\t"
+        "vsubpd      %%ymm9, %%ymm8, %%ymm8         \n\t"
+        "vmovupd       %%ymm8, (%[dst])             \n\t"
+        "vmovapd       %%ymm0, %%ymm1               \n\t"
+        "vmovapd       %%ymm6, %%ymm0               \n\t"
+        "vmovapd       %%ymm2, %%ymm3               \n\t"
+        "vmovapd       %%ymm7, %%ymm2               \n\t"
+        "vmovapd       %%ymm4, %%ymm5               \n\t"
+        "vmovapd       %%ymm8, %%ymm4               \n\t"
+        "add        %[stride], %[src]               \n\t"
+        "add        %[stride], %[dst]               \n\t"
+        "sub               $1, %[n]                 \n\t"
+        "jg                1b                       \n\t"
+        "vmovupd       %%ymm0,    (%[s])            \n\t"
+        "vmovupd       %%ymm1,  32(%[s])            \n\t"
+        "vmovupd       %%ymm2,  64(%[s])            \n\t"
+        "vmovupd       %%ymm3,  96(%[s])            \n\t"
+        "vmovupd       %%ymm4, 128(%[s])            \n\t"
+        "vmovupd       %%ymm5, 160(%[s])            \n\t"
+        "vzeroupper                                 \n\t"
+        : [src]"+&r"(src), [dst]"+&r"(dst), [n]"+&r"(n)
+        : [s]"r"(s), [c]"r"(filter_coeffs), [stride]"r"(stride)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",
+                       "%xmm5", "%xmm6", "%xmm7", "%xmm8", "%xmm9",)
+          "memory"
+    );
+}
+
+static void filter_avx(double *dst, const double *src, double *state,
+                       int nb_channels, int nb_samples)
+{
+    DECLARE_ALIGNED(32, double, s)[EBUR128_FILTER_STATE][4];
+    const x86_reg stride = nb_channels * sizeof(*src);
+    int ch;
+
+    if (nb_samples <= 0)
+        return;
+
+    for (ch = 0; ch + 4 <= nb_channels; ch += 4) {
+        load_state(s, state, nb_channels, ch, 4);
+        filter_group_avx(dst + ch, src + ch, s, stride, nb_samples);
+        store_state(state, s, nb_channels, ch, 4);
+    }
+    filter_channels_sse2(dst, src, state, nb_channels, ch, nb_samples);
+}
+
+/* two input samples per iteration, each one with its 4 phases in a ymm */
+static double true_peak_avx(const double *src, ptrdiff_t stride, int nb_samples)
+{
+    x86_reg n = nb_samples & ~1, k;
+    const x86_reg bstride = stride * sizeof(*src);
+    const double *p;
+    double peak = 0.0;
+
+    if (n) {
+        __asm__ volatile (
+            "vxorpd      %%ymm5, %%ymm5, %%ymm5         \n\t"
+            "vmovapd    %[mask], %%ymm4                 \n\t"
+            "1:                                         \n\t"
+            "mov          %[src], %[p]                  \n\t"
+            "vbroadcastsd             (%[p]), %%ymm2    \n\t"
+            "vbroadcastsd (%[p], %[stride]), %%ymm3     \n\t"
+            "vmulpd       (%[c]), %%ymm2, %%ymm0        \n\t"
+            "vmulpd       (%[c]), %%ymm3, %%ymm1        \n\t"
+            "mov             $32, %[k]                  \n\t"
+            "2:                                         \n\t"
+            "sub       %[stride], %[p]                  \n\t"
+            "vbroadcastsd             (%[p]), %%ymm2    \n\t"
+            "vbroadcastsd (%[p], %[stride]), %%ymm3     \n\t"
+            "vmulpd (%[c], %[k]), %%ymm2, %%ymm2        \n\t"
+            "vmulpd (%[c], %[k]), %%ymm3, %%ymm3        \n\t"
+            "vaddpd       %%ymm2, %%ymm0, %%ymm0        \n\t"
+            "vaddpd       %%ymm3, %%ymm1, %%ymm1        \n\t"
+            "add             $32, %[k]                  \n\t"
+            "cmp          %[end], %[k]                  \n\t"
+            "jl               2b                        \n\t"
+            "vandpd       %%ymm4, %%ymm0, %%ymm0        \n\t"
+            "vandpd       %%ymm4, %%ymm1, %%ymm1        \n\t"
+            "vmaxpd       %%ymm0, %%ymm5, %%ymm5        \n\t"
+            "vmaxpd       %%ymm1, %%ymm5, %%ymm5        \n\t"
+            "lea (%[src], %[stride], 2), %[src]         \n\t"
+            "sub              $2, %[n]                  \n\t"
+            "jg               1b                        \n\t"
+            "vextractf128 $1, %%ymm5, %%xmm0            \n\t"
+            "vmaxpd       %%xmm0, %%xmm5, %%xmm5        \n\t"
+            "vunpckhpd    %%xmm5, %%xmm5, %%xmm0        \n\t"
+            "vmaxsd       %%xmm0, %%xmm5, %%xmm5        \n\t"
+            "vmovsd       %%xmm5, %[peak]               \n\t"
+            "vzeroupper                                 \n\t"
+            : [src]"+&r"(src), [n]"+&r"(n), [p]"=&r"(p), [k]"=&r"(k),
+              [peak]"=m"(peak)
+            : [c]"r"(ff_ebur128_tp_coeffs), [stride]"r"(bstride),
+              [end]"i"(EBUR128_TP_TAPS * EBUR128_TP_PHASES * sizeof(double)),
+              [mask]"m"(abs_mask)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5",)
+              "memory"
+        );
+    }
+    if (nb_samples & 1)
+        peak = FFMAX(peak, true_peak_sse2(src, stride, 1));
+
+    return peak;
+}
+#endif /* ARCH_X86_64 && HAVE_SSE2_INLINE && HAVE_AVX_INLINE */
+
+av_cold void ff_ebur128_filter_init_x86(EBUR128DSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        dsp->filter    = filter_sse2;
+        dsp->true_peak = true_peak_sse2;
+    }
+#endif
+#if ARCH_X86_64 && HAVE_SSE2_INLINE && HAVE_AVX_INLINE
+    if (INLINE_AVX(cpu_flags)) {
+        dsp->filter    = filter_avx;
+        dsp->true_peak = true_peak_avx;
+    }
+#endif
+}
@@ -0,0 +1,205 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/lut3d.h"
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+
+/* Sort the (d, offset) pairs of two axes so that the larger d comes first.
+ * Equal fractions may come out in either order, which does not change the
+ * result since their weight difference is then zero. */
+#define SORT_PAIR(da, db, oa, ob)                                       \
+    "vcmpltps   %%ymm"#db", %%ymm"#da", %%ymm9                  \n\t"   \
+    "vmaxps     %%ymm"#db", %%ymm"#da", %%ymm10                 \n\t"   \
+    "vminps     %%ymm"#db", %%ymm"#da", %%ymm"#db"              \n\t"   \
+    "vmovaps    %%ymm10, %%ymm"#da"                             \n\t"   \
+    "vblendvps  %%ymm9, %%ymm"#ob", %%ymm"#oa", %%ymm10         \n\t"   \
+    "vblendvps  %%ymm9, %%ymm"#oa", %%ymm"#ob", %%ymm"#ob"      \n\t"   \
+    "vmovaps    %%ymm10, %%ymm"#oa"                             \n\t"
+
+/* Accumulate one channel of the 4 vertices in the same order as the C
+ * code: ((w0 * c000 + w1 * cA) + w2 * cB) + w3 * c111. */
+#define CHANNEL(off)                                                    \
+    "vpcmpeqd   %%ymm9, %%ymm9, %%ymm9                          \n\t"   \
+    "vgatherdps %%ymm9, "#off"(%[lut], %%ymm3, 4), %%ymm7       \n\t"   \
+    "vmulps     %%ymm0, %%ymm7, %%ymm7                          \n\t"   \
+    "vpcmpeqd   %%ymm9, %%ymm9, %%ymm9                          \n\t"   \
+    "vgatherdps %%ymm9, "#off"(%[lut], %%ymm5, 4), %%ymm10      \n\t"   \
+    "vmulps     %%ymm1, %%ymm10, %%ymm10                        \n\t"   \
+    "vaddps     %%ymm10, %%ymm7, %%ymm7                         \n\t"   \
+    "vpcmpeqd   %%ymm9, %%ymm9, %%ymm9                          \n\t"   \
+    "vgatherdps %%ymm9, "#off"(%[lut], %%ymm6, 4), %%ymm10      \n\t"   \
+    "vmulps     %%ymm8, %%ymm10, %%ymm10                        \n\t"   \
+    "vaddps     %%ymm10, %%ymm7, %%ymm7                         \n\t"   \
+    "vpcmpeqd   %%ymm9, %%ymm9, %%ymm9                          \n\t"   \
+    "vgatherdps %%ymm9, "#off"(%[lut], %%ymm4, 4), %%ymm10      \n\t"   \
+    "vmulps     %%ymm2, %%ymm10, %%ymm10                        \n\t"   \
+    "vaddps     %%ymm10, %%ymm7, %%ymm7                         \n\t"   \
+    "vmulps     %%ymm12, %%ymm7, %%ymm7                         \n\t"   \
+    "vcvttps2dq %%ymm7, %%ymm7                                  \n\t"   \
+    "vpxor      %%ymm10, %%ymm10, %%ymm10                       \n\t"   \
+    "vpmaxsd    %%ymm10, %%ymm7, %%ymm7                         \n\t"   \
+    "vpminsd    %%ymm11, %%ymm7, %%ymm7                         \n\t"   \
+    "vextracti128 $1, %%ymm7, %%xmm10                           \n\t"   \
+    "vpackusdw  %%xmm10, %%xmm7, %%xmm7                         \n\t"
+
+#define STORE_8(dst)                                                    \
+    "vpackuswb  %%xmm7, %%xmm7, %%xmm7                          \n\t"   \
+    "vmovq      %%xmm7, (%["#dst"], %[x])                       \n\t"
+
+#define STORE_16(dst)                                                   \
+    "vmovdqu    %%xmm7, (%["#dst"], %[x], 2)                    \n\t"
+
+#define LOAD_8(src, reg)                                                \
+    "vpmovzxbd  (%["#src"], %[x]), %%ymm"#reg"                  \n\t"
+
+#define LOAD_16(src, reg)                                               \
+    "vpmovzxwd  (%["#src"], %[x], 2), %%ymm"#reg"               \n\t"
+
+#define DEFINE_INTERP_LINE(nbits)                                                   \
+static void interp_tetrahedral_line_##nbits##_avx2(const LUT3DContext *lut3d,       \
+                                                  uint8_t *dstr, uint8_t *dstg,     \
+                                                  uint8_t *dstb,                    \
+                                                  const uint8_t *srcr,              \
+                                                  const uint8_t *srcg,              \
+                                                  const uint8_t *srcb,              \
+                                                  int w, int depth)                 \
+{                                                                                   \
+    const float scale  = (1. / ((1<<depth) - 1)) * (lut3d->lutsize - 1);            \
+    const float maxf   = (1 << depth) - 1;                                          \
+    const float one_f  = 1;                                                         \
+    const int   maxval = (1 << depth) - 1;                                          \
+    const int   lutmax = lut3d->lutsize - 1;                                        \
+    const int   one    = 1;                                                         \
+    x86_reg x = 0, width = w;                                                       \
+                                                                                    \
+    __asm__ volatile (                                                              \
+        "vbroadcastss  %[scale],  %%ymm15                       \n\t"               \
+        "vpbroadcastd  %[one],    %%ymm14                       \n\t"               \
+        "vpbroadcastd  %[lutmax], %%ymm13                       \n\t"               \
+        "vbroadcastss  %[maxf],   %%ymm12                       \n\t"               \
+        "vpbroadcastd  %[maxval], %%ymm11                       \n\t"               \
+        "1:                                                     \n\t"               \
+        LOAD_##nbits(srcr, 0)                                                       \
+        LOAD_##nbits(srcg, 1)                                                       \
+        LOAD_##nbits(srcb, 2)                                                       \
+        "vcvtdq2ps  %%ymm0, %%ymm0                              \n\t"               \
+        "vcvtdq2ps  %%ymm1, %%ymm1                              \n\t"               \
+        "vcvtdq2ps  %%ymm2, %%ymm2                              \n\t"               \
+        "vmulps     %%ymm15, %%ymm0, %%ymm0                     \n\t"               \
+        "vmulps     %%ymm15, %%ymm1, %%ymm1                     \n\t"               \
+        "vmulps     %%ymm15, %%ymm2, %%ymm2                     \n\t"               \
+        /* prev in ymm3-5, fractional parts in ymm0-2 */                            \
+        "vcvttps2dq %%ymm0, %%ymm3                              \n\t"               \
+        "vcvttps2dq %%ymm1, %%ymm4                              \n\t"               \
+        "vcvttps2dq %%ymm2, %%ymm5                              \n\t"               \
+        "vcvtdq2ps  %%ymm3, %%ymm6                              \n\t"               \
+        "vcvtdq2ps  %%ymm4, %%ymm7                              \n\t"               \
+        "vcvtdq2ps  %%ymm5, %%ymm8                              \n\t"               \
+        "vsubps     %%ymm6, %%ymm0, %%ymm0                      \n\t"               \
+        "vsubps     %%ymm7, %%ymm1, %%ymm1                      \n\t"               \
+        "vsubps     %%ymm8, %%ymm2, %%ymm2                      \n\t"               \
+        /* next - prev, as offsets in the 64x64x64 LUT, in ymm6-8 */                \
+        "vpaddd     %%ymm14, %%ymm3, %%ymm6                     \n\t"               \
+        "vpaddd     %%ymm14, %%ymm4, %%ymm7                     \n\t"               \
+        "vpaddd     %%ymm14, %%ymm5, %%ymm8                     \n\t"               \
+        "vpminsd    %%ymm13, %%ymm6, %%ymm6                     \n\t"               \
+        "vpminsd    %%ymm13, %%ymm7, %%ymm7                     \n\t"               \
+        "vpminsd    %%ymm13, %%ymm8, %%ymm8                     \n\t"               \
+        "vpsubd     %%ymm3, %%ymm6, %%ymm6                      \n\t"               \
+        "vpsubd     %%ymm4, %%ymm7, %%ymm7                      \n\t"               \
+        "vpsubd     %%ymm5, %%ymm8, %%ymm8                      \n\t"               \
+        "vpslld     $12, %%ymm6, %%ymm6                         \n\t"               \
+        "vpslld      $6, %%ymm7, %%ymm7                         \n\t"               \
+        /* c000 in ymm3, c111 in ymm4 */                                            \
+        "vpslld     $12, %%ymm3, %%ymm3                         \n\t"               \
+        "vpslld      $6, %%ymm4, %%ymm4                         \n\t"               \
+        "vpaddd     %%ymm4, %%ymm3, %%ymm3                      \n\t"               \
+        "vpaddd     %%ymm5, %%ymm3, %%ymm3                      \n\t"               \
+        "vpaddd     %%ymm6, %%ymm3, %%ymm4                      \n\t"               \
+        "vpaddd     %%ymm7, %%ymm4, %%ymm4                      \n\t"               \
+        "vpaddd     %%ymm8, %%ymm4, %%ymm4                      \n\t"               \
+        SORT_PAIR(0, 1, 6, 7)                                                       \
+        SORT_PAIR(1, 2, 7, 8)                                                       \
+        SORT_PAIR(0, 1, 6, 7)                                                       \
+        /* the two intermediate vertices in ymm5 and ymm6 */                        \
+        "vpaddd     %%ymm6, %%ymm3, %%ymm5                      \n\t"               \
+        "vpaddd     %%ymm7, %%ymm5, %%ymm6                      \n\t"               \
+        /* scale the indices to rgbvec units */                                     \
+        "vpaddd     %%ymm3, %%ymm3, %%ymm7                      \n\t"               \
+        "vpaddd     %%ymm7, %%ymm3, %%ymm3                      \n\t"               \
+        "vpaddd     %%ymm4, %%ymm4, %%ymm7                      \n\t"               \
+        "vpaddd     %%ymm7, %%ymm4, %%ymm4                      \n\t"               \
+        "vpaddd     %%ymm5, %%ymm5, %%ymm7                      \n\t"               \
+        "vpaddd     %%ymm7, %%ymm5, %%ymm5                      \n\t"               \
+        "vpaddd     %%ymm6, %%ymm6, %%ymm7                      \n\t"               \
+        "vpaddd     %%ymm7, %%ymm6, %%ymm6                      \n\t"               \
+        /* weights: 1 - dmax, dmax - dmid, dmid - dmin, dmin */                     \
+        "vbroadcastss %[one_f], %%ymm9                          \n\t"               \
+        "vsubps     %%ymm2, %%ymm1, %%ymm8                      \n\t"               \
+        "vsubps     %%ymm1, %%ymm0, %%ymm1                      \n\t"               \
+        "vsubps     %%ymm0, %%ymm9, %%ymm0                      \n\t"               \
+        CHANNEL(0)                                                                  \
+        STORE_##nbits(dstr)                                                         \
+        CHANNEL(4)                                                                  \
+        STORE_##nbits(dstg)                                                         \
+        CHANNEL(8)                                                                  \
+        STORE_##nbits(dstb)                                                         \
+        "add        $8, %[x]                                    \n\t"               \
+        "cmp        %[w], %[x]                                  \n\t"               \
+        "jl         1b                                          \n\t"               \
+        "vzeroupper                                             \n\t"               \
+        : [x]"+r"(x)                                                                \
+        : [dstr]"r"(dstr), [dstg]"r"(dstg), [dstb]"r"(dstb),                        \
+          [srcr]"r"(srcr), [srcg]"r"(srcg), [srcb]"r"(srcb),                        \
+          [lut]"r"(lut3d->lut), [w]"r"(width),                                      \
+          [scale]"m"(scale), [maxf]"m"(maxf), [one_f]"m"(one_f),                    \
+          [maxval]"m"(maxval), [lutmax]"m"(lutmax), [one]"m"(one)                   \
+        : XMM_CLOBBERS("%xmm0",  "%xmm1",  "%xmm2",  "%xmm3",                       \
+                       "%xmm4",  "%xmm5",  "%xmm6",  "%xmm7",                       \
+                       "%xmm8",  "%xmm9",  "%xmm10", "%xmm11",                      \
+                       "%xmm12", "%xmm13", "%xmm14", "%xmm15",)                     \
+          "memory"                                                                  \
+    );                                                                              \
+}
+
+DEFINE_INTERP_LINE(8)
+DEFINE_INTERP_LINE(16)
+
+#endif /* ARCH_X86_64 && HAVE_AVX2_INLINE */
+
+av_cold void ff_lut3d_init_x86(LUT3DContext *s, const AVPixFmtDescriptor *desc)
+{
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+    int cpu_flags = av_get_cpu_flags();
+    const int planar_rgb = (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
+                           (desc->flags & AV_PIX_FMT_FLAG_RGB);
+
+    if (INLINE_AVX2(cpu_flags) && planar_rgb &&
+        s->interpolation == INTERPOLATE_TETRAHEDRAL) {
+        if (desc->comp[0].depth == 8)
+            s->interp_line = interp_tetrahedral_line_8_avx2;
+        else
+            s->interp_line = interp_tetrahedral_line_16_avx2;
+    }
+#endif
+}
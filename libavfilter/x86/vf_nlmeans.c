@@ -0,0 +1,193 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_nlmeans.h"
+
+#if HAVE_SSE2_INLINE
+/* Prefix sum of the 4 dwords of reg, using tmp. */
+#define PREFIX_SUM(reg, tmp)                            \
+    "movdqa       %%"reg", %%"tmp"              \n\t"   \
+    "pslldq          $4, %%"tmp"                \n\t"   \
+    "paddd        %%"tmp", %%"reg"              \n\t"   \
+    "movdqa       %%"reg", %%"tmp"              \n\t"   \
+    "pslldq          $8, %%"tmp"                \n\t"   \
+    "paddd        %%"tmp", %%"reg"              \n\t"
+
+static void compute_safe_ssd_integral_image_sse2(uint32_t *dst, ptrdiff_t dst_linesize_32,
+                                                 const uint8_t *s1, ptrdiff_t linesize1,
+                                                 const uint8_t *s2, ptrdiff_t linesize2,
+                                                 int w, int h)
+{
+    x86_reg x, w4 = w, w8 = w & ~7;
+    int y;
+
+    for (y = 0; y < h; y++) {
+        const uint32_t *dst_top = dst - dst_linesize_32;
+        uint32_t acc = dst[-1] - dst_top[-1];
+
+        /* xmm7 holds the running sum of the line in all of its dwords */
+        __asm__ volatile (
+            "movd             %[acc], %%xmm7            \n\t"
+            "pshufd       $0, %%xmm7, %%xmm7            \n\t"
+            "pxor             %%xmm6, %%xmm6            \n\t"
+            "xor                %[x], %[x]              \n\t"
+            "cmp               %[w8], %[x]              \n\t"
+            "jge                  2f                    \n\t"
+            "1:                                         \n\t"
+            "movq     (%[s1], %[x]), %%xmm0             \n\t"
+            "movq     (%[s2], %[x]), %%xmm1             \n\t"
+            "punpcklbw        %%xmm6, %%xmm0            \n\t"
+            "punpcklbw        %%xmm6, %%xmm1            \n\t"
+            "psubw            %%xmm1, %%xmm0            \n\t"
+            /* d * d fits in an unsigned word */
+            "pmullw           %%xmm0, %%xmm0            \n\t"
+            "movdqa           %%xmm0, %%xmm1            \n\t"
+            "punpcklwd        %%xmm6, %%xmm0            \n\t"
+            "punpckhwd        %%xmm6, %%xmm1            \n\t"
+            PREFIX_SUM("xmm0", "xmm2")
+            PREFIX_SUM("xmm1", "xmm3")
+            "paddd            %%xmm7, %%xmm0            \n\t"
+            "pshufd   $0xFF, %%xmm0, %%xmm7             \n\t"
+            "paddd            %%xmm7, %%xmm1            \n\t"
+            "pshufd   $0xFF, %%xmm1, %%xmm7             \n\t"
+            "movdqu   (%[top], %[x], 4), %%xmm2         \n\t"
+            "movdqu 16(%[top], %[x], 4), %%xmm3         \n\t"
+            "paddd            %%xmm2, %%xmm0            \n\t"
+            "paddd            %%xmm3, %%xmm1            \n\t"
+            "movdqu           %%xmm0,   (%[dst], %[x], 4)\n\t"
+            "movdqu           %%xmm1, 16(%[dst], %[x], 4)\n\t"
+            "add                  $8, %[x]              \n\t"
+            "cmp               %[w8], %[x]              \n\t"
+            "jl                   1b                    \n\t"
+            "2:                                         \n\t"
+            "cmp               %[w4], %[x]              \n\t"
+            "jge                  3f                    \n\t"
+            "movd     (%[s1], %[x]), %%xmm0             \n\t"
+            "movd     (%[s2], %[x]), %%xmm1             \n\t"
+            "punpcklbw        %%xmm6, %%xmm0            \n\t"
+            "punpcklbw        %%xmm6, %%xmm1            \n\t"
+            "psubw            %%xmm1, %%xmm0            \n\t"
+            "pmullw           %%xmm0, %%xmm0            \n\t"
+            "punpcklwd        %%xmm6, %%xmm0            \n\t"
+            PREFIX_SUM("xmm0", "xmm2")
+            "paddd            %%xmm7, %%xmm0            \n\t"
+            "movdqu   (%[top], %[x], 4), %%xmm2         \n\t"
+            "paddd            %%xmm2, %%xmm0            \n\t"
+            "movdqu           %%xmm0, (%[dst], %[x], 4) \n\t"
+            "3:                                         \n\t"
+            : [x]"=&r"(x)
+            : [acc]"m"(acc), [s1]"r"(s1), [s2]"r"(s2), [dst]"r"(dst),
+              [top]"r"(dst_top), [w4]"m"(w4), [w8]"m"(w8)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                           "%xmm6", "%xmm7",)
+              "memory"
+        );
+
+        s1  += linesize1;
+        s2  += linesize2;
+        dst += dst_linesize_32;
+    }
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+/* The patches above the meaningful difference get a zero weight from the
+ * masked gather, and adding zero leaves the averages unchanged, so the
+ * result is identical to the C version. */
+static void compute_weights_line_avx2(const uint32_t *iia, const uint32_t *iib,
+                                      const uint32_t *iid, const uint32_t *iie,
+                                      const uint8_t *src, struct weighted_avg *wa,
+                                      const double *weight_lut, double pdiff_lut_scale,
+                                      int max_meaningful_diff, int startx, int endx)
+{
+    x86_reg x = 0, n = (endx - startx) & ~3;
+    struct weighted_avg *wa_x = wa + startx;
+
+    if (n) {
+        __asm__ volatile (
+            "vpbroadcastd      %[max], %%xmm7           \n\t"
+            "vbroadcastsd    %[scale], %%ymm6           \n\t"
+            "1:                                         \n\t"
+            "vmovdqu   (%[iie], %[x], 4), %%xmm0        \n\t"
+            "vpsubd    (%[iid], %[x], 4), %%xmm0, %%xmm0\n\t"
+            "vpsubd    (%[iib], %[x], 4), %%xmm0, %%xmm0\n\t"
+            "vpaddd    (%[iia], %[x], 4), %%xmm0, %%xmm0\n\t"
+            "vpcmpgtd          %%xmm0, %%xmm7, %%xmm1   \n\t"
+            "vcvtdq2pd         %%xmm0, %%ymm0           \n\t"
+            "vmulpd            %%ymm6, %%ymm0, %%ymm0   \n\t"
+            "vcvttpd2dq        %%ymm0, %%xmm0           \n\t"
+            "vpmovsxdq         %%xmm1, %%ymm1           \n\t"
+            "vxorpd            %%ymm2, %%ymm2, %%ymm2   \n\t"
+            "vgatherdpd        %%ymm1, (%[lut], %%xmm0, 8), %%ymm2 \n\t"
+            "vpmovzxbd   (%[src], %[x]), %%xmm3         \n\t"
+            "vcvtdq2pd         %%xmm3, %%ymm3           \n\t"
+            "vmulpd            %%ymm2, %%ymm3, %%ymm3   \n\t"
+            /* interleave into {total_weight, sum} pairs */
+            "vunpcklpd         %%ymm3, %%ymm2, %%ymm4   \n\t"
+            "vunpckhpd         %%ymm3, %%ymm2, %%ymm5   \n\t"
+            "vperm2f128 $0x20, %%ymm5, %%ymm4, %%ymm0   \n\t"
+            "vperm2f128 $0x31, %%ymm5, %%ymm4, %%ymm1   \n\t"
+            "vaddpd      (%[wa]), %%ymm0, %%ymm0        \n\t"
+            "vaddpd    32(%[wa]), %%ymm1, %%ymm1        \n\t"
+            "vmovupd           %%ymm0,   (%[wa])        \n\t"
+            "vmovupd           %%ymm1, 32(%[wa])        \n\t"
+            "add                  $64, %[wa]            \n\t"
+            "add                   $4, %[x]             \n\t"
+            "cmp                 %[n], %[x]             \n\t"
+            "jl                    1b                   \n\t"
+            "vzeroupper                                 \n\t"
+            : [x]"+r"(x), [wa]"+r"(wa_x)
+            : [iia]"r"(iia + startx), [iib]"r"(iib + startx),
+              [iid]"r"(iid + startx), [iie]"r"(iie + startx),
+              [src]"r"(src + startx), [lut]"r"(weight_lut), [n]"r"(n),
+              [max]"m"(max_meaningful_diff), [scale]"m"(pdiff_lut_scale)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",
+                           "%xmm5", "%xmm6", "%xmm7",)
+              "memory"
+        );
+    }
+
+    for (x = startx + n; x < endx; x++) {
+        const int patch_diff_sq = iie[x] - iid[x] - iib[x] + iia[x];
+        if (patch_diff_sq < max_meaningful_diff) {
+            const int weight_lut_idx = patch_diff_sq * pdiff_lut_scale;
+            const double weight = weight_lut[weight_lut_idx];
+            wa[x].total_weight += weight;
+            wa[x].sum += weight * src[x];
+        }
+    }
+}
+#endif /* ARCH_X86_64 && HAVE_AVX2_INLINE */
+
+av_cold void ff_nlmeans_init_x86(NLMeansDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags))
+        dsp->compute_safe_ssd_integral_image = compute_safe_ssd_integral_image_sse2;
+#endif
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags))
+        dsp->compute_weights_line = compute_weights_line_avx2;
+#endif
+}
@@ -0,0 +1,253 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_overlay.h"
+
+#if HAVE_SSE2_INLINE || HAVE_AVX2_INLINE
+DECLARE_ALIGNED(32, static const uint16_t, pw_255)[16] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+DECLARE_ALIGNED(32, static const uint16_t, pw_128)[16] = {
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128
+};
+DECLARE_ALIGNED(32, static const uint16_t, pw_257)[16] = {
+    257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257
+};
+#endif
+
+#if HAVE_SSE2_INLINE
+/*
+ * The words are divided by 255 the way FAST_DIV255() does it,
+ * ((x + 128) * 257) >> 16 being the high half of (x + 128) * 257.
+ */
+static int blend_row_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    x86_reg x = 0, n = w & ~15;
+
+    if (!n)
+        return 0;
+
+    __asm__ volatile (
+        "pxor                 %%xmm7, %%xmm7        \n\t"
+        "1:                                         \n\t"
+        "movdqu      (%[d], %[x]), %%xmm0           \n\t"
+        "movdqu      (%[s], %[x]), %%xmm1           \n\t"
+        "movdqu      (%[a], %[x]), %%xmm2           \n\t"
+        "movdqa               %%xmm0, %%xmm3        \n\t"
+        "punpcklbw            %%xmm7, %%xmm0        \n\t"
+        "punpckhbw            %%xmm7, %%xmm3        \n\t"
+        "movdqa               %%xmm1, %%xmm4        \n\t"
+        "punpcklbw            %%xmm7, %%xmm1        \n\t"
+        "punpckhbw            %%xmm7, %%xmm4        \n\t"
+        "movdqa               %%xmm2, %%xmm5        \n\t"
+        "punpcklbw            %%xmm7, %%xmm2        \n\t"
+        "punpckhbw            %%xmm7, %%xmm5        \n\t"
+        "pmullw               %%xmm2, %%xmm1        \n\t"
+        "pmullw               %%xmm5, %%xmm4        \n\t"
+        "movdqa            %[pw_255], %%xmm6        \n\t"
+        "psubw                %%xmm2, %%xmm6        \n\t"
+        "pmullw               %%xmm6, %%xmm0        \n\t"
+        "movdqa            %[pw_255], %%xmm6        \n\t"
+        "psubw                %%xmm5, %%xmm6        \n\t"
+        "pmullw               %%xmm6, %%xmm3        \n\t"
+        "paddw                %%xmm1, %%xmm0        \n\t"
+        "paddw                %%xmm4, %%xmm3        \n\t"
+        "paddw             %[pw_128], %%xmm0        \n\t"
+        "paddw             %[pw_128], %%xmm3        \n\t"
+        "pmulhuw           %[pw_257], %%xmm0        \n\t"
+        "pmulhuw           %[pw_257], %%xmm3        \n\t"
+        "packuswb             %%xmm3, %%xmm0        \n\t"
+        "movdqu               %%xmm0, (%[d], %[x])  \n\t"
+        "add                     $16, %[x]          \n\t"
+        "cmp                    %[n], %[x]          \n\t"
+        "jl                       1b                \n\t"
+        : [x]"+&r"(x)
+        : [d]"r"(d), [s]"r"(s), [a]"r"(a), [n]"r"(n),
+          [pw_255]"m"(*pw_255), [pw_128]"m"(*pw_128), [pw_257]"m"(*pw_257)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                       "%xmm4", "%xmm5", "%xmm6", "%xmm7",)
+          "memory"
+    );
+
+    return n;
+}
+
+static int blend_row_premultiplied_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    x86_reg x = 0, n = w & ~15;
+
+    if (!n)
+        return 0;
+
+    __asm__ volatile (
+        "pxor                 %%xmm7, %%xmm7        \n\t"
+        "1:                                         \n\t"
+        "movdqu      (%[d], %[x]), %%xmm0           \n\t"
+        "movdqu      (%[a], %[x]), %%xmm2           \n\t"
+        "movdqa               %%xmm0, %%xmm3        \n\t"
+        "punpcklbw            %%xmm7, %%xmm0        \n\t"
+        "punpckhbw            %%xmm7, %%xmm3        \n\t"
+        "movdqa               %%xmm2, %%xmm5        \n\t"
+        "punpcklbw            %%xmm7, %%xmm2        \n\t"
+        "punpckhbw            %%xmm7, %%xmm5        \n\t"
+        "movdqa            %[pw_255], %%xmm6        \n\t"
+        "psubw                %%xmm2, %%xmm6        \n\t"
+        "pmullw               %%xmm6, %%xmm0        \n\t"
+        "movdqa            %[pw_255], %%xmm6        \n\t"
+        "psubw                %%xmm5, %%xmm6        \n\t"
+        "pmullw               %%xmm6, %%xmm3        \n\t"
+        "paddw             %[pw_128], %%xmm0        \n\t"
+        "paddw             %[pw_128], %%xmm3        \n\t"
+        "pmulhuw           %[pw_257], %%xmm0        \n\t"
+        "pmulhuw           %[pw_257], %%xmm3        \n\t"
+        "packuswb             %%xmm3, %%xmm0        \n\t"
+        "movdqu      (%[s], %[x]), %%xmm1           \n\t"
+        "paddusb              %%xmm1, %%xmm0        \n\t"
+        "movdqu               %%xmm0, (%[d], %[x])  \n\t"
+        "add                     $16, %[x]          \n\t"
+        "cmp                    %[n], %[x]          \n\t"
+        "jl                       1b                \n\t"
+        : [x]"+&r"(x)
+        : [d]"r"(d), [s]"r"(s), [a]"r"(a), [n]"r"(n),
+          [pw_255]"m"(*pw_255), [pw_128]"m"(*pw_128), [pw_257]"m"(*pw_257)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                       "%xmm5", "%xmm6", "%xmm7",)
+          "memory"
+    );
+
+    return n;
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_AVX2_INLINE
+/* Same as the SSE2 versions on 32 pixels, the unpacks and packs stay in lane. */
+static int blend_row_avx2(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    x86_reg x = 0, n = w & ~31;
+
+    if (!n)
+        return 0;
+
+    __asm__ volatile (
+        "vpxor         %%ymm7, %%ymm7, %%ymm7               \n\t"
+        "vmovdqa            %[pw_255], %%ymm6               \n\t"
+        "1:                                                 \n\t"
+        "vmovdqu      (%[d], %[x]), %%ymm0                  \n\t"
+        "vmovdqu      (%[s], %[x]), %%ymm1                  \n\t"
+        "vmovdqu      (%[a], %[x]), %%ymm2                  \n\t"
+        "vpunpckhbw    %%ymm7, %%ymm0, %%ymm3               \n\t"
+        "vpunpcklbw    %%ymm7, %%ymm0, %%ymm0               \n\t"
+        "vpunpckhbw    %%ymm7, %%ymm1, %%ymm4               \n\t"
+        "vpunpcklbw    %%ymm7, %%ymm1, %%ymm1               \n\t"
+        "vpunpckhbw    %%ymm7, %%ymm2, %%ymm5               \n\t"
+        "vpunpcklbw    %%ymm7, %%ymm2, %%ymm2               \n\t"
+        "vpmullw       %%ymm2, %%ymm1, %%ymm1               \n\t"
+        "vpmullw       %%ymm5, %%ymm4, %%ymm4               \n\t"
+        "vpsubw        %%ymm2, %%ymm6, %%ymm2               \n\t"
+        "vpsubw        %%ymm5, %%ymm6, %%ymm5               \n\t"
+        "vpmullw       %%ymm2, %%ymm0, %%ymm0               \n\t"
+        "vpmullw       %%ymm5, %%ymm3, %%ymm3               \n\t"
+        "vpaddw        %%ymm1, %%ymm0, %%ymm0               \n\t"
+        "vpaddw        %%ymm4, %%ymm3, %%ymm3               \n\t"
+        "vpaddw     %[pw_128], %%ymm0, %%ymm0               \n\t"
+        "vpaddw     %[pw_128], %%ymm3, %%ymm3               \n\t"
+        "vpmulhuw   %[pw_257], %%ymm0, %%ymm0               \n\t"
+        "vpmulhuw   %[pw_257], %%ymm3, %%ymm3               \n\t"
+        "vpackuswb     %%ymm3, %%ymm0, %%ymm0               \n\t"
+        "vmovdqu       %%ymm0, (%[d], %[x])                 \n\t"
+        "add                     $32, %[x]                  \n\t"
+        "cmp                    %[n], %[x]                  \n\t"
+        "jl                       1b                        \n\t"
+        "vzeroupper                                         \n\t"
+        : [x]"+&r"(x)
+        : [d]"r"(d), [s]"r"(s), [a]"r"(a), [n]"r"(n),
+          [pw_255]"m"(*pw_255), [pw_128]"m"(*pw_128), [pw_257]"m"(*pw_257)
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",
+                       "%xmm4", "%xmm5", "%xmm6", "%xmm7",)
+          "memory"
+    );
+
+    return n;
+}
+
+static int blend_row_premultiplied_avx2(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    x86_reg x = 0, n = w & ~31;
+
+    if (!n)
+        return 0;
+
+    __asm__ volatile (
+        "vpxor         %%ymm7, %%ymm7, %%ymm7               \n\t"
+        "vmovdqa            %[pw_255], %%ymm6               \n\t"
+        "1:                                                 \n\t"
+        "vmovdqu      (%[d], %[x]), %%ymm0                  \n\t"
+        "vmovdqu      (%[a], %[x]), %%ymm2                  \n\t"
+        "vpunpckhbw    %%ymm7, %%ymm0, %%ymm3               \n\t"
+        "vpunpcklbw    %%ymm7, %%ymm0, %%ymm0               \n\t"
+        "vpunpckhbw    %%ymm7, %%ymm2, %%ymm5               \n\t"
+        "vpunpcklbw    %%ymm7, %%ymm2, %%ymm2               \n\t"
+        "vpsubw        %%ymm2, %%ymm6, %%ymm2               \n\t"
+        "vpsubw        %%ymm5, %%ymm6, %%ymm5               \n\t"
+        "vpmullw       %%ymm2, %%ymm0, %%ymm0               \n\t"
+        "vpmullw       %%ymm5, %%ymm3, %%ymm3               \n\t"
+        "vpaddw     %[pw_128], %%ymm0, %%ymm0               \n\t"
+        "vpaddw     %[pw_128], %%ymm3, %%ymm3               \n\t"
+        "vpmulhuw   %[pw_257], %%ymm0, %%ymm0               \n\t"
+        "vpmulhuw   %[pw_257], %%ymm3, %%ymm3               \n\t"
+        "vpackuswb     %%ymm3, %%ymm0, %%ymm0               \n\t"
+        "vpaddusb (%[s], %[x]), %%ymm0, %%ymm0              \n\t"
+        "vmovdqu       %%ymm0, (%[d], %[x])                 \n\t"
+        "add                     $32, %[x]                  \n\t"
+        "cmp                    %[n], %[x]                  \n\t"
+        "jl                       1b                        \n\t"
+        "vzeroupper                                         \n\t"
+        : [x]"+&r"(x)
+        : [d]"r"(d), [s]"r"(s), [a]"r"(a), [n]"r"(n),
+          [pw_255]"m"(*pw_255), [pw_128]"m"(*pw_128), [pw_257]"m"(*pw_257)
+        : XMM_CLOBBERS("%xmm0", "%xmm2", "%xmm3",
+                       "%xmm5", "%xmm6", "%xmm7",)
+          "memory"
+    );
+
+    return n;
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_overlay_init_x86(OverlayDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        dsp->blend_row[OVERLAY_ALPHA_STRAIGHT]      = blend_row_sse2;
+        dsp->blend_row[OVERLAY_ALPHA_PREMULTIPLIED] = blend_row_premultiplied_sse2;
+    }
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags)) {
+        dsp->blend_row[OVERLAY_ALPHA_STRAIGHT]      = blend_row_avx2;
+        dsp->blend_row[OVERLAY_ALPHA_PREMULTIPLIED] = blend_row_premultiplied_avx2;
+    }
+#endif
+}
@@ -23,6 +23,7 @@
 #include "libavutil/avstring.h"
 #include "libavutil/bprint.h"
 #include "libavutil/opt.h"
+#include "libavutil/thread.h"
 
 #include "avio_internal.h"
 #include "avformat.h"
@@ -82,6 +83,154 @@ void av_register_output_format(AVOutputFormat *format)
         last_oformat = &format->next;
 }
 
+/* One of the comma separated names of a registered format. */
+typedef struct FormatName {
+    const char *name;           ///< not 0-terminated
+    int len;
+    int idx;                    ///< position in the registered format list
+    void *fmt;
+} FormatName;
+
+/* Registered formats sorted by name, for the lookups by name.
+ * There is no lavf deinit to free them at; each array is released only when
+ * a registration makes it stale, and otherwise remains reachable until exit. */
+typedef struct FormatIndex {
+    FormatName *names;
+    int nb_names;
+    const void *last;           ///< list tail when the index was built
+} FormatIndex;
+
+static AVOnce format_index_once = AV_ONCE_INIT;
+static AVMutex format_index_lock;
+static FormatIndex iformat_index;
+static FormatIndex oformat_index;
+
+static void format_index_init(void)
+{
+    ff_mutex_init(&format_index_lock, NULL);
+}
+
+static int format_name_cmp_names(const FormatName *a, const FormatName *b)
+{
+    int ret = av_strncasecmp(a->name, b->name, FFMIN(a->len, b->len));
+    return ret ? ret : a->len - b->len;
+}
+
+static int format_name_cmp(const void *a, const void *b)
+{
+    int ret = format_name_cmp_names(a, b);
+    return ret ? ret : ((const FormatName *)a)->idx - ((const FormatName *)b)->idx;
+}
+
+static int format_name_find_cmp(const void *a, const void *b)
+{
+    return format_name_cmp_names(a, b);
+}
+
+/* Add the names of a format, with the matching rules of av_match_name(). */
+static int format_index_add(FormatIndex *fi, const char *names, void *fmt, int idx)
+{
+    while (*names) {
+        const char *p = strchr(names, ',');
+        FormatName *e;
+
+        if (!p)
+            p = names + strlen(names);
+        /* negated and catch-all names cannot be indexed */
+        if (*names == '-' || !strncmp("ALL", names, FFMAX(3, p - names)))
+            return AVERROR(EINVAL);
+
+        e = av_dynarray2_add((void **)&fi->names, &fi->nb_names, sizeof(*e), NULL);
+        if (!e)
+            return AVERROR(ENOMEM);
+        e->name = names;
+        e->len  = p - names;
+        e->idx  = idx;
+        e->fmt  = fmt;
+        names = p + (*p == ',');
+    }
+    return 0;
+}
+
+/* Call with format_index_lock held. */
+static void format_index_update(void)
+{
+    const void *last;
+    int i, ret = 0;
+
+    last = last_iformat;
+    if (iformat_index.last != last) {
+        AVInputFormat *f;
+
+        av_freep(&iformat_index.names);
+        iformat_index.nb_names = 0;
+        for (f = first_iformat, i = 0; f && ret >= 0; f = f->next, i++)
+            ret = format_index_add(&iformat_index, f->name, f, i);
+        if (ret < 0)
+            av_freep(&iformat_index.names);
+        else
+            qsort(iformat_index.names, iformat_index.nb_names,
+                  sizeof(*iformat_index.names), format_name_cmp);
+        iformat_index.last = last;
+    }
+
+    ret  = 0;
+    last = last_oformat;
+    if (oformat_index.last != last) {
+        AVOutputFormat *f;
+
+        av_freep(&oformat_index.names);
+        oformat_index.nb_names = 0;
+        for (f = first_oformat, i = 0; f && ret >= 0; f = f->next, i++)
+            ret = format_index_add(&oformat_index, f->name, f, i);
+        if (ret < 0)
+            av_freep(&oformat_index.names);
+        else
+            qsort(oformat_index.names, oformat_index.nb_names,
+                  sizeof(*oformat_index.names), format_name_cmp);
+        oformat_index.last = last;
+    }
+}
+
+/**
+ * Find the first registered format matching name as av_match_name() would.
+ *
+ * @param unique set to 0 if other formats match the name too
+ * @return the format, NULL if not found or the index cannot answer
+ */
+static void *format_index_find(const char *name, int output, int *unique)
+{
+    FormatIndex *fi = output ? &oformat_index : &iformat_index;
+    FormatName key = { name }, *e = NULL, *end;
+    void *fmt = NULL;
+
+    /* lists of names are compared differently by av_match_name() */
+    if (!name || !*name || strchr(name, ','))
+        return NULL;
+    key.len = strlen(name);
+
+    ff_thread_once(&format_index_once, format_index_init);
+    ff_mutex_lock(&format_index_lock);
+    format_index_update();
+    if (fi->names)
+        e = bsearch(&key, fi->names, fi->nb_names, sizeof(*fi->names),
+                    format_name_find_cmp);
+    if (e) {
+        while (e > fi->names && !format_name_cmp_names(&e[-1], &key))
+            e--;
+        fmt = e->fmt;
+        if (unique) {
+            end = fi->names + fi->nb_names;
+            for (*unique = 1; e < end && !format_name_cmp_names(e, &key); e++)
+                if (e->fmt != fmt)
+                    *unique = 0;
+        }
+    }
+    ff_mutex_unlock(&format_index_lock);
+
+    return fmt;
+}
+
 int av_match_ext(const char *filename, const char *extensions)
 {
     const char *ext;
@@ -109,6 +258,15 @@ AVOutputFormat *av_guess_format(const char *short_name, const char *filename,
         return av_guess_format("image2", NULL, NULL);
     }
 #endif
+    /* A format named short_name wins over any other match. */
+    if (short_name) {
+        int unique;
+        fmt = format_index_find(short_name, 1, &unique);
+        if (fmt && unique)
+            return fmt;
+        fmt = NULL;
+    }
+
     /* Find the proper file type. */
     fmt_found = NULL;
     score_max = 0;
@@ -163,18 +321,118 @@ enum AVCodecID av_guess_codec(AVOutputFormat *fmt, const char *short_name,
 
 AVInputFormat *av_find_input_format(const char *short_name)
 {
-    AVInputFormat *fmt = NULL;
+    AVInputFormat *fmt = format_index_find(short_name, 0, NULL);
+    if (fmt)
+        return fmt;
+
+    /* the index may miss formats registered concurrently */
     while ((fmt = av_iformat_next(fmt)))
         if (av_match_name(short_name, fmt->name))
             return fmt;
     return NULL;
 }
 
+/* Leading signatures of common formats, whose demuxers are probed first. */
+static const struct {
+    const char *name;
+    int offset;
+    int size;
+    const char *magic;
+} probe_magic[] = {
+    { "matroska", 0, 4, "\x1A\x45\xDF\xA3" },
+    { "mov",      4, 4, "ftyp" },
+    { "mov",      4, 4, "moov" },
+    { "ogg",      0, 4, "OggS" },
+    { "flv",      0, 3, "FLV" },
+    { "avi",      0, 4, "RIFF" },
+    { "wav",      0, 4, "RIFF" },
+    { "flac",     0, 4, "fLaC" },
+    { "mpegts",   0, 1, "\x47" },
+    { "nut",      0, 8, "nut/mult" },
+};
+
+/* Scores of the demuxers already probed by probe_candidates(). */
+typedef struct ProbeCache {
+    AVInputFormat *fmt[16];
+    int score[16];
+    int nb;
+} ProbeCache;
+
+static int probe_cached(AVInputFormat *fmt, AVProbeData *pd, ProbeCache *pc)
+{
+    int i, score;
+
+    for (i = 0; i < pc->nb; i++)
+        if (pc->fmt[i] == fmt)
+            return pc->score[i];
+
+    score = fmt->read_probe(pd);
+    if (pc->nb < FF_ARRAY_ELEMS(pc->fmt)) {
+        pc->fmt[pc->nb]   = fmt;
+        pc->score[pc->nb] = score;
+        pc->nb++;
+    }
+    return score;
+}
+
+/**
+ * Probe the demuxers whose extensions or leading signature match first.
+ *
+ * No demuxer scores more than AVPROBE_SCORE_MAX on data it does not own, so
+ * a single candidate reaching it is the format the full probe would find,
+ * without calling the read_probe() of every other demuxer.
+ * The scores are kept in pc, so the full probe does not compute them again.
+ *
+ * @return the demuxer, NULL if no candidate is certain
+ */
+static AVInputFormat *probe_candidates(AVProbeData *pd, int is_opened,
+                                       ProbeCache *pc, int *score_ret)
+{
+    AVInputFormat *magic[FF_ARRAY_ELEMS(probe_magic)];
+    AVInputFormat *fmt1 = NULL, *fmt = NULL;
+    int i, nb_magic = 0, score, score_max = 0;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(probe_magic); i++) {
+        if (pd->buf_size >= probe_magic[i].offset + probe_magic[i].size &&
+            !memcmp(pd->buf + probe_magic[i].offset, probe_magic[i].magic,
+                    probe_magic[i].size) &&
+            (fmt1 = av_find_input_format(probe_magic[i].name)))
+            magic[nb_magic++] = fmt1;
+    }
+    if (!nb_magic && !pd->filename)
+        return NULL;
+
+    fmt1 = NULL;
+    while ((fmt1 = av_iformat_next(fmt1))) {
+        if (!is_opened == !(fmt1->flags & AVFMT_NOFILE) && strcmp(fmt1->name, "image2"))
+            continue;
+        if (!fmt1->read_probe)
+            continue;
+        if (!fmt1->extensions || !av_match_ext(pd->filename, fmt1->extensions)) {
+            for (i = 0; i < nb_magic && magic[i] != fmt1; i++)
+                ;
+            if (i == nb_magic)
+                continue;
+        }
+        score = probe_cached(fmt1, pd, pc);
+        if (score > score_max) {
+            score_max = score;
+            fmt       = fmt1;
+        } else if (score == score_max)
+            fmt = NULL;
+    }
+    if (!fmt || score_max < AVPROBE_SCORE_MAX)
+        return NULL;
+    *score_ret = score_max;
+    return fmt;
+}
+
 AVInputFormat *av_probe_input_format3(AVProbeData *pd, int is_opened,
                                       int *score_ret)
 {
     AVProbeData lpd = *pd;
     AVInputFormat *fmt1 = NULL, *fmt;
+    ProbeCache pc = { { 0 } };
     int score, score_max = 0;
     const static uint8_t zerobuffer[AVPROBE_PADDING_SIZE];
     enum nodat {
@@ -200,13 +458,16 @@ AVInputFormat *av_probe_input_format3(AVProbeData *pd, int is_opened,
             nodat = ID3_GREATER_PROBE;
     }
 
+    if (nodat == NO_ID3 && (fmt = probe_candidates(&lpd, is_opened, &pc, score_ret)))
+        return fmt;
+
     fmt = NULL;
     while ((fmt1 = av_iformat_next(fmt1))) {
         if (!is_opened == !(fmt1->flags & AVFMT_NOFILE) && strcmp(fmt1->name, "image2"))
             continue;
         score = 0;
         if (fmt1->read_probe) {
-            score = fmt1->read_probe(&lpd);
+            score = probe_cached(fmt1, &lpd, &pc);
             if (score)
                 av_log(NULL, AV_LOG_TRACE, "Probing %s score:%d size:%d\n", fmt1->name, score, lpd.buf_size);
             if (fmt1->extensions && av_match_ext(lpd.filename, fmt1->extensions)) {
@@ -36,6 +36,7 @@
 #include "libavutil/mathematics.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/time.h"
+#include "libavutil/trace.h"
 #include "riff.h"
 #include "audiointerleave.h"
 #include "url.h"
@@ -416,7 +417,10 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
     if (s->oformat->init) {
-        if ((ret = s->oformat->init(s)) < 0) {
+        av_mem_tag_push(s);
+        ret = s->oformat->init(s);
+        av_mem_tag_pop();
+        if (ret < 0) {
             if (s->oformat->deinit)
                 s->oformat->deinit(s);
             return ret;
@@ -473,7 +477,10 @@ static int write_header_internal(AVFormatContext *s)
     if (!(s->oformat->flags & AVFMT_NOFILE) && s->pb)
         avio_write_marker(s->pb, AV_NOPTS_VALUE, AVIO_DATA_MARKER_HEADER);
     if (s->oformat->write_header) {
-        int ret = s->oformat->write_header(s);
+        int ret;
+        av_mem_tag_push(s);
+        ret = s->oformat->write_header(s);
+        av_mem_tag_pop();
         if (ret >= 0 && s->pb && s->pb->error < 0)
             ret = s->pb->error;
         s->internal->write_header_ret = ret;
@@ -768,7 +775,11 @@ FF_ENABLE_DEPRECATION_WARNINGS
         ret = s->oformat->write_uncoded_frame(s, pkt->stream_index, &frame, 0);
         av_frame_free(&frame);
     } else {
+        av_trace_begin("mux", s->oformat->name);
+        av_mem_tag_push(s);
         ret = s->oformat->write_packet(s, pkt);
+        av_mem_tag_pop();
+        av_trace_end("mux", s->oformat->name);
     }
 
     if (s->pb && ret >= 0) {
@@ -1279,7 +1290,12 @@ int av_interleaved_write_frame(AVFormatContext *s, AVPacket *pkt)
 
     for (;; ) {
         AVPacket opkt;
-        int ret = interleave_packet(s, &opkt, pkt, flush);
+        int ret;
+
+        /* the interleaving queue is charged to the muxer */
+        av_mem_tag_push(s);
+        ret = interleave_packet(s, &opkt, pkt, flush);
+        av_mem_tag_pop();
         if (pkt) {
             memset(pkt, 0, sizeof(*pkt));
             av_init_packet(pkt);
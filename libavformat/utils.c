@@ -35,6 +35,7 @@
 #include "libavutil/time.h"
 #include "libavutil/time_internal.h"
 #include "libavutil/timestamp.h"
+#include "libavutil/trace.h"
 
 #include "libavcodec/bytestream.h"
 #include "libavcodec/internal.h"
@@ -591,9 +592,13 @@ int avformat_open_input(AVFormatContext **ps, const char *filename,
         ff_id3v2_read_dict(s->pb, &s->internal->id3v2_meta, ID3v2_DEFAULT_MAGIC, &id3v2_extra_meta);
 
 
-    if (!(s->flags&AVFMT_FLAG_PRIV_OPT) && s->iformat->read_header)
-        if ((ret = s->iformat->read_header(s)) < 0)
+    if (!(s->flags&AVFMT_FLAG_PRIV_OPT) && s->iformat->read_header) {
+        av_mem_tag_push(s);
+        ret = s->iformat->read_header(s);
+        av_mem_tag_pop();
+        if (ret < 0)
             goto fail;
+    }
 
     if (!s->metadata) {
         s->metadata = s->internal->id3v2_meta;
@@ -813,7 +818,11 @@ int ff_read_packet(AVFormatContext *s, AVPacket *pkt)
         pkt->data = NULL;
         pkt->size = 0;
         av_init_packet(pkt);
+        av_trace_begin("demux", s->iformat->name);
+        av_mem_tag_push(s);
         ret = s->iformat->read_packet(s, pkt);
+        av_mem_tag_pop();
+        av_trace_end("demux", s->iformat->name);
         if (ret < 0) {
             /* Some demuxers return FFERROR_REDO when they consume
                data and discard it (ignored streams, junk, extradata).
@@ -22,7 +22,27 @@
 
 #include "bswap.h"
 #include "common.h"
+#include "cpu.h"
 #include "crc.h"
+#include "thread.h"
+#if ARCH_X86
+#include "x86/cpu.h"
+#include "x86/crc.h"
+#endif
+
+static const struct {
+    uint8_t  le;
+    uint8_t  bits;
+    uint32_t poly;
+} av_crc_table_params[AV_CRC_MAX] = {
+    [AV_CRC_8_ATM]      = { 0,  8,       0x07 },
+    [AV_CRC_16_ANSI]    = { 0, 16,     0x8005 },
+    [AV_CRC_16_CCITT]   = { 0, 16,     0x1021 },
+    [AV_CRC_24_IEEE]    = { 0, 24,   0x864CFB },
+    [AV_CRC_32_IEEE]    = { 0, 32, 0x04C11DB7 },
+    [AV_CRC_32_IEEE_LE] = { 1, 32, 0xEDB88320 },
+    [AV_CRC_16_ANSI_LE] = { 1, 16,     0xA001 },
+};
 
 #if CONFIG_HARDCODED_TABLES
 static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
@@ -291,22 +311,42 @@ static const AVCRC av_crc_table[AV_CRC_MAX][257] = {
 #else
 #define CRC_TABLE_SIZE 1024
 #endif
-static struct {
-    uint8_t  le;
-    uint8_t  bits;
-    uint32_t poly;
-} av_crc_table_params[AV_CRC_MAX] = {
-    [AV_CRC_8_ATM]      = { 0,  8,       0x07 },
-    [AV_CRC_16_ANSI]    = { 0, 16,     0x8005 },
-    [AV_CRC_16_CCITT]   = { 0, 16,     0x1021 },
-    [AV_CRC_24_IEEE]    = { 0, 24,   0x864CFB },
-    [AV_CRC_32_IEEE]    = { 0, 32, 0x04C11DB7 },
-    [AV_CRC_32_IEEE_LE] = { 1, 32, 0xEDB88320 },
-    [AV_CRC_16_ANSI_LE] = { 1, 16,     0xA001 },
-};
 static AVCRC av_crc_table[AV_CRC_MAX][CRC_TABLE_SIZE];
 #endif
 
+#if HAVE_CRC_CLMUL
+static AVOnce crc_clmul_once = AV_ONCE_INIT;
+static CRCClmulContext crc_clmul[AV_CRC_MAX];
+
+static av_cold void crc_clmul_init(void)
+{
+    int i;
+
+    for (i = 0; i < AV_CRC_MAX; i++)
+        if (av_crc_table_params[i].bits)
+            ff_crc_clmul_init(&crc_clmul[i],
+                              av_crc_table_params[i].le,
+                              av_crc_table_params[i].bits,
+                              av_crc_table_params[i].poly);
+}
+
+/* Only the tables of av_crc_get_table() have folding constants, which are
+ * computed by it. The CRC id follows from the position of ctx in the array. */
+static const CRCClmulContext *crc_get_clmul(const AVCRC *ctx)
+{
+    uintptr_t offset = (uintptr_t)ctx - (uintptr_t)av_crc_table;
+    int cpu_flags = av_get_cpu_flags();
+    int id;
+
+    if (!INLINE_CLMUL(cpu_flags) || !INLINE_SSE4(cpu_flags) ||
+        offset >= sizeof(av_crc_table) || offset % sizeof(av_crc_table[0]))
+        return NULL;
+
+    id = offset / sizeof(av_crc_table[0]);
+    return av_crc_table_params[id].bits ? &crc_clmul[id] : NULL;
+}
+#endif
+
 int av_crc_init(AVCRC *ctx, int le, int bits, uint32_t poly, int ctx_size)
 {
     unsigned i, j;
@@ -350,6 +390,9 @@ const AVCRC *av_crc_get_table(AVCRCId crc_id)
                         av_crc_table_params[crc_id].poly,
                         sizeof(av_crc_table[crc_id])) < 0)
             return NULL;
+#endif
+#if HAVE_CRC_CLMUL
+    ff_thread_once(&crc_clmul_once, crc_clmul_init);
 #endif
     return av_crc_table[crc_id];
 }
@@ -359,6 +402,17 @@ uint32_t av_crc(const AVCRC *ctx, uint32_t crc,
 {
     const uint8_t *end = buffer + length;
 
+#if HAVE_CRC_CLMUL
+    if (length >= 64) {
+        const CRCClmulContext *c = crc_get_clmul(ctx);
+        if (c) {
+            size_t n = length & ~15;
+            crc     = ff_crc_clmul(c, crc, buffer, n);
+            buffer += n;
+        }
+    }
+#endif
+
 #if !CONFIG_SMALL
     if (!ctx[256]) {
         while (((intptr_t) buffer & 3) && buffer < end)
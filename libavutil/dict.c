@@ -27,16 +27,174 @@
 #include "time_internal.h"
 #include "bprint.h"
 
+/* Dictionaries with at least this many entries get a hash index. */
+#define INDEX_MIN_COUNT 16
+
 struct AVDictionary {
     int count;
     AVDictionaryEntry *elems;
+    int elems_size;         ///< number of allocated elems
+
+    /* Hash index on the case-folded keys, NULL when not built. Each bucket
+     * chains the entries with that hash through next[], so that entries
+     * with equal keys (AV_DICT_MULTIKEY) all land in the same chain. */
+    int *buckets;           ///< first entry of each chain, -1 if empty
+    int *next;              ///< next entry in the same chain, -1 at the end
+    unsigned *hashes;       ///< hash of each entry's key
+    unsigned nb_buckets;    ///< always a power of 2
 };
 
+static unsigned hash_key(const char *key)
+{
+    uint32_t h = 2166136261U;
+
+    while (*key)
+        h = (h ^ av_toupper(*key++)) * 16777619U;
+    return h;
+}
+
+static void index_free(AVDictionary *m)
+{
+    av_freep(&m->buckets);
+    av_freep(&m->next);
+    av_freep(&m->hashes);
+    m->nb_buckets = 0;
+}
+
+static void index_link(AVDictionary *m, int i)
+{
+    unsigned b = m->hashes[i] & (m->nb_buckets - 1);
+
+    m->next[i]    = m->buckets[b];
+    m->buckets[b] = i;
+}
+
+/* Return the link in the chain of entry i which points to it. */
+static int *index_find_link(AVDictionary *m, int i)
+{
+    int *link = &m->buckets[m->hashes[i] & (m->nb_buckets - 1)];
+
+    while (*link != i)
+        link = &m->next[*link];
+    return link;
+}
+
+static int index_rehash(AVDictionary *m, unsigned nb_buckets)
+{
+    int *buckets = av_malloc_array(nb_buckets, sizeof(*buckets));
+    int i;
+
+    if (!buckets)
+        return AVERROR(ENOMEM);
+    memset(buckets, -1, nb_buckets * sizeof(*buckets));
+
+    av_free(m->buckets);
+    m->buckets    = buckets;
+    m->nb_buckets = nb_buckets;
+    for (i = 0; i < m->count; i++)
+        index_link(m, i);
+    return 0;
+}
+
+static void index_build(AVDictionary *m)
+{
+    int i;
+
+    m->next   = av_malloc_array(m->elems_size, sizeof(*m->next));
+    m->hashes = av_malloc_array(m->elems_size, sizeof(*m->hashes));
+    if (!m->next || !m->hashes)
+        goto fail;
+    for (i = 0; i < m->count; i++)
+        m->hashes[i] = hash_key(m->elems[i].key);
+    if (index_rehash(m, 2 * INDEX_MIN_COUNT) < 0)
+        goto fail;
+    return;
+fail:
+    /* lookups just fall back to the linear scan */
+    index_free(m);
+}
+
+/* Make room for one more entry. */
+static int dict_grow(AVDictionary *m)
+{
+    AVDictionaryEntry *tmp;
+    int size;
+
+    if (m->count < m->elems_size)
+        return 0;
+    if (m->elems_size > INT_MAX / 2 / sizeof(*m->elems))
+        return AVERROR(ENOMEM);
+    size = FFMAX(2 * m->elems_size, 4);
+
+    tmp = av_realloc_array(m->elems, size, sizeof(*m->elems));
+    if (!tmp)
+        return AVERROR(ENOMEM);
+    m->elems      = tmp;
+    m->elems_size = size;
+
+    if (m->buckets &&
+        (av_reallocp_array(&m->next,   size, sizeof(*m->next))   < 0 ||
+         av_reallocp_array(&m->hashes, size, sizeof(*m->hashes)) < 0))
+        index_free(m);
+    return 0;
+}
+
+/* Remove entry i by moving the last entry into its place. */
+static void dict_remove(AVDictionary *m, int i)
+{
+    int last = --m->count;
+
+    if (m->buckets) {
+        *index_find_link(m, i) = m->next[i];
+        if (i != last) {
+            *index_find_link(m, last) = i;
+            m->next[i]   = m->next[last];
+            m->hashes[i] = m->hashes[last];
+        }
+    }
+    m->elems[i] = m->elems[last];
+}
+
+static void dict_append(AVDictionary *m, char *key, char *value)
+{
+    int i = m->count++;
+
+    m->elems[i].key   = key;
+    m->elems[i].value = value;
+
+    if (m->buckets) {
+        m->hashes[i] = hash_key(key);
+        index_link(m, i);
+        if (m->count > m->nb_buckets && index_rehash(m, 2 * m->nb_buckets) < 0)
+            index_free(m);
+    } else if (m->count >= INDEX_MIN_COUNT) {
+        index_build(m);
+    }
+}
+
 int av_dict_count(const AVDictionary *m)
 {
     return m ? m->count : 0;
 }
 
+static AVDictionaryEntry *index_get(const AVDictionary *m, const char *key,
+                                    int start, int flags)
+{
+    unsigned h = hash_key(key);
+    int i, found = -1;
+
+    /* The chain is not in insertion order, keep the first match. */
+    for (i = m->buckets[h & (m->nb_buckets - 1)]; i >= 0; i = m->next[i]) {
+        if (m->hashes[i] != h || i < start || (found >= 0 && i > found))
+            continue;
+        if (flags & AV_DICT_MATCH_CASE ? strcmp(m->elems[i].key, key)
+                                       : av_strcasecmp(m->elems[i].key, key))
+            continue;
+        found = i;
+    }
+    return found >= 0 ? &m->elems[found] : NULL;
+}
+
 AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
                                const AVDictionaryEntry *prev, int flags)
 {
@@ -50,6 +208,9 @@ AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
     else
         i = 0;
 
+    if (m->buckets && !(flags & AV_DICT_IGNORE_SUFFIX))
+        return index_get(m, key, i, flags);
+
     for (; i < m->count; i++) {
         const char *s = m->elems[i].key;
         if (flags & AV_DICT_MATCH_CASE)
@@ -67,6 +228,15 @@ AVDictionaryEntry *av_dict_get(const AVDictionary *m, const char *key,
     return NULL;
 }
 
+static void dict_free(AVDictionary **pm)
+{
+    AVDictionary *m = *pm;
+
+    index_free(m);
+    av_freep(&m->elems);
+    av_freep(pm);
+}
+
 int av_dict_set(AVDictionary **pm, const char *key, const char *value,
                 int flags)
 {
@@ -101,17 +271,12 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
         else
             av_free(tag->value);
         av_free(tag->key);
-        *tag = m->elems[--m->count];
+        dict_remove(m, tag - m->elems);
     } else if (copy_value) {
-        AVDictionaryEntry *tmp = av_realloc(m->elems,
-                                            (m->count + 1) * sizeof(*m->elems));
-        if (!tmp)
+        if (dict_grow(m) < 0)
             goto err_out;
-        m->elems = tmp;
     }
     if (copy_value) {
-        m->elems[m->count].key = copy_key;
-        m->elems[m->count].value = copy_value;
         if (oldval && flags & AV_DICT_APPEND) {
             size_t len = strlen(oldval) + strlen(copy_value) + 1;
             char *newval = av_mallocz(len);
@@ -120,25 +285,21 @@ int av_dict_set(AVDictionary **pm, const char *key, const char *value,
             av_strlcat(newval, oldval, len);
             av_freep(&oldval);
             av_strlcat(newval, copy_value, len);
-            m->elems[m->count].value = newval;
             av_freep(&copy_value);
+            copy_value = newval;
         }
-        m->count++;
+        dict_append(m, copy_key, copy_value);
     } else {
         av_freep(&copy_key);
     }
-    if (!m->count) {
-        av_freep(&m->elems);
-        av_freep(pm);
-    }
+    if (!m->count)
+        dict_free(pm);
 
     return 0;
 
 err_out:
-    if (m && !m->count) {
-        av_freep(&m->elems);
-        av_freep(pm);
-    }
+    if (m && !m->count)
+        dict_free(pm);
     av_free(copy_key);
     av_free(copy_value);
     return AVERROR(ENOMEM);
@@ -209,6 +370,7 @@ void av_dict_free(AVDictionary **pm)
             av_freep(&m->elems[m->count].key);
             av_freep(&m->elems[m->count].value);
         }
+        index_free(m);
         av_freep(&m->elems);
     }
     av_freep(pm);
@@ -29,6 +29,7 @@
 #include "config.h"
 
 #include <limits.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,11 +38,14 @@
 #endif
 
 #include "avassert.h"
+#include "avstring.h"
 #include "avutil.h"
 #include "common.h"
 #include "dynarray.h"
 #include "intreadwrite.h"
+#include "log.h"
 #include "mem.h"
+#include "thread.h"
 
 #ifdef MALLOC_PREFIX
 
@@ -74,6 +78,287 @@ void av_max_alloc(size_t max){
     max_alloc_size = max;
 }
 
+#define MAX_MEM_TAGS      256
+#define MAX_MEM_TAG_DEPTH 16
+
+typedef struct MemTag {
+    char     class_name[64];
+    char     name[64];
+    int64_t  bytes;
+    int64_t  peak_bytes;
+    uint64_t nb_allocs;
+} MemTag;
+
+typedef struct MemTagStack {
+    MemTag *tags[MAX_MEM_TAG_DEPTH];
+    int     depth;
+} MemTagStack;
+
+typedef struct MemBlock {
+    void  *ptr;
+    size_t size;
+    int    tag;
+} MemBlock;
+
+static atomic_int mem_accounting = ATOMIC_VAR_INIT(0);
+static AVOnce     mem_once       = AV_ONCE_INIT;
+static AVMutex    mem_lock;
+#if HAVE_PTHREADS
+static pthread_key_t mem_tag_key;
+#elif !HAVE_THREADS
+static MemTagStack mem_tag_stack;
+#endif
+/* Other thread implementations have no per-thread tag stack, and a shared
+ * one would mix up the tags of concurrent threads. */
+#define MEM_ACCOUNTING (HAVE_PTHREADS || !HAVE_THREADS)
+
+/* protected by mem_lock; mem_tags[0] collects the untagged allocations */
+static MemTag    mem_tags[MAX_MEM_TAGS];
+static int       mem_nb_tags = 1;
+static MemTag    mem_total;
+/* the tracked blocks, in a linear probing hash table indexed by address */
+static MemBlock *mem_blocks;
+static size_t    mem_blocks_size;
+static size_t    mem_nb_blocks;
+
+static void mem_init(void)
+{
+    ff_mutex_init(&mem_lock, NULL);
+#if HAVE_PTHREADS
+    pthread_key_create(&mem_tag_key, free);
+#endif
+}
+
+static MemTagStack *get_tag_stack(int create)
+{
+#if HAVE_PTHREADS
+    MemTagStack *stack = pthread_getspecific(mem_tag_key);
+
+    if (!stack && create && (stack = malloc(sizeof(*stack)))) {
+        stack->depth = 0;
+        if (pthread_setspecific(mem_tag_key, stack)) {
+            free(stack);
+            stack = NULL;
+        }
+    }
+    return stack;
+#elif !HAVE_THREADS
+    return &mem_tag_stack;
+#else
+    return NULL;
+#endif
+}
+
+static size_t block_hash(const void *ptr, size_t mask)
+{
+    return (uint64_t)((uintptr_t)ptr >> 4) * 0x9E3779B97F4A7C15ULL >> 32 & mask;
+}
+
+/* Return the slot of ptr, or the free slot where it belongs. */
+static size_t block_find(const void *ptr)
+{
+    size_t mask = mem_blocks_size - 1, i = block_hash(ptr, mask);
+
+    while (mem_blocks[i].ptr && mem_blocks[i].ptr != ptr)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static void block_remove(size_t i)
+{
+    size_t mask = mem_blocks_size - 1, j, k;
+
+    mem_blocks[i].ptr = NULL;
+    mem_nb_blocks--;
+    /* move back the following entries that can no longer be reached */
+    for (j = (i + 1) & mask; mem_blocks[j].ptr; j = (j + 1) & mask) {
+        k = block_hash(mem_blocks[j].ptr, mask);
+        if (i <= j ? i < k && k <= j : i < k || k <= j)
+            continue;
+        mem_blocks[i]     = mem_blocks[j];
+        mem_blocks[j].ptr = NULL;
+        i = j;
+    }
+}
+
+static int blocks_grow(void)
+{
+    MemBlock *old = mem_blocks;
+    size_t old_size = mem_blocks_size, size = old_size ? old_size * 2 : 1024, i;
+
+    if (size > SIZE_MAX / sizeof(*mem_blocks) ||
+        !(mem_blocks = malloc(size * sizeof(*mem_blocks)))) {
+        mem_blocks = old;
+        return AVERROR(ENOMEM);
+    }
+    memset(mem_blocks, 0, size * sizeof(*mem_blocks));
+    mem_blocks_size = size;
+    for (i = 0; i < old_size; i++)
+        if (old[i].ptr)
+            mem_blocks[block_find(old[i].ptr)] = old[i];
+    free(old);
+    return 0;
+}
+
+static void tag_add(MemTag *tag, int64_t size, int nb_allocs)
+{
+    tag->bytes      += size;
+    tag->peak_bytes  = FFMAX(tag->peak_bytes, tag->bytes);
+    tag->nb_allocs  += nb_allocs;
+}
+
+/* Start tracking a block, with mem_lock held. */
+static void track_block(void *ptr, size_t size, MemTag *tag, int new_block)
+{
+    size_t i;
+
+    if (!atomic_load_explicit(&mem_accounting, memory_order_relaxed) ||
+        (mem_nb_blocks >= mem_blocks_size / 2 && blocks_grow() < 0))
+        return;
+    i = block_find(ptr);
+    if (mem_blocks[i].ptr)
+        return;
+    mem_blocks[i] = (MemBlock){ ptr, size, tag - mem_tags };
+    mem_nb_blocks++;
+    tag_add(tag,        size, new_block);
+    tag_add(&mem_total, size, new_block);
+}
+
+/* Stop tracking a block, with mem_lock held; return its tag, NULL if the
+ * block was not tracked. */
+static MemTag *untrack_block(void *ptr, size_t *size)
+{
+    MemTag *tag;
+    size_t i;
+
+    if (!mem_blocks_size)
+        return NULL;
+    i = block_find(ptr);
+    if (!mem_blocks[i].ptr)
+        return NULL;
+    tag   = &mem_tags[mem_blocks[i].tag];
+    *size = mem_blocks[i].size;
+    tag_add(tag,        -(int64_t)*size, 0);
+    tag_add(&mem_total, -(int64_t)*size, 0);
+    block_remove(i);
+    return tag;
+}
+
+static MemTag *current_tag(void)
+{
+    MemTagStack *stack = get_tag_stack(0);
+    MemTag *tag = NULL;
+
+    if (stack && stack->depth > 0)
+        tag = stack->tags[FFMIN(stack->depth, MAX_MEM_TAG_DEPTH) - 1];
+    return tag ? tag : &mem_tags[0];
+}
+
+int av_mem_set_accounting(int enable)
+{
+    int i;
+
+    if (!MEM_ACCOUNTING)
+        return enable ? AVERROR(ENOSYS) : 0;
+
+    ff_thread_once(&mem_once, mem_init);
+
+    ff_mutex_lock(&mem_lock);
+    if (enable && !atomic_load(&mem_accounting)) {
+        for (i = 0; i < mem_nb_tags; i++)
+            mem_tags[i].bytes = mem_tags[i].peak_bytes = mem_tags[i].nb_allocs = 0;
+        mem_total.bytes = mem_total.peak_bytes = mem_total.nb_allocs = 0;
+    } else if (!enable) {
+        free(mem_blocks);
+        mem_blocks      = NULL;
+        mem_blocks_size = 0;
+        mem_nb_blocks   = 0;
+    }
+    atomic_store(&mem_accounting, !!enable);
+    ff_mutex_unlock(&mem_lock);
+    return 0;
+}
+
+void av_mem_tag_push(void *avcl)
+{
+    const AVClass *avc = avcl ? *(const AVClass **)avcl : NULL;
+    MemTagStack *stack;
+    MemTag *tag = NULL;
+    const char *name;
+    int i;
+
+    if (!atomic_load_explicit(&mem_accounting, memory_order_relaxed) ||
+        !(stack = get_tag_stack(1)))
+        return;
+
+    if (avc) {
+        name = avc->item_name ? avc->item_name(avcl) : NULL;
+        if (!name)
+            name = avc->class_name;
+        ff_mutex_lock(&mem_lock);
+        for (i = 1; i < mem_nb_tags; i++) {
+            if (!strncmp(mem_tags[i].class_name, avc->class_name, sizeof(mem_tags[i].class_name) - 1) &&
+                !strncmp(mem_tags[i].name,       name,            sizeof(mem_tags[i].name)       - 1)) {
+                tag = &mem_tags[i];
+                break;
+            }
+        }
+        if (!tag && mem_nb_tags < MAX_MEM_TAGS) {
+            tag = &mem_tags[mem_nb_tags++];
+            av_strlcpy(tag->class_name, avc->class_name, sizeof(tag->class_name));
+            av_strlcpy(tag->name,       name,            sizeof(tag->name));
+        }
+        ff_mutex_unlock(&mem_lock);
+    }
+
+    /* deeper levels are counted but charged to the last stored tag */
+    if (stack->depth < MAX_MEM_TAG_DEPTH)
+        stack->tags[stack->depth] = tag;
+    stack->depth++;
+}
+
+void av_mem_tag_pop(void)
+{
+    MemTagStack *stack;
+
+    if (!atomic_load_explicit(&mem_accounting, memory_order_relaxed))
+        return;
+    stack = get_tag_stack(0);
+    if (stack && stack->depth > 0)
+        stack->depth--;
+}
+
+static void fill_stats(AVMemStats *stats, const MemTag *tag, int tagged)
+{
+    stats->class_name = tagged ? tag->class_name : NULL;
+    stats->name       = tagged ? tag->name       : NULL;
+    stats->bytes      = tag->bytes;
+    stats->peak_bytes = tag->peak_bytes;
+    stats->nb_allocs  = tag->nb_allocs;
+}
+
+AVMemStats *av_mem_get_stats(AVMemStats *total, int *nb_stats)
+{
+    AVMemStats *stats = av_malloc_array(MAX_MEM_TAGS, sizeof(*stats));
+    int i;
+
+    *nb_stats = 0;
+    if (!stats)
+        return NULL;
+
+    ff_thread_once(&mem_once, mem_init);
+
+    ff_mutex_lock(&mem_lock);
+    for (i = 0; i < mem_nb_tags; i++)
+        fill_stats(&stats[i], &mem_tags[i], i > 0);
+    if (total)
+        fill_stats(total, &mem_total, 0);
+    *nb_stats = mem_nb_tags;
+    ff_mutex_unlock(&mem_lock);
+
+    return stats;
+}
+
 void *av_malloc(size_t size)
 {
     void *ptr = NULL;
@@ -124,6 +409,11 @@ void *av_malloc(size_t size)
     if(!ptr && !size) {
         size = 1;
         ptr= av_malloc(1);
+    } else if (ptr && atomic_load_explicit(&mem_accounting, memory_order_relaxed)) {
+        MemTag *tag = current_tag();
+        ff_mutex_lock(&mem_lock);
+        track_block(ptr, size, tag, 1);
+        ff_mutex_unlock(&mem_lock);
     }
 #if CONFIG_MEMORY_POISONING
     if (ptr)
@@ -134,15 +424,37 @@ void *av_malloc(size_t size)
 
 void *av_realloc(void *ptr, size_t size)
 {
+    MemTag *tag = NULL, *old_tag = NULL;
+    size_t old_size;
+    void *ret;
+
     /* let's disallow possibly ambiguous cases */
     if (size > (max_alloc_size - 32))
         return NULL;
 
+    /* the lock is held across the reallocation, so that the old address
+     * is not reused by another thread before it is untracked */
+    if (atomic_load_explicit(&mem_accounting, memory_order_relaxed)) {
+        tag = current_tag();
+        ff_mutex_lock(&mem_lock);
+        if (ptr)
+            old_tag = untrack_block(ptr, &old_size);
+    }
+
 #if HAVE_ALIGNED_MALLOC
-    return _aligned_realloc(ptr, size + !size, ALIGN);
+    ret = _aligned_realloc(ptr, size + !size, ALIGN);
 #else
-    return realloc(ptr, size + !size);
+    ret = realloc(ptr, size + !size);
 #endif
+
+    if (tag) {
+        if (ret)
+            track_block(ret, size + !size, old_tag ? old_tag : tag, !old_tag);
+        else if (old_tag)
+            track_block(ptr, old_size, old_tag, 0);
+        ff_mutex_unlock(&mem_lock);
+    }
+    return ret;
 }
 
 void *av_realloc_f(void *ptr, size_t nelem, size_t elsize)
@@ -203,6 +515,13 @@ int av_reallocp_array(void *ptr, size_t nmemb, size_t size)
 
 void av_free(void *ptr)
 {
+    if (ptr && atomic_load_explicit(&mem_accounting, memory_order_relaxed)) {
+        size_t size;
+        ff_mutex_lock(&mem_lock);
+        untrack_block(ptr, &size);
+        ff_mutex_unlock(&mem_lock);
+    }
+
 #if HAVE_ALIGNED_MALLOC
     _aligned_free(ptr);
 #else
@@ -691,6 +691,80 @@ static inline int av_size_mult(size_t a, size_t b, size_t *r)
  */
 void av_max_alloc(size_t max);
 
+/**
+ * @}
+ */
+
+/**
+ * @defgroup lavu_mem_stats Allocation Accounting
+ * Attribution of the heap memory to the components allocating it.
+ *
+ * While accounting is enabled, every block allocated with the @ref
+ * lavu_mem_funcs "heap management functions" is charged to the tag of the
+ * calling thread until it is freed. The libraries set the tag to their
+ * codec, format or filter context while running it, so the statistics
+ * show which component holds memory. Untagged allocations are charged to
+ * an entry with a NULL class name.
+ *
+ * Accounting takes a lock on every allocation, reallocation and free, so
+ * it is disabled by default.
+ *
+ * @{
+ */
+
+/**
+ * Allocation statistics of one tag.
+ */
+typedef struct AVMemStats {
+    const char *class_name; ///< AVClass.class_name of the tag, NULL for untagged
+    const char *name;       ///< item name of the tagged context, NULL for untagged
+    int64_t  bytes;         ///< bytes currently allocated
+    int64_t  peak_bytes;    ///< highest value of bytes
+    uint64_t nb_allocs;     ///< number of blocks allocated
+} AVMemStats;
+
+/**
+ * Enable or disable allocation accounting.
+ *
+ * Enabling accounting resets the statistics; only blocks allocated from
+ * then on are tracked. Disabling it stops the tracking, the statistics
+ * remain available.
+ *
+ * Accounting needs a tag stack per thread. It is only available with
+ * pthreads or without threading support.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if accounting is not available
+ */
+int av_mem_set_accounting(int enable);
+
+/**
+ * Charge the allocations of the calling thread to a context, until the
+ * matching av_mem_tag_pop().
+ *
+ * The tag is identified by the class and item names of the context, so
+ * the contexts of the same component share their statistics. Tags nest.
+ *
+ * @param avcl  a pointer to an arbitrary struct of which the first field
+ *              is a pointer to an AVClass struct
+ */
+void av_mem_tag_push(void *avcl);
+
+/**
+ * Restore the tag of the calling thread before the last av_mem_tag_push().
+ */
+void av_mem_tag_pop(void);
+
+/**
+ * Get the allocation statistics.
+ *
+ * @param total     if not NULL, filled with the statistics of all tracked
+ *                  blocks
+ * @param nb_stats  set to the number of entries of the returned array
+ * @return an array of per-tag statistics, to be freed with av_free(), or
+ *         NULL on allocation failure
+ */
+AVMemStats *av_mem_get_stats(AVMemStats *total, int *nb_stats);
+
 /**
  * @}
  * @}
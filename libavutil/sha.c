@@ -23,12 +23,18 @@
 
 #include <string.h>
 
+#include "config.h"
 #include "attributes.h"
 #include "avutil.h"
 #include "bswap.h"
+#include "cpu.h"
 #include "sha.h"
 #include "intreadwrite.h"
 #include "mem.h"
+#if ARCH_X86
+#include "x86/cpu.h"
+#include "x86/sha.h"
+#endif
 
 /** hash context */
 typedef struct AVSHA {
@@ -272,6 +278,11 @@ static void sha256_transform(uint32_t *state, const uint8_t buffer[64])
 
 av_cold int av_sha_init(AVSHA *ctx, int bits)
 {
+#if HAVE_SHA_SHANI
+    int cpu_flags = av_get_cpu_flags();
+    int shani     = INLINE_SHANI(cpu_flags) && INLINE_SSE4(cpu_flags);
+#endif
+
     ctx->digest_len = bits >> 5;
     switch (bits) {
     case 160: // SHA-1
@@ -281,6 +292,10 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
         ctx->state[3] = 0x10325476;
         ctx->state[4] = 0xC3D2E1F0;
         ctx->transform = sha1_transform;
+#if HAVE_SHA_SHANI
+        if (shani)
+            ctx->transform = ff_sha1_transform_shani;
+#endif
         break;
     case 224: // SHA-224
         ctx->state[0] = 0xC1059ED8;
@@ -292,6 +307,10 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
         ctx->state[6] = 0x64F98FA7;
         ctx->state[7] = 0xBEFA4FA4;
         ctx->transform = sha256_transform;
+#if HAVE_SHA_SHANI
+        if (shani)
+            ctx->transform = ff_sha256_transform_shani;
+#endif
         break;
     case 256: // SHA-256
         ctx->state[0] = 0x6A09E667;
@@ -303,6 +322,10 @@ av_cold int av_sha_init(AVSHA *ctx, int bits)
         ctx->state[6] = 0x1F83D9AB;
         ctx->state[7] = 0x5BE0CD19;
         ctx->transform = sha256_transform;
+#if HAVE_SHA_SHANI
+        if (shani)
+            ctx->transform = ff_sha256_transform_shani;
+#endif
         break;
     default:
         return AVERROR(EINVAL);
@@ -70,6 +70,9 @@ static const struct {
     { AV_CPU_FLAG_3DNOWEXT,  "3dnowext"   },
     { AV_CPU_FLAG_CMOV,      "cmov"       },
     { AV_CPU_FLAG_AVX2,      "avx2"       },
+    { AV_CPU_FLAG_AVX512,    "avx512"     },
+    { AV_CPU_FLAG_CLMUL,     "clmul"      },
+    { AV_CPU_FLAG_SHANI,     "shani"      },
     { AV_CPU_FLAG_BMI1,      "bmi1"       },
     { AV_CPU_FLAG_BMI2,      "bmi2"       },
     { AV_CPU_FLAG_AESNI,     "aesni"      },
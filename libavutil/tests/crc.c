@@ -19,12 +19,60 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "libavutil/cpu.h"
 #include "libavutil/crc.h"
+#include "libavutil/mem.h"
+
+#define MAX_LEN (1 << 16)
+
+/* Compare av_crc() with the detected CPU flags, which may use SIMD, to the
+ * table-only code, for all lengths up to 300 bytes, some longer ones, and
+ * all alignments modulo 16. Each CRC is also computed in two updates. */
+static int check_simd(const uint8_t *buf)
+{
+    static const int long_len[] = { 511, 1024, 1999, 4097, MAX_LEN - 1 };
+    int id, ret = 0;
+
+    for (id = 0; id < AV_CRC_MAX; id++) {
+        const AVCRC *ctx = av_crc_get_table(id);
+        int align, i, errors = 0;
+
+        if (!ctx)
+            continue;
+        for (align = 0; align < 16; align++) {
+            for (i = 0; i < 301 + FF_ARRAY_ELEMS(long_len); i++) {
+                int len = i < 301 ? i : long_len[i - 301];
+                const uint8_t *src = buf + align;
+                uint32_t ref, ref_split, crc, crc_split;
+
+                av_force_cpu_flags(0);
+                ref       = av_crc(ctx, 0, src, len);
+                ref_split = av_crc(ctx, ref, src, len / 3);
+                ref_split = av_crc(ctx, ref_split, src + len / 3, len - len / 3);
+                av_force_cpu_flags(-1);
+                crc       = av_crc(ctx, 0, src, len);
+                crc_split = av_crc(ctx, ref, src, len / 3);
+                crc_split = av_crc(ctx, crc_split, src + len / 3, len - len / 3);
+
+                if (crc != ref || crc_split != ref_split) {
+                    if (!errors++)
+                        printf("crc id %d: length %d at offset %d: "
+                               "%08X %08X, expected %08X %08X\n",
+                               id, len, align, crc, crc_split, ref, ref_split);
+                }
+            }
+        }
+        if (errors)
+            ret = 1;
+    }
+    printf("simd: %s\n", ret ? "mismatch" : "ok");
+    return ret;
+}
 
 int main(void)
 {
-    uint8_t buf[1999];
-    int i;
+    uint8_t buf[1999], *big;
+    int i, ret;
     static const unsigned p[6][3] = {
         { AV_CRC_32_IEEE_LE, 0xEDB88320, 0x3D5CDD04 },
         { AV_CRC_32_IEEE   , 0x04C11DB7, 0xC0F5BAE0 },
@@ -42,5 +90,13 @@ int main(void)
         ctx = av_crc_get_table(p[i][0]);
         printf("crc %08X = %X\n", p[i][1], av_crc(ctx, 0, buf, sizeof(buf)));
     }
-    return 0;
+
+    big = av_malloc(MAX_LEN + 16);
+    if (!big)
+        return 1;
+    for (i = 0; i < MAX_LEN + 16; i++)
+        big[i] = i * 7 + (i >> 8) * 13;
+    ret = check_simd(big);
+    av_free(big);
+    return ret;
 }
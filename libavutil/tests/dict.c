@@ -28,6 +28,50 @@ static void print_dict(const AVDictionary *m)
     printf("\n");
 }
 
+static void test_large(void)
+{
+    AVDictionary *dict = NULL;
+    AVDictionaryEntry *e;
+    char key[16], val[16];
+    int i;
+
+    for (i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "key%d", i % 150);
+        snprintf(val, sizeof(val), "%d", i);
+        av_dict_set(&dict, key, val, 0);
+    }
+    for (i = 0; i < 150; i += 7) {
+        snprintf(key, sizeof(key), "KEY%d", i);
+        av_dict_set(&dict, key, NULL, 0);
+    }
+    for (i = 0; i < 40; i++) {
+        snprintf(key, sizeof(key), "Multi%d", i % 4);
+        snprintf(val, sizeof(val), "%d", i);
+        av_dict_set(&dict, key, val, AV_DICT_MULTIKEY);
+    }
+    av_dict_set(&dict, "key3", "x", AV_DICT_APPEND);
+    av_dict_set(&dict, "key4", "x", AV_DICT_DONT_OVERWRITE);
+    printf("count %d\n", av_dict_count(dict));
+
+    for (i = 0; i < 160; i += 13) {
+        snprintf(key, sizeof(key), "Key%d", i);
+        e = av_dict_get(dict, key, NULL, 0);
+        printf("%s: %s   ", key, e ? e->value : "(null)");
+        e = av_dict_get(dict, key, NULL, AV_DICT_MATCH_CASE);
+        printf("%s\n", e ? e->value : "(null)");
+    }
+    e = NULL;
+    while ((e = av_dict_get(dict, "multi2", e, 0)))
+        printf("%s %s   ", e->key, e->value);
+    printf("\n");
+    e = NULL;
+    while ((e = av_dict_get(dict, "key1", e, AV_DICT_IGNORE_SUFFIX)))
+        printf("%s %s   ", e->key, e->value);
+    printf("\n");
+    print_dict(dict);
+    av_dict_free(&dict);
+}
+
 static void test_separators(const AVDictionary *m, const char pair, const char val)
 {
     AVDictionary *dict = NULL;
@@ -132,5 +176,8 @@ int main(void)
     printf("%s\n", e->value);
     av_dict_free(&dict);
 
+    printf("\nTesting large dictionaries\n");
+    test_large();
+
     return 0;
 }
@@ -0,0 +1,151 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Charge allocations to nested and per-thread tags and print the resulting
+ * allocation statistics.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+typedef struct TestContext {
+    const AVClass *class;
+    const char *name;
+} TestContext;
+
+static const char *test_item_name(void *ctx)
+{
+    return ((TestContext *)ctx)->name;
+}
+
+static const AVClass test_class = {
+    .class_name = "test",
+    .item_name  = test_item_name,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
+static TestContext ctx_a = { &test_class, "a" };
+static TestContext ctx_b = { &test_class, "b" };
+static TestContext ctx_c = { &test_class, "c" };
+
+/* Statistics are read with accounting disabled, so that the array returned
+ * by av_mem_get_stats() is not counted itself. */
+static void print_stats(const char *step)
+{
+    AVMemStats total, *stats;
+    int i, nb_stats;
+
+    av_mem_set_accounting(0);
+    stats = av_mem_get_stats(&total, &nb_stats);
+    if (!stats) {
+        printf("%s: av_mem_get_stats() failed\n", step);
+        return;
+    }
+    printf("%s: total bytes=%"PRId64" peak=%"PRId64" allocs=%"PRIu64"\n",
+           step, total.bytes, total.peak_bytes, total.nb_allocs);
+    for (i = 0; i < nb_stats; i++) {
+        if (!stats[i].nb_allocs && !stats[i].peak_bytes)
+            continue;
+        if (stats[i].class_name)
+            printf("%s: %s:%s", step, stats[i].class_name, stats[i].name);
+        else
+            printf("%s: untagged", step);
+        printf(" bytes=%"PRId64" peak=%"PRId64" allocs=%"PRIu64"\n",
+               stats[i].bytes, stats[i].peak_bytes, stats[i].nb_allocs);
+    }
+    av_free(stats);
+}
+
+static void *tagged_thread(void *arg)
+{
+    void **p = arg;
+
+    av_mem_tag_push(&ctx_c);
+    p[0] = av_malloc(200);
+    av_mem_tag_pop();
+    p[1] = av_malloc(50);
+    return NULL;
+}
+
+int main(void)
+{
+    void *p[4], *q[2] = { NULL };
+    pthread_t thread;
+    int ret;
+
+    if ((ret = av_mem_set_accounting(1)) < 0) {
+        printf("accounting not available: %d\n", ret);
+        return 1;
+    }
+
+    /* nested tags, and reallocation keeping the tag of the block */
+    p[0] = av_malloc(100);
+    av_mem_tag_push(&ctx_a);
+    p[1] = av_malloc(1000);
+    av_mem_tag_push(&ctx_b);
+    p[2] = av_malloc(500);
+    p[1] = av_realloc(p[1], 3000);
+    av_mem_tag_pop();
+    p[3] = av_realloc(NULL, 10);
+    av_mem_tag_pop();
+    print_stats("nested");
+    av_free(p[0]);
+    av_free(p[1]);
+    av_free(p[2]);
+    av_free(p[3]);
+
+    /* a block freed under another tag is still charged to its own */
+    av_mem_set_accounting(1);
+    av_mem_tag_push(&ctx_a);
+    p[0] = av_malloc(2000);
+    av_mem_tag_pop();
+    av_mem_tag_push(&ctx_b);
+    p[1] = av_malloc(300);
+    av_free(p[0]);
+    av_mem_tag_pop();
+    print_stats("free");
+    av_free(p[1]);
+
+    /* the tags of a thread do not affect the allocations of another */
+    av_mem_set_accounting(1);
+    av_mem_tag_push(&ctx_a);
+    ret = pthread_create(&thread, NULL, tagged_thread, q);
+    if (ret) {
+        printf("pthread_create() failed: %d\n", ret);
+        return 1;
+    }
+    pthread_join(thread, NULL);
+    p[0] = av_malloc(10);
+    av_mem_tag_pop();
+    print_stats("threads");
+    av_free(p[0]);
+    av_free(q[0]);
+    av_free(q[1]);
+
+    /* nothing is tracked while accounting is disabled */
+    p[0] = av_malloc(4000);
+    av_free(p[0]);
+    print_stats("disabled");
+
+    return 0;
+}
@@ -17,13 +17,61 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
+#include "libavutil/cpu.h"
 #include "libavutil/mem.h"
 #include "libavutil/sha.h"
 
+#define MAX_LEN 4099
+
+static void hash(struct AVSHA *ctx, int bits, uint8_t *digest,
+                 const uint8_t *buf, int len, int split)
+{
+    av_sha_init(ctx, bits);
+    av_sha_update(ctx, buf, split);
+    av_sha_update(ctx, buf + split, len - split);
+    av_sha_final(ctx, digest);
+}
+
+/* Compare the digests with the detected CPU flags, which may use SIMD block
+ * transforms, to the C code, for various lengths, alignments and splits of
+ * the message into two updates. */
+static int check_simd(struct AVSHA *ctx, const int *lengths)
+{
+    static const int long_len[] = { 511, 1024, 1999, MAX_LEN };
+    uint8_t buf[MAX_LEN + 16], ref[32], digest[32];
+    int i, j, k, ret = 0;
+
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = i * 7 + (i >> 8) * 13;
+
+    for (j = 0; j < 3; j++) {
+        for (i = 0; i < 200 + FF_ARRAY_ELEMS(long_len); i++) {
+            int len   = i < 200 ? i : long_len[i - 200];
+            int align = i & 15;
+            int splits[4] = { 0, len / 3, len & ~63, len };
+
+            for (k = 0; k < 4; k++) {
+                av_force_cpu_flags(0);
+                hash(ctx, lengths[j], ref, buf + align, len, splits[k]);
+                av_force_cpu_flags(-1);
+                hash(ctx, lengths[j], digest, buf + align, len, splits[k]);
+                if (memcmp(digest, ref, lengths[j] >> 3)) {
+                    printf("SHA-%d: mismatch for length %d at offset %d, "
+                           "split at %d\n", lengths[j], len, align, splits[k]);
+                    ret = 1;
+                }
+            }
+        }
+    }
+    printf("simd: %s\n", ret ? "mismatch" : "ok");
+    return ret;
+}
+
 int main(void)
 {
-    int i, j, k;
+    int i, j, k, ret;
     struct AVSHA *ctx;
     unsigned char digest[32];
     static const int lengths[3] = { 160, 224, 256 };
@@ -69,7 +117,8 @@ int main(void)
             break;
         }
     }
+    ret = check_simd(ctx, lengths);
     av_free(ctx);
 
-    return 0;
+    return ret;
 }
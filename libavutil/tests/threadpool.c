@@ -0,0 +1,137 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Submit batches to one pool from several threads at once and check that
+ * every job runs exactly once with a thread index within its batch limit.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+
+#define NB_SUBMITTERS 4
+#define NB_BATCHES    200
+#define MAX_JOBS      64
+
+typedef struct Batch {
+    AVThreadPool *pool;
+    int max_threads;
+    int runs[MAX_JOBS];
+    int bad_threadnr;
+} Batch;
+
+static int job(void *opaque, int jobnr, int threadnr)
+{
+    Batch *b = opaque;
+
+    b->runs[jobnr]++;
+    if (threadnr < 0 || threadnr >= b->max_threads)
+        b->bad_threadnr = 1;
+    return jobnr * 3;
+}
+
+static int nested_job(void *opaque, int jobnr, int threadnr)
+{
+    Batch *outer = opaque;
+    Batch inner  = { .pool = outer->pool, .max_threads = 2 };
+    int i, ret = 0;
+
+    outer->runs[jobnr]++;
+    av_thread_pool_execute(inner.pool, job, &inner, NULL, 8, inner.max_threads);
+    for (i = 0; i < 8; i++)
+        ret |= inner.runs[i] != 1;
+    return ret | inner.bad_threadnr;
+}
+
+static int check_batch(AVThreadPool *pool, int nb_jobs, int max_threads)
+{
+    Batch b = { .pool = pool, .max_threads = max_threads };
+    int rets[MAX_JOBS];
+    int i;
+
+    memset(rets, -1, sizeof(rets));
+    av_thread_pool_execute(pool, job, &b, rets, nb_jobs, max_threads);
+    if (b.bad_threadnr)
+        return 1;
+    for (i = 0; i < nb_jobs; i++)
+        if (b.runs[i] != 1 || rets[i] != i * 3)
+            return 1;
+    return 0;
+}
+
+static void *submitter(void *arg)
+{
+    AVThreadPool *pool = arg;
+    int i;
+
+    for (i = 0; i < NB_BATCHES; i++)
+        if (check_batch(pool, 1 + i % MAX_JOBS, 1 + i % 7))
+            return (void *)1;
+    return NULL;
+}
+
+int main(void)
+{
+    AVThreadPool *pool;
+    pthread_t threads[NB_SUBMITTERS];
+    Batch nested = { 0 };
+    int rets[MAX_JOBS];
+    int i, ret = 0;
+
+    if (av_thread_pool_alloc(&pool, 3) < 0) {
+        fprintf(stderr, "Failed to allocate the pool\n");
+        return 1;
+    }
+    if (av_thread_pool_get_nb_threads(pool) != 3)
+        ret = 1;
+
+    for (i = 0; i < NB_SUBMITTERS; i++)
+        if (pthread_create(&threads[i], NULL, submitter, pool)) {
+            fprintf(stderr, "Failed to create submitter thread\n");
+            return 1;
+        }
+    for (i = 0; i < NB_SUBMITTERS; i++) {
+        void *res;
+        pthread_join(threads[i], &res);
+        if (res) {
+            fprintf(stderr, "Concurrent batches failed\n");
+            ret = 1;
+        }
+    }
+
+    nested.pool        = pool;
+    nested.max_threads = 4;
+    av_thread_pool_execute(pool, nested_job, &nested, rets, 16, nested.max_threads);
+    for (i = 0; i < 16; i++)
+        if (nested.runs[i] != 1 || rets[i]) {
+            fprintf(stderr, "Nested batches failed\n");
+            ret = 1;
+            break;
+        }
+
+    if (check_batch(NULL, MAX_JOBS, 4)) {
+        fprintf(stderr, "Execution without a pool failed\n");
+        ret = 1;
+    }
+
+    av_thread_pool_free(&pool);
+    return ret;
+}
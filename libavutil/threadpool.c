@@ -0,0 +1,250 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "common.h"
+#include "cpu.h"
+#include "error.h"
+#include "mem.h"
+#include "thread.h"
+#include "threadpool.h"
+
+#if HAVE_THREADS
+
+typedef struct ThreadPoolBatch {
+    av_thread_pool_func *func;
+    void *opaque;
+    int *rets;
+    int nb_jobs;
+    int next_job;
+    int nb_done;
+    int nb_participants;
+    int max_participants;
+    struct ThreadPoolBatch *next;
+} ThreadPoolBatch;
+
+#endif
+
+struct AVThreadPool {
+#if HAVE_THREADS
+    pthread_t *workers;
+    int nb_workers;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    /* batches which still have jobs nobody picked, oldest first */
+    ThreadPoolBatch *pending;
+    int exit;
+#else
+    int dummy;
+#endif
+};
+
+#if HAVE_THREADS
+
+static ThreadPoolBatch *find_pending_batch(AVThreadPool *pool)
+{
+    ThreadPoolBatch *b;
+
+    for (b = pool->pending; b; b = b->next)
+        if (b->nb_participants < b->max_participants)
+            return b;
+    return NULL;
+}
+
+static void remove_pending_batch(AVThreadPool *pool, ThreadPoolBatch *batch)
+{
+    ThreadPoolBatch **p = &pool->pending;
+
+    while (*p != batch)
+        p = &(*p)->next;
+    *p = batch->next;
+}
+
+/* Called and returns with pool->lock held. The batch must not be touched
+ * once its last job completed, as its owner may then return. */
+static void run_batch(AVThreadPool *pool, ThreadPoolBatch *b)
+{
+    int threadnr = b->nb_participants++;
+
+    while (b->next_job < b->nb_jobs) {
+        int jobnr = b->next_job++;
+        int ret;
+
+        if (b->next_job == b->nb_jobs)
+            remove_pending_batch(pool, b);
+
+        pthread_mutex_unlock(&pool->lock);
+        ret = b->func(b->opaque, jobnr, threadnr);
+        if (b->rets)
+            b->rets[jobnr] = ret;
+        pthread_mutex_lock(&pool->lock);
+
+        if (++b->nb_done == b->nb_jobs)
+            pthread_cond_broadcast(&pool->done_cond);
+    }
+}
+
+static void* attribute_align_arg worker(void *arg)
+{
+    AVThreadPool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        ThreadPoolBatch *b;
+
+        while (!pool->exit && !(b = find_pending_batch(pool)))
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        if (pool->exit)
+            break;
+        run_batch(pool, b);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+#endif /* HAVE_THREADS */
+
+int av_thread_pool_alloc(AVThreadPool **ppool, int nb_threads)
+{
+#if HAVE_THREADS
+    AVThreadPool *pool;
+    int i, ret;
+
+    *ppool = NULL;
+
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+    if (nb_threads <= 0)
+        return AVERROR(EINVAL);
+
+    if (!(pool = av_mallocz(sizeof(*pool))))
+        return AVERROR(ENOMEM);
+    if (!(pool->workers = av_mallocz_array(nb_threads, sizeof(*pool->workers)))) {
+        av_free(pool);
+        return AVERROR(ENOMEM);
+    }
+    if ((ret = pthread_mutex_init(&pool->lock, NULL))) {
+        av_free(pool->workers);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pool->work_cond, NULL))) {
+        pthread_mutex_destroy(&pool->lock);
+        av_free(pool->workers);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&pool->done_cond, NULL))) {
+        pthread_cond_destroy(&pool->work_cond);
+        pthread_mutex_destroy(&pool->lock);
+        av_free(pool->workers);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+
+    for (i = 0; i < nb_threads; i++) {
+        if ((ret = pthread_create(&pool->workers[i], NULL, worker, pool))) {
+            av_thread_pool_free(&pool);
+            return AVERROR(ret);
+        }
+        pool->nb_workers++;
+    }
+
+    *ppool = pool;
+    return 0;
+#else
+    *ppool = NULL;
+    return AVERROR(ENOSYS);
+#endif /* HAVE_THREADS */
+}
+
+void av_thread_pool_free(AVThreadPool **ppool)
+{
+#if HAVE_THREADS
+    AVThreadPool *pool = *ppool;
+    int i;
+
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->exit = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nb_workers; i++)
+        pthread_join(pool->workers[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    av_freep(&pool->workers);
+    av_freep(ppool);
+#endif
+}
+
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool)
+{
+#if HAVE_THREADS
+    return pool ? pool->nb_workers : 0;
+#else
+    return 0;
+#endif
+}
+
+int av_thread_pool_execute(AVThreadPool *pool, av_thread_pool_func *func,
+                           void *opaque, int *rets, int nb_jobs,
+                           int max_threads)
+{
+    int i, ret;
+
+#if HAVE_THREADS
+    if (pool && nb_jobs > 1 && max_threads > 1) {
+        ThreadPoolBatch batch = {
+            .func             = func,
+            .opaque           = opaque,
+            .rets             = rets,
+            .nb_jobs          = nb_jobs,
+            .max_participants = max_threads,
+        };
+        ThreadPoolBatch **p;
+
+        pthread_mutex_lock(&pool->lock);
+        for (p = &pool->pending; *p; p = &(*p)->next)
+            ;
+        *p = &batch;
+        pthread_cond_broadcast(&pool->work_cond);
+
+        run_batch(pool, &batch);
+        while (batch.nb_done < batch.nb_jobs)
+            pthread_cond_wait(&pool->done_cond, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+
+        return 0;
+    }
+#endif
+
+    for (i = 0; i < nb_jobs; i++) {
+        ret = func(opaque, i, 0);
+        if (rets)
+            rets[i] = ret;
+    }
+    return 0;
+}
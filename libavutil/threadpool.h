@@ -0,0 +1,84 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+/**
+ * @file
+ * Shared pool of worker threads.
+ *
+ * A single pool can serve any number of codec contexts and filter graphs at
+ * the same time, so that running many of them in one process does not
+ * multiply the number of threads. Each call to av_thread_pool_execute()
+ * submits a batch of independent jobs; idle workers and the calling thread
+ * pick jobs from the pending batches in submission order.
+ */
+
+typedef struct AVThreadPool AVThreadPool;
+
+/**
+ * Function executed for each job of a batch.
+ *
+ * @param opaque    the opaque pointer passed to av_thread_pool_execute()
+ * @param jobnr     index of the job, in the range [0, nb_jobs)
+ * @param threadnr  index of the thread running the job within this batch,
+ *                  in the range [0, max_threads); the calling thread is 0
+ * @return value stored in the rets array, if any
+ */
+typedef int (av_thread_pool_func)(void *opaque, int jobnr, int threadnr);
+
+/**
+ * Allocate a thread pool and start its worker threads.
+ *
+ * @param pool        pointer to the allocated pool
+ * @param nb_threads  number of worker threads, 0 for one per CPU
+ * @return  >=0 for success; <0 for error, in particular AVERROR(ENOSYS) if
+ *          lavu was built without thread support
+ */
+int av_thread_pool_alloc(AVThreadPool **pool, int nb_threads);
+
+/**
+ * Stop the worker threads and free the pool.
+ *
+ * The pool must no longer be used by any codec context or filter graph.
+ */
+void av_thread_pool_free(AVThreadPool **pool);
+
+/**
+ * @return the number of worker threads of the pool
+ */
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool);
+
+/**
+ * Run nb_jobs jobs and wait for all of them to complete.
+ *
+ * The calling thread takes part in the execution, so this is safe to call
+ * from a job running on the pool. If pool is NULL, all jobs are run by the
+ * calling thread.
+ *
+ * @param rets         array of nb_jobs return values, may be NULL
+ * @param max_threads  maximum number of threads working on this batch
+ *                     concurrently, bounding the threadnr passed to func
+ * @return 0
+ */
+int av_thread_pool_execute(AVThreadPool *pool, av_thread_pool_func *func,
+                           void *opaque, int *rets, int nb_jobs,
+                           int max_threads);
+
+#endif /* AVUTIL_THREADPOOL_H */
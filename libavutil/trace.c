@@ -0,0 +1,159 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "config.h"
+#include "avutil.h"
+#include "error.h"
+#include "thread.h"
+#include "time.h"
+#include "trace.h"
+
+#define MAX_TRACE_THREADS 256
+
+static atomic_int trace_active = ATOMIC_VAR_INIT(0);
+
+static AVOnce trace_once = AV_ONCE_INIT;
+static AVMutex trace_lock;
+
+/* protected by trace_lock */
+static FILE *trace_file;
+static int64_t trace_start_time;
+static unsigned trace_nb_events;
+#if HAVE_PTHREADS
+static pthread_t trace_threads[MAX_TRACE_THREADS];
+static int trace_nb_threads;
+#endif
+
+static void trace_init(void)
+{
+    ff_mutex_init(&trace_lock, NULL);
+}
+
+/* Return a small identifier for the calling thread, with trace_lock held. */
+static int get_thread_id(void)
+{
+#if HAVE_PTHREADS
+    pthread_t self = pthread_self();
+    int i;
+
+    for (i = 0; i < trace_nb_threads; i++)
+        if (pthread_equal(trace_threads[i], self))
+            return i + 1;
+    if (trace_nb_threads == MAX_TRACE_THREADS)
+        return 0;
+    trace_threads[trace_nb_threads++] = self;
+    return trace_nb_threads;
+#elif HAVE_W32THREADS
+    return GetCurrentThreadId();
+#else
+    return 1;
+#endif
+}
+
+static void write_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(f, "\\u%04x", (unsigned char)*s);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void write_event(char phase, const char *category, const char *name)
+{
+    int64_t ts;
+
+    if (!atomic_load_explicit(&trace_active, memory_order_relaxed))
+        return;
+
+    ts = av_gettime_relative();
+
+    ff_mutex_lock(&trace_lock);
+    if (trace_file) {
+        fputs(trace_nb_events++ ? ",\n{\"name\":" : "{\"name\":", trace_file);
+        write_string(trace_file, name ? name : "unknown");
+        fputs(",\"cat\":", trace_file);
+        write_string(trace_file, category);
+        fprintf(trace_file, ",\"ph\":\"%c\",\"ts\":%"PRId64",\"pid\":1,\"tid\":%d}",
+                phase, ts - trace_start_time, get_thread_id());
+    }
+    ff_mutex_unlock(&trace_lock);
+}
+
+int av_trace_start(const char *filename)
+{
+    FILE *f;
+    int ret = 0;
+
+    ff_thread_once(&trace_once, trace_init);
+
+    ff_mutex_lock(&trace_lock);
+    if (trace_file) {
+        ret = AVERROR(EEXIST);
+    } else if (!(f = av_fopen_utf8(filename, "w"))) {
+        ret = AVERROR(errno);
+    } else {
+        fputs("[\n", f);
+        trace_file       = f;
+        trace_start_time = av_gettime_relative();
+        trace_nb_events  = 0;
+        atomic_store_explicit(&trace_active, 1, memory_order_relaxed);
+    }
+    ff_mutex_unlock(&trace_lock);
+
+    return ret;
+}
+
+void av_trace_stop(void)
+{
+    ff_thread_once(&trace_once, trace_init);
+
+    ff_mutex_lock(&trace_lock);
+    if (trace_file) {
+        atomic_store_explicit(&trace_active, 0, memory_order_relaxed);
+        fputs("\n]\n", trace_file);
+        fclose(trace_file);
+        trace_file = NULL;
+    }
+    ff_mutex_unlock(&trace_lock);
+}
+
+int av_trace_is_active(void)
+{
+    return atomic_load_explicit(&trace_active, memory_order_relaxed);
+}
+
+void av_trace_begin(const char *category, const char *name)
+{
+    write_event('B', category, name);
+}
+
+void av_trace_end(const char *category, const char *name)
+{
+    write_event('E', category, name);
+}
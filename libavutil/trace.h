@@ -0,0 +1,70 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_TRACE_H
+#define AVUTIL_TRACE_H
+
+/**
+ * @file
+ * Timeline tracing.
+ *
+ * While tracing is active, the libraries record the beginning and end of
+ * the demuxing, decoding, filtering, encoding and muxing steps and of the
+ * slice jobs of the codec and filter threads, together with the thread
+ * running them. The events are written in the Chrome trace event JSON
+ * format, which chrome://tracing and Perfetto can display.
+ *
+ * When tracing is not active, av_trace_begin() and av_trace_end() return
+ * immediately.
+ */
+
+/**
+ * Start writing trace events to a file.
+ *
+ * @param filename  name of the JSON file to create
+ * @return  >= 0 on success, a negative AVERROR code on failure, in
+ *          particular AVERROR(EEXIST) if tracing is already active
+ */
+int av_trace_start(const char *filename);
+
+/**
+ * Stop tracing, complete and close the trace file.
+ */
+void av_trace_stop(void);
+
+/**
+ * @return nonzero if tracing is active
+ */
+int av_trace_is_active(void);
+
+/**
+ * Record the beginning of a step on the calling thread.
+ *
+ * @param category  kind of step, e.g. "decode"
+ * @param name      name of the component doing the work, e.g. the codec name
+ */
+void av_trace_begin(const char *category, const char *name);
+
+/**
+ * Record the end of the step last begun on the calling thread.
+ *
+ * The arguments must be the same as for the matching av_trace_begin().
+ */
+void av_trace_end(const char *category, const char *name);
+
+#endif /* AVUTIL_TRACE_H */
@@ -95,6 +95,7 @@ int ff_get_cpu_flags_x86(void)
 
     int eax, ebx, ecx, edx;
     int max_std_level, max_ext_level, std_caps = 0, ext_caps = 0;
+    int xcr0_lo = 0, xcr0_hi = 0;
     int family = 0, model = 0;
     union { int i[3]; char c[12]; } vendor;
 
@@ -128,12 +129,14 @@ int ff_get_cpu_flags_x86(void)
             rval |= AV_CPU_FLAG_SSE42;
         if (ecx & 0x01000000 )
             rval |= AV_CPU_FLAG_AESNI;
+        if (ecx & 0x00000002 )
+            rval |= AV_CPU_FLAG_CLMUL;
 #if HAVE_AVX
         /* Check OXSAVE and AVX bits */
         if ((ecx & 0x18000000) == 0x18000000) {
             /* Check for OS support */
-            xgetbv(0, eax, edx);
-            if ((eax & 0x6) == 0x6) {
+            xgetbv(0, xcr0_lo, xcr0_hi);
+            if ((xcr0_lo & 0x6) == 0x6) {
                 rval |= AV_CPU_FLAG_AVX;
                 if (ecx & 0x00001000)
                     rval |= AV_CPU_FLAG_FMA3;
@@ -148,6 +151,15 @@ int ff_get_cpu_flags_x86(void)
         if ((rval & AV_CPU_FLAG_AVX) && (ebx & 0x00000020))
             rval |= AV_CPU_FLAG_AVX2;
 #endif /* HAVE_AVX2 */
+#if HAVE_AVX512
+        /* Require F, CD, BW, DQ and VL, plus OS support for the opmask,
+         * upper ZMM0-15 and ZMM16-31 state */
+        if ((rval & AV_CPU_FLAG_AVX2) && (xcr0_lo & 0xe0) == 0xe0 &&
+            (ebx & 0xd0030000) == 0xd0030000)
+            rval |= AV_CPU_FLAG_AVX512;
+#endif /* HAVE_AVX512 */
+        if (ebx & 0x20000000)
+            rval |= AV_CPU_FLAG_SHANI;
         /* BMI1/2 don't need OS support */
         if (ebx & 0x00000008) {
             rval |= AV_CPU_FLAG_BMI1;
@@ -0,0 +1,230 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * CRC folding with PCLMULQDQ, after "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction" (Intel, 2009).
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/bswap.h"
+#include "libavutil/reverse.h"
+#include "libavutil/x86/asm.h"
+#include "crc.h"
+
+#if HAVE_CRC_CLMUL
+
+static uint32_t bitswap32(uint32_t x)
+{
+    return (uint32_t)ff_reverse[x       & 0xFF] << 24 |
+           (uint32_t)ff_reverse[x >>  8 & 0xFF] << 16 |
+           (uint32_t)ff_reverse[x >> 16 & 0xFF] <<  8 |
+                     ff_reverse[x >> 24];
+}
+
+/* x^n modulo x^32 + p */
+static uint32_t xpow_mod(int n, uint32_t p)
+{
+    uint32_t r = 1;
+
+    while (n--)
+        r = (r << 1) ^ (p & -(r >> 31));
+    return r;
+}
+
+/* x^n modulo x^32 + p, bit-reflected and multiplied by x */
+static uint64_t fold_const(int n, uint32_t p)
+{
+    return (uint64_t)bitswap32(xpow_mod(n, p)) << 1;
+}
+
+av_cold void ff_crc_clmul_init(CRCClmulContext *c, int le, int bits, uint32_t poly)
+{
+    uint32_t p = le ? bitswap32(poly) : poly << (32 - bits);
+    uint64_t q = 1ULL << 32, r = (uint64_t)p << 32;
+    int i;
+
+    /* q = x^64 / (x^32 + p), r starts as x^64 - x^32 * (x^32 + p) */
+    for (i = 63; i >= 32; i--) {
+        if (r >> i & 1) {
+            q |= 1ULL << (i - 32);
+            r ^= 1ULL << i ^ (uint64_t)p << (i - 32);
+        }
+    }
+
+    c->fold4[0]   = fold_const(4 * 128 + 32, p);
+    c->fold4[1]   = fold_const(4 * 128 - 32, p);
+    c->fold1[0]   = fold_const(128 + 32, p);
+    c->fold1[1]   = fold_const(128 - 32, p);
+    c->fold64[0]  = fold_const(64, p);
+    c->fold64[1]  = 0;
+    c->barrett[0] = (uint64_t)bitswap32(p) << 1 | 1;
+    c->barrett[1] = (uint64_t)bitswap32(q) << 1 | (q >> 32);
+    c->le         = le;
+}
+
+static const DECLARE_ALIGNED(16, uint8_t, clmul_tab)[4][16] = {
+    /* low 32 bits of each 64-bit lane */
+    { 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0 },
+    /* low nibble of each byte */
+    { 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+      0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F },
+    /* reversed nibble, in the high nibble */
+    { 0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0,
+      0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0 },
+    /* reversed nibble */
+    { 0x00, 0x08, 0x04, 0x0C, 0x02, 0x0A, 0x06, 0x0E,
+      0x01, 0x09, 0x05, 0x0D, 0x03, 0x0B, 0x07, 0x0F },
+};
+
+/* Load 16 bytes of input at off into xmm9. */
+#define LOAD_LE(off)                                            \
+    "movdqu       "off"(%[buf]), %%xmm9     \n\t"
+
+/* Same with the bits of each byte reversed. */
+#define LOAD_BE(off)                                            \
+    "movdqu       "off"(%[buf]), %%xmm10    \n\t"               \
+    "movdqa            %%xmm10, %%xmm9      \n\t"               \
+    "psrlw                  $4, %%xmm10     \n\t"               \
+    "pand              %%xmm13, %%xmm9      \n\t"               \
+    "pand              %%xmm13, %%xmm10     \n\t"               \
+    "movdqa            %%xmm14, %%xmm11     \n\t"               \
+    "pshufb             %%xmm9, %%xmm11     \n\t"               \
+    "movdqa            %%xmm15, %%xmm9      \n\t"               \
+    "pshufb            %%xmm10, %%xmm9      \n\t"               \
+    "por               %%xmm11, %%xmm9      \n\t"
+
+/* state = state.lo * k.lo ^ state.hi * k.hi ^ next, with k in xmm0 */
+#define FOLD(state, tmp, next)                                  \
+    "movdqa         %%"state", %%"tmp"      \n\t"               \
+    "pclmulqdq      $0x00, %%xmm0, %%"tmp"  \n\t"               \
+    "pclmulqdq      $0x11, %%xmm0, %%"state"\n\t"               \
+    "pxor           %%"tmp", %%"state"      \n\t"               \
+    "pxor           %%"next", %%"state"     \n\t"
+
+#define CRC_CLMUL(name, LOAD)                                                 \
+static uint32_t name(const CRCClmulContext *c, uint32_t crc,                  \
+                     const uint8_t *buf, x86_reg len)                         \
+{                                                                             \
+    __asm__ volatile (                                                        \
+        "movdqa         %[mask], %%xmm12        \n\t"                         \
+        "movdqa       %[nibble], %%xmm13        \n\t"                         \
+        "movdqa      %[rev_high], %%xmm14       \n\t"                         \
+        "movdqa       %[rev_low], %%xmm15       \n\t"                         \
+                                                                              \
+        LOAD("0")                                                             \
+        "movdqa          %%xmm9, %%xmm1         \n\t"                         \
+        LOAD("16")                                                            \
+        "movdqa          %%xmm9, %%xmm2         \n\t"                         \
+        LOAD("32")                                                            \
+        "movdqa          %%xmm9, %%xmm3         \n\t"                         \
+        LOAD("48")                                                            \
+        "movdqa          %%xmm9, %%xmm4         \n\t"                         \
+        "movd             %[crc], %%xmm5        \n\t"                         \
+        "pxor            %%xmm5, %%xmm1         \n\t"                         \
+        "add                $64, %[buf]         \n\t"                         \
+        "sub                $64, %[len]         \n\t"                         \
+                                                                              \
+        /* fold 64 bytes at a time */                                         \
+        "movdqa        %[fold4], %%xmm0         \n\t"                         \
+        "cmp                $64, %[len]         \n\t"                         \
+        "jb                  2f                 \n\t"                         \
+        "1:                                     \n\t"                         \
+        LOAD("0")                                                             \
+        FOLD("xmm1", "xmm5", "xmm9")                                          \
+        LOAD("16")                                                            \
+        FOLD("xmm2", "xmm6", "xmm9")                                          \
+        LOAD("32")                                                            \
+        FOLD("xmm3", "xmm7", "xmm9")                                          \
+        LOAD("48")                                                            \
+        FOLD("xmm4", "xmm8", "xmm9")                                          \
+        "add                $64, %[buf]         \n\t"                         \
+        "sub                $64, %[len]         \n\t"                         \
+        "cmp                $64, %[len]         \n\t"                         \
+        "jae                 1b                 \n\t"                         \
+                                                                              \
+        /* fold the 4 lanes into one, then 16 bytes at a time */              \
+        "2:                                     \n\t"                         \
+        "movdqa        %[fold1], %%xmm0         \n\t"                         \
+        FOLD("xmm1", "xmm5", "xmm2")                                          \
+        FOLD("xmm1", "xmm5", "xmm3")                                          \
+        FOLD("xmm1", "xmm5", "xmm4")                                          \
+        "test            %[len], %[len]         \n\t"                         \
+        "jz                  4f                 \n\t"                         \
+        "3:                                     \n\t"                         \
+        LOAD("0")                                                             \
+        FOLD("xmm1", "xmm5", "xmm9")                                          \
+        "add                $16, %[buf]         \n\t"                         \
+        "sub                $16, %[len]         \n\t"                         \
+        "jnz                 3b                 \n\t"                         \
+        "4:                                     \n\t"                         \
+                                                                              \
+        /* reduce 128 to 64 bits */                                           \
+        "movdqa          %%xmm1, %%xmm2         \n\t"                         \
+        "pclmulqdq $0x10, %%xmm0, %%xmm2        \n\t"                         \
+        "psrldq              $8, %%xmm1         \n\t"                         \
+        "pxor            %%xmm2, %%xmm1         \n\t"                         \
+        "movdqa       %[fold64], %%xmm0         \n\t"                         \
+        "movdqa          %%xmm1, %%xmm2         \n\t"                         \
+        "psrldq              $4, %%xmm2         \n\t"                         \
+        "pand           %%xmm12, %%xmm1         \n\t"                         \
+        "pclmulqdq $0x00, %%xmm0, %%xmm1        \n\t"                         \
+        "pxor            %%xmm2, %%xmm1         \n\t"                         \
+                                                                              \
+        /* Barrett reduction to 32 bits */                                    \
+        "movdqa      %[barrett], %%xmm0         \n\t"                         \
+        "movdqa          %%xmm1, %%xmm2         \n\t"                         \
+        "pand           %%xmm12, %%xmm2         \n\t"                         \
+        "pclmulqdq $0x10, %%xmm0, %%xmm2        \n\t"                         \
+        "pand           %%xmm12, %%xmm2         \n\t"                         \
+        "pclmulqdq $0x00, %%xmm0, %%xmm2        \n\t"                         \
+        "pxor            %%xmm2, %%xmm1         \n\t"                         \
+        "pextrd         $1, %%xmm1, %[crc]      \n\t"                         \
+        : [crc]"+r"(crc), [buf]"+r"(buf), [len]"+r"(len)                      \
+        : [fold4]"m"(c->fold4), [fold1]"m"(c->fold1),                         \
+          [fold64]"m"(c->fold64), [barrett]"m"(c->barrett),                   \
+          [mask]"m"(clmul_tab[0]), [nibble]"m"(clmul_tab[1]),                 \
+          [rev_high]"m"(clmul_tab[2]), [rev_low]"m"(clmul_tab[3])             \
+        : XMM_CLOBBERS("%xmm0",  "%xmm1",  "%xmm2",  "%xmm3",                 \
+                       "%xmm4",  "%xmm5",  "%xmm6",  "%xmm7",                 \
+                       "%xmm8",  "%xmm9",  "%xmm10", "%xmm11",                \
+                       "%xmm12", "%xmm13", "%xmm14", "%xmm15",)               \
+          "memory"                                                            \
+    );                                                                        \
+    return crc;                                                               \
+}
+
+CRC_CLMUL(crc_clmul_le, LOAD_LE)
+CRC_CLMUL(crc_clmul_be, LOAD_BE)
+
+uint32_t ff_crc_clmul(const CRCClmulContext *c, uint32_t crc,
+                      const uint8_t *buffer, size_t length)
+{
+    if (c->le)
+        return crc_clmul_le(c, crc, buffer, length);
+
+    /* The big-endian CRCs are kept byte-swapped by av_crc(), so reversing
+     * the bits of each byte gives the reflected CRC. */
+    crc = bitswap32(av_bswap32(crc));
+    crc = crc_clmul_be(c, crc, buffer, length);
+    return av_bswap32(bitswap32(crc));
+}
+
+#endif /* HAVE_CRC_CLMUL */
@@ -0,0 +1,58 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_CRC_H
+#define AVUTIL_X86_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "libavutil/mem.h"
+
+#define HAVE_CRC_CLMUL (ARCH_X86_64 && HAVE_CLMUL_INLINE)
+
+/**
+ * Constants for folding a CRC with carry-less multiplications.
+ *
+ * All CRCs are handled as 32-bit bit-reflected CRCs: the generator of a
+ * shorter CRC is multiplied by x^(32 - bits), and the input bits of a
+ * big-endian CRC are reversed.
+ */
+typedef struct CRCClmulContext {
+    DECLARE_ALIGNED(16, uint64_t, fold4)[2];    ///< x^(512+32), x^(512-32) mod P
+    DECLARE_ALIGNED(16, uint64_t, fold1)[2];    ///< x^(128+32), x^(128-32) mod P
+    DECLARE_ALIGNED(16, uint64_t, fold64)[2];   ///< x^64 mod P
+    DECLARE_ALIGNED(16, uint64_t, barrett)[2];  ///< P, x^64 / P
+    int le;
+} CRCClmulContext;
+
+/**
+ * Compute the folding constants of a CRC, with the av_crc_init() parameters.
+ */
+void ff_crc_clmul_init(CRCClmulContext *c, int le, int bits, uint32_t poly);
+
+/**
+ * Update a CRC as av_crc() with the table of the same CRC would.
+ *
+ * @param length at least 64 and a multiple of 16
+ */
+uint32_t ff_crc_clmul(const CRCClmulContext *c, uint32_t crc,
+                      const uint8_t *buffer, size_t length);
+
+#endif /* AVUTIL_X86_CRC_H */
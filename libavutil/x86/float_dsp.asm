@@ -24,6 +24,8 @@
 
 SECTION_RODATA 32
 pd_reverse: dd 7, 6, 5, 4, 3, 2, 1, 0
+pd_reverse16: dd 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+pd_0to15: dd 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
 
 SECTION .text
 
@@ -58,6 +60,22 @@ INIT_YMM avx
 VECTOR_FMUL
 %endif
 
+; The buffers are only 32-byte aligned, so the zmm versions use unaligned
+; loads and stores.
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+cglobal vector_fmul, 4,4,1, dst, src0, src1, len
+    lea       lenq, [lend*4 - mmsize]
+ALIGN 16
+.loop:
+    movups    m0,   [src0q + lenq]
+    mulps     m0, m0, [src1q + lenq]
+    movups    [dstq + lenq], m0
+    sub       lenq, mmsize
+    jge       .loop
+    RET
+%endif
+
 ;------------------------------------------------------------------------------
 ; void ff_vector_fmac_scalar(float *dst, const float *src, float mul, int len)
 ;------------------------------------------------------------------------------
@@ -122,6 +140,45 @@ INIT_YMM fma3
 VECTOR_FMAC_SCALAR
 %endif
 
+; broadcast the float or double scalar argument to m0
+%macro BROADCAST_MUL 1 ; ss/sd
+%if ARCH_X86_32
+    vbroadcast%1 m0, mulm
+%else
+%if WIN64
+    SWAP 0, 2
+%endif
+    vbroadcast%1 m0, xm0
+%endif
+%endmacro
+
+; k1 = lanes of the final, partial vector (len & 15 floats)
+%macro TAIL_MASK 2 ; len, tmp
+    mov        %2d, %1d
+    and        %2d, 15
+    sub        %1d, %2d
+    vpbroadcastd m1, %2d
+    vpcmpgtd   k1, m1, [pd_0to15]
+%endmacro
+
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+%if UNIX64
+cglobal vector_fmac_scalar, 3,3,2, dst, src, len
+%else
+cglobal vector_fmac_scalar, 4,4,3, dst, src, mul, len
+%endif
+    BROADCAST_MUL ss
+    lea    lenq, [lend*4-mmsize]
+.loop:
+    movups       m1, [dstq+lenq]
+    vfmadd231ps  m1, m0, [srcq+lenq]
+    movups [dstq+lenq], m1
+    sub    lenq, mmsize
+    jge .loop
+    RET
+%endif
+
 ;------------------------------------------------------------------------------
 ; void ff_vector_fmul_scalar(float *dst, const float *src, float mul, int len)
 ;------------------------------------------------------------------------------
@@ -151,6 +208,30 @@ cglobal vector_fmul_scalar, 4,4,3, dst, src, mul, len
 INIT_XMM sse
 VECTOR_FMUL_SCALAR
 
+; len is only a multiple of 4, the last partial vector is masked
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+%if UNIX64
+cglobal vector_fmul_scalar, 3,4,2, dst, src, len, tail
+%else
+cglobal vector_fmul_scalar, 4,5,3, dst, src, mul, len, tail
+%endif
+    BROADCAST_MUL ss
+    TAIL_MASK  len, tail
+    shl      lend, 2
+    vmulps     m1{k1}{z}, m0, [srcq+lenq]
+    vmovups    [dstq+lenq]{k1}, m1
+    sub      lenq, mmsize
+    jl .end
+.loop:
+    mulps      m1, m0, [srcq+lenq]
+    movups  [dstq+lenq], m1
+    sub      lenq, mmsize
+    jge .loop
+.end:
+    RET
+%endif
+
 ;------------------------------------------------------------------------------
 ; void ff_vector_dmac_scalar(double *dst, const double *src, double mul,
 ;                            int len)
@@ -214,6 +295,30 @@ INIT_YMM fma3
 VECTOR_DMAC_SCALAR
 %endif
 
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+%if ARCH_X86_32
+cglobal vector_dmac_scalar, 2,4,3, dst, src, mul, len, lenaddr
+    mov          lenq, lenaddrm
+%elif UNIX64
+cglobal vector_dmac_scalar, 3,3,3, dst, src, len
+%else
+cglobal vector_dmac_scalar, 4,4,3, dst, src, mul, len
+%endif
+    BROADCAST_MUL sd
+    lea    lenq, [lend*8-mmsize*2]
+.loop:
+    movupd       m1, [dstq+lenq]
+    movupd       m2, [dstq+lenq+mmsize]
+    vfmadd231pd  m1, m0, [srcq+lenq]
+    vfmadd231pd  m2, m0, [srcq+lenq+mmsize]
+    movupd [dstq+lenq], m1
+    movupd [dstq+lenq+mmsize], m2
+    sub    lenq, mmsize*2
+    jge .loop
+    RET
+%endif
+
 ;------------------------------------------------------------------------------
 ; void ff_vector_dmul_scalar(double *dst, const double *src, double mul,
 ;                            int len)
@@ -257,6 +362,26 @@ INIT_YMM avx
 VECTOR_DMUL_SCALAR
 %endif
 
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+%if ARCH_X86_32
+cglobal vector_dmul_scalar, 3,4,2, dst, src, mul, len, lenaddr
+    mov          lenq, lenaddrm
+%elif UNIX64
+cglobal vector_dmul_scalar, 3,3,2, dst, src, len
+%else
+cglobal vector_dmul_scalar, 4,4,3, dst, src, mul, len
+%endif
+    BROADCAST_MUL sd
+    lea          lenq, [lend*8-mmsize]
+.loop:
+    mulpd          m1, m0, [srcq+lenq]
+    movupd [dstq+lenq], m1
+    sub          lenq, mmsize
+    jge .loop
+    RET
+%endif
+
 ;-----------------------------------------------------------------------------
 ; vector_fmul_window(float *dst, const float *src0,
 ;                    const float *src1, const float *win, int len);
@@ -356,6 +481,21 @@ INIT_YMM fma3
 VECTOR_FMUL_ADD
 %endif
 
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+cglobal vector_fmul_add, 5,5,2, dst, src0, src1, src2, len
+    lea       lenq, [lend*4 - mmsize]
+ALIGN 16
+.loop:
+    movups  m0, [src0q + lenq]
+    movups  m1, [src2q + lenq]
+    vfmadd231ps m1, m0, [src1q + lenq]
+    movups  [dstq + lenq], m1
+    sub     lenq,   mmsize
+    jge     .loop
+    RET
+%endif
+
 ;-----------------------------------------------------------------------------
 ; void vector_fmul_reverse(float *dst, const float *src0, const float *src1,
 ;                          int len)
@@ -405,6 +545,22 @@ INIT_YMM avx2
 VECTOR_FMUL_REVERSE
 %endif
 
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+cglobal vector_fmul_reverse, 4,4,2, dst, src0, src1, len
+    movups  m1, [pd_reverse16]
+    lea       lenq, [lend*4 - mmsize]
+ALIGN 16
+.loop:
+    vpermps m0, m1, [src1q]
+    mulps   m0, m0, [src0q + lenq]
+    movups  [dstq + lenq], m0
+    add     src1q, mmsize
+    sub     lenq,  mmsize
+    jge     .loop
+    RET
+%endif
+
 ; float scalarproduct_float_sse(const float *v1, const float *v2, int len)
 INIT_XMM sse
 cglobal scalarproduct_float, 3,3,2, v1, v2, offset
@@ -430,6 +586,36 @@ cglobal scalarproduct_float, 3,3,2, v1, v2, offset
 %endif
     RET
 
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+cglobal scalarproduct_float, 3,4,3, v1, v2, len, tail
+    TAIL_MASK    len, tail
+    shl        lend, 2
+    vmovups      m0{k1}{z}, [v1q+lenq]
+    vmulps       m0{k1}{z}, m0, [v2q+lenq]
+    sub        lenq, mmsize
+    jl .end
+.loop:
+    movups       m1, [v1q+lenq]
+    vfmadd231ps  m0, m1, [v2q+lenq]
+    sub        lenq, mmsize
+    jge .loop
+.end:
+    vextractf64x4 ym1, m0, 1
+    addps       ym0, ym1
+    vextractf128 xm1, ym0, 1
+    addps       xm0, xm1
+    movhlps     xm1, xm0
+    addps       xm0, xm1
+    movshdup    xm1, xm0
+    addss       xm0, xm1
+%if ARCH_X86_64 == 0
+    movss       r0m, xm0
+    fld dword   r0m
+%endif
+    RET
+%endif
+
 ;-----------------------------------------------------------------------------
 ; void ff_butterflies_float(float *src0, float *src1, int len);
 ;-----------------------------------------------------------------------------
@@ -28,6 +28,8 @@ void ff_vector_fmul_sse(float *dst, const float *src0, const float *src1,
                         int len);
 void ff_vector_fmul_avx(float *dst, const float *src0, const float *src1,
                         int len);
+void ff_vector_fmul_avx512(float *dst, const float *src0, const float *src1,
+                           int len);
 
 void ff_vector_fmac_scalar_sse(float *dst, const float *src, float mul,
                                int len);
@@ -35,9 +37,13 @@ void ff_vector_fmac_scalar_avx(float *dst, const float *src, float mul,
                                int len);
 void ff_vector_fmac_scalar_fma3(float *dst, const float *src, float mul,
                                 int len);
+void ff_vector_fmac_scalar_avx512(float *dst, const float *src, float mul,
+                                  int len);
 
 void ff_vector_fmul_scalar_sse(float *dst, const float *src, float mul,
                                int len);
+void ff_vector_fmul_scalar_avx512(float *dst, const float *src, float mul,
+                                  int len);
 
 void ff_vector_dmac_scalar_sse2(double *dst, const double *src, double mul,
                                 int len);
@@ -45,11 +51,15 @@ void ff_vector_dmac_scalar_avx(double *dst, const double *src, double mul,
                                int len);
 void ff_vector_dmac_scalar_fma3(double *dst, const double *src, double mul,
                                 int len);
+void ff_vector_dmac_scalar_avx512(double *dst, const double *src, double mul,
+                                  int len);
 
 void ff_vector_dmul_scalar_sse2(double *dst, const double *src,
                                 double mul, int len);
 void ff_vector_dmul_scalar_avx(double *dst, const double *src,
                                double mul, int len);
+void ff_vector_dmul_scalar_avx512(double *dst, const double *src,
+                                  double mul, int len);
 
 void ff_vector_fmul_window_3dnowext(float *dst, const float *src0,
                                     const float *src1, const float *win, int len);
@@ -62,6 +72,8 @@ void ff_vector_fmul_add_avx(float *dst, const float *src0, const float *src1,
                             const float *src2, int len);
 void ff_vector_fmul_add_fma3(float *dst, const float *src0, const float *src1,
                              const float *src2, int len);
+void ff_vector_fmul_add_avx512(float *dst, const float *src0, const float *src1,
+                               const float *src2, int len);
 
 void ff_vector_fmul_reverse_sse(float *dst, const float *src0,
                                 const float *src1, int len);
@@ -69,8 +81,11 @@ void ff_vector_fmul_reverse_avx(float *dst, const float *src0,
                                 const float *src1, int len);
 void ff_vector_fmul_reverse_avx2(float *dst, const float *src0,
                                  const float *src1, int len);
+void ff_vector_fmul_reverse_avx512(float *dst, const float *src0,
+                                   const float *src1, int len);
 
 float ff_scalarproduct_float_sse(const float *v1, const float *v2, int order);
+float ff_scalarproduct_float_avx512(const float *v1, const float *v2, int order);
 
 void ff_butterflies_float_sse(float *av_restrict src0, float *av_restrict src1, int len);
 
@@ -111,4 +126,14 @@ av_cold void ff_float_dsp_init_x86(AVFloatDSPContext *fdsp)
         fdsp->vector_fmul_add    = ff_vector_fmul_add_fma3;
         fdsp->vector_dmac_scalar = ff_vector_dmac_scalar_fma3;
     }
+    if (EXTERNAL_AVX512(cpu_flags)) {
+        fdsp->vector_fmul         = ff_vector_fmul_avx512;
+        fdsp->vector_fmac_scalar  = ff_vector_fmac_scalar_avx512;
+        fdsp->vector_fmul_scalar  = ff_vector_fmul_scalar_avx512;
+        fdsp->vector_dmac_scalar  = ff_vector_dmac_scalar_avx512;
+        fdsp->vector_dmul_scalar  = ff_vector_dmul_scalar_avx512;
+        fdsp->vector_fmul_add     = ff_vector_fmul_add_avx512;
+        fdsp->vector_fmul_reverse = ff_vector_fmul_reverse_avx512;
+        fdsp->scalarproduct_float = ff_scalarproduct_float_avx512;
+    }
 }
@@ -0,0 +1,278 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * SHA-1 and SHA-256 block transforms with the Intel SHA extensions.
+ */
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "sha.h"
+
+#if HAVE_SHA_SHANI
+
+static const DECLARE_ALIGNED(16, uint32_t, K256)[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const DECLARE_ALIGNED(16, uint8_t, sha_flip)[2][16] = {
+    /* big-endian 128-bit word */
+    { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+    /* big-endian 32-bit words */
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+};
+
+/* Load the 16 bytes of input at off into m, with the byte order fixed. */
+#define LOAD(off, m, mask)                                      \
+    "movdqu       "off"(%[buf]), %%"m"      \n\t"               \
+    "pshufb          %%"mask", %%"m"        \n\t"
+
+/*
+ * SHA-1: ABCD in xmm0, E alternates between xmm1 and xmm2, the message
+ * schedule rotates through xmm3-xmm6.
+ */
+
+/* 4 rounds with function f and message words msg, with E in e; the E of
+ * the next 4 rounds is derived from ABCD into e_next. */
+#define SHA1_ROUNDS(f, msg, e, e_next)                          \
+    "sha1nexte        %%"msg", %%"e"        \n\t"               \
+    "movdqa            %%xmm0, %%"e_next"   \n\t"               \
+    "sha1rnds4  $"f", %%"e", %%xmm0         \n\t"
+
+#define SHA1_MSG1(msg, dst) "sha1msg1 %%"msg", %%"dst"          \n\t"
+#define SHA1_MSG2(msg, dst) "sha1msg2 %%"msg", %%"dst"          \n\t"
+#define SHA1_XOR(msg, dst)  "pxor     %%"msg", %%"dst"          \n\t"
+
+void ff_sha1_transform_shani(uint32_t *state, const uint8_t buffer[64])
+{
+    __asm__ volatile (
+        "pxor              %%xmm1, %%xmm1       \n\t"
+        "pinsrd $3, 16(%[state]), %%xmm1        \n\t"
+        "movdqu        (%[state]), %%xmm0       \n\t"
+        "pshufd     $0x1B, %%xmm0, %%xmm0       \n\t"
+        "movdqa           %[flip], %%xmm7       \n\t"
+        "movdqa            %%xmm1, %%xmm8       \n\t"
+        "movdqa            %%xmm0, %%xmm9       \n\t"
+
+        LOAD( "0", "xmm3", "xmm7")
+        LOAD("16", "xmm4", "xmm7")
+        LOAD("32", "xmm5", "xmm7")
+        LOAD("48", "xmm6", "xmm7")
+
+        /* rounds 0-3 */
+        "paddd             %%xmm3, %%xmm1       \n\t"
+        "movdqa            %%xmm0, %%xmm2       \n\t"
+        "sha1rnds4  $0, %%xmm1, %%xmm0          \n\t"
+        /* rounds 4-19 */
+        SHA1_ROUNDS("0", "xmm4", "xmm2", "xmm1")
+        SHA1_MSG1("xmm4", "xmm3")
+        SHA1_ROUNDS("0", "xmm5", "xmm1", "xmm2")
+        SHA1_MSG1("xmm5", "xmm4") SHA1_XOR("xmm5", "xmm3")
+        SHA1_MSG2("xmm6", "xmm3")
+        SHA1_ROUNDS("0", "xmm6", "xmm2", "xmm1")
+        SHA1_MSG1("xmm6", "xmm5") SHA1_XOR("xmm6", "xmm4")
+        SHA1_MSG2("xmm3", "xmm4")
+        SHA1_ROUNDS("0", "xmm3", "xmm1", "xmm2")
+        SHA1_MSG1("xmm3", "xmm6") SHA1_XOR("xmm3", "xmm5")
+        /* rounds 20-39 */
+        SHA1_MSG2("xmm4", "xmm5")
+        SHA1_ROUNDS("1", "xmm4", "xmm2", "xmm1")
+        SHA1_MSG1("xmm4", "xmm3") SHA1_XOR("xmm4", "xmm6")
+        SHA1_MSG2("xmm5", "xmm6")
+        SHA1_ROUNDS("1", "xmm5", "xmm1", "xmm2")
+        SHA1_MSG1("xmm5", "xmm4") SHA1_XOR("xmm5", "xmm3")
+        SHA1_MSG2("xmm6", "xmm3")
+        SHA1_ROUNDS("1", "xmm6", "xmm2", "xmm1")
+        SHA1_MSG1("xmm6", "xmm5") SHA1_XOR("xmm6", "xmm4")
+        SHA1_MSG2("xmm3", "xmm4")
+        SHA1_ROUNDS("1", "xmm3", "xmm1", "xmm2")
+        SHA1_MSG1("xmm3", "xmm6") SHA1_XOR("xmm3", "xmm5")
+        SHA1_MSG2("xmm4", "xmm5")
+        SHA1_ROUNDS("1", "xmm4", "xmm2", "xmm1")
+        SHA1_MSG1("xmm4", "xmm3") SHA1_XOR("xmm4", "xmm6")
+        /* rounds 40-59 */
+        SHA1_MSG2("xmm5", "xmm6")
+        SHA1_ROUNDS("2", "xmm5", "xmm1", "xmm2")
+        SHA1_MSG1("xmm5", "xmm4") SHA1_XOR("xmm5", "xmm3")
+        SHA1_MSG2("xmm6", "xmm3")
+        SHA1_ROUNDS("2", "xmm6", "xmm2", "xmm1")
+        SHA1_MSG1("xmm6", "xmm5") SHA1_XOR("xmm6", "xmm4")
+        SHA1_MSG2("xmm3", "xmm4")
+        SHA1_ROUNDS("2", "xmm3", "xmm1", "xmm2")
+        SHA1_MSG1("xmm3", "xmm6") SHA1_XOR("xmm3", "xmm5")
+        SHA1_MSG2("xmm4", "xmm5")
+        SHA1_ROUNDS("2", "xmm4", "xmm2", "xmm1")
+        SHA1_MSG1("xmm4", "xmm3") SHA1_XOR("xmm4", "xmm6")
+        SHA1_MSG2("xmm5", "xmm6")
+        SHA1_ROUNDS("2", "xmm5", "xmm1", "xmm2")
+        SHA1_MSG1("xmm5", "xmm4") SHA1_XOR("xmm5", "xmm3")
+        /* rounds 60-79 */
+        SHA1_MSG2("xmm6", "xmm3")
+        SHA1_ROUNDS("3", "xmm6", "xmm2", "xmm1")
+        SHA1_MSG1("xmm6", "xmm5") SHA1_XOR("xmm6", "xmm4")
+        SHA1_MSG2("xmm3", "xmm4")
+        SHA1_ROUNDS("3", "xmm3", "xmm1", "xmm2")
+        SHA1_MSG1("xmm3", "xmm6") SHA1_XOR("xmm3", "xmm5")
+        SHA1_MSG2("xmm4", "xmm5")
+        SHA1_ROUNDS("3", "xmm4", "xmm2", "xmm1")
+        SHA1_XOR("xmm4", "xmm6")
+        SHA1_MSG2("xmm5", "xmm6")
+        SHA1_ROUNDS("3", "xmm5", "xmm1", "xmm2")
+        SHA1_ROUNDS("3", "xmm6", "xmm2", "xmm1")
+
+        "sha1nexte         %%xmm8, %%xmm1       \n\t"
+        "paddd             %%xmm9, %%xmm0       \n\t"
+        "pshufd     $0x1B, %%xmm0, %%xmm0       \n\t"
+        "movdqu            %%xmm0, (%[state])   \n\t"
+        "pextrd $3, %%xmm1, 16(%[state])        \n\t"
+        :
+        : [state]"r"(state), [buf]"r"(buffer), [flip]"m"(sha_flip[0])
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",
+                       "%xmm5", "%xmm6", "%xmm7", "%xmm8", "%xmm9",)
+          "memory"
+    );
+}
+
+/*
+ * SHA-256: the state is kept as ABEF in xmm1 and CDGH in xmm2, the
+ * message schedule rotates through xmm3-xmm6. SHA256RNDS2 takes the
+ * message words plus constants in xmm0.
+ */
+
+/* 4 rounds with message words m0; in rounds 12 to 59 m1 gets the
+ * schedule of 12 rounds later, m3 being the words before m0. */
+#define SHA256_ROUNDS_LO(off, m0)                               \
+    "movdqa       "off"(%[k]), %%xmm0       \n\t"               \
+    "paddd           %%"m0", %%xmm0         \n\t"               \
+    "sha256rnds2       %%xmm1, %%xmm2       \n\t"
+#define SHA256_ROUNDS_HI                                        \
+    "punpckhqdq        %%xmm0, %%xmm0       \n\t"               \
+    "sha256rnds2       %%xmm2, %%xmm1       \n\t"
+#define SHA256_MSG2(m0, m1, m3)                                 \
+    "movdqa          %%"m0", %%xmm7         \n\t"               \
+    "palignr      $4, %%"m3", %%xmm7        \n\t"               \
+    "paddd           %%xmm7, %%"m1"         \n\t"               \
+    "sha256msg2      %%"m0", %%"m1"         \n\t"
+#define SHA256_MSG1(m0, m3) "sha256msg1 %%"m0", %%"m3"          \n\t"
+
+/* rounds 16-31 and 32-47 */
+#define SHA256_ROUNDS16(o0, o1, o2, o3)                         \
+    SHA256_ROUNDS_LO(o0, "xmm3")                                \
+    SHA256_MSG2("xmm3", "xmm4", "xmm6")                         \
+    SHA256_ROUNDS_HI                                            \
+    SHA256_MSG1("xmm3", "xmm6")                                 \
+    SHA256_ROUNDS_LO(o1, "xmm4")                                \
+    SHA256_MSG2("xmm4", "xmm5", "xmm3")                         \
+    SHA256_ROUNDS_HI                                            \
+    SHA256_MSG1("xmm4", "xmm3")                                 \
+    SHA256_ROUNDS_LO(o2, "xmm5")                                \
+    SHA256_MSG2("xmm5", "xmm6", "xmm4")                         \
+    SHA256_ROUNDS_HI                                            \
+    SHA256_MSG1("xmm5", "xmm4")                                 \
+    SHA256_ROUNDS_LO(o3, "xmm6")                                \
+    SHA256_MSG2("xmm6", "xmm3", "xmm5")                         \
+    SHA256_ROUNDS_HI                                            \
+    SHA256_MSG1("xmm6", "xmm5")
+
+void ff_sha256_transform_shani(uint32_t *state, const uint8_t buffer[64])
+{
+    __asm__ volatile (
+        "movdqu        (%[state]), %%xmm1       \n\t" /* DCBA */
+        "movdqu      16(%[state]), %%xmm2       \n\t" /* HGFE */
+        "movdqa            %%xmm1, %%xmm7       \n\t"
+        "punpcklqdq        %%xmm2, %%xmm1       \n\t" /* FEBA */
+        "punpckhqdq        %%xmm7, %%xmm2       \n\t" /* DCHG */
+        "pshufd     $0x1B, %%xmm1, %%xmm1       \n\t" /* ABEF */
+        "pshufd     $0xB1, %%xmm2, %%xmm2       \n\t" /* CDGH */
+        "movdqa           %[flip], %%xmm8       \n\t"
+        "movdqa            %%xmm1, %%xmm9       \n\t"
+        "movdqa            %%xmm2, %%xmm10      \n\t"
+
+        /* rounds 0-15 */
+        LOAD( "0", "xmm3", "xmm8")
+        SHA256_ROUNDS_LO("0", "xmm3")
+        SHA256_ROUNDS_HI
+        LOAD("16", "xmm4", "xmm8")
+        SHA256_ROUNDS_LO("16", "xmm4")
+        SHA256_ROUNDS_HI
+        SHA256_MSG1("xmm4", "xmm3")
+        LOAD("32", "xmm5", "xmm8")
+        SHA256_ROUNDS_LO("32", "xmm5")
+        SHA256_ROUNDS_HI
+        SHA256_MSG1("xmm5", "xmm4")
+        LOAD("48", "xmm6", "xmm8")
+        SHA256_ROUNDS_LO("48", "xmm6")
+        SHA256_MSG2("xmm6", "xmm3", "xmm5")
+        SHA256_ROUNDS_HI
+        SHA256_MSG1("xmm6", "xmm5")
+
+        SHA256_ROUNDS16( "64",  "80",  "96", "112")
+        SHA256_ROUNDS16("128", "144", "160", "176")
+
+        /* rounds 48-63 */
+        SHA256_ROUNDS_LO("192", "xmm3")
+        SHA256_MSG2("xmm3", "xmm4", "xmm6")
+        SHA256_ROUNDS_HI
+        SHA256_MSG1("xmm3", "xmm6")
+        SHA256_ROUNDS_LO("208", "xmm4")
+        SHA256_MSG2("xmm4", "xmm5", "xmm3")
+        SHA256_ROUNDS_HI
+        SHA256_ROUNDS_LO("224", "xmm5")
+        SHA256_MSG2("xmm5", "xmm6", "xmm4")
+        SHA256_ROUNDS_HI
+        SHA256_ROUNDS_LO("240", "xmm6")
+        SHA256_ROUNDS_HI
+
+        "paddd             %%xmm9, %%xmm1       \n\t"
+        "paddd            %%xmm10, %%xmm2       \n\t"
+        "movdqa            %%xmm1, %%xmm7       \n\t"
+        "punpcklqdq        %%xmm2, %%xmm1       \n\t" /* GHEF */
+        "punpckhqdq        %%xmm7, %%xmm2       \n\t" /* ABCD */
+        "pshufd     $0xB1, %%xmm1, %%xmm1       \n\t" /* HGFE */
+        "pshufd     $0x1B, %%xmm2, %%xmm2       \n\t" /* DCBA */
+        "movdqu            %%xmm2, (%[state])   \n\t"
+        "movdqu            %%xmm1, 16(%[state]) \n\t"
+        :
+        : [state]"r"(state), [buf]"r"(buffer), [k]"r"(K256),
+          [flip]"m"(sha_flip[1])
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",
+                       "%xmm5", "%xmm6", "%xmm7", "%xmm8", "%xmm9",
+                       "%xmm10",)
+          "memory"
+    );
+}
+
+#endif /* HAVE_SHA_SHANI */
@@ -0,0 +1,39 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_X86_SHA_H
+#define AVUTIL_X86_SHA_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+#define HAVE_SHA_SHANI (ARCH_X86_64 && HAVE_SHANI_INLINE)
+
+/**
+ * Update a SHA-1 state with one 64-byte block, as sha1_transform() does.
+ */
+void ff_sha1_transform_shani(uint32_t *state, const uint8_t buffer[64]);
+
+/**
+ * Update a SHA-224 or SHA-256 state with one 64-byte block, as
+ * sha256_transform() does.
+ */
+void ff_sha256_transform_shani(uint32_t *state, const uint8_t buffer[64]);
+
+#endif /* AVUTIL_X86_SHA_H */
@@ -22,6 +22,8 @@
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
 
+#define MIX_BLOCK_SIZE 256
+
 #define TEMPLATE_REMATRIX_FLT
 #include "rematrix_template.c"
 #undef TEMPLATE_REMATRIX_FLT
@@ -415,10 +417,12 @@ av_cold int swri_rematrix_init(SwrContext *s){
             s->mix_1_1_f = (mix_1_1_func_type*)copy_s16;
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_s16;
             s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s16(s);
+            s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_s16;
         } else {
             s->mix_1_1_f = (mix_1_1_func_type*)copy_clip_s16;
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_clip_s16;
             s->mix_any_f = (mix_any_func_type*)get_mix_any_func_clip_s16(s);
+            s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_clip_s16;
         }
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_FLTP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(float));
@@ -432,6 +436,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_float;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
         s->native_one    = av_mallocz(sizeof(double));
@@ -444,6 +449,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_double;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
         // Only for dithering currently
 //         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
@@ -457,6 +463,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_s32;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_s32;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s32(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)mix_n_1_s32;
     }else
         av_assert0(0);
     //FIXME quantize for integeres
@@ -484,7 +491,7 @@ av_cold void swri_rematrix_free(SwrContext *s){
 }
 
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
+    int out_i, in_i, j;
     int len1 = 0;
     int off = 0;
 
@@ -493,7 +500,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
         return 0;
     }
 
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
+    if(s->mix_2_1_simd || s->mix_1_1_simd || s->mix_n_1_simd){
         len1= len&~15;
         off = len1 * out->bps;
     }
@@ -530,35 +537,35 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             if(len != len1)
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
-        default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
+        default: {
+            int nb_in = s->matrix_ch[out_i][0];
+            const uint8_t *src[SWR_CH_MAX];
+            union {
+                float   flt[SWR_CH_MAX];
+                double  dbl[SWR_CH_MAX];
+                int32_t s32[SWR_CH_MAX];
+            } coeffs;
+
+            for(j=0; j<nb_in; j++){
+                in_i  = s->matrix_ch[out_i][1+j];
+                src[j]= in->ch[in_i];
+                if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP)
+                    coeffs.flt[j] = s->matrix_flt[out_i][in_i];
+                else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP)
+                    coeffs.dbl[j] = s->matrix[out_i][in_i];
+                else
+                    coeffs.s32[j] = s->matrix32[out_i][in_i];
+            }
+            if(s->mix_n_1_simd && len1)
+                s->mix_n_1_simd(out->ch[out_i], (const void **)src, &coeffs, nb_in, len1);
+            else
+                s->mix_n_1_f   (out->ch[out_i], (const void **)src, &coeffs, nb_in, len1);
+            if(len != len1){
+                for(j=0; j<nb_in; j++)
+                    src[j] += off;
+                s->mix_n_1_f   (out->ch[out_i]+off, (const void **)src, &coeffs, nb_in, len-len1);
             }
+            break;}
         }
     }
     return 0;
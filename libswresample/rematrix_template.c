@@ -87,6 +87,25 @@ static void RENAME(mix8to2)(SAMPLE **out, const SAMPLE **in, COEFF *coeffp, inte
     }
 }
 
+static void RENAME(mix_n_1)(SAMPLE *out, const SAMPLE **in, const COEFF *coeffp, integer nb_in, integer len){
+    INTER acc[MIX_BLOCK_SIZE];
+    int i, j, pos;
+
+    for(pos=0; pos<len; pos+=MIX_BLOCK_SIZE){
+        int n = FFMIN(len - pos, MIX_BLOCK_SIZE);
+        INTER coeff = coeffp[0];
+        for(i=0; i<n; i++)
+            acc[i] = in[0][pos + i]*coeff;
+        for(j=1; j<nb_in; j++){
+            coeff = coeffp[j];
+            for(i=0; i<n; i++)
+                acc[i]+= in[j][pos + i]*coeff;
+        }
+        for(i=0; i<n; i++)
+            out[pos + i] = R(acc[i]);
+    }
+}
+
 static RENAME(mix_any_func_type) *RENAME(get_mix_any_func)(SwrContext *s){
     if(   s->out_ch_layout == AV_CH_LAYOUT_STEREO && (s->in_ch_layout == AV_CH_LAYOUT_5POINT1 || s->in_ch_layout == AV_CH_LAYOUT_5POINT1_BACK)
        && s->matrix[0][2] == s->matrix[1][2] && s->matrix[0][3] == s->matrix[1][3]
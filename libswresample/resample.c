@@ -27,6 +27,7 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/thread.h"
 #include "resample.h"
 
 static inline double eval_poly(const double *coeff, int size, double x) {
@@ -276,11 +277,145 @@ fail:
     return ret;
 }
 
+#define FILTER_BANK_CACHE_SIZE 16
+
+/* Filter banks only depend on these parameters, so they are built once and
+ * shared read-only between all contexts using the same configuration.
+ * Entries outlive the contexts using them, so that contexts created one after
+ * the other with the same configuration reuse the same filter bank. The least
+ * recently used entry is evicted when the cache is full. */
+typedef struct FilterBankCacheEntry {
+    AVBufferRef *buf;
+    uint64_t last_used;
+    enum AVSampleFormat format;
+    enum SwrFilterType filter_type;
+    double factor;
+    double kaiser_beta;
+    int filter_length;
+    int phase_count;
+} FilterBankCacheEntry;
+
+static AVOnce filter_bank_cache_once = AV_ONCE_INIT;
+static AVMutex filter_bank_cache_lock;
+static FilterBankCacheEntry filter_bank_cache[FILTER_BANK_CACHE_SIZE];
+static uint64_t filter_bank_cache_clock;
+
+static av_cold void filter_bank_cache_init(void)
+{
+    ff_mutex_init(&filter_bank_cache_lock, NULL);
+}
+
+#if AV_GCC_VERSION_AT_LEAST(3,1) || defined(__clang__)
+/* release the cached filter banks when the library is unloaded */
+static av_cold void __attribute__((destructor)) filter_bank_cache_uninit(void)
+{
+    int i;
+
+    for (i = 0; i < FILTER_BANK_CACHE_SIZE; i++)
+        av_buffer_unref(&filter_bank_cache[i].buf);
+}
+#endif
+
+static int filter_bank_cache_match(const FilterBankCacheEntry *e, const ResampleContext *c, int phase_count)
+{
+    return e->buf &&
+           e->format        == c->format        &&
+           e->filter_type   == c->filter_type   &&
+           e->factor        == c->factor        &&
+           e->kaiser_beta   == c->kaiser_beta   &&
+           e->filter_length == c->filter_length &&
+           e->phase_count   == phase_count;
+}
+
+static void filter_bank_cache_add(const ResampleContext *c, int phase_count, AVBufferRef *buf)
+{
+    FilterBankCacheEntry *e = &filter_bank_cache[0];
+    AVBufferRef *ref;
+    int i;
+
+    ff_mutex_lock(&filter_bank_cache_lock);
+    for (i = 0; i < FILTER_BANK_CACHE_SIZE; i++) {
+        FilterBankCacheEntry *cur = &filter_bank_cache[i];
+        /* another context built the same filter bank concurrently */
+        if (filter_bank_cache_match(cur, c, phase_count))
+            goto end;
+        if (!cur->buf) {
+            e = cur;
+            break;
+        }
+        if (cur->last_used < e->last_used)
+            e = cur;
+    }
+    if (!(ref = av_buffer_ref(buf)))
+        goto end;
+
+    /* contexts still using the evicted filter bank keep their own reference */
+    av_buffer_unref(&e->buf);
+    e->buf           = ref;
+    e->last_used     = ++filter_bank_cache_clock;
+    e->format        = c->format;
+    e->filter_type   = c->filter_type;
+    e->factor        = c->factor;
+    e->kaiser_beta   = c->kaiser_beta;
+    e->filter_length = c->filter_length;
+    e->phase_count   = phase_count;
+end:
+    ff_mutex_unlock(&filter_bank_cache_lock);
+}
+
+/**
+ * Get a reference to the filter bank with phase_count phases for the filter
+ * parameters of c, building it if no context created it before.
+ */
+static int get_filter_bank(ResampleContext *c, int phase_count, AVBufferRef **pbuf)
+{
+    int64_t size = (int64_t)c->filter_alloc * (phase_count + 1) * c->felem_size;
+    AVBufferRef *buf = NULL;
+    int i, ret;
+
+    ff_thread_once(&filter_bank_cache_once, filter_bank_cache_init);
+
+    ff_mutex_lock(&filter_bank_cache_lock);
+    for (i = 0; i < FILTER_BANK_CACHE_SIZE; i++) {
+        if (filter_bank_cache_match(&filter_bank_cache[i], c, phase_count)) {
+            buf = av_buffer_ref(filter_bank_cache[i].buf);
+            if (buf)
+                filter_bank_cache[i].last_used = ++filter_bank_cache_clock;
+            break;
+        }
+    }
+    ff_mutex_unlock(&filter_bank_cache_lock);
+    if (buf) {
+        *pbuf = buf;
+        return 0;
+    }
+
+    if (size > INT_MAX)
+        return AVERROR(EINVAL);
+    buf = av_buffer_allocz(size);
+    if (!buf)
+        return AVERROR(ENOMEM);
+
+    ret = build_filter(c, buf->data, c->factor, c->filter_length, c->filter_alloc,
+                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
+    if (ret < 0) {
+        av_buffer_unref(&buf);
+        return ret;
+    }
+    memcpy(buf->data + (c->filter_alloc*phase_count+1)*c->felem_size, buf->data, (c->filter_alloc-1)*c->felem_size);
+    memcpy(buf->data + (c->filter_alloc*phase_count  )*c->felem_size, buf->data + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+
+    filter_bank_cache_add(c, phase_count, buf);
+
+    *pbuf = buf;
+    return 0;
+}
+
 static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
-    av_freep(&c->filter_bank);
+    av_buffer_unref(&c->filter_bank_buf);
     av_freep(cc);
 }
 
@@ -345,16 +480,12 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->factor        = factor;
         c->filter_length = filter_length;
         c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
-        if (!c->filter_bank)
+        if (get_filter_bank(c, phase_count, &c->filter_bank_buf) < 0)
             goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
-            goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+        c->filter_bank   = c->filter_bank_buf->data;
     }
 
     c->compensation_distance= 0;
@@ -375,14 +506,14 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     return c;
 error:
-    av_freep(&c->filter_bank);
+    av_buffer_unref(&c->filter_bank_buf);
     av_free(c);
     return NULL;
 }
 
 static int rebuild_filter_bank_with_compensation(ResampleContext *c)
 {
-    uint8_t *new_filter_bank;
+    AVBufferRef *new_filter_bank;
     int new_src_incr, new_dst_incr;
     int phase_count = c->phase_count_compensation;
     int ret;
@@ -392,23 +523,14 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
 
     av_assert0(!c->frac && !c->dst_incr_mod);
 
-    new_filter_bank = av_calloc(c->filter_alloc, (phase_count + 1) * c->felem_size);
-    if (!new_filter_bank)
-        return AVERROR(ENOMEM);
-
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
-    if (ret < 0) {
-        av_freep(&new_filter_bank);
+    ret = get_filter_bank(c, phase_count, &new_filter_bank);
+    if (ret < 0)
         return ret;
-    }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
 
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
     {
-        av_freep(&new_filter_bank);
+        av_buffer_unref(&new_filter_bank);
         return AVERROR(EINVAL);
     }
 
@@ -423,8 +545,9 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
     c->index         *= phase_count / c->phase_count;
     c->phase_count    = phase_count;
-    av_freep(&c->filter_bank);
-    c->filter_bank = new_filter_bank;
+    av_buffer_unref(&c->filter_bank_buf);
+    c->filter_bank_buf = new_filter_bank;
+    c->filter_bank     = new_filter_bank->data;
     return 0;
 }
 
@@ -449,8 +572,64 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
     return 0;
 }
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+typedef struct ResampleThreadData {
+    ResampleContext *c;
+    ResampleContext last_ctx;
+    AudioData *dst, *src;
+    int dst_size;
+    int need_emms;
+    int consumed;
+    int64_t index2, incr;
+    int (*resample_func)(struct ResampleContext *c, void *dst,
+                         const void *src, int n, int update_ctx);
+} ResampleThreadData;
+
+/* The last channel updates the resampler position. It works on a copy of
+ * the context, so that the other channels still read the initial position
+ * while it runs; the caller copies the new position back. */
+static int resample_channels(SwrContext *s, void *arg, int jobnr, int nb_jobs)
+{
+    ResampleThreadData *td = arg;
+    const int nb_channels = td->dst->ch_count;
+    const int start = (nb_channels *  jobnr   ) / nb_jobs;
+    const int end   = (nb_channels * (jobnr+1)) / nb_jobs;
     int i;
+
+    for (i = start; i < end; i++) {
+        int last = i == nb_channels - 1;
+
+        if (!td->resample_func)
+            td->c->dsp.resample_one(td->dst->ch[i], td->src->ch[i], td->dst_size, td->index2, td->incr);
+        else if (last)
+            td->consumed = td->resample_func(&td->last_ctx, td->dst->ch[i], td->src->ch[i], td->dst_size, 1);
+        else
+            td->resample_func(td->c, td->dst->ch[i], td->src->ch[i], td->dst_size, 0);
+    }
+
+    if (td->need_emms)
+        emms_c();
+
+    return 0;
+}
+
+static void resample_all_channels(SwrContext *s, ResampleThreadData *td)
+{
+    int nb_jobs = 1;
+
+    /* threads only pay off when each job has enough samples to process */
+    if (s->nb_threads > 1 && (int64_t)td->dst_size * td->c->filter_length >= 4096)
+        nb_jobs = FFMIN(td->dst->ch_count, s->nb_threads);
+
+    td->last_ctx = *td->c;
+    if (nb_jobs > 1)
+        swri_execute(s, resample_channels, td, nb_jobs);
+    else
+        resample_channels(s, td, 0, 1);
+}
+
+static int multiple_resample(SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+    ResampleContext *c = s->resample;
+    ResampleThreadData td = { .c = c, .dst = dst, .src = src };
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms = c->format == AV_SAMPLE_FMT_S16P && ARCH_X86_32 &&
                     (mm_flags & (AV_CPU_FLAG_MMX2 | AV_CPU_FLAG_SSE2)) == AV_CPU_FLAG_MMX2;
@@ -461,6 +640,7 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
     src_size = FFMIN(src_size, max_src_size);
 
     *consumed = 0;
+    td.need_emms = need_emms;
 
     if (c->filter_length == 1 && c->phase_count == 1) {
         int64_t index2= (1LL<<32)*c->frac/c->src_incr + (1LL<<32)*c->index;
@@ -469,33 +649,35 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
 
         dst_size = FFMAX(FFMIN(dst_size, new_size), 0);
         if (dst_size > 0) {
-            for (i = 0; i < dst->ch_count; i++) {
-                c->dsp.resample_one(dst->ch[i], src->ch[i], dst_size, index2, incr);
-                if (i+1 == dst->ch_count) {
-                    c->index += dst_size * c->dst_incr_div;
-                    c->index += (c->frac + dst_size * (int64_t)c->dst_incr_mod) / c->src_incr;
-                    av_assert2(c->index >= 0);
-                    *consumed = c->index;
-                    c->frac   = (c->frac + dst_size * (int64_t)c->dst_incr_mod) % c->src_incr;
-                    c->index = 0;
-                }
-            }
+            td.dst_size = dst_size;
+            td.index2   = index2;
+            td.incr     = incr;
+            resample_all_channels(s, &td);
+
+            c->index += dst_size * c->dst_incr_div;
+            c->index += (c->frac + dst_size * (int64_t)c->dst_incr_mod) / c->src_incr;
+            av_assert2(c->index >= 0);
+            *consumed = c->index;
+            c->frac   = (c->frac + dst_size * (int64_t)c->dst_incr_mod) % c->src_incr;
+            c->index = 0;
         }
     } else {
         int64_t end_index = (1LL + src_size - c->filter_length) * c->phase_count;
         int64_t delta_frac = (end_index - c->index) * c->src_incr - c->frac;
         int delta_n = (delta_frac + c->dst_incr - 1) / c->dst_incr;
-        int (*resample_func)(struct ResampleContext *c, void *dst,
-                             const void *src, int n, int update_ctx);
 
         dst_size = FFMAX(FFMIN(dst_size, delta_n), 0);
         if (dst_size > 0) {
             /* resample_linear and resample_common should have same behavior
              * when frac and dst_incr_mod are zero */
-            resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
-                            c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            td.resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
+                               c->dsp.resample_linear : c->dsp.resample_common;
+            td.dst_size = dst_size;
+            resample_all_channels(s, &td);
+
+            c->index  = td.last_ctx.index;
+            c->frac   = td.last_ctx.frac;
+            *consumed = td.consumed;
         }
     }
 
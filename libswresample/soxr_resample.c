@@ -82,12 +82,13 @@ static int flush(struct SwrContext *s){
 }
 
 static int process(
-        struct ResampleContext * c, AudioData *dst, int dst_size,
+        struct SwrContext *s, AudioData *dst, int dst_size,
         AudioData *src, int src_size, int *consumed){
+    soxr_t c = (soxr_t)s->resample;
     size_t idone, odone;
-    soxr_error_t error = soxr_set_error((soxr_t)c, soxr_set_num_channels((soxr_t)c, src->ch_count));
+    soxr_error_t error = soxr_set_error(c, soxr_set_num_channels(c, src->ch_count));
     if (!error)
-        error = soxr_process((soxr_t)c, src->ch, (size_t)src_size,
+        error = soxr_process(c, src->ch, (size_t)src_size,
                              &idone, dst->ch, (size_t)dst_size, &odone);
     else
         idone = 0;
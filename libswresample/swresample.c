@@ -23,6 +23,7 @@
 #include "audioconvert.h"
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/cpu.h"
 #include "libavutil/internal.h"
 
 #include <float.h>
@@ -106,6 +107,43 @@ static void set_audiodata_fmt(AudioData *a, enum AVSampleFormat fmt){
         a->planar = 1;
 }
 
+typedef struct SwrPoolJob {
+    SwrContext *s;
+    swri_action_func *func;
+    void *arg;
+    int nb_jobs;
+} SwrPoolJob;
+
+static int pool_job(void *opaque, int jobnr, int threadnr){
+    SwrPoolJob *job = opaque;
+    return job->func(job->s, job->arg, jobnr, job->nb_jobs);
+}
+
+int swri_execute(SwrContext *s, swri_action_func *func, void *arg, int nb_jobs){
+    SwrPoolJob job = { s, func, arg, nb_jobs };
+
+    return av_thread_pool_execute(s->thread_pool, pool_job, &job, NULL,
+                                  nb_jobs, s->nb_threads);
+}
+
+static av_cold int thread_init(SwrContext *s){
+    int nb_threads = s->threads ? s->threads : av_cpu_count();
+    int ret;
+
+    if (nb_threads <= 1)
+        return 0;
+
+    /* the calling thread is the first of the nb_threads working on a batch */
+    ret = av_thread_pool_alloc(&s->thread_pool, nb_threads - 1);
+    if (ret == AVERROR(ENOSYS))
+        return 0;
+    if (ret < 0)
+        return ret;
+
+    s->nb_threads = nb_threads;
+    return 0;
+}
+
 static void free_temp(AudioData *a){
     av_free(a->data);
     memset(a, 0, sizeof(*a));
@@ -140,6 +178,7 @@ av_cold void swr_free(SwrContext **ss){
         clear_context(s);
         if (s->resampler)
             s->resampler->free(&s->resample);
+        av_thread_pool_free(&s->thread_pool);
     }
 
     av_freep(ss);
@@ -154,6 +193,8 @@ av_cold int swr_init(struct SwrContext *s){
     char l1[1024], l2[1024];
 
     clear_context(s);
+    av_thread_pool_free(&s->thread_pool);
+    s->nb_threads = 1;
 
     if(s-> in_sample_fmt >= AV_SAMPLE_FMT_NB){
         av_log(s, AV_LOG_ERROR, "Requested input sample format %d is invalid\n", s->in_sample_fmt);
@@ -269,6 +310,8 @@ av_cold int swr_init(struct SwrContext *s){
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
         }
+        if (s->resampler == &swri_resampler && (ret = thread_init(s)) < 0)
+            return ret;
     }else
         s->resampler->free(&s->resample);
     if(    s->int_sample_fmt != AV_SAMPLE_FMT_S16P
@@ -506,7 +549,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &tmp, s->in_buffer_count, &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -526,7 +569,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
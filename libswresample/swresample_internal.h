@@ -23,6 +23,7 @@
 
 #include "swresample.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/threadpool.h"
 #include "config.h"
 
 #define SWR_CH_MAX 64
@@ -42,6 +43,8 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+typedef void (mix_n_1_func_type)(void *out, const void **in, const void *coeffp, integer nb_in, integer len);
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -71,7 +74,7 @@ struct DitherContext {
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct SwrContext *s, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -89,6 +92,8 @@ struct Resampler {
   get_out_samples_func          get_out_samples;
 };
 
+typedef int (swri_action_func)(struct SwrContext *s, void *arg, int jobnr, int nb_jobs);
+
 extern struct Resampler const swri_resampler;
 extern struct Resampler const swri_soxr_resampler;
 
@@ -133,6 +138,7 @@ struct SwrContext {
     double kaiser_beta;                                /**< swr beta value for Kaiser window (only applicable if filter_type == AV_FILTER_TYPE_KAISER) */
     double precision;                               /**< soxr resampling precision (in bits) */
     int cheby;                                      /**< soxr: if 1 then passband rolloff will be none (Chebyshev) & irrational ratio approximation precision will be higher */
+    int threads;                                    ///< swr: number of threads used to resample channels in parallel, 0 for automatic
 
     float min_compensation;                         ///< swr minimum below which no compensation will happen
     float min_hard_compensation;                    ///< swr minimum below which no silence inject / sample drop will happen
@@ -167,6 +173,8 @@ struct SwrContext {
     struct AudioConvert *full_convert;              ///< full conversion context (single conversion for input and output)
     struct ResampleContext *resample;               ///< resampling context
     struct Resampler const *resampler;              ///< resampler virtual function table
+    AVThreadPool *thread_pool;                      ///< resampling thread pool, NULL when resampling in a single thread
+    int nb_threads;                                 ///< number of threads actually used for resampling, including the caller
 
     double matrix[SWR_CH_MAX][SWR_CH_MAX];          ///< floating point rematrixing coefficients
     float matrix_flt[SWR_CH_MAX][SWR_CH_MAX];       ///< single precision floating point rematrixing coefficients
@@ -184,9 +192,18 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_1_func_type *mix_n_1_f;
+    mix_n_1_func_type *mix_n_1_simd;
+
     /* TODO: callbacks for ASM optimizations */
 };
 
+/**
+ * Run func for jobs 0..nb_jobs-1, in parallel if s has a thread pool.
+ * The calling thread takes part in the execution.
+ */
+int swri_execute(SwrContext *s, swri_action_func *func, void *arg, int nb_jobs);
+
 av_warn_unused_result
 int swri_realloc_audio(AudioData *a, int count);
 
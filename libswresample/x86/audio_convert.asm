@@ -24,6 +24,9 @@ SECTION_RODATA 32
 flt2pm31: times 8 dd 4.6566129e-10
 flt2p31 : times 8 dd 2147483648.0
 flt2p15 : times 8 dd 32768.0
+dbl2pm31: times 4 dq 4.656612873077392578125e-10
+dbl2p31 : times 4 dq 2147483648.0
+dbl2p31m1:times 4 dq 2147483647.0
 
 word_unpack_shuf : db  0, 1, 4, 5, 8, 9,12,13, 2, 3, 6, 7,10,11,14,15
 
@@ -605,6 +608,63 @@ pack_8ch_%2_to_%1_u_int %+ SUFFIX:
     packssdw  m1, m3
 %endmacro
 
+; The scaling by a power of 2 is exact and cvtpd2dq rounds to nearest even
+; like llrint(), so the output is identical to C. Values above INT32_MAX are
+; clipped before the conversion, those below INT32_MIN convert to the
+; 0x80000000 it returns for out of range input.
+%macro INT32_TO_DOUBLE_INIT 6
+    mova      %5, [dbl2pm31]
+%endmacro
+%macro INT32_TO_DOUBLE_N 6
+%if mmsize == 32
+    vextractf128 xm3, m1, 1
+    cvtdq2pd  m2, xm1
+    vextractf128 xm1, m0, 1
+    cvtdq2pd  m0, xm0
+    cvtdq2pd  m1, xm1
+    cvtdq2pd  m3, xm3
+%else
+    pshufd    m2, m0, q3232
+    pshufd    m3, m1, q3232
+    cvtdq2pd  m0, m0
+    cvtdq2pd  m1, m1
+    cvtdq2pd  m2, m2
+    cvtdq2pd  m3, m3
+    SWAP 1, 2
+%endif
+    mulpd m0, m0, %5
+    mulpd m1, m1, %5
+    mulpd m2, m2, %5
+    mulpd m3, m3, %5
+%endmacro
+
+%macro DOUBLE_TO_INT32_INIT 6
+    mova      %5, [dbl2p31]
+    mova      %6, [dbl2p31m1]
+%endmacro
+%macro DOUBLE_TO_INT32_N 6
+    mulpd m0, m0, %5
+    mulpd m1, m1, %5
+    mulpd m2, m2, %5
+    mulpd m3, m3, %5
+    minpd m0, m0, %6
+    minpd m1, m1, %6
+    minpd m2, m2, %6
+    minpd m3, m3, %6
+    cvtpd2dq xm0, m0
+    cvtpd2dq xm1, m1
+    cvtpd2dq xm2, m2
+    cvtpd2dq xm3, m3
+%if mmsize == 32
+    vinsertf128 m0, m0, xm1, 1
+    vinsertf128 m1, m2, xm3, 1
+%else
+    punpcklqdq m0, m1
+    punpcklqdq m2, m3
+    SWAP 1, 2
+%endif
+%endmacro
+
 %macro NOP_N 0-6
 %endmacro
 
@@ -693,6 +753,11 @@ PACK_8CH float, int32, a, 2, 2, 10, INT32_TO_FLOAT_N, INT32_TO_FLOAT_INIT
 PACK_8CH int32, float, u, 2, 2, 10, FLOAT_TO_INT32_N, FLOAT_TO_INT32_INIT
 PACK_8CH int32, float, a, 2, 2, 10, FLOAT_TO_INT32_N, FLOAT_TO_INT32_INIT
 
+CONV double, int32, u, 3, 2, INT32_TO_DOUBLE_N, INT32_TO_DOUBLE_INIT
+CONV double, int32, a, 3, 2, INT32_TO_DOUBLE_N, INT32_TO_DOUBLE_INIT
+CONV int32, double, u, 2, 3, DOUBLE_TO_INT32_N, DOUBLE_TO_INT32_INIT
+CONV int32, double, a, 2, 3, DOUBLE_TO_INT32_N, DOUBLE_TO_INT32_INIT
+
 INIT_XMM ssse3
 UNPACK_2CH int16, int16, u, 1, 1, NOP_N, NOP_N
 UNPACK_2CH int16, int16, a, 1, 1, NOP_N, NOP_N
@@ -730,6 +795,10 @@ PACK_8CH int32, float, a, 2, 2, 10, FLOAT_TO_INT32_N, FLOAT_TO_INT32_INIT
 INIT_YMM avx
 CONV float, int32, u, 2, 2, INT32_TO_FLOAT_N, INT32_TO_FLOAT_INIT
 CONV float, int32, a, 2, 2, INT32_TO_FLOAT_N, INT32_TO_FLOAT_INIT
+CONV double, int32, u, 3, 2, INT32_TO_DOUBLE_N, INT32_TO_DOUBLE_INIT
+CONV double, int32, a, 3, 2, INT32_TO_DOUBLE_N, INT32_TO_DOUBLE_INIT
+CONV int32, double, u, 2, 3, DOUBLE_TO_INT32_N, DOUBLE_TO_INT32_INIT
+CONV int32, double, a, 2, 3, DOUBLE_TO_INT32_N, DOUBLE_TO_INT32_INIT
 %endif
 
 %if HAVE_AVX2_EXTERNAL
@@ -32,6 +32,8 @@ PROTO4(_pack_6ch_)
 PROTO4(_pack_8ch_)
 PROTO4(_unpack_2ch_)
 PROTO4(_unpack_6ch_)
+PROTO(_, int32, double, sse2) PROTO(_, double, int32, sse2)
+PROTO(_, int32, double, avx)  PROTO(_, double, int32, avx)
 
 av_cold void swri_audio_convert_init_x86(struct AudioConvert *ac,
                                  enum AVSampleFormat out_fmt,
@@ -78,6 +80,10 @@ MULTI_CAPS_FUNC(SSE2, sse2)
             ac->simd_f =  ff_float_to_int32_a_sse2;
         if(   out_fmt == AV_SAMPLE_FMT_S16  && in_fmt == AV_SAMPLE_FMT_FLT || out_fmt == AV_SAMPLE_FMT_S16P && in_fmt == AV_SAMPLE_FMT_FLTP)
             ac->simd_f =  ff_float_to_int16_a_sse2;
+        if(   out_fmt == AV_SAMPLE_FMT_DBL  && in_fmt == AV_SAMPLE_FMT_S32 || out_fmt == AV_SAMPLE_FMT_DBLP && in_fmt == AV_SAMPLE_FMT_S32P)
+            ac->simd_f =  ff_int32_to_double_a_sse2;
+        if(   out_fmt == AV_SAMPLE_FMT_S32  && in_fmt == AV_SAMPLE_FMT_DBL || out_fmt == AV_SAMPLE_FMT_S32P && in_fmt == AV_SAMPLE_FMT_DBLP)
+            ac->simd_f =  ff_double_to_int32_a_sse2;
 
         if(channels == 2) {
             if(   out_fmt == AV_SAMPLE_FMT_FLT  && in_fmt == AV_SAMPLE_FMT_FLTP || out_fmt == AV_SAMPLE_FMT_S32 && in_fmt == AV_SAMPLE_FMT_S32P)
@@ -148,6 +154,10 @@ MULTI_CAPS_FUNC(SSE2, sse2)
     if(EXTERNAL_AVX_FAST(mm_flags)) {
         if(   out_fmt == AV_SAMPLE_FMT_FLT  && in_fmt == AV_SAMPLE_FMT_S32 || out_fmt == AV_SAMPLE_FMT_FLTP && in_fmt == AV_SAMPLE_FMT_S32P)
             ac->simd_f =  ff_int32_to_float_a_avx;
+        if(   out_fmt == AV_SAMPLE_FMT_DBL  && in_fmt == AV_SAMPLE_FMT_S32 || out_fmt == AV_SAMPLE_FMT_DBLP && in_fmt == AV_SAMPLE_FMT_S32P)
+            ac->simd_f =  ff_int32_to_double_a_avx;
+        if(   out_fmt == AV_SAMPLE_FMT_S32  && in_fmt == AV_SAMPLE_FMT_DBL || out_fmt == AV_SAMPLE_FMT_S32P && in_fmt == AV_SAMPLE_FMT_DBLP)
+            ac->simd_f =  ff_double_to_int32_a_avx;
     }
     if(EXTERNAL_AVX(mm_flags)) {
         if(channels == 6) {
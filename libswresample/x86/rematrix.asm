@@ -24,6 +24,7 @@
 SECTION_RODATA 32
 dw1: times 8  dd 1
 w1 : times 16 dw 1
+pd_16384: times 8 dd 16384
 
 SECTION .text
 
@@ -71,6 +72,111 @@ mix_2_1_float_u_int %+ SUFFIX:
     REP_RET
 %endmacro
 
+;-----------------------------------------------------------------------------
+; void mix_n_1_<type>(<type> *out, const <type> **in, const <coeff> *coeffp,
+;                     integer nb_in, integer len)
+;
+; Generic mix of nb_in input channels into one output channel. len is a
+; multiple of 16. All the inputs are accumulated into two vectors of output,
+; in the same order as in C, so that the output is identical to it.
+;-----------------------------------------------------------------------------
+%macro MIXN_FLT 2 ; type, s/d
+cglobal mix_n_1_%1, 5, 8, 5, out, in, coeffp, nb_in, len, i, src, x
+%ifidn %2, s
+    shl        lenq, 2
+%else
+    shl        lenq, 3
+%endif
+    xor          xq, xq
+.next:
+    mov        srcq, [inq]
+%ifidn %2, s
+    VBROADCASTSS m4, [coeffpq]
+%else
+    VBROADCASTSD m4, [coeffpq]
+%endif
+    movu         m0, [srcq + xq         ]
+    movu         m1, [srcq + xq + mmsize]
+    mulp%2       m0, m0, m4
+    mulp%2       m1, m1, m4
+    mov          iq, 1
+.next_in:
+    mov        srcq, [inq + gprsize*iq]
+%ifidn %2, s
+    VBROADCASTSS m4, [coeffpq + 4*iq]
+%else
+    VBROADCASTSD m4, [coeffpq + 8*iq]
+%endif
+    movu         m2, [srcq + xq         ]
+    movu         m3, [srcq + xq + mmsize]
+    mulp%2       m2, m2, m4
+    mulp%2       m3, m3, m4
+    addp%2       m0, m0, m2
+    addp%2       m1, m1, m3
+    inc          iq
+    cmp          iq, nb_inq
+        jl .next_in
+    movu  [outq + xq         ], m0
+    movu  [outq + xq + mmsize], m1
+    add          xq, mmsize*2
+    cmp          xq, lenq
+        jl .next
+    RET
+%endmacro
+
+; The int16 inputs are widened to 32 bits and multiplied by the 17.15
+; coefficients. packssdw saturates the result like the clipping C version;
+; the plain one is only used with matrices that do not overflow.
+%macro MIXN_INT16 0
+cglobal mix_n_1_int16, 5, 8, 6, out, in, coeffp, nb_in, len, i, src, x
+    add        lenq, lenq
+    xor          xq, xq
+    mova         m5, [pd_16384]
+.next:
+    mov        srcq, [inq]
+%if cpuflag(avx2)
+    vpbroadcastd m4, [coeffpq]
+%else
+    movd         m4, [coeffpq]
+    SPLATD       m4
+%endif
+    pmovsxwd     m0, [srcq + xq           ]
+    pmovsxwd     m1, [srcq + xq + mmsize/2]
+    pmulld       m0, m4
+    pmulld       m1, m4
+    mov          iq, 1
+.next_in:
+    mov        srcq, [inq + gprsize*iq]
+%if cpuflag(avx2)
+    vpbroadcastd m4, [coeffpq + 4*iq]
+%else
+    movd         m4, [coeffpq + 4*iq]
+    SPLATD       m4
+%endif
+    pmovsxwd     m2, [srcq + xq           ]
+    pmovsxwd     m3, [srcq + xq + mmsize/2]
+    pmulld       m2, m4
+    pmulld       m3, m4
+    paddd        m0, m2
+    paddd        m1, m3
+    inc          iq
+    cmp          iq, nb_inq
+        jl .next_in
+    paddd        m0, m5
+    paddd        m1, m5
+    psrad        m0, 15
+    psrad        m1, 15
+    packssdw     m0, m1
+%if mmsize == 32
+    vpermq       m0, m0, q3120
+%endif
+    movu  [outq + xq], m0
+    add          xq, mmsize
+    cmp          xq, lenq
+        jl .next
+    RET
+%endmacro
+
 %macro MIX1_FLT 1
 cglobal mix_1_1_%1_float, 5, 5, 3, out, in, coeffp, index, len
 %ifidn %1, a
@@ -248,3 +354,21 @@ MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
 %endif
+
+%if ARCH_X86_64
+INIT_XMM sse2
+MIXN_FLT float,  s
+MIXN_FLT double, d
+INIT_XMM sse4
+MIXN_INT16
+
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+MIXN_FLT float,  s
+MIXN_FLT double, d
+%endif
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+MIXN_INT16
+%endif
+%endif
@@ -51,9 +51,23 @@ SECTION_RODATA
 pf_1:      dd 1.0
 pdbl_1:    dq 1.0
 pd_0x4000: dd 0x4000
+pd_0to15:  dd 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
 
 SECTION .text
 
+; With zmm, the filter_length % (mmsize / bps) taps past the last full vector
+; are loaded under the k1 mask set up here, instead of reading past the end
+; of the source and of the filter.
+%macro TAIL_MASK 2 ; tmp, log2_bps
+%if mmsize == 64
+    mov                         %1d, min_filter_len_x4d
+    and                         %1d, mmsize - 1
+    shr                         %1d, %2
+    vpbroadcastd                  m1, %1d
+    vpcmpgtd                      k1, m1, [pd_0to15]
+%endif
+%endmacro
+
 ; FIXME remove unneeded variables (index_incr, phase_mask)
 %macro RESAMPLE_FNS 3-5 ; format [float or int16], bps, log2_bps, float op suffix [s or d], 1.0 constant
 ; int resample_common_$format(ResampleContext *ctx, $format *dst,
@@ -88,6 +102,7 @@ cglobal resample_common_%1, 0, 15, 2, ctx, dst, src, phase_count, index, frac, \
     mov           min_filter_len_x4d, [ctxq+ResampleContext.filter_length]
     mov                dst_incr_divd, [ctxq+ResampleContext.dst_incr_div]
     shl           min_filter_len_x4d, %3
+    TAIL_MASK       min_filter_count_x4, %3
     lea                     dst_endq, [dstq+sizeq*%2]
 
 %if UNIX64
@@ -169,11 +184,20 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     movd                          m0, [pd_0x4000]
 %else ; float/double
     xorps                         m0, m0, m0
+%endif
+%if mmsize == 64
+    ; the counter runs one vector ahead, so that it turns positive on the
+    ; masked tail
+%assign %%ofs mmsize
+    add         min_filter_count_x4q, mmsize
+    jg .tail
+%else
+%assign %%ofs 0
 %endif
 
     align 16
 .inner_loop:
-    movu                          m1, [srcq+min_filter_count_x4q*1]
+    movu                          m1, [srcq+min_filter_count_x4q*1-%%ofs]
 %ifidn %1, int16
 %if cpuflag(xop)
     vpmadcswd                     m0, m1, [filterq+min_filter_count_x4q*1], m0
@@ -183,14 +207,21 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
 %endif
 %else ; float/double
 %if cpuflag(fma4) || cpuflag(fma3)
-    fmaddp%4                      m0, m1, [filterq+min_filter_count_x4q*1], m0
+    fmaddp%4                      m0, m1, [filterq+min_filter_count_x4q*1-%%ofs], m0
 %else
     mulp%4                        m1, m1, [filterq+min_filter_count_x4q*1]
     addp%4                        m0, m0, m1
 %endif ; cpuflag
 %endif
     add         min_filter_count_x4q, mmsize
+%if mmsize == 64
+    jle .inner_loop
+.tail:
+    vmovup%4                      m1{k1}{z}, [srcq+min_filter_count_x4q*1-mmsize]
+    vfmadd231p%4                  m0{k1}, m1, [filterq+min_filter_count_x4q*1-mmsize]
+%else
     js .inner_loop
+%endif
 
 %ifidn %1, int16
     HADDD                         m0, m1
@@ -201,7 +232,11 @@ cglobal resample_common_%1, 1, 7, 2, ctx, phase_count, dst, frac, \
     movd                      [dstq], m0
 %else ; float/double
     ; horizontal sum & store
-%if mmsize == 32
+%if mmsize == 64
+    vextractf64x4                ym1, m0, 0x1
+    addp%4                       ym0, ym1
+%endif
+%if mmsize >= 32
     vextractf128                 xm1, m0, 0x1
     addp%4                       xm0, xm1
 %endif
@@ -320,6 +355,7 @@ cglobal resample_linear_%1, 0, 15, 5, ctx, phase_mask, src, phase_count, index,
 %endif
     mov                dst_incr_divd, [ctxq+ResampleContext.dst_incr_div]
     shl           min_filter_len_x4d, %3
+    TAIL_MASK       min_filter_count_x4, %3
     lea                     dst_endq, [dstq+sizeq*%2]
 
 %if UNIX64
@@ -419,11 +455,18 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 %else ; float/double
     xorps                         m0, m0, m0
     xorps                         m2, m2, m2
+%endif
+%if mmsize == 64
+%assign %%ofs mmsize
+    add         min_filter_count_x4q, mmsize
+    jg .tail
+%else
+%assign %%ofs 0
 %endif
 
     align 16
 .inner_loop:
-    movu                          m1, [srcq+min_filter_count_x4q*1]
+    movu                          m1, [srcq+min_filter_count_x4q*1-%%ofs]
 %ifidn %1, int16
 %if cpuflag(xop)
     vpmadcswd                     m2, m1, [filter2q+min_filter_count_x4q*1], m2
@@ -436,8 +479,8 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 %endif ; cpuflag
 %else ; float/double
 %if cpuflag(fma4) || cpuflag(fma3)
-    fmaddp%4                      m2, m1, [filter2q+min_filter_count_x4q*1], m2
-    fmaddp%4                      m0, m1, [filter1q+min_filter_count_x4q*1], m0
+    fmaddp%4                      m2, m1, [filter2q+min_filter_count_x4q*1-%%ofs], m2
+    fmaddp%4                      m0, m1, [filter1q+min_filter_count_x4q*1-%%ofs], m0
 %else
     mulp%4                        m3, m1, [filter2q+min_filter_count_x4q*1]
     mulp%4                        m1, m1, [filter1q+min_filter_count_x4q*1]
@@ -446,7 +489,15 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
 %endif ; cpuflag
 %endif
     add         min_filter_count_x4q, mmsize
+%if mmsize == 64
+    jle .inner_loop
+.tail:
+    vmovup%4                      m1{k1}{z}, [srcq+min_filter_count_x4q*1-mmsize]
+    vfmadd231p%4                  m2{k1}, m1, [filter2q+min_filter_count_x4q*1-mmsize]
+    vfmadd231p%4                  m0{k1}, m1, [filter1q+min_filter_count_x4q*1-mmsize]
+%else
     js .inner_loop
+%endif
 
 %ifidn %1, int16
 %if mmsize == 16
@@ -486,7 +537,13 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     ; - unix64: eax=r6[filter1], edx=r2[todo]
 %else ; float/double
     ; val += (v2 - val) * (FELEML) frac / c->src_incr;
-%if mmsize == 32
+%if mmsize == 64
+    vextractf64x4                ym1, m0, 0x1
+    vextractf64x4                ym3, m2, 0x1
+    addp%4                       ym0, ym1
+    addp%4                       ym2, ym3
+%endif
+%if mmsize >= 32
     vextractf128                 xm1, m0, 0x1
     vextractf128                 xm3, m2, 0x1
     addp%4                       xm0, xm1
@@ -593,6 +650,10 @@ RESAMPLE_FNS float, 4, 2, s, pf_1
 INIT_XMM fma4
 RESAMPLE_FNS float, 4, 2, s, pf_1
 %endif
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+RESAMPLE_FNS float, 4, 2, s, pf_1
+%endif
 
 %if ARCH_X86_32
 INIT_MMX mmxext
@@ -617,3 +678,7 @@ RESAMPLE_FNS double, 8, 3, d, pdbl_1
 INIT_YMM fma3
 RESAMPLE_FNS double, 8, 3, d, pdbl_1
 %endif
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+RESAMPLE_FNS double, 8, 3, d, pdbl_1
+%endif
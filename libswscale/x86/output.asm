@@ -36,6 +36,9 @@ pw_16:         times 8 dw 16
 pw_32:         times 8 dw 32
 pw_512:        times 8 dw 512
 pw_1024:       times 8 dw 1024
+pd_0to7:       dd  0,  1,  2,  3,  4,  5,  6,  7
+pw_0to31:      dw  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
+               dw 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
 
 SECTION .text
 
@@ -283,6 +286,69 @@ yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
 %endif
 
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+; $filterSize is even as above, but $dstW needs no padding: the last group
+; of 32 pixels is loaded and stored under a mask.
+; The taps are multiplied in pairs by vpmaddwd, so the 32-bit sums are exact.
+INIT_ZMM avx512
+cglobal yuv2planeX_8, 7, 10, 9, filter, fltsize, src, dst, w, dither, offset, i, cntr, tmp
+    movsxdifnidn fltsizeq, fltsized
+    movsxdifnidn        wq, wd
+
+    ; rotate the dither by offset; m6 holds it for pixels 0-3 and m7 for
+    ; pixels 4-7 of each group of 8, matching the vpunpck{l,h}wd layout
+    vpmovzxbd         ym6, [ditherq]
+    movd              xm7, offsetd
+    vpbroadcastd      ym7, xm7
+    vpaddd            ym7, [pd_0to7]
+    vpermd            ym6, ym7, ym6
+    vpslld            ym6, 12
+    vshufi32x4         m7, m6, m6, q1111
+    vshufi32x4         m6, m6, m6, q0000
+
+    mov              tmpd, wd
+    and              tmpd, 31
+    vpbroadcastw       m0, tmpd
+    vpcmpgtw           k2, m0, [pw_0to31]
+    pxor              xm8, xm8
+    xor                 iq, iq
+
+.pixelloop:
+    kxnord             k1, k1, k1
+    lea              tmpq, [iq+32]
+    cmp              tmpq, wq
+    jle .full
+    kmovd              k1, k2
+.full:
+    mova               m0, m6
+    mova               m1, m7
+    xor             cntrq, cntrq
+.taploop:
+    mov              tmpq, [srcq+cntrq*8]
+    vmovdqu16          m2{k1}{z}, [tmpq+iq*2]
+    mov              tmpq, [srcq+cntrq*8+8]
+    vmovdqu16          m3{k1}{z}, [tmpq+iq*2]
+    vpbroadcastd       m4, [filterq+cntrq*2]
+    punpckhwd          m5, m2, m3
+    punpcklwd          m2, m3
+    pmaddwd            m5, m4
+    pmaddwd            m2, m4
+    paddd              m1, m5
+    paddd              m0, m2
+    add             cntrq, 2
+    cmp             cntrq, fltsizeq
+    jl .taploop
+    psrad              m0, 19
+    psrad              m1, 19
+    packssdw           m0, m1
+    pmaxsw             m0, m8
+    vpmovuswb [dstq+iq]{k1}, m0
+    add                 iq, 32
+    cmp                 iq, wq
+    jl .pixelloop
+    RET
+%endif
+
 ; %1=outout-bpc, %2=alignment (u/a)
 %macro yuv2plane1_mainloop 2
 .loop_%2:
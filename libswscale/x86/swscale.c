@@ -332,6 +332,7 @@ VSCALEX_FUNCS(sse2);
 VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
+VSCALEX_FUNC(8, avx512);
 
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
@@ -581,4 +582,8 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+    if (ARCH_X86_64 && EXTERNAL_AVX512(cpu_flags) &&
+        c->dstBpc == 8 && !c->use_mmx_vfilter)
+        c->yuv2planeX = ff_yuv2planeX_8_avx512;
 }
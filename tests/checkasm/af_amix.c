@@ -0,0 +1,82 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/af_amix.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#define LEN    1024
+#define NB_SRC 5
+
+#define randomize(buf, len)                                     \
+    do {                                                        \
+        int k;                                                  \
+        for (k = 0; k < len; k++)                               \
+            buf[k] = (double)rnd() / UINT_MAX * 2.0 - 1.0;      \
+    } while (0)
+
+/* The kernels must be bit-exact, so the outputs are compared with memcmp(). */
+#define CHECK_MIX(name, type)                                                   \
+static void check_mix_##name(const AMixDSPContext *dsp)                         \
+{                                                                               \
+    LOCAL_ALIGNED_32(type, dst0, [LEN + 1]);                                    \
+    LOCAL_ALIGNED_32(type, dst1, [LEN + 1]);                                    \
+    LOCAL_ALIGNED_32(type, buf,  [NB_SRC * (LEN + 1)]);                         \
+    const type *src[NB_SRC];                                                    \
+    type scale[NB_SRC];                                                         \
+    int i, nb_src, len;                                                         \
+                                                                                \
+    declare_func(void, type *dst, const type **src, const type *scale,          \
+                 int nb_src, int len);                                          \
+                                                                                \
+    randomize(buf, NB_SRC * (LEN + 1));                                         \
+    randomize(scale, NB_SRC);                                                   \
+    /* the sources are deliberately misaligned */                               \
+    for (i = 0; i < NB_SRC; i++)                                                \
+        src[i] = buf + i * (LEN + 1) + (i & 1);                                 \
+                                                                                \
+    if (check_func(dsp->mix_##name, "mix_" #name)) {                            \
+        for (nb_src = 1; nb_src <= NB_SRC; nb_src += 2) {                       \
+            for (len = LEN - 13; len <= LEN; len += 13) {                       \
+                randomize(dst0, LEN + 1);                                       \
+                memcpy(dst1, dst0, (LEN + 1) * sizeof(*dst0));                  \
+                call_ref(dst0 + 1, src, scale, nb_src, len);                    \
+                call_new(dst1 + 1, src, scale, nb_src, len);                    \
+                if (memcmp(dst0, dst1, (LEN + 1) * sizeof(*dst0)))              \
+                    fail();                                                     \
+            }                                                                   \
+        }                                                                       \
+        bench_new(dst1, src, scale, NB_SRC, LEN);                               \
+    }                                                                           \
+    report("mix_" #name);                                                       \
+}
+
+CHECK_MIX(flt, float)
+CHECK_MIX(dbl, double)
+
+void checkasm_check_amix(void)
+{
+    AMixDSPContext dsp;
+
+    ff_amix_init(&dsp);
+
+    check_mix_flt(&dsp);
+    check_mix_dbl(&dsp);
+}
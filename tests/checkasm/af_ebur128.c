@@ -0,0 +1,158 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/ebur128.h"
+#include "libavfilter/f_ebur128.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#define MAX_CHANNELS 8
+#define NB_SAMPLES   480
+#define HISTORY      (EBUR128_TP_TAPS - 1)
+
+#define randomize(buf, len)                                     \
+    do {                                                        \
+        int k;                                                  \
+        for (k = 0; k < len; k++)                               \
+            buf[k] = (double)rnd() / UINT_MAX * 2.0 - 1.0;      \
+    } while (0)
+
+/* The kernels must be bit-exact, so the outputs are compared with memcmp(). */
+
+#if CONFIG_EBUR128_FILTER
+static void check_filter(const EBUR128DSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(double, src,  [MAX_CHANNELS * NB_SAMPLES]);
+    LOCAL_ALIGNED_32(double, dst0, [MAX_CHANNELS * NB_SAMPLES]);
+    LOCAL_ALIGNED_32(double, dst1, [MAX_CHANNELS * NB_SAMPLES]);
+    double state0[EBUR128_FILTER_STATE * MAX_CHANNELS];
+    double state1[EBUR128_FILTER_STATE * MAX_CHANNELS];
+    int nb_channels;
+
+    declare_func(void, double *dst, const double *src, double *state,
+                 int nb_channels, int nb_samples);
+
+    randomize(src, MAX_CHANNELS * NB_SAMPLES);
+
+    if (check_func(dsp->filter, "filter")) {
+        for (nb_channels = 1; nb_channels <= MAX_CHANNELS; nb_channels++) {
+            randomize(state0, EBUR128_FILTER_STATE * nb_channels);
+            memcpy(state1, state0, sizeof(state0));
+            call_ref(dst0, src, state0, nb_channels, NB_SAMPLES - nb_channels);
+            call_new(dst1, src, state1, nb_channels, NB_SAMPLES - nb_channels);
+            if (memcmp(dst0, dst1, nb_channels * (NB_SAMPLES - nb_channels) * sizeof(*dst0)) ||
+                memcmp(state0, state1, EBUR128_FILTER_STATE * nb_channels * sizeof(*state0)))
+                fail();
+        }
+        bench_new(dst1, src, state1, 6, NB_SAMPLES);
+    }
+    report("filter");
+}
+
+static void check_true_peak(const EBUR128DSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(double, buf, [3 * (HISTORY + NB_SAMPLES)]);
+    const double *src = buf + 3 * HISTORY;
+    int stride, nb_samples;
+
+    declare_func(double, const double *src, ptrdiff_t stride, int nb_samples);
+
+    randomize(buf, 3 * (HISTORY + NB_SAMPLES));
+
+    if (check_func(dsp->true_peak, "true_peak")) {
+        for (stride = 1; stride <= 3; stride += 2) {
+            for (nb_samples = 1; nb_samples <= NB_SAMPLES; nb_samples += 53) {
+                double peak0 = call_ref(src + stride - 1, stride, nb_samples);
+                double peak1 = call_new(src + stride - 1, stride, nb_samples);
+                if (peak0 != peak1)
+                    fail();
+            }
+        }
+        bench_new(src, 1, NB_SAMPLES);
+    }
+    report("true_peak");
+}
+#endif
+
+#if CONFIG_LOUDNORM_FILTER
+static void check_loudnorm_filter(const FFEBUR128DSPContext *dsp)
+{
+    /* the pre-filter and RLB-filter of BS.1770 at 48kHz, multiplied */
+    static const double pre_b[3] = { PRE_B0, PRE_B1, PRE_B2 };
+    static const double pre_a[3] = { 1.0,    PRE_A1, PRE_A2 };
+    static const double rlb_b[3] = { RLB_B0, RLB_B1, RLB_B2 };
+    static const double rlb_a[3] = { 1.0,    RLB_A1, RLB_A2 };
+    LOCAL_ALIGNED_32(double, src,  [MAX_CHANNELS * NB_SAMPLES]);
+    LOCAL_ALIGNED_32(double, dst0, [MAX_CHANNELS * NB_SAMPLES]);
+    LOCAL_ALIGNED_32(double, dst1, [MAX_CHANNELS * NB_SAMPLES]);
+    double v0[4 * MAX_CHANNELS], v1[4 * MAX_CHANNELS];
+    double b[5] = { 0 }, a[5] = { 0 }, coeffs[9];
+    int i, j, channels;
+
+    declare_func(void, double *dst, const double *src, double *v,
+                 const double *coeffs, int channels, int frames);
+
+    for (i = 0; i < 3; i++) {
+        for (j = 0; j < 3; j++) {
+            b[i + j] += pre_b[i] * rlb_b[j];
+            a[i + j] += pre_a[i] * rlb_a[j];
+        }
+    }
+    memcpy(coeffs,     b,     5 * sizeof(*b));
+    memcpy(coeffs + 5, a + 1, 4 * sizeof(*a));
+
+    randomize(src, MAX_CHANNELS * NB_SAMPLES);
+
+    if (check_func(dsp->filter, "loudnorm_filter")) {
+        for (channels = 1; channels <= MAX_CHANNELS; channels++) {
+            randomize(v0, 4 * channels);
+            memcpy(v1, v0, sizeof(v0));
+            call_ref(dst0, src, v0, coeffs, channels, NB_SAMPLES - channels);
+            call_new(dst1, src, v1, coeffs, channels, NB_SAMPLES - channels);
+            if (memcmp(dst0, dst1, channels * (NB_SAMPLES - channels) * sizeof(*dst0)) ||
+                memcmp(v0, v1, 4 * channels * sizeof(*v0)))
+                fail();
+        }
+        bench_new(dst1, src, v1, coeffs, 6, NB_SAMPLES);
+    }
+    report("loudnorm_filter");
+}
+#endif
+
+void checkasm_check_ebur128(void)
+{
+#if CONFIG_EBUR128_FILTER
+    {
+        EBUR128DSPContext dsp;
+
+        ff_ebur128_filter_init(&dsp);
+        check_filter(&dsp);
+        check_true_peak(&dsp);
+    }
+#endif
+#if CONFIG_LOUDNORM_FILTER
+    {
+        FFEBUR128DSPContext dsp;
+
+        ff_ebur128_init_dsp(&dsp);
+        check_loudnorm_filter(&dsp);
+    }
+#endif
+}
@@ -80,6 +80,9 @@ static const struct {
     #if CONFIG_DCA_DECODER
         { "synth_filter", checkasm_check_synth_filter },
     #endif
+    #if CONFIG_DNXHD_DECODER
+        { "dnxhddsp", checkasm_check_dnxhddsp },
+    #endif
     #if CONFIG_FLACDSP
         { "flacdsp", checkasm_check_flacdsp },
     #endif
@@ -98,6 +101,7 @@ static const struct {
     #if CONFIG_HEVC_DECODER
         { "hevc_add_res", checkasm_check_hevc_add_res },
         { "hevc_idct", checkasm_check_hevc_idct },
+        { "hevc_pel", checkasm_check_hevc_pel },
     #endif
     #if CONFIG_JPEG2000_DECODER
         { "jpeg2000dsp", checkasm_check_jpeg2000dsp },
@@ -108,6 +112,9 @@ static const struct {
     #if CONFIG_PIXBLOCKDSP
         { "pixblockdsp", checkasm_check_pixblockdsp },
     #endif
+    #if CONFIG_PRORES_KS_ENCODER
+        { "proresencdsp", checkasm_check_proresencdsp },
+    #endif
     #if CONFIG_V210_ENCODER
         { "v210enc", checkasm_check_v210enc },
     #endif
@@ -122,15 +129,36 @@ static const struct {
     #endif
 #endif
 #if CONFIG_AVFILTER
+    #if CONFIG_AMIX_FILTER
+        { "af_amix", checkasm_check_amix },
+    #endif
+    #if CONFIG_EBUR128_FILTER || CONFIG_LOUDNORM_FILTER
+        { "af_ebur128", checkasm_check_ebur128 },
+    #endif
     #if CONFIG_BLEND_FILTER
         { "vf_blend", checkasm_check_blend },
     #endif
     #if CONFIG_COLORSPACE_FILTER
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
+    #if CONFIG_NLMEANS_FILTER
+        { "vf_nlmeans", checkasm_check_nlmeans },
+    #endif
+    #if CONFIG_OVERLAY_FILTER
+        { "vf_overlay", checkasm_check_overlay },
+    #endif
+#endif
+#if CONFIG_SWRESAMPLE
+        { "sw_audio_convert", checkasm_check_sw_audio_convert },
+        { "sw_rematrix", checkasm_check_sw_rematrix },
+        { "sw_resample", checkasm_check_sw_resample },
+#endif
+#if CONFIG_SWSCALE
+        { "sw_scale", checkasm_check_sw_scale },
 #endif
 #if CONFIG_AVUTIL
         { "fixed_dsp", checkasm_check_fixed_dsp },
+        { "float_dsp", checkasm_check_float_dsp },
 #endif
     { NULL }
 };
@@ -173,6 +201,9 @@ static const struct {
     { "FMA3",     "fma3",     AV_CPU_FLAG_FMA3 },
     { "FMA4",     "fma4",     AV_CPU_FLAG_FMA4 },
     { "AVX2",     "avx2",     AV_CPU_FLAG_AVX2 },
+    { "AVX-512",  "avx512",   AV_CPU_FLAG_AVX512 },
+    { "CLMUL",    "clmul",    AV_CPU_FLAG_CLMUL },
+    { "SHANI",    "shani",    AV_CPU_FLAG_SHANI },
 #endif
     { NULL }
 };
@@ -285,6 +316,25 @@ int float_near_abs_eps_array_ulp(const float *a, const float *b, float eps,
     return 1;
 }
 
+int double_near_abs_eps(double a, double b, double eps)
+{
+    double abs_diff = fabs(a - b);
+
+    return abs_diff < eps;
+}
+
+int double_near_abs_eps_array(const double *a, const double *b, double eps,
+                              unsigned len)
+{
+    unsigned i;
+
+    for (i = 0; i < len; i++) {
+        if (!double_near_abs_eps(a[i], b[i], eps))
+            return 0;
+    }
+    return 1;
+}
+
 /* Print colored text to stderr if the terminal supports it */
 static void color_printf(int color, const char *fmt, ...)
 {
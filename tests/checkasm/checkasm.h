@@ -33,21 +33,33 @@
 
 void checkasm_check_alacdsp(void);
 void checkasm_check_audiodsp(void);
+void checkasm_check_amix(void);
 void checkasm_check_blend(void);
 void checkasm_check_blockdsp(void);
 void checkasm_check_bswapdsp(void);
 void checkasm_check_colorspace(void);
+void checkasm_check_dnxhddsp(void);
+void checkasm_check_ebur128(void);
 void checkasm_check_fixed_dsp(void);
 void checkasm_check_flacdsp(void);
+void checkasm_check_float_dsp(void);
 void checkasm_check_fmtconvert(void);
 void checkasm_check_h264dsp(void);
 void checkasm_check_h264pred(void);
 void checkasm_check_h264qpel(void);
 void checkasm_check_hevc_add_res(void);
 void checkasm_check_hevc_idct(void);
+void checkasm_check_hevc_pel(void);
 void checkasm_check_jpeg2000dsp(void);
 void checkasm_check_llviddsp(void);
+void checkasm_check_nlmeans(void);
+void checkasm_check_overlay(void);
 void checkasm_check_pixblockdsp(void);
+void checkasm_check_proresencdsp(void);
+void checkasm_check_sw_audio_convert(void);
+void checkasm_check_sw_rematrix(void);
+void checkasm_check_sw_resample(void);
+void checkasm_check_sw_scale(void);
 void checkasm_check_synth_filter(void);
 void checkasm_check_v210enc(void);
 void checkasm_check_vp8dsp(void);
@@ -70,6 +82,9 @@ int float_near_abs_eps_array(const float *a, const float *b, float eps,
                              unsigned len);
 int float_near_abs_eps_array_ulp(const float *a, const float *b, float eps,
                                  unsigned max_ulp, unsigned len);
+int double_near_abs_eps(double a, double b, double eps);
+int double_near_abs_eps_array(const double *a, const double *b, double eps,
+                              unsigned len);
 
 extern AVLFG checkasm_lfg;
 #define rnd() av_lfg_get(&checkasm_lfg)
@@ -0,0 +1,70 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/dnxhddsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+static void check_dequant(void)
+{
+    LOCAL_ALIGNED_16(int16_t, block0, [64]);
+    LOCAL_ALIGNED_16(int16_t, block1, [64]);
+    LOCAL_ALIGNED_32(int32_t, scale, [64]);
+    LOCAL_ALIGNED_32(int32_t, bias, [64]);
+    DNXHDDSPContext c;
+    static const int shifts[] = { 4, 6 };
+    int i, s;
+
+    declare_func(void, int16_t *block, const int32_t *scale,
+                 const int32_t *bias, int shift);
+
+    ff_dnxhddsp_init(&c);
+
+    for (s = 0; s < FF_ARRAY_ELEMS(shifts); s++) {
+        if (check_func(c.dequant, "dnxhd_dequant_%d", shifts[s])) {
+            /* an 11 bit qscale times a weight from the cid tables, and
+             * levels of up to 13 bits, half of them zero */
+            int qscale = (rnd() & 0x7ff) + 1;
+            for (i = 0; i < 64; i++) {
+                int level = rnd() & 0x1fff;
+                scale[i]  = qscale * ((rnd() & 0x7f) + 1);
+                bias[i]   = (scale[i] >> 1) + (rnd() & 1 ? 32 : 0);
+                if (rnd() & 1)
+                    level = 0;
+                block0[i] = rnd() & 1 ? -level : level;
+            }
+            memcpy(block1, block0, 64 * sizeof(*block0));
+
+            call_ref(block0, scale, bias, shifts[s]);
+            call_new(block1, scale, bias, shifts[s]);
+            if (memcmp(block0, block1, 64 * sizeof(*block0)))
+                fail();
+            bench_new(block1, scale, bias, shifts[s]);
+        }
+    }
+
+    report("dequant");
+}
+
+void checkasm_check_dnxhddsp(void)
+{
+    check_dequant();
+}
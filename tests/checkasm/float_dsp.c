@@ -0,0 +1,241 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/float_dsp.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define LEN 256
+
+#define randomize_buffer(buf)                                   \
+    do {                                                        \
+        int i;                                                  \
+        for (i = 0; i < LEN; i++)                               \
+            buf[i] = (double)rnd() / (UINT_MAX >> 1) - 1.0;     \
+    } while (0)
+
+/* The FMA versions round once instead of twice, hence the tolerance. */
+#define EPS (2 * FLT_EPSILON)
+
+static void check_vector_fmul(const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED_32(float, ref, [LEN]);
+    LOCAL_ALIGNED_32(float, new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1, int len);
+
+    call_ref(ref, src0, src1, LEN);
+    call_new(new, src0, src1, LEN);
+    if (!float_near_abs_eps_array(ref, new, EPS, LEN))
+        fail();
+    bench_new(new, src0, src1, LEN);
+}
+
+static void check_vector_fmac_scalar(const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED_32(float, ref, [LEN]);
+    LOCAL_ALIGNED_32(float, new, [LEN]);
+    float scale = src1[0];
+
+    declare_func(void, float *dst, const float *src, float mul, int len);
+
+    memcpy(ref, src1, LEN * sizeof(*ref));
+    memcpy(new, src1, LEN * sizeof(*new));
+    call_ref(ref, src0, scale, LEN);
+    call_new(new, src0, scale, LEN);
+    if (!float_near_abs_eps_array(ref, new, EPS, LEN))
+        fail();
+    bench_new(new, src0, scale, LEN);
+}
+
+static void check_vector_fmul_scalar(const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED_32(float, ref, [LEN]);
+    LOCAL_ALIGNED_32(float, new, [LEN]);
+    float scale = src1[0];
+    int len;
+
+    declare_func(void, float *dst, const float *src, float mul, int len);
+
+    /* only a multiple of 4 is required here */
+    for (len = 4; len <= LEN; len += 4 * 9) {
+        memset(ref, 0, LEN * sizeof(*ref));
+        memset(new, 0, LEN * sizeof(*new));
+        call_ref(ref, src0, scale, len);
+        call_new(new, src0, scale, len);
+        if (!float_near_abs_eps_array(ref, new, EPS, LEN))
+            fail();
+    }
+    bench_new(new, src0, scale, LEN);
+}
+
+static void check_vector_dmac_scalar(const double *src0, const double *src1)
+{
+    LOCAL_ALIGNED_32(double, ref, [LEN]);
+    LOCAL_ALIGNED_32(double, new, [LEN]);
+    double scale = src1[0];
+
+    declare_func(void, double *dst, const double *src, double mul, int len);
+
+    memcpy(ref, src1, LEN * sizeof(*ref));
+    memcpy(new, src1, LEN * sizeof(*new));
+    call_ref(ref, src0, scale, LEN);
+    call_new(new, src0, scale, LEN);
+    if (!double_near_abs_eps_array(ref, new, 2 * DBL_EPSILON, LEN))
+        fail();
+    bench_new(new, src0, scale, LEN);
+}
+
+static void check_vector_dmul_scalar(const double *src0, const double *src1)
+{
+    LOCAL_ALIGNED_32(double, ref, [LEN]);
+    LOCAL_ALIGNED_32(double, new, [LEN]);
+    double scale = src1[0];
+
+    declare_func(void, double *dst, const double *src, double mul, int len);
+
+    call_ref(ref, src0, scale, LEN);
+    call_new(new, src0, scale, LEN);
+    if (!double_near_abs_eps_array(ref, new, 2 * DBL_EPSILON, LEN))
+        fail();
+    bench_new(new, src0, scale, LEN);
+}
+
+static void check_vector_fmul_window(const float *src0, const float *src1,
+                                     const float *win)
+{
+    LOCAL_ALIGNED_32(float, ref, [LEN]);
+    LOCAL_ALIGNED_32(float, new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1,
+                 const float *win, int len);
+
+    call_ref(ref, src0, src1, win, LEN / 2);
+    call_new(new, src0, src1, win, LEN / 2);
+    if (!float_near_abs_eps_array(ref, new, EPS, LEN))
+        fail();
+    bench_new(new, src0, src1, win, LEN / 2);
+}
+
+static void check_vector_fmul_add(const float *src0, const float *src1,
+                                  const float *src2)
+{
+    LOCAL_ALIGNED_32(float, ref, [LEN]);
+    LOCAL_ALIGNED_32(float, new, [LEN]);
+
+    declare_func(void, float *dst, const float *src0, const float *src1,
+                 const float *src2, int len);
+
+    call_ref(ref, src0, src1, src2, LEN);
+    call_new(new, src0, src1, src2, LEN);
+    if (!float_near_abs_eps_array(ref, new, EPS, LEN))
+        fail();
+    bench_new(new, src0, src1, src2, LEN);
+}
+
+static void check_butterflies_float(const float *src0, const float *src1)
+{
+    LOCAL_ALIGNED_32(float, ref0, [LEN]);
+    LOCAL_ALIGNED_32(float, ref1, [LEN]);
+    LOCAL_ALIGNED_32(float, new0, [LEN]);
+    LOCAL_ALIGNED_32(float, new1, [LEN]);
+
+    declare_func(void, float *av_restrict src0, float *av_restrict src1, int len);
+
+    memcpy(ref0, src0, LEN * sizeof(*src0));
+    memcpy(ref1, src1, LEN * sizeof(*src1));
+    memcpy(new0, src0, LEN * sizeof(*src0));
+    memcpy(new1, src1, LEN * sizeof(*src1));
+    call_ref(ref0, ref1, LEN);
+    call_new(new0, new1, LEN);
+    if (!float_near_abs_eps_array(ref0, new0, EPS, LEN) ||
+        !float_near_abs_eps_array(ref1, new1, EPS, LEN))
+        fail();
+    bench_new(new0, new1, LEN);
+}
+
+static void check_scalarproduct_float(const float *src0, const float *src1)
+{
+    float ref, new;
+    int len;
+
+    declare_func(float, const float *v1, const float *v2, int len);
+
+    /* the sum is reordered, so allow for a few roundings per element */
+    for (len = 4; len <= LEN; len += 4 * 9) {
+        ref = call_ref(src0, src1, len);
+        new = call_new(src0, src1, len);
+        if (!float_near_abs_eps(ref, new, len * FLT_EPSILON))
+            fail();
+    }
+    bench_new(src0, src1, LEN);
+}
+
+void checkasm_check_float_dsp(void)
+{
+    LOCAL_ALIGNED_32(float,  src0,  [LEN]);
+    LOCAL_ALIGNED_32(float,  src1,  [LEN]);
+    LOCAL_ALIGNED_32(float,  src2,  [LEN]);
+    LOCAL_ALIGNED_32(double, dbl0,  [LEN]);
+    LOCAL_ALIGNED_32(double, dbl1,  [LEN]);
+    AVFloatDSPContext *fdsp = avpriv_float_dsp_alloc(1);
+
+    if (!fdsp) {
+        fail();
+        return;
+    }
+
+    randomize_buffer(src0);
+    randomize_buffer(src1);
+    randomize_buffer(src2);
+    randomize_buffer(dbl0);
+    randomize_buffer(dbl1);
+
+    if (check_func(fdsp->vector_fmul, "vector_fmul"))
+        check_vector_fmul(src0, src1);
+    if (check_func(fdsp->vector_fmul_add, "vector_fmul_add"))
+        check_vector_fmul_add(src0, src1, src2);
+    if (check_func(fdsp->vector_fmul_reverse, "vector_fmul_reverse"))
+        check_vector_fmul(src0, src1);
+    if (check_func(fdsp->vector_fmul_window, "vector_fmul_window"))
+        check_vector_fmul_window(src0, src1, src2);
+    report("vector_fmul");
+    if (check_func(fdsp->vector_fmac_scalar, "vector_fmac_scalar"))
+        check_vector_fmac_scalar(src0, src1);
+    if (check_func(fdsp->vector_fmul_scalar, "vector_fmul_scalar"))
+        check_vector_fmul_scalar(src0, src1);
+    report("vector_fmul_scalar");
+    if (check_func(fdsp->vector_dmac_scalar, "vector_dmac_scalar"))
+        check_vector_dmac_scalar(dbl0, dbl1);
+    if (check_func(fdsp->vector_dmul_scalar, "vector_dmul_scalar"))
+        check_vector_dmul_scalar(dbl0, dbl1);
+    report("vector_dmul_scalar");
+    if (check_func(fdsp->butterflies_float, "butterflies_float"))
+        check_butterflies_float(src0, src1);
+    report("butterflies_float");
+    if (check_func(fdsp->scalarproduct_float, "scalarproduct_float"))
+        check_scalarproduct_float(src0, src1);
+    report("scalarproduct_float");
+
+    av_freep(&fdsp);
+}
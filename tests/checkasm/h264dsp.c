@@ -226,7 +226,77 @@ static void check_idct(void)
     report("idct");
 }
 
+#define randomize_dc_coefs(buf, n)                                           \
+    do {                                                                     \
+        int i;                                                               \
+        for (i = 0; i < n; i++) {                                            \
+            int v = (int)(rnd() & 0x7f) - 64;                                \
+            if (bit_depth == 8)                                              \
+                (buf)[i] = v;                                                \
+            else                                                             \
+                ((int32_t *)(buf))[i] = v;                                   \
+        }                                                                    \
+    } while (0)
+
+static void check_dc_dequant_idct(void)
+{
+    LOCAL_ALIGNED_16(int16_t, input,  [16 * 2]);
+    LOCAL_ALIGNED_16(int16_t, input0, [16 * 2]);
+    LOCAL_ALIGNED_16(int16_t, input1, [16 * 2]);
+    LOCAL_ALIGNED_16(int16_t, block,  [16 * 16 * 2]);
+    LOCAL_ALIGNED_16(int16_t, block0, [16 * 16 * 2]);
+    LOCAL_ALIGNED_16(int16_t, block1, [16 * 16 * 2]);
+    H264DSPContext h;
+    int bit_depth, chroma_format_idc, qmul;
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        for (chroma_format_idc = 1; chroma_format_idc <= 2; chroma_format_idc++) {
+            ff_h264dsp_init(&h, bit_depth, chroma_format_idc);
+
+            /* the luma function does not depend on the chroma format */
+            if (chroma_format_idc == 1) {
+                declare_func_emms(AV_CPU_FLAG_MMX, void, int16_t *output, int16_t *input, int qmul);
+
+                if (check_func(h.h264_luma_dc_dequant_idct, "h264_luma_dc_dequant_idct_%dbpp", bit_depth)) {
+                    randomize_dc_coefs(input, 16);
+                    randomize_dc_coefs(block, 16 * 16);
+                    qmul = (rnd() & 0xfff) + 1;
+                    memcpy(input0, input, 16 * SIZEOF_COEF);
+                    memcpy(input1, input, 16 * SIZEOF_COEF);
+                    memcpy(block0, block, 16 * 16 * SIZEOF_COEF);
+                    memcpy(block1, block, 16 * 16 * SIZEOF_COEF);
+                    call_ref(block0, input0, qmul);
+                    call_new(block1, input1, qmul);
+                    if (memcmp(block0, block1, 16 * 16 * SIZEOF_COEF))
+                        fail();
+                    bench_new(block1, input1, qmul);
+                }
+            }
+
+            {
+                declare_func_emms(AV_CPU_FLAG_MMX, void, int16_t *block, int qmul);
+
+                if (check_func(h.h264_chroma_dc_dequant_idct, "h264_chroma%s_dc_dequant_idct_%dbpp",
+                               chroma_format_idc == 2 ? "422" : "", bit_depth)) {
+                    randomize_dc_coefs(block, 16 * 8);
+                    qmul = (rnd() & 0xfff) + 1;
+                    memcpy(block0, block, 16 * 8 * SIZEOF_COEF);
+                    memcpy(block1, block, 16 * 8 * SIZEOF_COEF);
+                    call_ref(block0, qmul);
+                    call_new(block1, qmul);
+                    if (memcmp(block0, block1, 16 * 8 * SIZEOF_COEF))
+                        fail();
+                    memcpy(block1, block, 16 * 8 * SIZEOF_COEF);
+                    bench_new(block1, qmul);
+                }
+            }
+        }
+    }
+    report("dc_dequant_idct");
+}
+
 void checkasm_check_h264dsp(void)
 {
     check_idct();
+    check_dc_dequant_idct();
 }
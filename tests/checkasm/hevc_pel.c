@@ -0,0 +1,109 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+static const uint32_t pixel_mask[3] = { 0xffffffff, 0x01ff01ff, 0x03ff03ff };
+static const int sizes[10] = { 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+static const char *const types[4] = { "pel_pixels", "h", "v", "hv" };
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+/* the filters read up to 3 pixels before and 4 after the block */
+#define SRC_STRIDE   (2 * (MAX_PB_SIZE + 8))
+#define BUF_SIZE     (SRC_STRIDE * (MAX_PB_SIZE + 8))
+#define DST_SIZE     (MAX_PB_SIZE * MAX_PB_SIZE)
+
+#define randomize_buffers()                        \
+    do {                                           \
+        uint32_t mask = pixel_mask[bit_depth - 8]; \
+        int k;                                     \
+        for (k = 0; k < BUF_SIZE; k += 4) {        \
+            uint32_t r = rnd() & mask;             \
+            AV_WN32A(buf0 + k, r);                 \
+            AV_WN32A(buf1 + k, r);                 \
+        }                                          \
+        for (k = 0; k < DST_SIZE; k++) {           \
+            int16_t r = rnd();                     \
+            dst0[k] = r;                           \
+            dst1[k] = r;                           \
+        }                                          \
+    } while (0)
+
+#define src0 (buf0 + 3 * SRC_STRIDE + 8)
+#define src1 (buf1 + 3 * SRC_STRIDE + 8)
+
+static void check_put_hevc_pel(const char *pel, int nb_filters,
+                               void (*(*tab)[2][2])(int16_t *dst, uint8_t *src,
+                                                   ptrdiff_t srcstride, int height,
+                                                   intptr_t mx, intptr_t my, int width),
+                               int bit_depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, dst0, [DST_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, dst1, [DST_SIZE]);
+    int size, v, h;
+
+    declare_func(void, int16_t *dst, uint8_t *src, ptrdiff_t srcstride,
+                 int height, intptr_t mx, intptr_t my, int width);
+
+    for (v = 0; v < 2; v++) {
+        for (h = 0; h < 2; h++) {
+            for (size = 0; size < 10; size++) {
+                const int w = sizes[size];
+
+                if (check_func(tab[size][v][h], "put_hevc_%s_%s%d_%d", pel,
+                               types[(v << 1) | h], w, bit_depth)) {
+                    intptr_t mx = h ? 1 + rnd() % nb_filters : 0;
+                    intptr_t my = v ? 1 + rnd() % nb_filters : 0;
+
+                    randomize_buffers();
+                    call_ref(dst0, src0, SRC_STRIDE, w, mx, my, w);
+                    call_new(dst1, src1, SRC_STRIDE, w, mx, my, w);
+                    if (memcmp(dst0, dst1, DST_SIZE * sizeof(*dst0)))
+                        fail();
+                    bench_new(dst1, src1, SRC_STRIDE, w, mx, my, w);
+                }
+            }
+        }
+    }
+}
+
+void checkasm_check_hevc_pel(void)
+{
+    HEVCDSPContext h;
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_put_hevc_pel("qpel", 3, h.put_hevc_qpel, bit_depth);
+    }
+    report("qpel");
+
+    for (bit_depth = 8; bit_depth <= 10; bit_depth++) {
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_put_hevc_pel("epel", 7, h.put_hevc_epel, bit_depth);
+    }
+    report("epel");
+}
@@ -20,6 +20,7 @@
 
 #include "checkasm.h"
 #include "libavcodec/jpeg2000dsp.h"
+#include "libavcodec/jpeg2000dwt.h"
 #include "libavutil/common.h"
 #include "libavutil/internal.h"
 #include "libavutil/intreadwrite.h"
@@ -55,6 +56,75 @@ static void check_mct(uint8_t *ref0, uint8_t *ref1, uint8_t *ref2,
     bench_new(new0, new1, new2, BUF_SIZE / sizeof(int32_t));
 }
 
+#define LIFT_LEN (FF_DWT_STRIP - 8)
+
+#define randomize_lift()                                            \
+    do {                                                            \
+        int i;                                                      \
+        for (i = 0; i < FF_DWT_STRIP; i++) {                        \
+            src0[i] = (int32_t)(rnd() & 0xFFFFF) - (1 << 19);       \
+            src1[i] = (int32_t)(rnd() & 0xFFFFF) - (1 << 19);       \
+            ref[i]  = new[i] = (int32_t)(rnd() & 0xFFFFF) - (1 << 19); \
+        }                                                           \
+    } while (0)
+
+static void check_lift53(int32_t *ref, int32_t *new,
+                         int32_t *src0, int32_t *src1)
+{
+    declare_func(void, int32_t *dst, const int32_t *src0,
+                 const int32_t *src1, int n);
+
+    randomize_lift();
+    call_ref(ref, src0, src1, LIFT_LEN);
+    call_new(new, src0, src1, LIFT_LEN);
+    if (memcmp(ref, new, sizeof(*ref) * FF_DWT_STRIP))
+        fail();
+    bench_new(new, src0, src1, LIFT_LEN);
+}
+
+static void check_lift97(int32_t *ref, int32_t *new,
+                         int32_t *src0, int32_t *src1, int coef)
+{
+    declare_func(void, int32_t *dst, const int32_t *src0,
+                 const int32_t *src1, int n, int coef);
+
+    randomize_lift();
+    call_ref(ref, src0, src1, LIFT_LEN, coef);
+    call_new(new, src0, src1, LIFT_LEN, coef);
+    if (memcmp(ref, new, sizeof(*ref) * FF_DWT_STRIP))
+        fail();
+    bench_new(new, src0, src1, LIFT_LEN, coef);
+}
+
+static void check_dwt(void)
+{
+    LOCAL_ALIGNED_32(int32_t, ref,  [FF_DWT_STRIP]);
+    LOCAL_ALIGNED_32(int32_t, new,  [FF_DWT_STRIP]);
+    LOCAL_ALIGNED_32(int32_t, src0, [FF_DWT_STRIP]);
+    LOCAL_ALIGNED_32(int32_t, src1, [FF_DWT_STRIP]);
+    int border[2][2] = { { 0, 64 }, { 0, 64 } };
+    DWTContext dwt53 = { 0 }, dwt97 = { 0 };
+
+    if (ff_jpeg2000_dwt_init(&dwt53, border, 1, FF_DWT53) < 0 ||
+        ff_jpeg2000_dwt_init(&dwt97, border, 1, FF_DWT97_INT) < 0)
+        goto end;
+
+    if (check_func(dwt53.sd_lift53_high, "jpeg2000_dwt53_lift_high"))
+        check_lift53(ref, new, src0, src1);
+    if (check_func(dwt53.sd_lift53_low, "jpeg2000_dwt53_lift_low"))
+        check_lift53(ref, new, src0, src1);
+    /* the subtracting steps use a negative coefficient */
+    if (check_func(dwt97.sd_lift97_int, "jpeg2000_dwt97_int_lift_neg"))
+        check_lift97(ref, new, src0, src1, -103949);
+    if (check_func(dwt97.sd_lift97_int, "jpeg2000_dwt97_int_lift_pos"))
+        check_lift97(ref, new, src0, src1, 57862);
+
+    report("dwt_encode");
+end:
+    ff_dwt_destroy(&dwt53);
+    ff_dwt_destroy(&dwt97);
+}
+
 void checkasm_check_jpeg2000dsp(void)
 {
     LOCAL_ALIGNED_32(uint8_t, ref, [BUF_SIZE*3]);
@@ -68,4 +138,6 @@ void checkasm_check_jpeg2000dsp(void)
                   &new[BUF_SIZE*0], &new[BUF_SIZE*1], &new[BUF_SIZE*2]);
 
     report("mct_decode");
+
+    check_dwt();
 }
@@ -0,0 +1,73 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/proresencdsp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define MAX_BLOCKS 32
+
+static void check_quantize(ProresEncDSPContext *c)
+{
+    LOCAL_ALIGNED_32(int16_t, blocks, [64 * MAX_BLOCKS]);
+    LOCAL_ALIGNED_32(int16_t, qmat,   [64]);
+    LOCAL_ALIGNED_32(int16_t, levels0, [64 * MAX_BLOCKS]);
+    LOCAL_ALIGNED_32(int16_t, levels1, [64 * MAX_BLOCKS]);
+    uint32_t nz0[64], nz1[64];
+    int i, nb_blocks, shift, err0, err1;
+
+    declare_func(int, int16_t *levels, uint32_t nz[64], const int16_t *blocks,
+                 const int16_t *qmat, int nb_blocks);
+
+    for (nb_blocks = 1; nb_blocks <= MAX_BLOCKS; nb_blocks++) {
+        /* mostly small coefficients, as after the DCT, so that many
+         * levels quantize to zero, with the odd full range one */
+        shift = rnd() % 15;
+        for (i = 0; i < 64 * nb_blocks; i++)
+            blocks[i] = rnd() & 7 ? (int16_t)rnd() >> shift : (int16_t)rnd();
+        for (i = 0; i < 64; i++)
+            qmat[i] = rnd() & 1 ? rnd() % 64 + 1 : rnd() % 0x7FFF + 1;
+        memset(levels0, 0, 64 * MAX_BLOCKS * sizeof(*levels0));
+        memset(levels1, 0, 64 * MAX_BLOCKS * sizeof(*levels1));
+        memset(nz0, 0xFF, sizeof(nz0));
+        memset(nz1, 0xFF, sizeof(nz1));
+
+        err0 = call_ref(levels0, nz0, blocks, qmat, nb_blocks);
+        err1 = call_new(levels1, nz1, blocks, qmat, nb_blocks);
+        if (err0 != err1 || memcmp(nz0, nz1, sizeof(nz0)) ||
+            memcmp(levels0, levels1, 64 * MAX_BLOCKS * sizeof(*levels0)))
+            fail();
+        if (nb_blocks == MAX_BLOCKS)
+            bench_new(levels1, nz1, blocks, qmat, nb_blocks);
+    }
+}
+
+void checkasm_check_proresencdsp(void)
+{
+    ProresEncDSPContext c;
+
+    ff_proresencdsp_init(&c);
+
+    if (check_func(c.quantize, "prores_quantize"))
+        check_quantize(&c);
+
+    report("quantize");
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libswresample/audioconvert.h"
+
+#define BUF_SIZE 1024
+
+static conv_func_type *conv_ref;
+static int conv_is, conv_os;
+
+/* the generic per sample conversion, with the calling convention of simd_f */
+static void conv_c(uint8_t **dst, const uint8_t **src, int len)
+{
+    conv_ref(dst[0], src[0], conv_is, conv_os, dst[0] + len * conv_os);
+}
+
+static void randomize(uint8_t *buf, enum AVSampleFormat fmt)
+{
+    int i;
+
+    if (fmt == AV_SAMPLE_FMT_S32) {
+        for (i = 0; i < BUF_SIZE; i++)
+            ((int32_t *)buf)[i] = rnd();
+    } else {
+        /* include out of range values, exact values and ties */
+        static const double special[] = {
+            1.0, -1.0, 2.0, -2.0, 0.5 / (1U<<31), 1.5 / (1U<<31), -0.5 / (1U<<31),
+        };
+        double *d = (double *)buf;
+        for (i = 0; i < BUF_SIZE; i++)
+            d[i] = (double)rnd() / UINT_MAX * 2.5 - 1.25;
+        for (i = 0; i < FF_ARRAY_ELEMS(special); i++)
+            d[i * 7] = special[i];
+    }
+}
+
+static void check_conv(enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt,
+                       const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SIZE * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE * sizeof(double)]);
+    const uint8_t *in[1] = { src };
+    uint8_t *out0[1] = { dst0 }, *out1[1] = { dst1 };
+    int os = av_get_bytes_per_sample(out_fmt);
+    AudioConvert *ac;
+    int len;
+
+    declare_func(void, uint8_t **dst, const uint8_t **src, int len);
+
+    ac = swri_audio_convert_alloc(out_fmt, in_fmt, 2, NULL, 0);
+    if (!ac) {
+        fail();
+        return;
+    }
+    conv_ref = ac->conv_f;
+    conv_is  = av_get_bytes_per_sample(in_fmt);
+    conv_os  = os;
+
+    randomize(src, in_fmt);
+
+    if (check_func(ac->simd_f ? ac->simd_f : conv_c, "%s", name)) {
+        for (len = 16; len <= BUF_SIZE; len += 16 * 21) {
+            memset(dst0, 0, BUF_SIZE * os);
+            memset(dst1, 0, BUF_SIZE * os);
+            call_ref(out0, in, len);
+            call_new(out1, in, len);
+            if (memcmp(dst0, dst1, BUF_SIZE * os))
+                fail();
+        }
+        bench_new(out1, in, BUF_SIZE);
+    }
+
+    swri_audio_convert_free(&ac);
+}
+
+void checkasm_check_sw_audio_convert(void)
+{
+    check_conv(AV_SAMPLE_FMT_DBL, AV_SAMPLE_FMT_S32, "int32_to_double");
+    check_conv(AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_DBL, "double_to_int32");
+    report("convert");
+}
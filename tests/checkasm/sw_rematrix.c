@@ -0,0 +1,218 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+
+#define BUF_SIZE 1024
+#define LEN      (BUF_SIZE - 16)
+
+static void randomize_float(float *buf, int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        buf[i] = (float)rnd() / (UINT_MAX >> 1) - 1.0f;
+}
+
+static void randomize_double(double *buf, int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        buf[i] = (double)rnd() / (UINT_MAX >> 1) - 1.0;
+}
+
+static void randomize_int16(int16_t *buf, int len)
+{
+    int i;
+    for (i = 0; i < len; i++)
+        buf[i] = rnd();
+}
+
+static int cmp_samples(const uint8_t *a, const uint8_t *b,
+                       enum AVSampleFormat fmt, int len)
+{
+    int i;
+
+    if (fmt == AV_SAMPLE_FMT_FLTP)
+        return !float_near_abs_eps_array((const float *)a, (const float *)b,
+                                         1e-6, len);
+
+    /* the SIMD int16 paths use a rescaled matrix and may round differently */
+    for (i = 0; i < len; i++)
+        if (FFABS(((const int16_t *)a)[i] - ((const int16_t *)b)[i]) > 1)
+            return 1;
+    return 0;
+}
+
+static void check_rematrix(enum AVSampleFormat fmt, const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, src0, [BUF_SIZE * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [BUF_SIZE * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE * sizeof(float)]);
+    int bps = av_get_bytes_per_sample(fmt);
+    struct SwrContext *s;
+    void *coeff_ref, *coeff_new;
+
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, fmt, 48000,
+                           AV_CH_LAYOUT_5POINT1, fmt, 48000, 0, NULL);
+    if (!s || swr_init(s) < 0 || s->midbuf.fmt != fmt || !s->native_matrix) {
+        fail();
+        swr_free(&s);
+        return;
+    }
+
+    /* checkasm compares against the last SIMD version that passed, which
+     * takes a different coefficient layout, so the C functions are called
+     * directly as the reference */
+    coeff_ref = s->native_matrix;
+
+    if (fmt == AV_SAMPLE_FMT_FLTP) {
+        randomize_float((float *)src0, BUF_SIZE);
+        randomize_float((float *)src1, BUF_SIZE);
+    } else {
+        randomize_int16((int16_t *)src0, BUF_SIZE);
+        randomize_int16((int16_t *)src1, BUF_SIZE);
+    }
+
+    {
+        declare_func(void, uint8_t *out, const uint8_t *in, void *coeffp,
+                     integer index, integer len);
+
+        coeff_new = s->mix_1_1_simd ? s->native_simd_matrix : s->native_matrix;
+        if (check_func(s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f,
+                       "rematrix_1_1_%s", name)) {
+            memset(dst0, 0, BUF_SIZE * bps);
+            memset(dst1, 0, BUF_SIZE * bps);
+            s->mix_1_1_f(dst0, src0, coeff_ref, 2, LEN);
+            call_new(dst1, src0, coeff_new, 2, LEN);
+            if (cmp_samples(dst0, dst1, fmt, LEN))
+                fail();
+            bench_new(dst1, src0, coeff_new, 2, LEN);
+        }
+    }
+
+    {
+        declare_func(void, uint8_t *out, const uint8_t *in1, const uint8_t *in2,
+                     void *coeffp, integer index1, integer index2, integer len);
+
+        coeff_new = s->mix_2_1_simd ? s->native_simd_matrix : s->native_matrix;
+        if (check_func(s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f,
+                       "rematrix_2_1_%s", name)) {
+            memset(dst0, 0, BUF_SIZE * bps);
+            memset(dst1, 0, BUF_SIZE * bps);
+            s->mix_2_1_f(dst0, src0, src1, coeff_ref, 0, 2, LEN);
+            call_new(dst1, src0, src1, coeff_new, 0, 2, LEN);
+            if (cmp_samples(dst0, dst1, fmt, LEN))
+                fail();
+            bench_new(dst1, src0, src1, coeff_new, 0, 2, LEN);
+        }
+    }
+
+    swr_free(&s);
+}
+
+/* mix all 6 inputs into each output, through the generic N to 1 path */
+static void check_mix_n_1(enum AVSampleFormat fmt, const char *name, double gain)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [6 * BUF_SIZE * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE * sizeof(double)]);
+    union {
+        float   flt[6];
+        double  dbl[6];
+        int32_t s32[6];
+    } coeffs;
+    const void *in[6];
+    double matrix[2 * 6];
+    int bps = av_get_bytes_per_sample(fmt);
+    struct SwrContext *s;
+    int i, len;
+
+    declare_func(void, void *out, const void **in, const void *coeffp,
+                 integer nb_in, integer len);
+
+    for (i = 0; i < 2 * 6; i++)
+        matrix[i] = gain * (i % 6 + 1) / 21;
+
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, fmt, 48000,
+                           AV_CH_LAYOUT_5POINT1, fmt, 48000, 0, NULL);
+    if (!s || swr_set_matrix(s, matrix, 6) < 0 || swr_init(s) < 0 ||
+        s->midbuf.fmt != fmt || s->matrix_ch[0][0] != 6) {
+        fail();
+        swr_free(&s);
+        return;
+    }
+
+    for (i = 0; i < 6; i++) {
+        uint8_t *buf = src + i * BUF_SIZE * sizeof(double);
+
+        if (fmt == AV_SAMPLE_FMT_FLTP)
+            randomize_float((float *)buf, BUF_SIZE);
+        else if (fmt == AV_SAMPLE_FMT_DBLP)
+            randomize_double((double *)buf, BUF_SIZE);
+        else
+            randomize_int16((int16_t *)buf, BUF_SIZE);
+        in[i] = buf;
+
+        if (fmt == AV_SAMPLE_FMT_FLTP)
+            coeffs.flt[i] = s->matrix_flt[0][i];
+        else if (fmt == AV_SAMPLE_FMT_DBLP)
+            coeffs.dbl[i] = s->matrix[0][i];
+        else
+            coeffs.s32[i] = s->matrix32[0][i];
+    }
+
+    /* the generic path is bit-exact, unlike the 1_1 and 2_1 ones; the SIMD
+     * versions take multiples of 16 samples */
+    if (check_func(s->mix_n_1_simd ? s->mix_n_1_simd : s->mix_n_1_f,
+                   "rematrix_n_1_%s", name)) {
+        for (len = LEN - 48; len <= LEN; len += 16) {
+            memset(dst0, 0, BUF_SIZE * bps);
+            memset(dst1, 0, BUF_SIZE * bps);
+            call_ref(dst0, in, &coeffs, 6, len);
+            call_new(dst1, in, &coeffs, 6, len);
+            if (memcmp(dst0, dst1, BUF_SIZE * bps))
+                fail();
+        }
+        bench_new(dst1, in, &coeffs, 6, LEN);
+    }
+
+    swr_free(&s);
+}
+
+void checkasm_check_sw_rematrix(void)
+{
+    check_rematrix(AV_SAMPLE_FMT_FLTP, "float");
+    report("rematrix_float");
+
+    check_rematrix(AV_SAMPLE_FMT_S16P, "int16");
+    report("rematrix_int16");
+
+    check_mix_n_1(AV_SAMPLE_FMT_FLTP, "float",    1.0);
+    check_mix_n_1(AV_SAMPLE_FMT_DBLP, "double",   1.0);
+    check_mix_n_1(AV_SAMPLE_FMT_S16P, "int16",    0.9);
+    check_mix_n_1(AV_SAMPLE_FMT_S16P, "int16_clip", 1.8);
+    report("rematrix_n_1");
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libswresample/swresample.h"
+#include "libswresample/swresample_internal.h"
+#include "libswresample/resample.h"
+
+#define DST_LEN 512
+/* enough input for DST_LEN output samples at 44100 -> 48000 with filters of
+ * up to 128 taps */
+#define SRC_LEN (DST_LEN + 256)
+
+static void check_resample(enum AVSampleFormat fmt, int linear, int filter_size,
+                           const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [SRC_LEN * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_LEN * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_LEN * sizeof(double)]);
+    ResampleContext *c;
+    int i, n0, n1;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    c = swri_resampler.init(NULL, 48000, 44100, filter_size, 10, linear, 0.97, fmt,
+                            SWR_FILTER_TYPE_KAISER, 9, 0, 0, 0);
+    if (!c) {
+        fail();
+        return;
+    }
+
+    for (i = 0; i < SRC_LEN; i++) {
+        double v = (double)rnd() / UINT_MAX * 2.0 - 1.0;
+        if (fmt == AV_SAMPLE_FMT_FLTP)
+            ((float *)src)[i]  = v;
+        else
+            ((double *)src)[i] = v;
+    }
+
+    if (check_func(linear ? c->dsp.resample_linear : c->dsp.resample_common,
+                   "%s_%d", name, filter_size)) {
+        int index0, frac0;
+
+        memset(dst0, 0, DST_LEN * sizeof(double));
+        memset(dst1, 0, DST_LEN * sizeof(double));
+        /* start from a phase that is not 0; the asm only returns the
+         * consumed sample count when asked to update the context */
+        c->index = 7;
+        c->frac  = c->src_incr / 3;
+        n0 = call_ref(c, dst0, src, DST_LEN, 1);
+        index0 = c->index;
+        frac0  = c->frac;
+        c->index = 7;
+        c->frac  = c->src_incr / 3;
+        n1 = call_new(c, dst1, src, DST_LEN, 1);
+        if (n0 != n1 || index0 != c->index || frac0 != c->frac ||
+            (fmt == AV_SAMPLE_FMT_FLTP &&
+             !float_near_abs_eps_array((float *)dst0, (float *)dst1, 1e-5, DST_LEN)) ||
+            (fmt == AV_SAMPLE_FMT_DBLP &&
+             !double_near_abs_eps_array((double *)dst0, (double *)dst1, 1e-12, DST_LEN)))
+            fail();
+        bench_new(c, dst1, src, DST_LEN, 0);
+    }
+
+    swri_resampler.free(&c);
+}
+
+void checkasm_check_sw_resample(void)
+{
+    static const int filter_sizes[] = { 32, 70, 128 };
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(filter_sizes); i++) {
+        check_resample(AV_SAMPLE_FMT_FLTP, 0, filter_sizes[i], "resample_common_float");
+        check_resample(AV_SAMPLE_FMT_FLTP, 1, filter_sizes[i], "resample_linear_float");
+    }
+    report("resample_float");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(filter_sizes); i++) {
+        check_resample(AV_SAMPLE_FMT_DBLP, 0, filter_sizes[i], "resample_common_double");
+        check_resample(AV_SAMPLE_FMT_DBLP, 1, filter_sizes[i], "resample_linear_double");
+    }
+    report("resample_double");
+}
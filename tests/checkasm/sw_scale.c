@@ -0,0 +1,101 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define MAX_TAPS  16
+#define LARGEST_W 1920
+
+static const int widths[]       = { 8, 24, 128, 144, 256, 1918, 1920 };
+/* the vertical filter is padded to an even number of taps on x86 */
+static const int filter_sizes[] = { 2, 4, 6, 8, 12, 16 };
+
+static void check_yuv2planeX(void)
+{
+    LOCAL_ALIGNED_32(int16_t, src_pixels, [MAX_TAPS * LARGEST_W]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [LARGEST_W]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [LARGEST_W]);
+    const int16_t *src[MAX_TAPS];
+    int16_t filter[MAX_TAPS];
+    uint8_t dither[8];
+    struct SwsContext *ctx;
+    int i, fsi, wi;
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    /* bit-exact scaling keeps the generic coefficient layout */
+    ctx = sws_getContext(LARGEST_W, 1080, AV_PIX_FMT_YUV420P,
+                         LARGEST_W, 720,  AV_PIX_FMT_YUV420P,
+                         SWS_BICUBIC | SWS_ACCURATE_RND | SWS_BITEXACT,
+                         NULL, NULL, NULL);
+    if (!ctx) {
+        fail();
+        return;
+    }
+
+    for (i = 0; i < MAX_TAPS * LARGEST_W; i++)
+        src_pixels[i] = rnd() >> 17;
+    for (i = 0; i < MAX_TAPS; i++)
+        src[i] = src_pixels + i * LARGEST_W;
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+
+    for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+        const int filter_size = filter_sizes[fsi];
+        int sum = 0;
+
+        /* the taps of a real filter sum up to 4096 */
+        for (i = 0; i < filter_size - 1; i++) {
+            filter[i] = (int)(rnd() % 2048) - 512;
+            sum += filter[i];
+        }
+        filter[filter_size - 1] = 4096 - sum;
+
+        if (check_func(ctx->yuv2planeX, "yuv2planeX_8_%d", filter_size)) {
+            for (wi = 0; wi < FF_ARRAY_ELEMS(widths); wi++) {
+                const int dstW   = widths[wi];
+                /* the chroma planes start 3 samples into the dither */
+                const int offset = rnd() & 1 ? 3 : 0;
+
+                memset(dst0, 0, LARGEST_W);
+                memset(dst1, 0, LARGEST_W);
+                call_ref(filter, filter_size, src, dst0, dstW, dither, offset);
+                call_new(filter, filter_size, src, dst1, dstW, dither, offset);
+                if (memcmp(dst0, dst1, dstW))
+                    fail();
+            }
+            bench_new(filter, filter_size, src, dst1, LARGEST_W, dither, 0);
+        }
+    }
+    report("yuv2planeX");
+
+    sws_freeContext(ctx);
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_yuv2planeX();
+}
@@ -0,0 +1,131 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_nlmeans.h"
+#include "libavutil/avassert.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#define WIDTH  256
+#define HEIGHT 64
+#define SRC_LINESIZE (WIDTH + 16)
+/* one extra line and column in front for the 0-line and 0-column */
+#define II_LINESIZE  (WIDTH + 4)
+#define II_SIZE      (II_LINESIZE * (HEIGHT + 1))
+#define LUT_SIZE     512
+
+static void check_compute_safe_ssd_integral_image(const NLMeansDSPContext *dsp)
+{
+    uint8_t  *src  = av_malloc(SRC_LINESIZE * (HEIGHT + 16));
+    uint32_t *ii0  = av_malloc(II_SIZE * sizeof(*ii0));
+    uint32_t *ii1  = av_malloc(II_SIZE * sizeof(*ii1));
+    int i, offx, offy;
+
+    declare_func(void, uint32_t *dst, ptrdiff_t dst_linesize_32,
+                 const uint8_t *s1, ptrdiff_t linesize1,
+                 const uint8_t *s2, ptrdiff_t linesize2,
+                 int w, int h);
+
+    av_assert0(src && ii0 && ii1);
+
+    if (check_func(dsp->compute_safe_ssd_integral_image, "compute_safe_ssd_integral_image")) {
+        for (i = 0; i < SRC_LINESIZE * (HEIGHT + 16); i++)
+            src[i] = rnd();
+
+        for (offy = 0; offy <= 8; offy += 8) {
+            for (offx = 0; offx <= 3; offx++) {
+                const uint8_t *s2 = src + offy * SRC_LINESIZE + offx;
+
+                /* the top line and left column are inputs of the function */
+                for (i = 0; i < II_SIZE; i++)
+                    ii0[i] = ii1[i] = rnd();
+
+                call_ref(ii0 + II_LINESIZE + 1, II_LINESIZE,
+                         src, SRC_LINESIZE, s2, SRC_LINESIZE,
+                         WIDTH, HEIGHT);
+                call_new(ii1 + II_LINESIZE + 1, II_LINESIZE,
+                         src, SRC_LINESIZE, s2, SRC_LINESIZE,
+                         WIDTH, HEIGHT);
+                if (memcmp(ii0, ii1, II_SIZE * sizeof(*ii0)))
+                    fail();
+            }
+        }
+        bench_new(ii1 + II_LINESIZE + 1, II_LINESIZE,
+                  src, SRC_LINESIZE, src + 1, SRC_LINESIZE,
+                  WIDTH, HEIGHT);
+    }
+    report("compute_safe_ssd_integral_image");
+
+    av_freep(&src);
+    av_freep(&ii0);
+    av_freep(&ii1);
+}
+
+static void check_compute_weights_line(const NLMeansDSPContext *dsp)
+{
+    LOCAL_ALIGNED_16(uint32_t, iie,   [WIDTH]);
+    LOCAL_ALIGNED_16(uint32_t, zero,  [WIDTH]);
+    LOCAL_ALIGNED_16(uint8_t,  src,   [WIDTH]);
+    LOCAL_ALIGNED_16(double,   lut,   [LUT_SIZE]);
+    struct weighted_avg wa0[WIDTH], wa1[WIDTH];
+    const int max_meaningful_diff = 1000;
+    const double pdiff_lut_scale = (double)LUT_SIZE / max_meaningful_diff;
+    int i;
+
+    declare_func(void, const uint32_t *iia, const uint32_t *iib,
+                 const uint32_t *iid, const uint32_t *iie,
+                 const uint8_t *src, struct weighted_avg *wa,
+                 const double *weight_lut, double pdiff_lut_scale,
+                 int max_meaningful_diff, int startx, int endx);
+
+    if (check_func(dsp->compute_weights_line, "compute_weights_line")) {
+        memset(zero, 0, WIDTH * sizeof(*zero));
+        for (i = 0; i < LUT_SIZE; i++)
+            lut[i] = exp(-i / (double)LUT_SIZE * 4);
+        for (i = 0; i < WIDTH; i++) {
+            /* some of the patches are above the meaningful difference */
+            iie[i] = rnd() % (max_meaningful_diff * 2);
+            src[i] = rnd();
+            wa0[i].total_weight = wa1[i].total_weight = rnd() & 0xff;
+            wa0[i].sum          = wa1[i].sum          = rnd() & 0xffff;
+        }
+
+        call_ref(zero, zero, zero, iie, src, wa0, lut, pdiff_lut_scale,
+                 max_meaningful_diff, 3, WIDTH - 5);
+        call_new(zero, zero, zero, iie, src, wa1, lut, pdiff_lut_scale,
+                 max_meaningful_diff, 3, WIDTH - 5);
+        if (memcmp(wa0, wa1, sizeof(wa0)))
+            fail();
+        bench_new(zero, zero, zero, iie, src, wa1, lut, pdiff_lut_scale,
+                  max_meaningful_diff, 0, WIDTH);
+    }
+    report("compute_weights_line");
+}
+
+void checkasm_check_nlmeans(void)
+{
+    NLMeansDSPContext dsp;
+
+    ff_nlmeans_init(&dsp);
+
+    check_compute_safe_ssd_integral_image(&dsp);
+    check_compute_weights_line(&dsp);
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_overlay.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 256
+
+#define randomize_buffers(buf, size)        \
+    do {                                    \
+        int j;                              \
+        for (j = 0; j < size; j += 4)       \
+            AV_WN32A(buf + j, rnd());       \
+    } while (0)
+
+static void check_blend_row(const OverlayDSPContext *dsp, int alpha_format,
+                            const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, d,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, d0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, d1, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, s,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, a,  [WIDTH]);
+    int i, w, n;
+
+    declare_func(int, uint8_t *d, const uint8_t *s, const uint8_t *a, int w);
+
+    if (check_func(dsp->blend_row[alpha_format], "%s", name)) {
+        for (w = 1; w <= WIDTH; w += 37) {
+            randomize_buffers(d,  WIDTH);
+            randomize_buffers(s,  WIDTH);
+            randomize_buffers(a,  WIDTH);
+            /* exercise the extreme alpha values as well */
+            for (i = 0; i < WIDTH; i += 7)
+                a[i] = i & 8 ? 255 : 0;
+            memcpy(d0, d, WIDTH);
+            memcpy(d1, d, WIDTH);
+
+            /* the pixels past the returned count must be left untouched */
+            call_ref(d0, s, a, w);
+            n = call_new(d1, s, a, w);
+            if (n < 0 || n > w || memcmp(d0, d1, n) ||
+                memcmp(d1 + n, d + n, WIDTH - n))
+                fail();
+        }
+        bench_new(d1, s, a, WIDTH);
+    }
+    report("%s", name);
+}
+
+void checkasm_check_overlay(void)
+{
+    OverlayDSPContext dsp;
+
+    ff_overlay_init(&dsp);
+
+    check_blend_row(&dsp, OVERLAY_ALPHA_STRAIGHT,      "blend_row");
+    check_blend_row(&dsp, OVERLAY_ALPHA_PREMULTIPLIED, "blend_row_premultiplied");
+}
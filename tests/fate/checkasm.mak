@@ -1,8 +1,11 @@
-FATE_CHECKASM = fate-checkasm-alacdsp                                   \
+FATE_CHECKASM = fate-checkasm-af_amix                                   \
+                fate-checkasm-af_ebur128                                \
+                fate-checkasm-alacdsp                                   \
                 fate-checkasm-audiodsp                                  \
                 fate-checkasm-blockdsp                                  \
                 fate-checkasm-bswapdsp                                  \
                 fate-checkasm-fixed_dsp                                 \
+                fate-checkasm-float_dsp                                 \
                 fate-checkasm-flacdsp                                   \
                 fate-checkasm-fmtconvert                                \
                 fate-checkasm-h264dsp                                   \
@@ -10,13 +13,21 @@ FATE_CHECKASM = fate-checkasm-alacdsp                                   \
                 fate-checkasm-h264qpel                                  \
                 fate-checkasm-hevc_add_res                              \
                 fate-checkasm-hevc_idct                                 \
+                fate-checkasm-hevc_pel                                  \
                 fate-checkasm-jpeg2000dsp                               \
                 fate-checkasm-llviddsp                                  \
                 fate-checkasm-pixblockdsp                               \
+                fate-checkasm-proresencdsp                              \
+                fate-checkasm-sw_audio_convert                          \
+                fate-checkasm-sw_rematrix                               \
+                fate-checkasm-sw_resample                               \
+                fate-checkasm-sw_scale                                  \
                 fate-checkasm-synth_filter                              \
                 fate-checkasm-v210enc                                   \
                 fate-checkasm-vf_blend                                  \
                 fate-checkasm-vf_colorspace                             \
+                fate-checkasm-vf_nlmeans                                \
+                fate-checkasm-vf_overlay                                \
                 fate-checkasm-videodsp                                  \
                 fate-checkasm-vp8dsp                                    \
                 fate-checkasm-vp9dsp                                    \
@@ -80,6 +80,14 @@ fate-filter-testsrc2-yuv444p: CMD = framecrc -lavfi testsrc2=r=7:d=10 -pix_fmt y
 FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER) += fate-filter-testsrc2-rgb24
 fate-filter-testsrc2-rgb24: CMD = framecrc -lavfi testsrc2=r=7:d=10 -pix_fmt rgb24
 
+HALDCLUT_GRAPH = "testsrc2=r=7:d=2,format=$(1)[main];haldclutsrc=level=6,lutrgb=r=negval:b=val/2[clut];[main][clut]haldclut=shortest=1"
+
+FATE_FILTER_HALDCLUT = fate-filter-haldclut-gbrp fate-filter-haldclut-gbrp10 fate-filter-haldclut-yuv444p10
+FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER FORMAT_FILTER HALDCLUTSRC_FILTER LUTRGB_FILTER HALDCLUT_FILTER) += $(FATE_FILTER_HALDCLUT)
+fate-filter-haldclut-gbrp:      CMD = framecrc -lavfi $(call HALDCLUT_GRAPH,gbrp)      -pix_fmt gbrp
+fate-filter-haldclut-gbrp10:    CMD = framecrc -lavfi $(call HALDCLUT_GRAPH,gbrp10)    -pix_fmt gbrp10
+fate-filter-haldclut-yuv444p10: CMD = framecrc -lavfi $(call HALDCLUT_GRAPH,yuv444p10) -pix_fmt yuv444p10
+
 FATE_FILTER-$(call ALLYES, AVDEVICE TESTSRC_FILTER FORMAT_FILTER CONCAT_FILTER SCALE_FILTER) += fate-filter-lavd-scalenorm
 fate-filter-lavd-scalenorm: tests/data/filtergraphs/scalenorm
 fate-filter-lavd-scalenorm: CMD = framecrc -f lavfi -graph_file $(TARGET_PATH)/tests/data/filtergraphs/scalenorm -i dummy
@@ -667,6 +675,10 @@ FATE_METADATA_FILTER-$(call ALLYES, $(EBUR128_METADATA_DEPS)) += fate-filter-met
 fate-filter-metadata-ebur128: SRC = $(TARGET_SAMPLES)/filter/seq-3341-7_seq-3342-5-24bit.flac
 fate-filter-metadata-ebur128: CMD = run $(FILTER_METADATA_COMMAND) "amovie='$(SRC)',ebur128=metadata=1"
 
+EBUR128_TPK_METADATA_DEPS = FFPROBE AVDEVICE LAVFI_INDEV SINE_FILTER EBUR128_FILTER
+FATE_METADATA_FILTER-$(call ALLYES, $(EBUR128_TPK_METADATA_DEPS)) += fate-filter-metadata-ebur128-tpk
+fate-filter-metadata-ebur128-tpk: CMD = run $(FILTER_METADATA_COMMAND) sine="frequency=10000:sample_rate=44100:duration=1,ebur128=metadata=1:peak=true+sample"
+
 READVITC_METADATA_DEPS = FFPROBE LAVFI_INDEV MOVIE_FILTER AVCODEC AVDEVICE \
                          AVI_DEMUXER FFVHUFF_DECODER READVITC_FILTER
 FATE_METADATA_FILTER-$(call ALLYES, $(READVITC_METADATA_DEPS)) += fate-filter-metadata-readvitc-def
@@ -109,6 +109,10 @@ FATE_LIBAVUTIL += fate-md5
 fate-md5: libavutil/tests/md5$(EXESUF)
 fate-md5: CMD = run libavutil/tests/md5
 
+FATE_LIBAVUTIL-$(HAVE_PTHREADS) += fate-mem
+fate-mem: libavutil/tests/mem$(EXESUF)
+fate-mem: CMD = run libavutil/tests/mem
+
 FATE_LIBAVUTIL += fate-murmur3
 fate-murmur3: libavutil/tests/murmur3$(EXESUF)
 fate-murmur3: CMD = run libavutil/tests/murmur3
@@ -141,6 +145,11 @@ FATE_LIBAVUTIL += fate-sha512
 fate-sha512: libavutil/tests/sha512$(EXESUF)
 fate-sha512: CMD = run libavutil/tests/sha512
 
+FATE_LIBAVUTIL-$(HAVE_THREADS) += fate-threadpool
+fate-threadpool: libavutil/tests/threadpool$(EXESUF)
+fate-threadpool: CMD = run libavutil/tests/threadpool
+fate-threadpool: REF = /dev/null
+
 FATE_LIBAVUTIL += fate-tree
 fate-tree: libavutil/tests/tree$(EXESUF)
 fate-tree: CMD = run libavutil/tests/tree
@@ -1094,5 +1094,16 @@ fate-swr-audioconvert: CMP = stddev
 fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
+
+# 5.1 to mono goes through the generic N to 1 mix; the volume makes it clip
+FATE_SWR_REMATRIX-$(call FILTERDEMDECENCMUX, ARESAMPLE AFORMAT, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-swr-rematrix-s16p
+fate-swr-rematrix-s16p: tests/data/asynth-22050-6.wav
+fate-swr-rematrix-s16p: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-22050-6.wav -af aresample=rematrix_volume=2,aformat=channel_layouts=mono -fflags +bitexact -f wav
+
+FATE_SWR_REMATRIX-$(call FILTERDEMDECENCMUX, ARESAMPLE AFORMAT, WAV, PCM_S16LE, PCM_S32LE, WAV) += fate-swr-rematrix-s32p
+fate-swr-rematrix-s32p: tests/data/asynth-22050-6.wav
+fate-swr-rematrix-s32p: CMD = md5 -i $(TARGET_PATH)/tests/data/asynth-22050-6.wav -af aresample=internal_sample_fmt=s32p,aformat=sample_fmts=s32:channel_layouts=mono -fflags +bitexact -f wav -acodec pcm_s32le
+
+FATE_SWR += $(FATE_SWR_REMATRIX-yes)
 FATE_FFMPEG += $(FATE_SWR)
 fate-swr: $(FATE_SWR)
@@ -0,0 +1,735 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Throughput benchmark for decoders, encoders, swscale and filtergraphs.
+ *
+ * The packets of one video stream are read into memory, and decoded into
+ * memory for the modes that take frames, before anything is timed. Each
+ * run then only sets up the benchmarked component, feeds it everything and
+ * drains it. The results are written as JSON, one entry per thread count.
+ */
+
+#include "config.h"
+
+#if HAVE_SCHED_GETAFFINITY
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+#include <sched.h>
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+#include "libavformat/avformat.h"
+#include "libavutil/avstring.h"
+#include "libavutil/mem.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+#include "libavutil/timer.h"
+#include "libswscale/swscale.h"
+
+#ifndef AV_READ_TIME
+#define AV_READ_TIME(x) 0
+#define HAVE_CYCLES 0
+#else
+#define HAVE_CYCLES 1
+#endif
+
+#if HAVE_UNISTD_H
+#include <unistd.h> /* for getopt */
+#endif
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+#define MAX_THREAD_COUNTS 32
+#define MAX_RUNS          100
+
+typedef struct BenchContext {
+    const struct BenchMode *mode;
+    const char *input;
+    const char *arg;
+    int nb_runs;
+    int max_frames;
+    int pin;
+    int thread_counts[MAX_THREAD_COUNTS];
+    int nb_thread_counts;
+
+    AVFormatContext *fmt;
+    AVStream *st;
+    AVPacket **packets;
+    int nb_packets;
+    AVFrame **frames;
+    int nb_frames;
+    int width, height;
+    enum AVPixelFormat pix_fmt;
+    const char *component;
+
+    /* state of one run */
+    AVCodecContext *avctx;
+    AVCodec *encoder;
+    struct SwsContext *sws;
+    int dst_w, dst_h;
+    enum AVPixelFormat dst_fmt;
+    AVFilterGraph *graph;
+    AVFilterContext *src, *sink;
+    AVFrame *frame;
+    AVPacket *pkt;
+
+#if HAVE_SCHED_GETAFFINITY && defined(CPU_SET)
+    cpu_set_t cpus;
+#endif
+} BenchContext;
+
+typedef struct BenchMode {
+    const char *name;
+    int need_frames;
+    /** once, after the input has been read */
+    int  (*prepare)(BenchContext *b);
+    /** before each run, untimed */
+    int  (*init)(BenchContext *b, int threads);
+    /** timed; returns the number of frames processed */
+    int  (*run)(BenchContext *b);
+    void (*uninit)(BenchContext *b);
+} BenchMode;
+
+static int open_decoder(BenchContext *b, int threads)
+{
+    AVCodec *codec = avcodec_find_decoder(b->st->codecpar->codec_id);
+    int ret;
+
+    if (!codec) {
+        av_log(NULL, AV_LOG_ERROR, "No decoder for the input stream\n");
+        return AVERROR_DECODER_NOT_FOUND;
+    }
+    if (!(b->avctx = avcodec_alloc_context3(codec)))
+        return AVERROR(ENOMEM);
+    if ((ret = avcodec_parameters_to_context(b->avctx, b->st->codecpar)) < 0)
+        return ret;
+    b->avctx->thread_count = threads;
+    return avcodec_open2(b->avctx, codec, NULL);
+}
+
+static void close_codec(BenchContext *b)
+{
+    avcodec_free_context(&b->avctx);
+}
+
+/* Decode all packets, storing the frames if store is set. */
+static int decode_packets(BenchContext *b, int store)
+{
+    int i, ret, nb = 0;
+
+    for (i = 0; i <= b->nb_packets; i++) {
+        ret = avcodec_send_packet(b->avctx, i < b->nb_packets ? b->packets[i] : NULL);
+        if (ret < 0)
+            return ret;
+        while ((ret = avcodec_receive_frame(b->avctx, b->frame)) >= 0) {
+            nb++;
+            if (store && b->nb_frames < b->max_frames) {
+                AVFrame *f = av_frame_alloc();
+                if (!f)
+                    return AVERROR(ENOMEM);
+                av_frame_move_ref(f, b->frame);
+                f->pts = b->nb_frames;
+                b->frames[b->nb_frames++] = f;
+            }
+            av_frame_unref(b->frame);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            return ret;
+    }
+    return nb;
+}
+
+static int decode_run(BenchContext *b)
+{
+    return decode_packets(b, 0);
+}
+
+/* Convert the preloaded frames to another pixel format, untimed. */
+static int convert_frames(BenchContext *b, enum AVPixelFormat fmt)
+{
+    struct SwsContext *sws;
+    int i, ret = 0;
+
+    sws = sws_getContext(b->width, b->height, b->pix_fmt,
+                         b->width, b->height, fmt, SWS_BICUBIC, NULL, NULL, NULL);
+    if (!sws)
+        return AVERROR(EINVAL);
+    for (i = 0; i < b->nb_frames; i++) {
+        AVFrame *src = b->frames[i], *dst = av_frame_alloc();
+        if (!dst) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        dst->format = fmt;
+        dst->width  = b->width;
+        dst->height = b->height;
+        if ((ret = av_frame_get_buffer(dst, 32)) < 0 ||
+            (ret = av_frame_copy_props(dst, src)) < 0) {
+            av_frame_free(&dst);
+            break;
+        }
+        sws_scale(sws, (const uint8_t * const *)src->data, src->linesize,
+                  0, b->height, dst->data, dst->linesize);
+        av_frame_free(&b->frames[i]);
+        b->frames[i] = dst;
+    }
+    sws_freeContext(sws);
+    b->pix_fmt = fmt;
+    return ret;
+}
+
+static int encode_prepare(BenchContext *b)
+{
+    const enum AVPixelFormat *p;
+
+    if (!(b->encoder = avcodec_find_encoder_by_name(b->arg))) {
+        av_log(NULL, AV_LOG_ERROR, "Unknown encoder '%s'\n", b->arg);
+        return AVERROR_ENCODER_NOT_FOUND;
+    }
+    if (b->encoder->type != AVMEDIA_TYPE_VIDEO) {
+        av_log(NULL, AV_LOG_ERROR, "Encoder '%s' is not a video encoder\n", b->arg);
+        return AVERROR(EINVAL);
+    }
+    b->component = b->encoder->name;
+    if (!b->encoder->pix_fmts)
+        return 0;
+    for (p = b->encoder->pix_fmts; *p != AV_PIX_FMT_NONE; p++)
+        if (*p == b->pix_fmt)
+            return 0;
+    return convert_frames(b, avcodec_find_best_pix_fmt_of_list(b->encoder->pix_fmts,
+                                                                b->pix_fmt, 0, NULL));
+}
+
+static int encode_init(BenchContext *b, int threads)
+{
+    AVRational rate = b->st->avg_frame_rate;
+
+    if (!(b->avctx = avcodec_alloc_context3(b->encoder)))
+        return AVERROR(ENOMEM);
+    b->avctx->width               = b->width;
+    b->avctx->height              = b->height;
+    b->avctx->pix_fmt             = b->pix_fmt;
+    b->avctx->sample_aspect_ratio = b->frames[0]->sample_aspect_ratio;
+    b->avctx->time_base           = rate.num && rate.den ? av_inv_q(rate)
+                                                         : (AVRational){ 1, 25 };
+    b->avctx->thread_count        = threads;
+    return avcodec_open2(b->avctx, b->encoder, NULL);
+}
+
+static int encode_run(BenchContext *b)
+{
+    int i, ret;
+
+    for (i = 0; i <= b->nb_frames; i++) {
+        ret = avcodec_send_frame(b->avctx, i < b->nb_frames ? b->frames[i] : NULL);
+        if (ret < 0)
+            return ret;
+        while ((ret = avcodec_receive_packet(b->avctx, b->pkt)) >= 0)
+            av_packet_unref(b->pkt);
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            return ret;
+    }
+    return b->nb_frames;
+}
+
+static int scale_prepare(BenchContext *b)
+{
+    char size[64];
+    const char *fmt = strchr(b->arg, ':');
+
+    av_strlcpy(size, b->arg, fmt ? FFMIN(sizeof(size), fmt - b->arg + 1) : sizeof(size));
+    if (av_parse_video_size(&b->dst_w, &b->dst_h, size) < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Invalid size '%s'\n", size);
+        return AVERROR(EINVAL);
+    }
+    b->dst_fmt = fmt ? av_get_pix_fmt(fmt + 1) : b->pix_fmt;
+    if (b->dst_fmt == AV_PIX_FMT_NONE) {
+        av_log(NULL, AV_LOG_ERROR, "Unknown pixel format '%s'\n", fmt + 1);
+        return AVERROR(EINVAL);
+    }
+    b->component = "swscale";
+    if (b->nb_thread_counts > 1) {
+        av_log(NULL, AV_LOG_WARNING, "swscale is single-threaded, "
+               "only benchmarking with 1 thread\n");
+        b->thread_counts[0]  = 1;
+        b->nb_thread_counts = 1;
+    }
+    return 0;
+}
+
+static int scale_init(BenchContext *b, int threads)
+{
+    b->sws = sws_getContext(b->width, b->height, b->pix_fmt,
+                            b->dst_w, b->dst_h, b->dst_fmt,
+                            SWS_BICUBIC, NULL, NULL, NULL);
+    if (!b->sws)
+        return AVERROR(EINVAL);
+    b->frame->format = b->dst_fmt;
+    b->frame->width  = b->dst_w;
+    b->frame->height = b->dst_h;
+    return av_frame_get_buffer(b->frame, 32);
+}
+
+static int scale_run(BenchContext *b)
+{
+    int i;
+
+    for (i = 0; i < b->nb_frames; i++)
+        sws_scale(b->sws, (const uint8_t * const *)b->frames[i]->data,
+                  b->frames[i]->linesize, 0, b->height,
+                  b->frame->data, b->frame->linesize);
+    return b->nb_frames;
+}
+
+static void scale_uninit(BenchContext *b)
+{
+    sws_freeContext(b->sws);
+    b->sws = NULL;
+    av_frame_unref(b->frame);
+}
+
+static int filter_prepare(BenchContext *b)
+{
+    b->component = b->arg;
+    return 0;
+}
+
+static int filter_init(BenchContext *b, int threads)
+{
+    AVFilterInOut *outputs = avfilter_inout_alloc();
+    AVFilterInOut *inputs  = avfilter_inout_alloc();
+    AVRational sar = b->frames[0]->sample_aspect_ratio;
+    char args[256];
+    int ret;
+
+    if (!outputs || !inputs || !(b->graph = avfilter_graph_alloc())) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    b->graph->nb_threads = threads;
+
+    snprintf(args, sizeof(args),
+             "video_size=%dx%d:pix_fmt=%d:time_base=1/25:pixel_aspect=%d/%d",
+             b->width, b->height, b->pix_fmt, sar.num, FFMAX(sar.den, 1));
+    ret = avfilter_graph_create_filter(&b->src, avfilter_get_by_name("buffer"),
+                                       "in", args, NULL, b->graph);
+    if (ret < 0)
+        goto end;
+    ret = avfilter_graph_create_filter(&b->sink, avfilter_get_by_name("buffersink"),
+                                       "out", NULL, NULL, b->graph);
+    if (ret < 0)
+        goto end;
+
+    outputs->name       = av_strdup("in");
+    outputs->filter_ctx = b->src;
+    inputs->name        = av_strdup("out");
+    inputs->filter_ctx  = b->sink;
+    if (!outputs->name || !inputs->name) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = avfilter_graph_parse_ptr(b->graph, b->arg, &inputs, &outputs, NULL)) < 0)
+        goto end;
+    ret = avfilter_graph_config(b->graph, NULL);
+end:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    return ret;
+}
+
+static int filter_drain(BenchContext *b)
+{
+    int ret;
+
+    while ((ret = av_buffersink_get_frame(b->sink, b->frame)) >= 0)
+        av_frame_unref(b->frame);
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int filter_run(BenchContext *b)
+{
+    int i, ret;
+
+    for (i = 0; i <= b->nb_frames; i++) {
+        ret = av_buffersrc_add_frame_flags(b->src, i < b->nb_frames ? b->frames[i] : NULL,
+                                           AV_BUFFERSRC_FLAG_KEEP_REF);
+        if (ret < 0 || (ret = filter_drain(b)) < 0)
+            return ret;
+    }
+    return b->nb_frames;
+}
+
+static void filter_uninit(BenchContext *b)
+{
+    avfilter_graph_free(&b->graph);
+}
+
+static const BenchMode modes[] = {
+    { "decode", 0, NULL,           open_decoder, decode_run, close_codec   },
+    { "encode", 1, encode_prepare, encode_init,  encode_run, close_codec   },
+    { "scale",  1, scale_prepare,  scale_init,   scale_run,  scale_uninit  },
+    { "filter", 1, filter_prepare, filter_init,  filter_run, filter_uninit },
+};
+
+static int read_input(BenchContext *b)
+{
+    AVPacket *pkt = NULL;
+    int idx, ret;
+
+    if ((ret = avformat_open_input(&b->fmt, b->input, NULL, NULL)) < 0 ||
+        (ret = avformat_find_stream_info(b->fmt, NULL)) < 0)
+        return ret;
+    idx = av_find_best_stream(b->fmt, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (idx < 0)
+        return idx;
+    b->st = b->fmt->streams[idx];
+    b->component = avcodec_get_name(b->st->codecpar->codec_id);
+
+    if (!(b->packets = av_calloc(b->max_frames, sizeof(*b->packets))))
+        return AVERROR(ENOMEM);
+    while (b->nb_packets < b->max_frames) {
+        if (!pkt && !(pkt = av_packet_alloc()))
+            return AVERROR(ENOMEM);
+        if ((ret = av_read_frame(b->fmt, pkt)) < 0)
+            break;
+        if (pkt->stream_index == idx) {
+            b->packets[b->nb_packets++] = pkt;
+            pkt = NULL;
+        } else {
+            av_packet_unref(pkt);
+        }
+    }
+    av_packet_free(&pkt);
+    if (ret < 0 && ret != AVERROR_EOF)
+        return ret;
+
+    b->width   = b->st->codecpar->width;
+    b->height  = b->st->codecpar->height;
+    b->pix_fmt = b->st->codecpar->format;
+    if (!b->mode->need_frames)
+        return 0;
+
+    /* decode everything now, so that the runs only time the component */
+    if (!(b->frames = av_calloc(b->max_frames, sizeof(*b->frames))))
+        return AVERROR(ENOMEM);
+    if ((ret = open_decoder(b, 0)) < 0 || (ret = decode_packets(b, 1)) < 0)
+        return ret;
+    close_codec(b);
+    if (!b->nb_frames) {
+        av_log(NULL, AV_LOG_ERROR, "No frames decoded from '%s'\n", b->input);
+        return AVERROR_INVALIDDATA;
+    }
+    b->width   = b->frames[0]->width;
+    b->height  = b->frames[0]->height;
+    b->pix_fmt = b->frames[0]->format;
+    return 0;
+}
+
+/* Restrict the process, and the threads it creates later, to n CPUs. */
+static void pin_threads(BenchContext *b, int n)
+{
+#if HAVE_SCHED_GETAFFINITY && defined(CPU_SET)
+    cpu_set_t set;
+    int i;
+
+    CPU_ZERO(&set);
+    for (i = 0; i < CPU_SETSIZE && n > 0; i++) {
+        if (CPU_ISSET(i, &b->cpus)) {
+            CPU_SET(i, &set);
+            n--;
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set))
+        av_log(NULL, AV_LOG_WARNING, "Could not set the CPU affinity\n");
+#endif
+}
+
+/**
+ * Run once more with allocation accounting, which is kept out of the timed
+ * runs, and return the peak of the heap memory allocated during the run.
+ */
+static int64_t measure_peak_heap(BenchContext *b, int threads)
+{
+    AVMemStats total = { 0 }, *stats;
+    int nb_stats, ret;
+
+    if ((ret = av_mem_set_accounting(1)) < 0)
+        return ret;
+    ret = b->mode->init(b, threads);
+    if (ret >= 0)
+        ret = b->mode->run(b);
+    b->mode->uninit(b);
+    av_mem_set_accounting(0);
+    if (ret < 0)
+        return ret;
+
+    stats = av_mem_get_stats(&total, &nb_stats);
+    if (!stats)
+        return AVERROR(ENOMEM);
+    av_free(stats);
+    return total.peak_bytes;
+}
+
+static void print_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(f, "\\u%04x", (unsigned char)*s);
+        else
+            fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static int run_benchmark(BenchContext *b, FILE *out)
+{
+    double base_fps = 0;
+    int i, j, ret;
+
+    fprintf(out, "{\n  \"version\": ");
+    print_string(out, av_version_info());
+    fprintf(out, ",\n  \"mode\": \"%s\",\n  \"input\": ", b->mode->name);
+    print_string(out, b->input);
+    fprintf(out, ",\n  \"component\": ");
+    print_string(out, b->component);
+    fprintf(out, ",\n  \"width\": %d,\n  \"height\": %d,\n  \"pix_fmt\": \"%s\",\n"
+            "  \"frames\": %d,\n  \"runs\": %d,\n  \"pinned\": %s,\n  \"results\": [",
+            b->width, b->height, av_get_pix_fmt_name(b->pix_fmt) ? av_get_pix_fmt_name(b->pix_fmt) : "none",
+            b->mode->need_frames ? b->nb_frames : b->nb_packets, b->nb_runs,
+            b->pin ? "true" : "false");
+
+    for (i = 0; i < b->nb_thread_counts; i++) {
+        int threads = b->thread_counts[i];
+        double seconds[MAX_RUNS], best = 0, total = 0;
+        uint64_t cycles, best_cycles = 0;
+        int64_t peak_heap;
+        int frames = 0;
+
+        if (b->pin)
+            pin_threads(b, threads);
+
+        /* the first run warms up the caches and is not reported */
+        for (j = -1; j < b->nb_runs; j++) {
+            int64_t t0, t1;
+            uint64_t c0, c1;
+
+            if ((ret = b->mode->init(b, threads)) < 0) {
+                b->mode->uninit(b);
+                goto fail;
+            }
+            t0 = av_gettime_relative();
+            c0 = AV_READ_TIME();
+            ret = b->mode->run(b);
+            c1 = AV_READ_TIME();
+            t1 = av_gettime_relative();
+            b->mode->uninit(b);
+            if (ret < 0)
+                goto fail;
+            if (j < 0)
+                continue;
+
+            frames     = ret;
+            seconds[j] = (t1 - t0) / 1000000.0;
+            cycles     = c1 - c0;
+            total     += seconds[j];
+            if (!j || seconds[j] < best) {
+                best        = seconds[j];
+                best_cycles = cycles;
+            }
+        }
+
+        peak_heap = measure_peak_heap(b, threads);
+        if (peak_heap < 0 && peak_heap != AVERROR(ENOSYS)) {
+            ret = peak_heap;
+            goto fail;
+        }
+
+        fprintf(out, "%s\n    {\n      \"threads\": %d,\n      \"seconds\": [",
+                i ? "," : "", threads);
+        for (j = 0; j < b->nb_runs; j++)
+            fprintf(out, "%s%.6f", j ? ", " : "", seconds[j]);
+        fprintf(out, "],\n      \"fps\": %.3f,\n      \"mean_fps\": %.3f,\n",
+                best > 0 ? frames / best : 0, total > 0 ? frames * b->nb_runs / total : 0);
+        if (HAVE_CYCLES && frames && b->width && b->height)
+            fprintf(out, "      \"cycles_per_pixel\": %.3f,\n",
+                    (double)best_cycles / ((double)frames * b->width * b->height));
+        else
+            fprintf(out, "      \"cycles_per_pixel\": null,\n");
+        if (peak_heap >= 0)
+            fprintf(out, "      \"peak_heap_kb\": %"PRId64",\n", peak_heap >> 10);
+        else
+            fprintf(out, "      \"peak_heap_kb\": null,\n");
+        if (!i)
+            base_fps = best > 0 ? frames / best : 0;
+        fprintf(out, "      \"speedup\": %.3f\n    }",
+                base_fps > 0 && best > 0 ? frames / best / base_fps : 0);
+        fflush(out);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    return 0;
+fail:
+    fprintf(out, "\n  ]\n}\n");
+    return ret;
+}
+
+static int parse_thread_counts(BenchContext *b, const char *s)
+{
+    char *end;
+
+    b->nb_thread_counts = 0;
+    do {
+        long n = strtol(s, &end, 10);
+        if (end == s || n < 1 || n > 1024 ||
+            b->nb_thread_counts == MAX_THREAD_COUNTS)
+            return AVERROR(EINVAL);
+        b->thread_counts[b->nb_thread_counts++] = n;
+        s = end + 1;
+    } while (*end == ',');
+    return *end ? AVERROR(EINVAL) : 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] decode INPUT\n"
+            "       %s [options] encode INPUT ENCODER\n"
+            "       %s [options] scale  INPUT WxH[:pix_fmt]\n"
+            "       %s [options] filter INPUT GRAPH\n"
+            "Benchmark the first video stream of INPUT, or a component fed with its\n"
+            "decoded frames, with everything preloaded into memory.\n"
+            "Options:\n"
+            "  -n runs     timed runs per thread count (default 3)\n"
+            "  -f frames   number of packets to preload (default 100)\n"
+            "  -t list     comma-separated thread counts, e.g. 1,2,4,8 (default 1)\n"
+            "  -p          pin to as many CPUs as threads\n"
+            "  -o file     write the JSON report to file instead of stdout\n",
+            name, name, name, name);
+}
+
+int main(int argc, char **argv)
+{
+    BenchContext b = { .nb_runs = 3, .max_frames = 100,
+                       .thread_counts = { 1 }, .nb_thread_counts = 1 };
+    const char *output = NULL;
+    FILE *out = stdout;
+    int i, opt, ret;
+
+    while ((opt = getopt(argc, argv, "hn:f:t:po:")) != -1) {
+        switch (opt) {
+        case 'n':
+            b.nb_runs = strtol(optarg, NULL, 0);
+            break;
+        case 'f':
+            b.max_frames = strtol(optarg, NULL, 0);
+            break;
+        case 't':
+            if (parse_thread_counts(&b, optarg) < 0) {
+                fprintf(stderr, "Invalid thread counts '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            b.pin = 1;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            return opt != 'h';
+        }
+    }
+    if (argc - optind < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (i = 0; i < FF_ARRAY_ELEMS(modes); i++)
+        if (!strcmp(argv[optind], modes[i].name))
+            b.mode = &modes[i];
+    if (!b.mode || (b.mode->need_frames && argc - optind < 3) ||
+        b.nb_runs < 1 || b.nb_runs > MAX_RUNS || b.max_frames < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    b.input = argv[optind + 1];
+    b.arg   = argv[optind + 2];
+
+#if HAVE_SCHED_GETAFFINITY && defined(CPU_SET)
+    if (b.pin && sched_getaffinity(0, sizeof(b.cpus), &b.cpus)) {
+        av_log(NULL, AV_LOG_WARNING, "Could not get the CPU affinity\n");
+        b.pin = 0;
+    }
+#else
+    b.pin = 0;
+#endif
+
+    av_register_all();
+    avfilter_register_all();
+
+    if (!(b.frame = av_frame_alloc()) || !(b.pkt = av_packet_alloc())) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = read_input(&b)) < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Error reading '%s'\n", b.input);
+        goto end;
+    }
+    if (b.mode->prepare && (ret = b.mode->prepare(&b)) < 0)
+        goto end;
+
+    if (output && !(out = fopen(output, "w"))) {
+        ret = AVERROR(errno);
+        goto end;
+    }
+    ret = run_benchmark(&b, out);
+    if (out != stdout)
+        fclose(out);
+
+end:
+    if (ret < 0)
+        av_log(NULL, AV_LOG_ERROR, "%s\n", av_err2str(ret));
+    close_codec(&b);
+    for (i = 0; i < b.nb_packets; i++)
+        av_packet_free(&b.packets[i]);
+    av_freep(&b.packets);
+    for (i = 0; i < b.nb_frames; i++)
+        av_frame_free(&b.frames[i]);
+    av_freep(&b.frames);
+    av_frame_free(&b.frame);
+    av_packet_free(&b.pkt);
+    avformat_close_input(&b.fmt);
+    return ret < 0;
+}